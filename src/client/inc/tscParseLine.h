@@ -73,6 +73,20 @@ typedef struct SSmlSqlInsertBatch {
 } SSmlSqlInsertBatch;
 
 #define MAX_SML_SQL_INSERT_BATCHES 512
+#define SML_STMT_MAX_BATCH_ROWS    10000
+
+typedef struct {
+  SArray* cTablePoints;
+  int32_t fromIndex;
+  int32_t toIndex;
+} SSmlStmtRange;
+
+// the points of a super table bound to its insert statement, kept until executed so they can be bound again on retry
+typedef struct {
+  TAOS_STMT* stmt;
+  SArray*    ranges;  // SArray<SSmlStmtRange>
+  int32_t    numOfRows;
+} SSmlStmtBatch;
 
 typedef struct {
   uint64_t id;
@@ -288,6 +288,7 @@ STableMetaInfo* tscGetTableMetaInfoFromCmd(SSqlCmd *pCmd, int32_t tableIndex);
 STableMetaInfo* tscGetMetaInfo(SQueryInfo *pQueryInfo, int32_t tableIndex);
 
 void        tscInitQueryInfo(SQueryInfo* pQueryInfo);
+int32_t     tscQueryInfoCopy(SQueryInfo* pQueryInfo, const SQueryInfo* pSrc);
 void        tscClearSubqueryInfo(SSqlCmd* pCmd);
 int32_t     tscAddQueryInfo(SSqlCmd *pCmd);
 SQueryInfo *tscGetQueryInfo(SSqlCmd* pCmd);
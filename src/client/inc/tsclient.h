@@ -522,6 +522,9 @@ extern SHashObj  *tscVgroupMap;
 extern SHashObj  *tscTableMetaMap;
 extern SCacheObj *tscVgroupListBuf;
 
+// lifetime of a cached super table vgroup list
+#define TSC_STABLE_VGROUP_LIST_KEEP_MS 5000
+
 extern int   tscObjRef;
 extern void *tscTmr;
 extern void *tscQhandle;
@@ -379,22 +379,22 @@ static int32_t createOrderDescriptor(tOrderDescriptor **pOrderDesc, SQueryInfo*
       }
     } else {
       /*
-       * 1. the orderby ts asc/desc projection query for the super table
+       * 1. the orderby ts/column asc/desc projection query for the super table
        * 2. interval query without groupby clause
        */
       if (pQueryInfo->interval.interval != 0) {
         orderColIndexList[0] = PRIMARYKEY_TIMESTAMP_COL_INDEX;
+        assert(pQueryInfo->order.orderColId == PRIMARYKEY_TIMESTAMP_COL_INDEX);
       } else {
         size_t size = tscNumOfExprs(pQueryInfo);
         for (int32_t i = 0; i < size; ++i) {
           SExprInfo *pExpr = tscExprGet(pQueryInfo, i);
-          if (pExpr->base.functionId == TSDB_FUNC_PRJ && pExpr->base.colInfo.colId == PRIMARYKEY_TIMESTAMP_COL_INDEX) {
+          if (pExpr->base.functionId == TSDB_FUNC_PRJ && pExpr->base.colInfo.colId == pQueryInfo->order.orderColId) {
             orderColIndexList[0] = i;
+            break;
           }
         }
       }
-
-      assert(pQueryInfo->order.orderColId == PRIMARYKEY_TIMESTAMP_COL_INDEX);
     }
   }
 
@@ -463,10 +463,13 @@ int32_t tscCreateGlobalMergerEnv(SQueryInfo *pQueryInfo, tExtMemBuffer ***pMemBu
     return TSDB_CODE_TSC_OUT_OF_MEMORY;
   }
 
+  // the results of all the vnodes are merged here, in the client. mergeMemBufferSize only keeps them out of the temp
+  // files, the merge itself is not moved to a dnode
   assert(numOfSub <= pTableMetaInfo->vgroupList->numOfVgroups);
   for (int32_t i = 0; i < numOfSub; ++i) {
     (*pMemBuffer)[i] = createExtMemBuffer(*nBufferSizes, rlen, pg, pModel);
     (*pMemBuffer)[i]->flushModel = MULTIPLE_APPEND_MODEL;
+    (*pMemBuffer)[i]->flushToMem = (tsMergeMemBufferSize > 0);  // the memory is shared by all the queries of the process
   }
 
   if (createOrderDescriptor(pOrderDesc, pQueryInfo, pModel) != TSDB_CODE_SUCCESS) {
@@ -1118,6 +1121,13 @@ static int32_t doSlimitImpl(SOperatorInfo* pOperator, SSLimitOperatorInfo* pInfo
     }
 
     rowIndex += 1;
+
+    // all rows are in one group without group columns, the rest of the merged rows are not required
+    if (numOfCols == 0 && pInfo->limit.limit >= 0 && pInfo->rowsTotal >= pInfo->limit.limit) {
+      setQueryStatus(pOperator->pRuntimeEnv, QUERY_COMPLETED);
+      pOperator->status = OP_EXEC_DONE;
+      return BLOCK_NO_GROUP;
+    }
   }
 
   return BLOCK_SAME_GROUP;
@@ -940,6 +940,12 @@ _cleanup:
   return 0;
 }
 
+static bool isSmlInsertRetryCode(int32_t code) {
+  return code == TSDB_CODE_TDB_INVALID_TABLE_ID || code == TSDB_CODE_VND_INVALID_VGROUP_ID ||
+         code == TSDB_CODE_TDB_TABLE_RECONFIGURE || code == TSDB_CODE_APP_NOT_READY ||
+         code == TSDB_CODE_RPC_NETWORK_UNAVAIL;
+}
+
 static void insertCallback(void *param, TAOS_RES *res, int32_t notUsedCode) {
   SSmlSqlInsertBatch *batch = (SSmlSqlInsertBatch *)param;
   batch->code = taos_errno(res);
@@ -955,11 +961,7 @@ static void insertCallback(void *param, TAOS_RES *res, int32_t notUsedCode) {
   batch->tryAgain = false;
   batch->resetQueryCache = false;
   batch->sleep = false;
-  if ((code == TSDB_CODE_TDB_INVALID_TABLE_ID
-       || code == TSDB_CODE_VND_INVALID_VGROUP_ID
-       || code == TSDB_CODE_TDB_TABLE_RECONFIGURE
-       || code == TSDB_CODE_APP_NOT_READY
-       || code == TSDB_CODE_RPC_NETWORK_UNAVAIL) && batch->tryTimes < TSDB_MAX_REPLICA) {
+  if (isSmlInsertRetryCode(code) && batch->tryTimes < TSDB_MAX_REPLICA) {
     batch->tryAgain = true;
   }
 
@@ -979,12 +981,9 @@ static void insertCallback(void *param, TAOS_RES *res, int32_t notUsedCode) {
   tsem_post(&batch->sem);
 }
 
-static int32_t applyDataPointsWithSqlInsert(TAOS* taos, TAOS_SML_DATA_POINT* points, int32_t numPoints, SArray* stableSchemas, SSmlLinesInfo* info) {
+static int32_t applyDataPointsWithSqlInsert(TAOS* taos, SHashObj* cname2points, SArray* stableSchemas, SSmlLinesInfo* info) {
   int32_t code = TSDB_CODE_SUCCESS;
 
-  SHashObj* cname2points = taosHashInit(128, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, false);
-  arrangePointsByChildTableName(points, numPoints, cname2points, stableSchemas, info);
-
   for (int i = 0; i < MAX_SML_SQL_INSERT_BATCHES; ++i) {
     info->batches[i].id = info->id;
     info->batches[i].index = i;
@@ -1112,14 +1111,313 @@ cleanup:
     info->batches[i].sql = NULL;
     tsem_destroy(&info->batches[i].sem);
   }
+  return code;
+}
+
+static char* buildStmtInsertSql(SSmlSTableSchema* sTableSchema) {
+  SStringBuilder sb;
+  memset(&sb, 0, sizeof(sb));
+
+  size_t numTags = taosArrayGetSize(sTableSchema->tags);
+  size_t numCols = taosArrayGetSize(sTableSchema->fields);
+
+  taosStringBuilderAppendString(&sb, "insert into ? using ");
+  taosStringBuilderAppendString(&sb, sTableSchema->sTableName);
+  taosStringBuilderAppendString(&sb, " (");
+  for (int i = 0; i < numTags; ++i) {
+    SSchema* tagSchema = taosArrayGet(sTableSchema->tags, i);
+    if (i > 0) {
+      taosStringBuilderAppendChar(&sb, ',');
+    }
+    taosStringBuilderAppendString(&sb, tagSchema->name);
+  }
+  taosStringBuilderAppendString(&sb, ") tags (");
+  for (int i = 0; i < numTags; ++i) {
+    taosStringBuilderAppendString(&sb, (i > 0) ? ",?" : "?");
+  }
+  taosStringBuilderAppendString(&sb, ") (");
+  for (int i = 0; i < numCols; ++i) {
+    SSchema* colSchema = taosArrayGet(sTableSchema->fields, i);
+    if (i > 0) {
+      taosStringBuilderAppendChar(&sb, ',');
+    }
+    taosStringBuilderAppendString(&sb, colSchema->name);
+  }
+  taosStringBuilderAppendString(&sb, ") values (");
+  for (int i = 0; i < numCols; ++i) {
+    taosStringBuilderAppendString(&sb, (i > 0) ? ",?" : "?");
+  }
+  taosStringBuilderAppendChar(&sb, ')');
+
+  return taosStringBuilderGetResult(&sb, NULL);
+}
+
+static int32_t bindChildTableTags(TAOS_STMT* stmt, char* cTableName, SSmlSTableSchema* sTableSchema, SArray* cTablePoints) {
+  size_t numTags = taosArrayGetSize(sTableSchema->tags);
+  size_t rows = taosArrayGetSize(cTablePoints);
+
+  TAOS_SML_KV* tagKVs[TSDB_MAX_TAGS] = {0};
+  for (int i = 0; i < rows; ++i) {
+    TAOS_SML_DATA_POINT* pDataPoint = taosArrayGetP(cTablePoints, i);
+    for (int j = 0; j < pDataPoint->tagNum; ++j) {
+      TAOS_SML_KV* kv = pDataPoint->tags + j;
+      tagKVs[kv->fieldSchemaIdx] = kv;
+    }
+  }
+
+  TAOS_BIND* tagBinds = calloc(numTags, sizeof(TAOS_BIND));
+  uintptr_t* lengths = calloc(numTags, sizeof(uintptr_t));
+  int        isNull = 1;
+  if (tagBinds == NULL || lengths == NULL) {
+    free(tagBinds);
+    free(lengths);
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  for (int i = 0; i < numTags; ++i) {
+    SSchema*     tagSchema = taosArrayGet(sTableSchema->tags, i);
+    TAOS_SML_KV* kv = tagKVs[i];
+
+    tagBinds[i].buffer_type = tagSchema->type;
+    if (kv == NULL) {
+      tagBinds[i].is_null = &isNull;
+    } else {
+      lengths[i] = kv->length;
+      tagBinds[i].buffer = kv->value;
+      tagBinds[i].buffer_length = kv->length;
+      tagBinds[i].length = &lengths[i];
+    }
+  }
+
+  int32_t code = taos_stmt_set_tbname_tags(stmt, cTableName, tagBinds);
+
+  free(tagBinds);
+  free(lengths);
+  return code;
+}
+
+// bind rows [fromIndex, toIndex) of a child table in the column-wise way
+static int32_t bindChildTableRows(TAOS_STMT* stmt, SSmlSTableSchema* sTableSchema, SArray* cTablePoints, int fromIndex,
+                                  int toIndex) {
+  int32_t code = TSDB_CODE_SUCCESS;
+  size_t  numCols = taosArrayGetSize(sTableSchema->fields);
+  int32_t rows = toIndex - fromIndex;
+
+  TAOS_MULTI_BIND* colBinds = calloc(numCols, sizeof(TAOS_MULTI_BIND));
+  if (colBinds == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  for (int i = 0; i < numCols; ++i) {
+    SSchema*         colSchema = taosArrayGet(sTableSchema->fields, i);
+    TAOS_MULTI_BIND* bind = colBinds + i;
+
+    bind->buffer_type = colSchema->type;
+    bind->buffer_length = IS_VAR_DATA_TYPE(colSchema->type) ? colSchema->bytes : tDataTypes[colSchema->type].bytes;
+    bind->num = rows;
+    bind->buffer = malloc(bind->buffer_length * rows);
+    bind->length = malloc(sizeof(int32_t) * rows);
+    bind->is_null = calloc(rows, sizeof(char));
+    if (bind->buffer == NULL || bind->length == NULL || bind->is_null == NULL) {
+      code = TSDB_CODE_TSC_OUT_OF_MEMORY;
+      goto _cleanup;
+    }
+
+    memset(bind->is_null, 1, rows);
+  }
+
+  for (int r = 0; r < rows; ++r) {
+    TAOS_SML_DATA_POINT* point = taosArrayGetP(cTablePoints, fromIndex + r);
+    for (int i = 0; i < point->fieldNum; ++i) {
+      TAOS_SML_KV*     kv = point->fields + i;
+      TAOS_MULTI_BIND* bind = colBinds + kv->fieldSchemaIdx;
+
+      int32_t len = IS_VAR_DATA_TYPE(kv->type) ? kv->length : tDataTypes[kv->type].bytes;
+      memcpy((char*)bind->buffer + bind->buffer_length * r, kv->value, len);
+      bind->length[r] = len;
+      bind->is_null[r] = 0;
+    }
+  }
+
+  code = taos_stmt_bind_param_batch(stmt, colBinds);
+  if (code == TSDB_CODE_SUCCESS) {
+    code = taos_stmt_add_batch(stmt);
+  }
+
+_cleanup:
+  for (int i = 0; i < numCols; ++i) {
+    free(colBinds[i].buffer);
+    free(colBinds[i].length);
+    free(colBinds[i].is_null);
+  }
+  free(colBinds);
+  return code;
+}
+
+static int32_t prepareSmlStmt(TAOS* taos, SSmlStmtBatch* pBatch, SSmlSTableSchema* sTableSchema, SSmlLinesInfo* info) {
+  pBatch->stmt = taos_stmt_init(taos);
+  if (pBatch->stmt == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  char* sql = buildStmtInsertSql(sTableSchema);
+  tscDebug("SML:0x%"PRIx64" prepare insert stmt: %s", info->id, sql);
+  int32_t code = taos_stmt_prepare(pBatch->stmt, sql, 0);
+  free(sql);
+  if (code != TSDB_CODE_SUCCESS) {
+    tscError("SML:0x%"PRIx64" prepare insert stmt failed: %s", info->id, taos_stmt_errstr(pBatch->stmt));
+  }
+
+  return code;
+}
+
+static int32_t bindSmlStmtBatch(SSmlStmtBatch* pBatch, SSmlSTableSchema* sTableSchema, SSmlLinesInfo* info) {
+  int32_t code = TSDB_CODE_SUCCESS;
+  size_t  numRanges = taosArrayGetSize(pBatch->ranges);
+
+  for (int32_t i = 0; i < numRanges && code == TSDB_CODE_SUCCESS; ++i) {
+    SSmlStmtRange*       pRange = taosArrayGet(pBatch->ranges, i);
+    TAOS_SML_DATA_POINT* point = taosArrayGetP(pRange->cTablePoints, 0);
+
+    code = bindChildTableTags(pBatch->stmt, point->childTableName, sTableSchema, pRange->cTablePoints);
+    if (code != TSDB_CODE_SUCCESS) {
+      tscError("SML:0x%"PRIx64" bind child table %s failed: %s", info->id, point->childTableName,
+               taos_stmt_errstr(pBatch->stmt));
+      break;
+    }
+
+    code = bindChildTableRows(pBatch->stmt, sTableSchema, pRange->cTablePoints, pRange->fromIndex, pRange->toIndex);
+    if (code != TSDB_CODE_SUCCESS) {
+      tscError("SML:0x%"PRIx64" bind points of child table %s failed: %s", info->id, point->childTableName,
+               taos_stmt_errstr(pBatch->stmt));
+    }
+  }
+
+  return code;
+}
+
+/*
+ * Bind the points kept by the batch and execute the statement. As the SQL path does, the statement is retried when
+ * the table meta or the vgroup of the client is stale, with a new statement which loads them again.
+ */
+static int32_t executeSmlStmtBatch(TAOS* taos, SSmlStmtBatch* pBatch, SSmlSTableSchema* sTableSchema,
+                                   SSmlLinesInfo* info) {
+  int32_t code = TSDB_CODE_SUCCESS;
+  if (pBatch->numOfRows == 0) {
+    return code;
+  }
+
+  for (int32_t tryTimes = 1;; ++tryTimes) {
+    code = TSDB_CODE_SUCCESS;
+    if (pBatch->stmt == NULL) {
+      code = prepareSmlStmt(taos, pBatch, sTableSchema, info);
+    }
+
+    if (code == TSDB_CODE_SUCCESS) {
+      code = bindSmlStmtBatch(pBatch, sTableSchema, info);
+    }
+
+    if (code == TSDB_CODE_SUCCESS) {
+      int32_t affectedRows = taos_stmt_affected_rows(pBatch->stmt);
+      code = taos_stmt_execute(pBatch->stmt);
+      if (code == TSDB_CODE_SUCCESS) {
+        info->affectedRows += taos_stmt_affected_rows(pBatch->stmt) - affectedRows;
+        break;
+      }
+
+      tscError("SML:0x%"PRIx64" execute insert stmt failed, try times:%d, code:0x%x, reason: %s", info->id, tryTimes, code,
+               taos_stmt_errstr(pBatch->stmt));
+    }
+
+    if (!isSmlInsertRetryCode(code) || tryTimes >= TSDB_MAX_REPLICA) {
+      break;
+    }
+
+    // the statement kept after a reconfigure attaches the table schema to the submit blocks
+    if (code == TSDB_CODE_TDB_INVALID_TABLE_ID || code == TSDB_CODE_VND_INVALID_VGROUP_ID) {
+      TAOS_RES* res = taos_query(taos, "RESET QUERY CACHE");
+      taos_free_result(res);
+
+      taos_stmt_close(pBatch->stmt);
+      pBatch->stmt = NULL;
+    }
+
+    if (code != TSDB_CODE_TDB_TABLE_RECONFIGURE) {
+      taosMsleep(100 * (2 << tryTimes));
+    }
+  }
+
+  taosArrayClear(pBatch->ranges);
+  pBatch->numOfRows = 0;
+  return code;
+}
+
+/*
+ * Bind the data points of each child table to an insert statement of its super table, so the values are written
+ * into the submit blocks directly, without being printed into SQL text and parsed again.
+ */
+static int32_t applyDataPointsWithStmt(TAOS* taos, SHashObj* cname2points, SArray* stableSchemas, SSmlLinesInfo* info) {
+  int32_t code = TSDB_CODE_SUCCESS;
+
+  size_t         numStables = taosArrayGetSize(stableSchemas);
+  SSmlStmtBatch* batches = calloc(numStables, sizeof(SSmlStmtBatch));
+  if (batches == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
 
-  pCTablePoints = taosHashIterate(cname2points, NULL);
+  for (int32_t i = 0; i < numStables; ++i) {
+    batches[i].ranges = taosArrayInit(16, sizeof(SSmlStmtRange));
+    if (batches[i].ranges == NULL) {
+      code = TSDB_CODE_TSC_OUT_OF_MEMORY;
+      goto _cleanup;
+    }
+  }
+
+  SArray** pCTablePoints = taosHashIterate(cname2points, NULL);
   while (pCTablePoints) {
-    SArray* pPoints = *pCTablePoints;
-    taosArrayDestroy(&pPoints);
+    SArray*              cTablePoints = *pCTablePoints;
+    TAOS_SML_DATA_POINT* point = taosArrayGetP(cTablePoints, 0);
+    SSmlSTableSchema*    sTableSchema = taosArrayGet(stableSchemas, point->schemaIdx);
+    SSmlStmtBatch*       pBatch = batches + point->schemaIdx;
+
+    int32_t rows = (int32_t)taosArrayGetSize(cTablePoints);
+    for (int32_t fromIndex = 0; fromIndex < rows && code == TSDB_CODE_SUCCESS;) {
+      SSmlStmtRange range = {.cTablePoints = cTablePoints, .fromIndex = fromIndex};
+      range.toIndex = MIN(rows, fromIndex + SML_STMT_MAX_BATCH_ROWS - pBatch->numOfRows);
+      if (taosArrayPush(pBatch->ranges, &range) == NULL) {
+        code = TSDB_CODE_TSC_OUT_OF_MEMORY;
+        break;
+      }
+
+      pBatch->numOfRows += (range.toIndex - fromIndex);
+      fromIndex = range.toIndex;
+
+      // limit the size of the submit message
+      if (pBatch->numOfRows >= SML_STMT_MAX_BATCH_ROWS) {
+        code = executeSmlStmtBatch(taos, pBatch, sTableSchema, info);
+      }
+    }
+
+    if (code != TSDB_CODE_SUCCESS) {
+      taosHashCancelIterate(cname2points, pCTablePoints);
+      goto _cleanup;
+    }
+
     pCTablePoints = taosHashIterate(cname2points, pCTablePoints);
   }
-  taosHashCleanup(cname2points);
+
+  for (int32_t i = 0; i < numStables && code == TSDB_CODE_SUCCESS; ++i) {
+    code = executeSmlStmtBatch(taos, batches + i, taosArrayGet(stableSchemas, i), info);
+  }
+
+_cleanup:
+  for (int32_t i = 0; i < numStables; ++i) {
+    if (batches[i].stmt != NULL) {
+      taos_stmt_close(batches[i].stmt);
+    }
+    taosArrayDestroy(&batches[i].ranges);
+  }
+  free(batches);
   return code;
 }
 
@@ -1243,7 +1541,24 @@ int tscSmlInsert(TAOS* taos, TAOS_SML_DATA_POINT* points, int numPoint, SSmlLine
   }
 
   tscDebug("SML:0x%"PRIx64" apply data points", info->id);
-  code = applyDataPointsWithSqlInsert(taos, points, numPoint, stableSchemas, info);
+  SHashObj* cname2points = taosHashInit(128, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, false);
+  arrangePointsByChildTableName(points, numPoint, cname2points, stableSchemas, info);
+
+  if (tsSmlDirectInsert) {
+    // not retried through the SQL path, since the rows of the statements executed before the failure are written
+    code = applyDataPointsWithStmt(taos, cname2points, stableSchemas, info);
+  } else {
+    code = applyDataPointsWithSqlInsert(taos, cname2points, stableSchemas, info);
+  }
+
+  SArray** pCTablePoints = taosHashIterate(cname2points, NULL);
+  while (pCTablePoints) {
+    SArray* pPoints = *pCTablePoints;
+    taosArrayDestroy(&pPoints);
+    pCTablePoints = taosHashIterate(cname2points, pCTablePoints);
+  }
+  taosHashCleanup(cname2points);
+
   if (code != 0) {
     tscError("SML:0x%"PRIx64" error apply data points : %s", info->id, tstrerror(code));
   }
@@ -25,6 +25,8 @@
 
 int tsParseInsertSql(SSqlObj *pSql);
 int32_t tsCheckTimestamp(STableDataBlocks *pDataBlocks, const char *start);
+int32_t validateLimitNode(SSqlCmd* pCmd, SQueryInfo* pQueryInfo, SSqlNode* pSqlNode, SSqlObj* pSql);
+int32_t validateTagCondExpr(SSqlCmd* pCmd, tExprNode *p);
 
 ////////////////////////////////////////////////////////////////////////////////
 // functions for normal statement preparation
@@ -35,6 +37,30 @@ typedef struct SNormalStmtPart {
   char* str;
 } SNormalStmtPart;
 
+typedef enum {
+  NORMAL_TMPL_NONE = 0,  // no template, the next successful execution tries to build one
+  NORMAL_TMPL_READY,     // executions clone the template and rebind the parameter slots
+  NORMAL_TMPL_DISABLED,  // the statement can not be served by a template
+} NORMAL_TMPL_ST;
+
+typedef enum {
+  NORMAL_SLOT_TS = 1,    // bound of the primary timestamp, i.e., the query time window
+  NORMAL_SLOT_TAG,       // value of a tag/tbname comparison in the tag query condition
+  NORMAL_SLOT_LIMIT,
+  NORMAL_SLOT_OFFSET,
+  NORMAL_SLOT_SLIMIT,
+  NORMAL_SLOT_SOFFSET,
+} NORMAL_SLOT_KIND;
+
+typedef struct SNormalStmtSlot {
+  int16_t    kind;
+  int16_t    optr;       // comparison operator of the timestamp and tag slots
+  uint16_t   param;      // index of the bound parameter
+  int16_t    colType;    // type of the tag column
+  int16_t    valType;    // type of the tag value the template is validated with
+  tExprNode* pNode;      // value node in the tag query condition
+} SNormalStmtSlot;
+
 typedef struct SNormalStmt {
   uint16_t         sizeParts;
   uint16_t         numParts;
@@ -42,6 +68,16 @@ typedef struct SNormalStmt {
   char* sql;
   SNormalStmtPart* parts;
   tVariant*        params;
+
+  int8_t           tmplState;
+  int64_t          tmplTime;
+  SSqlObj*         pTmpl;      // validated query of the statement, cloned by each execution
+  int16_t*         tmplTypes;  // types of the parameters the template is validated with
+  uint16_t         numSlots;
+  SNormalStmtSlot* slots;
+  SLimitVal        limit;      // limit/offset given as literals
+  SLimitVal        slimit;
+  tExprNode*       pTagCond;   // tag query condition of the template, the tag slots point to its value nodes
 } SNormalStmt;
 
 typedef struct SMultiTbStmt {
@@ -94,6 +130,11 @@ typedef struct STscStmt {
                       STMT_RET(TSDB_CODE_TSC_DISCONNECTED);  \
                     }
 
+// the result of a query statement may have been taken by taos_stmt_use_result before it is executed again
+#define STMT_QUERY_CHECK if (pStmt == NULL || pStmt->taos == NULL || (pStmt->isInsert && pStmt->pSql == NULL)) { \
+                            STMT_RET(TSDB_CODE_TSC_DISCONNECTED);  \
+                          }
+
 static int32_t invalidOperationMsg(char* dstBuffer, const char* errMsg) {
   return tscInvalidOperationMsg(dstBuffer, errMsg, NULL);
 }
@@ -199,6 +240,11 @@ static int normalStmtBindParam(STscStmt* stmt, TAOS_BIND* bind) {
         break;
 
       default:
+        if (stmt->pSql == NULL) {
+          tscError("bind column%d: type mismatch or invalid", i);
+          return TSDB_CODE_TSC_INVALID_VALUE;
+        }
+
         tscError("0x%"PRIx64" bind column%d: type mismatch or invalid", stmt->pSql->self, i);
         return invalidOperationMsg(tscGetErrorMsgPayload(&stmt->pSql->cmd), "bind type mismatch or invalid");
     }
@@ -210,9 +256,15 @@ static int normalStmtBindParam(STscStmt* stmt, TAOS_BIND* bind) {
 
 static int normalStmtPrepare(STscStmt* stmt) {
   SNormalStmt* normal = &stmt->normal;
-  char* sql = stmt->pSql->sqlstr;
   uint32_t i = 0, start = 0;
 
+  // the parts refer to the sql string, which must survive the sql object released by the first execution
+  char* sql = strdup(stmt->pSql->sqlstr);
+  if (sql == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+  normal->sql = sql;
+
   while (sql[i] != 0) {
     SStrToken token = {0};
     token.n = tGetToken(sql + i, &token.type);
@@ -327,6 +379,996 @@ static char* normalStmtBuildSql(STscStmt* stmt) {
   return taosStringBuilderGetResult(&sb, NULL);
 }
 
+static void normalStmtDropTemplate(SNormalStmt* normal) {
+  if (normal->pTmpl != NULL) {
+    taosReleaseRef(tscObjRef, normal->pTmpl->self);
+    normal->pTmpl = NULL;
+  }
+
+  tExprTreeDestroy(normal->pTagCond, NULL);
+  normal->pTagCond = NULL;
+
+  tfree(normal->slots);
+  tfree(normal->tmplTypes);
+  normal->numSlots = 0;
+  normal->tmplState = NORMAL_TMPL_NONE;
+}
+
+static bool normalStmtSaveParamTypes(SNormalStmt* normal) {
+  if (normal->numParams == 0) {
+    return true;
+  }
+
+  normal->tmplTypes = malloc(sizeof(int16_t) * normal->numParams);
+  if (normal->tmplTypes == NULL) {
+    return false;
+  }
+
+  for (uint16_t i = 0; i < normal->numParams; ++i) {
+    normal->tmplTypes[i] = (int16_t)normal->params[i].nType;
+  }
+
+  return true;
+}
+
+// a parameter of another type may take another path of the parser, e.g., a string compared with the timestamp
+static bool normalStmtIsSameParamTypes(SNormalStmt* normal) {
+  for (uint16_t i = 0; i < normal->numParams; ++i) {
+    if (normal->tmplTypes[i] != (int16_t)normal->params[i].nType) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static int16_t normalStmtRelationOptr(uint32_t tokenType) {
+  switch (tokenType) {
+    case TK_EQ: return TSDB_RELATION_EQUAL;
+    case TK_LT: return TSDB_RELATION_LESS;
+    case TK_LE: return TSDB_RELATION_LESS_EQUAL;
+    case TK_GT: return TSDB_RELATION_GREATER;
+    case TK_GE: return TSDB_RELATION_GREATER_EQUAL;
+    default:    return -1;
+  }
+}
+
+static bool normalStmtIsClauseEnd(uint32_t tokenType) {
+  switch (tokenType) {
+    case TK_RANGE:
+    case TK_EVERY:
+    case TK_INTERVAL:
+    case TK_SLIDING:
+    case TK_SESSION:
+    case TK_STATE_WINDOW:
+    case TK_FILL:
+    case TK_GROUP:
+    case TK_HAVING:
+    case TK_ORDER:
+    case TK_SLIMIT:
+    case TK_LIMIT:
+    case TK_SEMI:
+      return true;
+    default:
+      return false;
+  }
+}
+
+enum {
+  NORMAL_COL_UNKNOWN = 0,
+  NORMAL_COL_TS,
+  NORMAL_COL_TAG,
+  NORMAL_COL_NORMAL,
+};
+
+static int32_t normalStmtColumnKind(STableMeta* pTableMeta, SStrToken* pToken) {
+  if (pToken->type != TK_ID) {
+    return NORMAL_COL_UNKNOWN;
+  }
+
+  SSchema* pSchema = tscGetTableSchema(pTableMeta);
+  int32_t  numOfCols = tscGetNumOfColumns(pTableMeta);
+  int32_t  numOfTags = tscGetNumOfTags(pTableMeta);
+
+  for (int32_t i = 0; i < numOfCols + numOfTags; ++i) {
+    if (strlen(pSchema[i].name) == pToken->n && strncmp(pSchema[i].name, pToken->z, pToken->n) == 0) {
+      if (i == PRIMARYKEY_TIMESTAMP_COL_INDEX) {
+        return NORMAL_COL_TS;
+      }
+
+      return (i < numOfCols) ? NORMAL_COL_NORMAL : NORMAL_COL_TAG;
+    }
+  }
+
+  const char* tbname = tGetTbnameColumnSchema()->name;
+  if (strlen(tbname) == pToken->n && strncmp(tbname, pToken->z, pToken->n) == 0) {
+    return NORMAL_COL_TAG;
+  }
+
+  return NORMAL_COL_UNKNOWN;
+}
+
+typedef struct SNormalStmtTagCond {
+  SStrToken name;  // tag column of the comparison
+  int32_t   slot;  // -1 if the value is a literal
+} SNormalStmtTagCond;
+
+typedef struct SNormalStmtParser {
+  SStrToken*  tokens;
+  int32_t     numOfTokens;
+  int32_t     pos;
+  uint16_t    param;     // index of the next placeholder
+  STableMeta* pTableMeta;
+  SArray*     slots;     // SArray<SNormalStmtSlot>
+  SArray*     tagConds;  // SArray<SNormalStmtTagCond>, the tag comparisons in the order of the where clause
+  SLimitVal   limit;
+  SLimitVal   slimit;
+} SNormalStmtParser;
+
+static void normalStmtAddSlot(SNormalStmtParser* p, int16_t kind, int16_t optr, uint16_t param) {
+  SNormalStmtSlot slot = {.kind = kind, .optr = optr, .param = param};
+  taosArrayPush(p->slots, &slot);
+}
+
+static SArray* normalStmtTokenize(SNormalStmt* normal) {
+  SArray* tokens = taosArrayInit(64, sizeof(SStrToken));
+  if (tokens == NULL) {
+    return NULL;
+  }
+
+  // the parts are split at the placeholders, so the tokens of each part are the tokens of the statement
+  for (uint16_t i = 0; i < normal->numParts; ++i) {
+    SNormalStmtPart* part = normal->parts + i;
+    if (part->isParam) {
+      SStrToken t = {.n = 1, .type = TK_QUESTION, .z = NULL};
+      taosArrayPush(tokens, &t);
+      continue;
+    }
+
+    uint32_t j = 0;
+    while (j < part->len) {
+      SStrToken t = {0};
+      t.z = part->str + j;
+      t.n = tGetToken(t.z, &t.type);
+      if (t.n == 0) {
+        break;
+      }
+
+      j += t.n;
+      if (t.type != TK_SPACE && t.type != TK_COMMENT) {
+        taosArrayPush(tokens, &t);
+      }
+    }
+  }
+
+  return tokens;
+}
+
+/*
+ * Collect the parameter slots in the where clause. Only a chain of conditions joined by AND is accepted, in which the
+ * placeholders are the values of comparisons on the primary timestamp or on a tag.
+ */
+static bool normalStmtParseWhere(SNormalStmtParser* p) {
+  SStrToken* t = p->tokens;
+  int32_t    n = p->numOfTokens;
+  int32_t    i = p->pos;
+  size_t     numOfSlots = taosArrayGetSize(p->slots);
+  int32_t    numOfTsSlots = 0;
+  bool       hasOr = false, hasUnknown = false, hasTsLiteral = false;
+
+  while (i < n && !normalStmtIsClauseEnd(t[i].type)) {
+    int32_t start = i, depth = 0, numOfParams = 0;
+    bool    between = false;
+
+    for (; i < n; ++i) {
+      uint32_t type = t[i].type;
+      if (type == TK_QUESTION) {
+        ++numOfParams;
+      } else if (type == TK_LP) {
+        ++depth;
+      } else if (type == TK_RP) {
+        --depth;
+      } else if (depth == 0) {
+        if (type == TK_BETWEEN) {
+          between = true;
+        } else if (type == TK_OR) {
+          hasOr = true;
+        } else if (type == TK_AND) {
+          if (!between) {
+            break;
+          }
+          between = false;
+        } else if (normalStmtIsClauseEnd(type)) {
+          break;
+        }
+      }
+    }
+
+    int32_t len = i - start;
+    if (len == 0) {
+      return false;
+    }
+
+    if (i < n && t[i].type == TK_AND) {
+      ++i;
+    }
+
+    int32_t kind = (len > 1 && t[start + 1].type == TK_DOT) ? NORMAL_COL_UNKNOWN : normalStmtColumnKind(p->pTableMeta, &t[start]);
+    int16_t optr = (len == 3 && t[start + 2].type == TK_QUESTION) ? normalStmtRelationOptr(t[start + 1].type) : -1;
+
+    if (kind == NORMAL_COL_TS) {
+      if (optr >= 0) {
+        normalStmtAddSlot(p, NORMAL_SLOT_TS, optr, p->param++);
+        numOfTsSlots += 1;
+      } else if (len == 5 && t[start + 1].type == TK_BETWEEN && t[start + 2].type == TK_QUESTION &&
+                 t[start + 3].type == TK_AND && t[start + 4].type == TK_QUESTION) {
+        normalStmtAddSlot(p, NORMAL_SLOT_TS, TSDB_RELATION_GREATER_EQUAL, p->param++);
+        normalStmtAddSlot(p, NORMAL_SLOT_TS, TSDB_RELATION_LESS_EQUAL, p->param++);
+        numOfTsSlots += 2;
+      } else if (numOfParams > 0) {
+        return false;
+      } else {
+        hasTsLiteral = true;
+      }
+    } else if (kind == NORMAL_COL_TAG) {
+      SNormalStmtTagCond cond = {.name = t[start], .slot = -1};
+      if (optr >= 0) {
+        cond.slot = (int32_t)taosArrayGetSize(p->slots);
+        normalStmtAddSlot(p, NORMAL_SLOT_TAG, optr, p->param++);
+      } else if (numOfParams > 0) {
+        return false;
+      }
+
+      taosArrayPush(p->tagConds, &cond);
+    } else {
+      if (numOfParams > 0) {
+        return false;
+      }
+
+      hasUnknown |= (kind == NORMAL_COL_UNKNOWN);
+    }
+  }
+
+  p->pos = i;
+
+  // conditions that are not understood here may constrain the same columns as the slots do
+  if (taosArrayGetSize(p->slots) > numOfSlots && (hasOr || hasUnknown)) {
+    return false;
+  }
+
+  return numOfTsSlots == 0 || !hasTsLiteral;
+}
+
+static bool normalStmtParseSigned(SNormalStmtParser* p, int64_t* val, int32_t* param) {
+  SStrToken* t = p->tokens;
+  int32_t    n = p->numOfTokens;
+
+  *param = -1;
+  if (p->pos < n && t[p->pos].type == TK_QUESTION) {
+    *param = p->param++;
+    p->pos += 1;
+    return true;
+  }
+
+  bool minus = false;
+  if (p->pos < n && (t[p->pos].type == TK_MINUS || t[p->pos].type == TK_PLUS)) {
+    minus = (t[p->pos].type == TK_MINUS);
+    p->pos += 1;
+  }
+
+  if (p->pos >= n || t[p->pos].type != TK_INTEGER) {
+    return false;
+  }
+
+  *val = strtoll(t[p->pos].z, NULL, 10);
+  if (minus) {
+    *val = -(*val);
+  }
+
+  p->pos += 1;
+  return true;
+}
+
+// [s]limit x, [s]limit x [s]offset y, or [s]limit y, x
+static bool normalStmtParseLimit(SNormalStmtParser* p, SLimitVal* pLimit, uint32_t offsetToken, int16_t limitKind,
+                                 int16_t offsetKind) {
+  int64_t v1 = 0, v2 = 0;
+  int32_t s1 = -1, s2 = -1;
+
+  p->pos += 1;
+  if (!normalStmtParseSigned(p, &v1, &s1)) {
+    return false;
+  }
+
+  bool comma = false;
+  if (p->pos < p->numOfTokens && (p->tokens[p->pos].type == offsetToken || p->tokens[p->pos].type == TK_COMMA)) {
+    comma = (p->tokens[p->pos].type == TK_COMMA);
+    p->pos += 1;
+    if (!normalStmtParseSigned(p, &v2, &s2)) {
+      return false;
+    }
+  }
+
+  int16_t kind1 = comma ? offsetKind : limitKind;
+  int16_t kind2 = comma ? limitKind : offsetKind;
+
+  pLimit->limit = comma ? v2 : v1;
+  pLimit->offset = comma ? v1 : v2;
+  if (s1 >= 0) {
+    normalStmtAddSlot(p, kind1, 0, (uint16_t)s1);
+  }
+
+  if (s2 >= 0) {
+    normalStmtAddSlot(p, kind2, 0, (uint16_t)s2);
+  }
+
+  return true;
+}
+
+static bool normalStmtParseSlots(SNormalStmtParser* p) {
+  SStrToken* t = p->tokens;
+  int32_t    n = p->numOfTokens;
+
+  // select ... from [db.]table [where ...] ... [slimit ...] [limit ...]
+  if (n == 0 || t[0].type != TK_SELECT) {
+    return false;
+  }
+
+  int32_t i = 1, depth = 0;
+  for (; i < n; ++i) {
+    if (t[i].type == TK_QUESTION) {
+      return false;
+    } else if (t[i].type == TK_LP) {
+      ++depth;
+    } else if (t[i].type == TK_RP) {
+      --depth;
+    } else if (depth == 0 && t[i].type == TK_FROM) {
+      break;
+    }
+  }
+
+  if (i + 1 >= n || t[i + 1].type != TK_ID) {
+    return false;
+  }
+
+  i += 2;
+  if (i + 1 < n && t[i].type == TK_DOT && t[i + 1].type == TK_ID) {
+    i += 2;
+  }
+
+  // table alias, multiple tables or union
+  if (i < n && t[i].type != TK_WHERE && !normalStmtIsClauseEnd(t[i].type)) {
+    return false;
+  }
+
+  p->pos = i;
+  if (i < n && t[i].type == TK_WHERE) {
+    p->pos += 1;
+    if (!normalStmtParseWhere(p)) {
+      return false;
+    }
+  }
+
+  bool hasTs = false;
+  for (size_t j = 0; j < taosArrayGetSize(p->slots); ++j) {
+    hasTs |= (((SNormalStmtSlot*)taosArrayGet(p->slots, j))->kind == NORMAL_SLOT_TS);
+  }
+
+  while (p->pos < n) {
+    uint32_t type = t[p->pos].type;
+    if (type == TK_LIMIT) {
+      if (!normalStmtParseLimit(p, &p->limit, TK_OFFSET, NORMAL_SLOT_LIMIT, NORMAL_SLOT_OFFSET)) {
+        return false;
+      }
+    } else if (type == TK_SLIMIT) {
+      if (!normalStmtParseLimit(p, &p->slimit, TK_SOFFSET, NORMAL_SLOT_SLIMIT, NORMAL_SLOT_SOFFSET)) {
+        return false;
+      }
+    } else if (type == TK_QUESTION || type == TK_UNION || (hasTs && (type == TK_RANGE || type == TK_EVERY))) {
+      return false;
+    } else {
+      p->pos += 1;
+    }
+  }
+
+  return true;
+}
+
+static void normalStmtCollectTagConds(tExprNode* pNode, SArray* pConds) {
+  if (pNode == NULL || pNode->nodeType != TSQL_NODE_EXPR) {
+    return;
+  }
+
+  tExprNode* pLeft = pNode->_node.pLeft;
+  tExprNode* pRight = pNode->_node.pRight;
+  if (pLeft != NULL && pRight != NULL && pLeft->nodeType == TSQL_NODE_COL && pRight->nodeType == TSQL_NODE_VALUE) {
+    taosArrayPush(pConds, &pNode);
+    return;
+  }
+
+  normalStmtCollectTagConds(pLeft, pConds);
+  normalStmtCollectTagConds(pRight, pConds);
+}
+
+// map the tag slots to the value nodes of the tag query condition created by the parser
+static bool normalStmtBindTagSlots(SNormalStmt* normal, SQueryInfo* pQueryInfo, SArray* tagConds) {
+  size_t numOfConds = taosArrayGetSize(tagConds);
+
+  bool hasSlot = false;
+  for (size_t i = 0; i < numOfConds; ++i) {
+    hasSlot |= (((SNormalStmtTagCond*)taosArrayGet(tagConds, i))->slot >= 0);
+  }
+
+  if (!hasSlot) {
+    return true;
+  }
+
+  if (pQueryInfo->tagCond.pCond == NULL || taosArrayGetSize(pQueryInfo->tagCond.pCond) != 1) {
+    return false;
+  }
+
+  SCond* pCond = taosArrayGet(pQueryInfo->tagCond.pCond, 0);
+
+  TRY(TSDB_MAX_TAG_CONDITIONS) {
+    normal->pTagCond = exprTreeFromBinary(pCond->cond, pCond->len);
+    CLEANUP_EXECUTE();
+  } CATCH(code) {
+    CLEANUP_EXECUTE();
+    UNUSED(code);
+  } END_TRY
+
+  if (normal->pTagCond == NULL) {
+    return false;
+  }
+
+  SArray* pNodes = taosArrayInit(numOfConds, POINTER_BYTES);
+  normalStmtCollectTagConds(normal->pTagCond, pNodes);
+
+  bool ret = (taosArrayGetSize(pNodes) == numOfConds);
+  for (size_t i = 0; ret && i < numOfConds; ++i) {
+    SNormalStmtTagCond* cond = taosArrayGet(tagConds, i);
+    tExprNode*          pNode = taosArrayGetP(pNodes, i);
+    SSchema*            pSchema = pNode->_node.pLeft->pSchema;
+
+    if (strlen(pSchema->name) != cond->name.n || strncmp(pSchema->name, cond->name.z, cond->name.n) != 0) {
+      ret = false;
+    } else if (cond->slot >= 0) {
+      SNormalStmtSlot* slot = normal->slots + cond->slot;
+      if (pNode->_node.optr != slot->optr || pSchema->type == TSDB_DATA_TYPE_JSON) {
+        ret = false;
+      } else {
+        slot->pNode = pNode->_node.pRight;
+        slot->colType = pSchema->type;
+      }
+    }
+  }
+
+  taosArrayDestroy(&pNodes);
+  return ret;
+}
+
+static bool normalStmtInitSlots(STscStmt* pStmt, SQueryInfo* pQueryInfo) {
+  SNormalStmt* normal = &pStmt->normal;
+
+  SNormalStmtParser p = {0};
+  p.pTableMeta = tscGetMetaInfo(pQueryInfo, 0)->pTableMeta;
+  p.limit = (SLimitVal){.limit = -1, .offset = 0};
+  p.slimit = (SLimitVal){.limit = -1, .offset = 0};
+
+  SArray* tokens = normalStmtTokenize(normal);
+  p.slots = taosArrayInit(4, sizeof(SNormalStmtSlot));
+  p.tagConds = taosArrayInit(4, sizeof(SNormalStmtTagCond));
+
+  bool ret = false;
+  if (tokens != NULL && p.slots != NULL && p.tagConds != NULL) {
+    p.tokens = tokens->pData;
+    p.numOfTokens = (int32_t)taosArrayGetSize(tokens);
+    ret = normalStmtParseSlots(&p) && p.param == normal->numParams;
+  }
+
+  if (ret && taosArrayGetSize(p.slots) > 0) {
+    normal->numSlots = (uint16_t)taosArrayGetSize(p.slots);
+    normal->slots = malloc(sizeof(SNormalStmtSlot) * normal->numSlots);
+    if (normal->slots == NULL) {
+      normal->numSlots = 0;
+      ret = false;
+    } else {
+      memcpy(normal->slots, p.slots->pData, sizeof(SNormalStmtSlot) * normal->numSlots);
+    }
+  }
+
+  if (ret) {
+    normal->limit = p.limit;
+    normal->slimit = p.slimit;
+    ret = normalStmtBindTagSlots(normal, pQueryInfo, p.tagConds);
+  }
+
+  taosArrayDestroy(&tokens);
+  taosArrayDestroy(&p.slots);
+  taosArrayDestroy(&p.tagConds);
+  return ret;
+}
+
+// the value the parser creates from the literal that normalStmtBuildSql generates for the parameter
+static bool normalStmtParamToValue(tVariant* var, tVariant* dst) {
+  memset(dst, 0, sizeof(tVariant));
+
+  switch (var->nType) {
+    case TSDB_DATA_TYPE_BOOL:
+    case TSDB_DATA_TYPE_TINYINT:
+    case TSDB_DATA_TYPE_SMALLINT:
+    case TSDB_DATA_TYPE_INT:
+    case TSDB_DATA_TYPE_BIGINT:
+    case TSDB_DATA_TYPE_TIMESTAMP:
+      if (var->i64 == INT64_MIN) {
+        return false;
+      }
+
+      dst->nType = TSDB_DATA_TYPE_BIGINT;
+      dst->i64 = var->i64;
+      return true;
+
+    case TSDB_DATA_TYPE_UTINYINT:
+    case TSDB_DATA_TYPE_USMALLINT:
+    case TSDB_DATA_TYPE_UINT:
+    case TSDB_DATA_TYPE_UBIGINT:
+      if (var->u64 > INT64_MAX) {
+        return false;
+      }
+
+      dst->nType = TSDB_DATA_TYPE_BIGINT;
+      dst->i64 = (int64_t)var->u64;
+      return true;
+
+    case TSDB_DATA_TYPE_FLOAT:
+    case TSDB_DATA_TYPE_DOUBLE: {
+      if (isnan(var->dKey) || isinf(var->dKey)) {
+        return false;
+      }
+
+      char buf[512];
+      snprintf(buf, sizeof(buf), "%.9lf", var->dKey);
+      dst->nType = TSDB_DATA_TYPE_DOUBLE;
+      dst->dKey = strtod(buf, NULL);
+      return true;
+    }
+
+    case TSDB_DATA_TYPE_BINARY:
+    case TSDB_DATA_TYPE_NCHAR: {
+      // the escape characters are not kept by the generated literal
+      size_t len = strlen(var->pz);
+      if (len != var->nLen || strchr(var->pz, '\\') != NULL ||
+          (var->nType == TSDB_DATA_TYPE_NCHAR && strchr(var->pz, '\'') != NULL)) {
+        return false;
+      }
+
+      dst->pz = strdup(var->pz);
+      if (dst->pz == NULL) {
+        return false;
+      }
+
+      dst->nType = TSDB_DATA_TYPE_BINARY;
+      dst->nLen = (int32_t)len;
+      return true;
+    }
+
+    default:
+      return false;
+  }
+}
+
+static bool normalStmtParamToInteger(tVariant* var, int64_t* val) {
+  tVariant v;
+  if (!normalStmtParamToValue(var, &v)) {
+    return false;
+  }
+
+  if (v.nType != TSDB_DATA_TYPE_BIGINT) {
+    tVariantDestroy(&v);
+    return false;
+  }
+
+  *val = v.i64;
+  return true;
+}
+
+// string compared with a nchar column is converted by the parser
+static bool normalStmtConvertNchar(tVariant* var) {
+  char*   buf = calloc(1, var->nLen * TSDB_NCHAR_SIZE);
+  int32_t len = 0;
+  if (buf == NULL || !taosMbsToUcs4(var->pz, var->nLen, buf, var->nLen * TSDB_NCHAR_SIZE, &len)) {
+    tfree(buf);
+    return false;
+  }
+
+  free(var->pz);
+  var->pz = buf;
+  var->nLen = len;
+  var->nType = TSDB_DATA_TYPE_NCHAR;
+  return true;
+}
+
+static bool normalStmtSetTagCond(SSqlCmd* pCmd, SQueryInfo* pQueryInfo, tExprNode* pTagCond) {
+  if (validateTagCondExpr(pCmd, pTagCond) != TSDB_CODE_SUCCESS) {
+    return false;
+  }
+
+  bool          ret = true;
+  SBufferWriter bw = tbufInitWriter(NULL, false);
+
+  TRY(0) {
+    exprTreeToBinary(&bw, pTagCond);
+  } CATCH(code) {
+    tbufCloseWriter(&bw);
+    UNUSED(code);
+    ret = false;
+  } END_TRY
+
+  if (ret) {
+    SCond* pCond = taosArrayGet(pQueryInfo->tagCond.pCond, 0);
+    tfree(pCond->cond);
+    pCond->len = (int32_t)tbufTell(&bw);
+    pCond->cond = tbufGetData(&bw, true);
+  }
+
+  return ret;
+}
+
+/*
+ * Write the bound parameters into the query cloned from the template. If the parameters would make the parser take
+ * another path, e.g., an empty time window or a limit of 0, false is returned and the statement falls back to the SQL
+ * text for this execution.
+ */
+static bool normalStmtApplySlots(STscStmt* pStmt, SSqlObj* pSql, bool init) {
+  SNormalStmt* normal = &pStmt->normal;
+  SSqlCmd*     pCmd = &pSql->cmd;
+  SQueryInfo*  pQueryInfo = tscGetQueryInfo(pCmd);
+  STimeWindow  win = TSWINDOW_INITIALIZER;
+  SSqlNode     node = {.limit = normal->limit, .slimit = normal->slimit};
+  bool         hasTs = false, hasTag = false, hasLimit = false;
+
+  for (uint16_t i = 0; i < normal->numSlots; ++i) {
+    SNormalStmtSlot* slot = normal->slots + i;
+    tVariant*        var = normal->params + slot->param;
+    int64_t          v = 0;
+
+    if (slot->kind == NORMAL_SLOT_TAG) {
+      tVariant val;
+      if (!normalStmtParamToValue(var, &val)) {
+        return false;
+      }
+
+      if (slot->colType == TSDB_DATA_TYPE_NCHAR && val.nType == TSDB_DATA_TYPE_BINARY && val.nLen > 0 &&
+          !normalStmtConvertNchar(&val)) {
+        tVariantDestroy(&val);
+        return false;
+      }
+
+      // the tag condition is validated with values of the same type only
+      if (init) {
+        slot->valType = val.nType;
+      } else if (val.nType != slot->valType) {
+        tVariantDestroy(&val);
+        return false;
+      }
+
+      tVariantDestroy(slot->pNode->pVal);
+      *slot->pNode->pVal = val;
+      hasTag = true;
+      continue;
+    }
+
+    if (!normalStmtParamToInteger(var, &v)) {
+      return false;
+    }
+
+    switch (slot->kind) {
+      case NORMAL_SLOT_TS:
+        hasTs = true;
+        if (slot->optr == TSDB_RELATION_GREATER) {
+          if (v == INT64_MAX) {
+            return false;
+          }
+          win.skey = MAX(win.skey, v + 1);
+        } else if (slot->optr == TSDB_RELATION_GREATER_EQUAL) {
+          win.skey = MAX(win.skey, v);
+        } else if (slot->optr == TSDB_RELATION_LESS) {
+          if (v == INT64_MIN) {
+            return false;
+          }
+          win.ekey = MIN(win.ekey, v - 1);
+        } else if (slot->optr == TSDB_RELATION_LESS_EQUAL) {
+          win.ekey = MIN(win.ekey, v);
+        } else {
+          win.skey = MAX(win.skey, v);
+          win.ekey = MIN(win.ekey, v);
+        }
+        break;
+
+      case NORMAL_SLOT_LIMIT:
+        node.limit.limit = v;
+        hasLimit = true;
+        break;
+
+      case NORMAL_SLOT_OFFSET:
+        node.limit.offset = v;
+        hasLimit = true;
+        break;
+
+      case NORMAL_SLOT_SLIMIT:
+        node.slimit.limit = v;
+        hasLimit = true;
+        break;
+
+      case NORMAL_SLOT_SOFFSET:
+        node.slimit.offset = v;
+        hasLimit = true;
+        break;
+
+      default:
+        assert(false);
+        break;
+    }
+  }
+
+  if (hasTs) {
+    // an empty or unbounded time window changes how the query is validated
+    if (win.skey > win.ekey || !IS_TSWINDOW_SPECIFIED(win)) {
+      return false;
+    }
+
+    pQueryInfo->window = win;
+  }
+
+  if (hasTag && !normalStmtSetTagCond(pCmd, pQueryInfo, normal->pTagCond)) {
+    return false;
+  }
+
+  if (hasLimit) {
+    if (validateLimitNode(pCmd, pQueryInfo, &node, pSql) != TSDB_CODE_SUCCESS ||
+        pQueryInfo->command != TSDB_SQL_SELECT) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static SSqlObj* normalStmtCreateSqlObj(STscStmt* pStmt, const char* sql, void* param) {
+  SSqlObj* pSql = calloc(1, sizeof(SSqlObj));
+  if (pSql == NULL) {
+    return NULL;
+  }
+
+  tsem_init(&pSql->rspSem, 0, 0);
+  pSql->signature = pSql;
+  pSql->param     = (param != NULL) ? param : pSql;
+  pSql->pTscObj   = pStmt->taos;
+  pSql->maxRetry  = TSDB_MAX_REPLICA;
+  pSql->fp        = waitForQueryRsp;
+  pSql->fetchFp   = waitForQueryRsp;
+  pSql->rootObj   = pSql;
+  pSql->cmd.resColumnId = TSDB_RES_COL_ID;
+
+  registerSqlObj(pSql);
+
+  size_t sqlLen = strlen(sql);
+  pSql->sqlstr = calloc(1, sqlLen + 1);
+  if (pSql->sqlstr == NULL) {
+    taosReleaseRef(tscObjRef, pSql->self);
+    return NULL;
+  }
+
+  strntolower(pSql->sqlstr, sql, (int32_t)sqlLen);
+  return pSql;
+}
+
+static SSqlObj* normalStmtCloneQuery(STscStmt* pStmt, SSqlObj* pTmpl, const char* sql) {
+  SQueryInfo* pSrc = tscGetQueryInfo(&pTmpl->cmd);
+
+  SSqlObj* pSql = normalStmtCreateSqlObj(pStmt, sql, pStmt->taos);
+  if (pSql == NULL) {
+    return NULL;
+  }
+
+  SSqlCmd* pCmd = &pSql->cmd;
+  if (tscAllocPayload(pCmd, TSDB_DEFAULT_PAYLOAD_SIZE) != TSDB_CODE_SUCCESS || tscAddQueryInfo(pCmd) != TSDB_CODE_SUCCESS) {
+    taosReleaseRef(tscObjRef, pSql->self);
+    return NULL;
+  }
+
+  SQueryInfo* pQueryInfo = tscGetQueryInfo(pCmd);
+  if (tscQueryInfoCopy(pQueryInfo, pSrc) != TSDB_CODE_SUCCESS) {
+    taosReleaseRef(tscObjRef, pSql->self);
+    return NULL;
+  }
+
+  // the attributes that are set by the parser at the end of validation
+  pQueryInfo->udColumnId      = pSrc->udColumnId;
+  pQueryInfo->distinct        = pSrc->distinct;
+  pQueryInfo->onlyHasTagCond  = pSrc->onlyHasTagCond;
+  pQueryInfo->round           = pSrc->round;
+  pQueryInfo->havingFieldNum  = pSrc->havingFieldNum;
+  pQueryInfo->stableQuery     = pSrc->stableQuery;
+  pQueryInfo->groupbyColumn   = pSrc->groupbyColumn;
+  pQueryInfo->groupbyTag      = pSrc->groupbyTag;
+  pQueryInfo->simpleAgg       = pSrc->simpleAgg;
+  pQueryInfo->projectionQuery = pSrc->projectionQuery;
+  pQueryInfo->hasFilter       = pSrc->hasFilter;
+  pQueryInfo->onlyTagQuery    = pSrc->onlyTagQuery;
+  pQueryInfo->globalMerge     = pSrc->globalMerge;
+  pQueryInfo->isStddev        = pSrc->isStddev;
+
+  if (pQueryInfo->exprList1 == NULL && pSrc->exprList1 != NULL) {
+    pQueryInfo->exprList1 = taosArrayInit(4, POINTER_BYTES);
+    if (pQueryInfo->exprList1 == NULL || tscExprCopyAll(pQueryInfo->exprList1, pSrc->exprList1, true) != 0) {
+      taosReleaseRef(tscObjRef, pSql->self);
+      return NULL;
+    }
+  }
+
+  pCmd->command = pTmpl->cmd.command;
+  pCmd->active = pQueryInfo;
+  pSql->res.precision = pTmpl->res.precision;
+  return pSql;
+}
+
+static bool normalStmtIsSameQuery(SQueryInfo* p1, SQueryInfo* p2) {
+  if (p1->window.skey != p2->window.skey || p1->window.ekey != p2->window.ekey ||
+      memcmp(&p1->limit, &p2->limit, sizeof(SLimitVal)) != 0 || memcmp(&p1->slimit, &p2->slimit, sizeof(SLimitVal)) != 0 ||
+      p1->clauseLimit != p2->clauseLimit || p1->prjOffset != p2->prjOffset || p1->vgroupLimit != p2->vgroupLimit ||
+      p1->type != p2->type || p1->command != p2->command) {
+    return false;
+  }
+
+  size_t numOfConds = (p1->tagCond.pCond != NULL) ? taosArrayGetSize(p1->tagCond.pCond) : 0;
+  if (numOfConds != ((p2->tagCond.pCond != NULL) ? taosArrayGetSize(p2->tagCond.pCond) : 0)) {
+    return false;
+  }
+
+  for (size_t i = 0; i < numOfConds; ++i) {
+    SCond* c1 = taosArrayGet(p1->tagCond.pCond, i);
+    SCond* c2 = taosArrayGet(p2->tagCond.pCond, i);
+    if (c1->uid != c2->uid || c1->len != c2->len || memcmp(c1->cond, c2->cond, c1->len) != 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/*
+ * Keep a copy of the query the parser creates from the SQL text of this execution as the template of the following
+ * executions. The template is used only if rebinding the current parameters into the copy reproduces the query.
+ */
+static void normalStmtBuildTemplate(STscStmt* pStmt, SSqlObj* pSql) {
+  SNormalStmt* normal = &pStmt->normal;
+  SSqlCmd*     pCmd = &pSql->cmd;
+  SQueryInfo*  pQueryInfo = tscGetQueryInfo(pCmd);
+
+  if (pQueryInfo == NULL || pCmd->command != TSDB_SQL_SELECT || pQueryInfo->command != TSDB_SQL_SELECT) {
+    // e.g., an empty time window, which may be different with other parameters
+    return;
+  }
+
+  bool ok = (pCmd->active == pQueryInfo && pQueryInfo->sibling == NULL && pQueryInfo->numOfTables == 1 &&
+             taosArrayGetSize(pQueryInfo->pUpstream) == 0 && !QUERY_IS_JOIN_QUERY(pQueryInfo->type) &&
+             pQueryInfo->tsBuf == NULL && pQueryInfo->pUdfInfo == NULL);
+
+  // the number of intervals and the range of interp are validated against the time window by the parser, which a
+  // rebound time window would skip
+  ok = ok && pQueryInfo->interval.interval == 0 && !tscIsSessionWindowQuery(pQueryInfo) && !pQueryInfo->stateWindow &&
+       pQueryInfo->fillType == TSDB_FILL_NONE && !tscQueryContainsFunction(pQueryInfo, TSDB_FUNC_INTERP);
+
+  if (ok) {
+    normal->pTmpl = normalStmtCloneQuery(pStmt, pSql, pSql->sqlstr);
+    ok = (normal->pTmpl != NULL) && normalStmtInitSlots(pStmt, tscGetQueryInfo(&normal->pTmpl->cmd));
+  }
+
+  if (ok) {
+    SSqlObj* pNew = normalStmtCloneQuery(pStmt, normal->pTmpl, pSql->sqlstr);
+    ok = (pNew != NULL) && normalStmtApplySlots(pStmt, pNew, true) &&
+         normalStmtIsSameQuery(tscGetQueryInfo(&pNew->cmd), pQueryInfo) && normalStmtSaveParamTypes(normal);
+    if (pNew != NULL) {
+      taosReleaseRef(tscObjRef, pNew->self);
+    }
+  }
+
+  if (!ok) {
+    tscDebug("0x%"PRIx64" statement is not executed with a query template", pSql->self);
+    normalStmtDropTemplate(normal);
+    normal->tmplState = NORMAL_TMPL_DISABLED;
+    return;
+  }
+
+  tscDebug("0x%"PRIx64" query template created, %d parameter slots", pSql->self, normal->numSlots);
+  normal->tmplTime = taosGetTimestampMs();
+  normal->tmplState = NORMAL_TMPL_READY;
+}
+
+/*
+ * Parse and execute the SQL text as taos_query does, the parsed query is kept as the template before it is executed.
+ * If the table meta has to be retrieved first, the query is validated and executed by the meta callback, and the
+ * template is built by one of the next executions.
+ */
+static SSqlObj* normalStmtQueryAndBuildTemplate(STscStmt* pStmt, const char* sql) {
+  SSqlObj* pSql = normalStmtCreateSqlObj(pStmt, sql, pStmt->taos);
+  if (pSql == NULL) {
+    terrno = TSDB_CODE_TSC_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  tscDebugL("0x%"PRIx64" SQL: %s", pSql->self, pSql->sqlstr);
+
+  taosAcquireRef(tscObjRef, pSql->self);
+  int32_t code = tsParseSql(pSql, true);
+  if (code == TSDB_CODE_SUCCESS) {
+    normalStmtBuildTemplate(pStmt, pSql);
+    executeQuery(pSql, tscGetQueryInfo(&pSql->cmd));
+  } else if (code != TSDB_CODE_TSC_ACTION_IN_PROGRESS) {
+    pSql->res.code = code;
+    tscAsyncResultOnError(pSql);
+  }
+  taosReleaseRef(tscObjRef, pSql->self);
+
+  tsem_wait(&pSql->rspSem);
+  return pSql;
+}
+
+static int normalStmtExecute(STscStmt* pStmt) {
+  SNormalStmt* normal = &pStmt->normal;
+
+  char* sql = normalStmtBuildSql(pStmt);
+  if (sql == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  // the meta and vgroup list kept by the template are refreshed as the cached ones are, and parameters of other types
+  // are validated by the parser again
+  if (normal->tmplState == NORMAL_TMPL_READY &&
+      (!tsStmtQueryTemplate || taosGetTimestampMs() - normal->tmplTime > TSC_STABLE_VGROUP_LIST_KEEP_MS ||
+       !normalStmtIsSameParamTypes(normal))) {
+    normalStmtDropTemplate(normal);
+  }
+
+  SSqlObj* pSql = NULL;
+  if (normal->tmplState == NORMAL_TMPL_READY) {
+    pSql = normalStmtCloneQuery(pStmt, normal->pTmpl, sql);
+    if (pSql != NULL && !normalStmtApplySlots(pStmt, pSql, false)) {
+      taosReleaseRef(tscObjRef, pSql->self);
+      pSql = NULL;
+    }
+  }
+
+  if (pStmt->pSql != NULL) {
+    taosReleaseRef(tscObjRef, pStmt->pSql->self);
+  }
+
+  if (pSql != NULL) {
+    tscDebugL("0x%"PRIx64" SQL: %s", pSql->self, pSql->sqlstr);
+
+    taosAcquireRef(tscObjRef, pSql->self);
+    executeQuery(pSql, tscGetQueryInfo(&pSql->cmd));
+    taosReleaseRef(tscObjRef, pSql->self);
+    tsem_wait(&pSql->rspSem);
+  } else if (tsStmtQueryTemplate && normal->tmplState == NORMAL_TMPL_NONE && strlen(sql) <= (size_t)tsMaxSQLStringLen) {
+    pSql = normalStmtQueryAndBuildTemplate(pStmt, sql);
+  } else {
+    pSql = taos_query((TAOS*)pStmt->taos, sql);
+  }
+
+  // the query is parsed again from the SQL text if it is retried, the template may be out of date
+  if (normal->tmplState == NORMAL_TMPL_READY &&
+      (pSql == NULL || taos_errno(pSql) != TSDB_CODE_SUCCESS || pSql->retry > 0)) {
+    normalStmtDropTemplate(normal);
+  }
+
+  free(sql);
+  pStmt->pSql = pSql;
+  pStmt->numOfRows += taos_affected_rows(pSql);
+  return taos_errno(pSql);
+}
+
 static int fillColumnsNull(STableDataBlocks* pBlock, int32_t rowNum) {
   SParsedDataColInfo* spd = &pBlock->boundColumnInfo;
   int32_t offset = 0;
@@ -1920,6 +2962,7 @@ int taos_stmt_close(TAOS_STMT* stmt) {
     }
     free(normal->parts);
     free(normal->sql);
+    normalStmtDropTemplate(normal);
   } else {
     if (pStmt->multiTbInsert) {
       taosHashCleanup(pStmt->mtb.pTableHash);
@@ -1946,7 +2989,7 @@ int taos_stmt_close(TAOS_STMT* stmt) {
 
 int taos_stmt_bind_param(TAOS_STMT* stmt, TAOS_BIND* bind) {
   STscStmt* pStmt = (STscStmt*)stmt;
-  STMT_CHECK
+  STMT_QUERY_CHECK
 
   if (pStmt->isInsert) {
     if (pStmt->multiTbInsert) {
@@ -2077,7 +3120,7 @@ int taos_stmt_reset(TAOS_STMT* stmt) {
 int taos_stmt_execute(TAOS_STMT* stmt) {
   int ret = 0;
   STscStmt* pStmt = (STscStmt*)stmt;
-  STMT_CHECK
+  STMT_QUERY_CHECK
 
   if (pStmt->isInsert) {
     if (pStmt->last != STMT_ADD_BATCH) {
@@ -2094,16 +3137,7 @@ int taos_stmt_execute(TAOS_STMT* stmt) {
       ret = insertStmtExecute(pStmt);
     }
   } else { // normal stmt query
-    char* sql = normalStmtBuildSql(pStmt);
-    if (sql == NULL) {
-      ret = TSDB_CODE_TSC_OUT_OF_MEMORY;
-    } else {
-      taosReleaseRef(tscObjRef, pStmt->pSql->self);
-      pStmt->pSql = taos_query((TAOS*)pStmt->taos, sql);
-      pStmt->numOfRows += taos_affected_rows(pStmt->pSql);
-      ret = taos_errno(pStmt->pSql);
-      free(sql);
-    }
+    ret = normalStmtExecute(pStmt);
   }
 
   STMT_RET(ret);
@@ -121,7 +121,7 @@ static int32_t setCompactVnodeInfo(SSqlObj* pSql, struct SSqlInfo* pInfo);
 static int32_t validateOneTag(SSqlCmd* pCmd, TAOS_FIELD* pTagField);
 static bool hasNormalColumnFilter(SQueryInfo* pQueryInfo);
 
-static int32_t validateLimitNode(SSqlCmd* pCmd, SQueryInfo* pQueryInfo, SSqlNode* pSqlNode, SSqlObj* pSql);
+int32_t validateLimitNode(SSqlCmd* pCmd, SQueryInfo* pQueryInfo, SSqlNode* pSqlNode, SSqlObj* pSql);
 static int32_t parseCreateDBOptions(SSqlCmd* pCmd, SCreateDbInfo* pCreateDbSql);
 static int32_t getColumnIndexByName(const SStrToken* pToken, SQueryInfo* pQueryInfo, SColumnIndex* pIndex, char* msg);
 static int32_t getTableIndexByName(SStrToken* pToken, SQueryInfo* pQueryInfo, SColumnIndex* pIndex);
@@ -4477,7 +4477,6 @@ int32_t validateGroupbyNode(SQueryInfo* pQueryInfo, SArray* pList, SSqlCmd* pCmd
   const char* msg2 = "invalid column name in group by clause";
   const char* msg3 = "columns from one table allowed as group by columns";
   const char* msg4 = "join query does not support group by";
-  const char* msg5 = "not allowed column type for group by";
   const char* msg6 = "tags not allowed for table query";
   //const char* msg7 = "not support group by expression";
   //const char* msg8 = "normal column can only locate at the end of group by clause";
@@ -4588,11 +4587,6 @@ int32_t validateGroupbyNode(SQueryInfo* pQueryInfo, SArray* pList, SSqlCmd* pCmd
       index.columnIndex = relIndex;
       tscColumnListInsert(pTableMetaInfo->tagColList, index.columnIndex, pTableMeta->id.uid, pSchema);
     } else {
-      // check if the column type is valid, here only support the bool/tinyint/smallint/bigint group by
-      if (pSchema->type == TSDB_DATA_TYPE_FLOAT || pSchema->type == TSDB_DATA_TYPE_DOUBLE) {
-        return invalidOperationMsg(tscGetErrorMsgPayload(pCmd), msg5);
-      }
-
       tscColumnListInsert(pQueryInfo->colList, index.columnIndex, pTableMeta->id.uid, pSchema);
 
       SColIndex colIndex = { .colIndex = index.columnIndex, .flag = TSDB_COL_NORMAL, .colId = pSchema->colId };
@@ -6198,7 +6192,7 @@ static void doAddJoinTagsColumnsIntoTagList(SSqlCmd* pCmd, SQueryInfo* pQueryInf
 }
 */
 
-static int32_t validateTagCondExpr(SSqlCmd* pCmd, tExprNode *p) {
+int32_t validateTagCondExpr(SSqlCmd* pCmd, tExprNode *p) {
   const char *msg1 = "invalid tag operator";
   const char* msg2 = "not supported filter condition";
   
@@ -6932,6 +6926,7 @@ int32_t validateOrderbyNode(SSqlCmd* pCmd, SQueryInfo* pQueryInfo, SSqlNode* pSq
    * 3. from stable/table group by column1 order by column1
    * 4. from stable/table order by ts
    * 5. select stable/table top(column2,1) ... order by column2
+   * 6. select column1 ... from stable order by column1 limit n
    */
   size_t size = taosArrayGetSize(pSortOrder);
   if (!UTIL_TABLE_IS_SUPER_TABLE(pTableMetaInfo)) {
@@ -6988,6 +6983,7 @@ int32_t validateOrderbyNode(SSqlCmd* pCmd, SQueryInfo* pQueryInfo, SSqlNode* pSq
     bool orderByTags = false;
     bool orderByTS = false;
     bool orderByGroupbyCol = false;
+    bool orderByNormalCol = false;
 
     if (index.columnIndex >= tscGetNumOfColumns(pTableMetaInfo->pTableMeta)) {    // order by tag1
       int32_t relTagIndex = index.columnIndex - tscGetNumOfColumns(pTableMetaInfo->pTableMeta);
@@ -7032,10 +7028,14 @@ int32_t validateOrderbyNode(SSqlCmd* pCmd, SQueryInfo* pQueryInfo, SSqlNode* pSq
         if (pColIndex->colIndex == index.columnIndex) {
           orderByGroupbyCol = true;
         }
+      } else if (tscIsProjectionQueryOnSTable(pQueryInfo, 0) && pSqlNode->limit.limit > 0 &&
+                 index.columnIndex < tscGetNumOfColumns(pTableMetaInfo->pTableMeta)) {
+        // the top N rows of each vnode are merged at the client side
+        orderByNormalCol = true;
       }
     }
 
-    if (!(orderByTags || orderByTS || orderByGroupbyCol) && !isTopBottomUniqueQuery(pQueryInfo)) {
+    if (!(orderByTags || orderByTS || orderByGroupbyCol || orderByNormalCol) && !isTopBottomUniqueQuery(pQueryInfo)) {
       return invalidOperationMsg(pMsgBuf, msg3);
     }
 
@@ -7066,6 +7066,39 @@ int32_t validateOrderbyNode(SSqlCmd* pCmd, SQueryInfo* pQueryInfo, SSqlNode* pSq
         return invalidOperationMsg(pMsgBuf, msg5);
       }
 
+      pQueryInfo->order.order = pItem->sortOrder;
+      pQueryInfo->order.orderColId = pSchema[index.columnIndex].colId;
+    } else if (orderByNormalCol) {
+      if (udf) {
+        return invalidOperationMsg(pMsgBuf, msg11);
+      }
+
+      if (size > 1) {
+        return invalidOperationMsg(pMsgBuf, msg0);
+      }
+
+      // the order column is required in the result of each vnode to merge the rows
+      bool found = false;
+      for (int32_t i = 0; i < tscNumOfExprs(pQueryInfo); ++i) {
+        SExprInfo* pExpr = tscExprGet(pQueryInfo, i);
+        if (pExpr->base.functionId == TSDB_FUNC_PRJ && pExpr->base.colInfo.colId == pSchema[index.columnIndex].colId) {
+          found = true;
+          break;
+        }
+      }
+
+      if (!found) {
+        SSchema* pColSchema = &pSchema[index.columnIndex];
+        int32_t  numOfCols = (int32_t)tscNumOfFields(pQueryInfo);
+        tscAddFuncInSelectClause(pQueryInfo, numOfCols, TSDB_FUNC_PRJ, &index, pColSchema, TSDB_COL_NORMAL, getNewResColId(pCmd));
+        tscColumnListInsert(pQueryInfo->colList, index.columnIndex, pTableMetaInfo->pTableMeta->id.uid, pColSchema);
+
+        SInternalField* pSupInfo = tscFieldInfoGetInternalField(&pQueryInfo->fieldsInfo, numOfCols);
+        pSupInfo->visible = false;
+      }
+
+      // the rows are merged in the order of the non-timestamp order columns
+      pQueryInfo->groupbyExpr.orderType = pItem->sortOrder;
       pQueryInfo->order.order = pItem->sortOrder;
       pQueryInfo->order.orderColId = pSchema[index.columnIndex].colId;
     } else {
@@ -66,6 +66,8 @@ extern int32_t  tsCompressMsgSize;
 extern int32_t  tsCompressColData;
 extern int32_t  tsMaxNumOfDistinctResults;
 extern char     tsTempDir[];
+extern int32_t  tsMergeMemBufferSize;
+extern int32_t  tsOrderMemBufferSize;
 extern int32_t  tsShortcutFlag;
 
 // query buffer management
@@ -117,6 +119,20 @@ extern int8_t  tsCacheLastRow;
 extern bool    tsdbForceKeepFile;
 extern bool    tsdbForceCompactFile;
 extern int32_t tsdbWalFlushSize;
+extern int32_t tsWalRestoreReadAhead;
+extern int32_t tsWalRestoreRate;
+extern int32_t tsWalCompressSize;
+extern int32_t tsdbBlkCacheSize;
+extern int32_t tsdbReadAheadBlocks;
+extern int8_t  tsdbMemAppendMode;
+extern int32_t tsdbDictMaxEntries;
+extern int32_t tsdbCommitWorkers;
+extern int8_t  tsdbHeadMmap;
+extern int8_t  tsdbZoneMap;
+extern int8_t  tsdbTagIndex;
+extern int8_t  tsdbFloatCodec;
+extern int8_t  tsdbSyncDelta;
+extern int32_t tsdbSyncRate;
 
 // balance
 extern int8_t  tsEnableBalance;
@@ -234,6 +250,10 @@ extern int8_t tsDeadLockKillQuery;
 extern char tsDefaultJSONStrType[];
 extern char tsSmlChildTableName[];
 extern char tsSmlTagNullName[];
+extern int8_t tsSmlDirectInsert;
+
+// prepared statement
+extern int8_t tsStmtQueryTemplate;
 
 
 typedef struct {
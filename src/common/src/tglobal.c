@@ -22,6 +22,7 @@
 #include "tcompare.h"
 #include "tconfig.h"
 #include "tlocale.h"
+#include "tscompression.h"
 #include "tsocket.h"
 #include "ttimezone.h"
 #include "tulog.h"
@@ -162,6 +163,32 @@ int32_t tsTsdbMetaCompactRatio = TSDB_META_COMPACT_RATIO;
 bool    tsdbForceKeepFile = false;
 bool    tsdbForceCompactFile = false;                    // compact TSDB fileset forcibly
 int32_t tsdbWalFlushSize = TSDB_DEFAULT_WAL_FLUSH_SIZE;  // MB
+int32_t tsWalRestoreReadAhead = 4;                       // MB of wal each vnode reads ahead of the replay, 0 means serial
+int32_t tsWalRestoreRate = 0;                            // MB per second of wal read by all the replays, 0 means no limit
+
+/*
+ * denote if the wal records are compressed by LZ4 before written to the wal file. The records written compressed can
+ * not be restored by the versions before it: they are taken as corrupted and skipped, and the file is truncated at the
+ * first record which can not be skipped, so the writes in the wal files of the vnodes not yet committed are lost by a
+ * downgrade. Turn the option off and restart once, so that the wal files are committed and renewed, before a downgrade.
+ * The wal of the mnode is never compressed, since it is never renewed.
+ *
+ * 0: all records are compressed
+ * -1: no record is compressed
+ * other values: if the record payload size is greater than the tsWalCompressSize, the record will be compressed.
+ */
+int32_t tsWalCompressSize = -1;
+int32_t tsdbBlkCacheSize = 0;                            // MB per vnode, 0 means no decoded block cache
+int32_t tsdbReadAheadBlocks = 0;                         // number of file blocks to prefetch in sequential scans
+int8_t  tsdbMemAppendMode = 0;                           // append in order rows to arrays instead of the skiplist
+int32_t tsdbDictMaxEntries = 0;                          // max distinct values of a dictionary encoded column, 0 means off
+int32_t tsdbCommitWorkers = 0;                           // threads to commit the tables of a file set, 0 means serial
+int8_t  tsdbHeadMmap = 0;                                // map .head files into memory and share their index across queries
+int8_t  tsdbZoneMap = 0;                                 // keep the column ranges of each table in a file set to skip it
+int8_t  tsdbTagIndex = 0;                                // index the tag columns of super tables other than the first one
+int8_t  tsdbFloatCodec = 0;                              // choose the codec of float/double columns per block
+int8_t  tsdbSyncDelta = 1;                               // resync only the changed chunks of the files a replica has
+int32_t tsdbSyncRate = 0;                                // MB per second of the files sent to a replica, 0 means no limit
 
 // balance
 int8_t  tsEnableBalance = 1;
@@ -210,6 +237,8 @@ char   tsMnodeBakDir[PATH_MAX] = {0};
 char   tsDataDir[PATH_MAX] = {0};
 char   tsScriptDir[PATH_MAX] = {0};
 char   tsTempDir[PATH_MAX] = "/tmp/";
+int32_t tsMergeMemBufferSize = 0;  // MB of the vnode results kept in memory by the merges of all the super table queries
+int32_t tsOrderMemBufferSize = 64;  // MB of rows sorted in memory by an order by before they are spilled to disk
 int32_t tsKeepTimeOffset = 0;
 
 int32_t tsDiskCfgNum = 0;
@@ -292,6 +321,10 @@ char tsSmlChildTableName[TSDB_TABLE_NAME_LEN] = ""; //user defined child table n
 char tsSmlTagNullName[TSDB_COL_NAME_LEN] = "_tag_null"; //for line protocol if tag is omitted, add a tag with NULL value
                                                         //to make sure inserted records belongs to the same measurement
                                                         //default name is _tag_null and can be user configurable
+int8_t tsSmlDirectInsert = 0; //bind schemaless data points to the insert statement directly instead of building SQL text
+
+// keep the validated query of a prepared select statement and rebind its parameters instead of parsing the SQL text again
+int8_t tsStmtQueryTemplate = 0;
 
 int32_t (*monStartSystemFp)() = NULL;
 void (*monStopSystemFp)() = NULL;
@@ -1647,6 +1680,26 @@ static void doInitGlobalConfig(void) {
   cfg.unitType = TAOS_CFG_UTYPE_NONE;
   taosInitConfigOption(cfg);
 
+  cfg.option = "mergeMemBufferSize";
+  cfg.ptr = &tsMergeMemBufferSize;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW | TSDB_CFG_CTYPE_B_CLIENT;
+  cfg.minValue = 0;
+  cfg.maxValue = 65536;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_MB;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "orderMemBufferSize";
+  cfg.ptr = &tsOrderMemBufferSize;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW | TSDB_CFG_CTYPE_B_CLIENT;
+  cfg.minValue = 1;
+  cfg.maxValue = 65536;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_MB;
+  taosInitConfigOption(cfg);
+
   cfg.option = "tsdbMetaCompactRatio";
   cfg.ptr = &tsTsdbMetaCompactRatio;
   cfg.valType = TAOS_CFG_VTYPE_INT32;
@@ -1711,6 +1764,28 @@ static void doInitGlobalConfig(void) {
   cfg.unitType = TAOS_CFG_UTYPE_NONE;
   taosInitConfigOption(cfg);
 
+  // write schemaless data points without generating the insert SQL
+  cfg.option = "smlDirectInsert";
+  cfg.ptr = &tsSmlDirectInsert;
+  cfg.valType = TAOS_CFG_VTYPE_INT8;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW | TSDB_CFG_CTYPE_B_CLIENT;
+  cfg.minValue = 0;
+  cfg.maxValue = 1;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  // re-execute prepared select statements without parsing the SQL text
+  cfg.option = "stmtQueryTemplate";
+  cfg.ptr = &tsStmtQueryTemplate;
+  cfg.valType = TAOS_CFG_VTYPE_INT8;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW | TSDB_CFG_CTYPE_B_CLIENT;
+  cfg.minValue = 0;
+  cfg.maxValue = 1;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
   // flush vnode wal file if walSize > walFlushSize and walSize > cache*0.5*blocks
   cfg.option = "walFlushSize";
   cfg.ptr = &tsdbWalFlushSize;
@@ -1722,6 +1797,153 @@ static void doInitGlobalConfig(void) {
   cfg.unitType = TAOS_CFG_UTYPE_MB;
   taosInitConfigOption(cfg);
 
+  // wal records read and checked by a thread while the vnode replays the ones before them
+  cfg.option = "walRestoreReadAhead";
+  cfg.ptr = &tsWalRestoreReadAhead;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 1024;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_MB;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "walRestoreRate";
+  cfg.ptr = &tsWalRestoreRate;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 65536;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_MB;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "walCompressSize";
+  cfg.ptr = &tsWalCompressSize;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = -1;
+  cfg.maxValue = TSDB_MAX_WAL_SIZE;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_BYTE;
+  taosInitConfigOption(cfg);
+
+  // memory budget of the decoded column block cache of each vnode
+  cfg.option = "tsdbBlockCacheSize";
+  cfg.ptr = &tsdbBlkCacheSize;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 65536;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_MB;
+  taosInitConfigOption(cfg);
+
+  // number of data blocks read ahead of the one being decoded when scanning a file set, 0 disables it
+  cfg.option = "tsdbReadAheadBlocks";
+  cfg.ptr = &tsdbReadAheadBlocks;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 64;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  // rows arriving in key order are appended to arrays in the mem buffer, only rows out of order go to the skiplist
+  cfg.option = "tsdbMemAppendMode";
+  cfg.ptr = &tsdbMemAppendMode;
+  cfg.valType = TAOS_CFG_VTYPE_INT8;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 1;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  // binary/nchar columns of a file block with no more distinct values than this are dictionary encoded, data files
+  // written with it on can't be read by older versions
+  cfg.option = "tsdbDictMaxEntries";
+  cfg.ptr = &tsdbDictMaxEntries;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = TSDB_STR_DICT_MAX_ENTRIES;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  // tables of a file set are committed by the workers in parallel, the files are the same as the serial commit
+  cfg.option = "tsdbCommitWorkers";
+  cfg.ptr = &tsdbCommitWorkers;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 64;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "tsdbHeadMmap";
+  cfg.ptr = &tsdbHeadMmap;
+  cfg.valType = TAOS_CFG_VTYPE_INT8;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 1;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "tsdbZoneMap";
+  cfg.ptr = &tsdbZoneMap;
+  cfg.valType = TAOS_CFG_VTYPE_INT8;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 1;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "tsdbTagIndex";
+  cfg.ptr = &tsdbTagIndex;
+  cfg.valType = TAOS_CFG_VTYPE_INT8;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 1;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "tsdbFloatCodec";
+  cfg.ptr = &tsdbFloatCodec;
+  cfg.valType = TAOS_CFG_VTYPE_INT8;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 1;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "tsdbSyncDelta";
+  cfg.ptr = &tsdbSyncDelta;
+  cfg.valType = TAOS_CFG_VTYPE_INT8;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 1;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "tsdbSyncRate";
+  cfg.ptr = &tsdbSyncRate;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 65536;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_MB;
+  taosInitConfigOption(cfg);
+
   // shortcut flag to facilitate debugging
   cfg.option = "shortcutFlag";
   cfg.ptr = &tsShortcutFlag;
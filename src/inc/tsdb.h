@@ -407,6 +407,12 @@ int64_t tsdbSkipOffset(TsdbQueryHandleT queryHandle);
  */
 void tsdbReportStat(void *repo, int64_t *totalPoints, int64_t *totalStorage, int64_t *compStorage);
 
+// fetch and reset the block cache hit/miss counters of all repos since last call, and get the bytes they hold
+void tsdbGetBlkCacheStatisInfo(int64_t *nHit, int64_t *nMiss, int64_t *used);
+
+// fetch and reset the bytes of the files sent to and kept by recovering replicas since last call
+void tsdbGetSyncStatisInfo(int64_t *nSent, int64_t *nSkipped);
+
 int  tsdbInitCommitQueue();
 void tsdbDestroyCommitQueue();
 int  tsdbSyncCommit(STsdbRepo *repo);
@@ -446,6 +452,10 @@ char* parseTagDatatoJson(void *p);
 typedef bool (*readover_callback)(void* param, int8_t type, int32_t tid);
 void tsdbAddScanCallback(TsdbQueryHandleT* queryHandle, readover_callback callback, void* param);
 
+// return false if no row in the range of the statistics can match the query, then the blocks are skipped
+typedef bool (*filter_statis_callback)(void* param, SDataStatis* pStatis, int32_t numOfCols, int32_t numOfRows);
+void tsdbAddFilterCallback(TsdbQueryHandleT* queryHandle, filter_statis_callback callback, void* param);
+
 int32_t tsdbTableTid(void* pTable);
 
 #ifdef __cplusplus
@@ -32,7 +32,7 @@ typedef enum {
 
 typedef struct {
   int8_t   msgType;
-  int8_t   sver;  // sver 2 for WAL SDataRow/SMemRow compatibility
+  int8_t   sver;  // sver 2 for WAL SDataRow/SMemRow compatibility, sver 3 for the records compressed
   int8_t   reserved[2];
   int32_t  len;
   uint64_t version;
@@ -50,6 +50,7 @@ typedef struct {
 
 typedef void *  twalh;  // WAL HANDLE
 typedef int32_t FWalWrite(void *ahandle, void *pHead, int32_t qtype, void *pMsg);
+typedef void    FWalProgress(void *ahandle, int64_t restored, int64_t total, int64_t leftMs);
 
 int32_t  walInit();
 void     walCleanUp();
@@ -62,11 +63,13 @@ void     walRemoveOneOldFile(twalh);
 void     walRemoveAllOldFiles(twalh);
 int32_t  walWrite(twalh, SWalHead *);
 void     walFsync(twalh, bool forceFsync);
-int32_t  walRestore(twalh, void *pVnode, FWalWrite writeFp);
+int32_t  walRestore(twalh, void *pVnode, FWalWrite writeFp, FWalProgress progressFp);
 int32_t  walGetWalFile(twalh, char *fileName, int64_t *fileId);
 uint64_t walGetVersion(twalh);
 void     walResetVersion(twalh, uint64_t newVer);
 int64_t  walGetFSize(twalh);
+void *   walDecompressRecord(SWalHead *pHead, void *buf);
+void     walGetCompStatisInfo(int64_t *rawBytes, int64_t *writtenBytes);
 
 #ifdef __cplusplus
 }
@@ -26,6 +26,13 @@ typedef struct {
   int64_t submitReqSucNum;
   int64_t submitRowNum;
   int64_t submitRowSucNum;
+  int64_t blkCacheHitNum;
+  int64_t blkCacheMissNum;
+  int64_t blkCacheUsed;
+  int64_t syncSentBytes;
+  int64_t syncSkippedBytes;
+  int64_t walRawBytes;
+  int64_t walWrittenBytes;
 } SVnodeStatisInfo;
 
 typedef struct {
@@ -377,6 +377,12 @@ int32_t taosFsync(FileFd fd) {
   return FlushFileBuffers(h)-1;
 }
 
+int32_t taosReadAhead(FileFd fd, int64_t offset, int64_t count) { return 0; }
+
+void *taosMmapReadOnly(FileFd fd, int64_t length) { return NULL; }
+
+void taosMunmap(void *ptr, int64_t length) {}
+
 int32_t taosRename(char *oldName, char *newName) {
   int32_t code = MoveFileEx(oldName, newName, MOVEFILE_REPLACE_EXISTING | MOVEFILE_COPY_ALLOWED);
   if (code < 0) {
@@ -393,6 +399,25 @@ int32_t taosRename(char *oldName, char *newName) {
 int32_t taosFtruncate(FileFd fd, int64_t length) { return ftruncate(fd, length); }
 int32_t taosFsync(FileFd fd) { return fsync(fd); }
 
+// hint the kernel to start reading the range in background, the caller does not wait for the I/O
+int32_t taosReadAhead(FileFd fd, int64_t offset, int64_t count) {
+#if defined(_TD_DARWIN_64)
+  return 0;
+#else
+  return posix_fadvise(fd, offset, count, POSIX_FADV_WILLNEED);
+#endif
+}
+
+// map the file from the beginning for reading, NULL if failed
+void *taosMmapReadOnly(FileFd fd, int64_t length) {
+  void *ptr = mmap(NULL, (size_t)length, PROT_READ, MAP_SHARED, fd, 0);
+  return (ptr == MAP_FAILED) ? NULL : ptr;
+}
+
+void taosMunmap(void *ptr, int64_t length) {
+  if (ptr != NULL) munmap(ptr, (size_t)length);
+}
+
 int32_t taosRename(char *oldName, char *newName) {
   int32_t code = rename(oldName, newName);
   if (code < 0) {
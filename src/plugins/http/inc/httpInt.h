@@ -40,6 +40,7 @@
 #define HTTP_GC_TARGET_SIZE         16384
 #define HTTP_WRITE_RETRY_TIMES      500
 #define HTTP_WRITE_WAIT_TIME_MS     5
+#define HTTP_WRITE_MAX_WAIT_MS      5000    //max wait of a response write for the client, it blocks the fetch thread
 #define HTTP_PASSWORD_LEN           TSDB_UNI_LEN
 #define HTTP_SESSION_ID_LEN         (TSDB_USER_LEN + HTTP_PASSWORD_LEN)
 #define HTTP_STATUS_CODE_NUM        63
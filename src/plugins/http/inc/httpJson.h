@@ -39,6 +39,8 @@ extern char JsonFalseTkn[];
 typedef struct {
   int32_t size;
   int32_t total;
+  bool    failed;  // a chunk is not sent completely, the rest of the response is dropped
+  char    slot;    // the last char sent, 0 if nothing is sent
   char*   lst;
   char    buf[JSON_BUFFER_SIZE];
   struct  HttpContext* pContext;
@@ -42,6 +42,11 @@ int32_t httpWriteBufByFd(struct HttpContext* pContext, const char* buf, int32_t
   int32_t len;
   int32_t countWait = 0;
   int32_t writeLen = 0;
+#ifdef _TD_LINUX
+  // the write runs on the thread of the fetch callback, so the total wait for the client is capped
+  int64_t maxWaitMs = MIN(tsHttpKeepAlive, HTTP_WRITE_MAX_WAIT_MS);
+  int64_t deadlineMs = taosGetTimestampMs() + maxWaitMs;
+#endif
 
   do {
     if (pContext->fd > 2) {
@@ -51,17 +56,40 @@ int32_t httpWriteBufByFd(struct HttpContext* pContext, const char* buf, int32_t
     }
 
     if (len < 0) {
+#ifdef _TD_LINUX
+      // the socket is full, wait until the client reads the response, until the deadline of the write
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        int64_t leftMs = deadlineMs - taosGetTimestampMs();
+        struct pollfd wfd = {.fd = pContext->fd, .events = POLLOUT};
+        if (leftMs > 0 && poll(&wfd, 1, (int32_t)leftMs) > 0) {
+          countWait++;
+          continue;
+        }
+        httpDebug("context:%p, fd:%d, socket is not writable in %" PRId64 " ms, times:%d, written:%d of %d", pContext,
+                  pContext->fd, maxWaitMs, countWait, writeLen, sz);
+
+        // the response is dropped, so the socket is reset when closed instead of lingering on the bytes not sent
+        struct linger linger = {.l_onoff = 1, .l_linger = 0};
+        taosSetSockOpt(pContext->fd, SOL_SOCKET, SO_LINGER, (void*)&linger, sizeof(linger));
+        break;
+      } else if (errno == EINTR) {
+        continue;
+      }
+
+      httpDebug("context:%p, fd:%d, socket write errno:%d:%s", pContext, pContext->fd, errno, strerror(errno));
+      break;
+#else
       httpDebug("context:%p, fd:%d, socket write errno:%d:%s, times:%d", pContext, pContext->fd, errno, strerror(errno),
                 countWait);
       if (++countWait > HTTP_WRITE_RETRY_TIMES) break;
       taosMsleep(HTTP_WRITE_WAIT_TIME_MS);
       continue;
+#endif
     } else if (len == 0) {
       httpDebug("context:%p, fd:%d, socket write errno:%d:%s, connect already closed", pContext, pContext->fd, errno,
                 strerror(errno));
       break;
     } else {
-      countWait = 0;
       writeLen += len;
     }
   } while (writeLen < sz);
@@ -101,6 +129,15 @@ int32_t httpWriteJsonBufBody(JsonBuf* buf, bool isTheLast) {
     buf->pContext->fd = -1;
   }
 
+  // the client can not parse the chunks after a broken one
+  if (buf->failed) {
+    if (isTheLast && buf->pContext->parser->acceptEncodingGzip == 1 && tsHttpEnableCompress) {
+      deflateEnd(&buf->pContext->gzipStream);
+    }
+    buf->lst = buf->buf;
+    return 0;
+  }
+
   /*
    * HTTP servers often use compression to optimize transmission, for example
    * with Content-Encoding: gzip or Content-Encoding: deflate.
@@ -117,8 +154,9 @@ int32_t httpWriteJsonBufBody(JsonBuf* buf, bool isTheLast) {
       int32_t len = sprintf(sLen, "%x\r\n", srcLen);
       httpTrace("context:%p, fd:%d, write body, chunkSize:%d, response:\n%s", buf->pContext, buf->pContext->fd, srcLen,
                 buf->buf);
-      httpWriteBufNoTrace(buf->pContext, sLen, len);
-      remain = httpWriteBufNoTrace(buf->pContext, buf->buf, srcLen);
+      if (httpWriteBufNoTrace(buf->pContext, sLen, len) != len) buf->failed = true;
+      remain = buf->failed ? 0 : httpWriteBufNoTrace(buf->pContext, buf->buf, srcLen);
+      if (remain != srcLen) buf->failed = true;
     }
   } else {
     char    compressBuf[JSON_BUFFER_SIZE] = {0};
@@ -129,8 +167,9 @@ int32_t httpWriteJsonBufBody(JsonBuf* buf, bool isTheLast) {
         int32_t len = sprintf(sLen, "%x\r\n", compressBufLen);
         httpTrace("context:%p, fd:%d, write body, chunkSize:%d, compressSize:%d, last:%d, response:\n%s", buf->pContext,
                   buf->pContext->fd, srcLen, compressBufLen, isTheLast, buf->buf);
-        httpWriteBufNoTrace(buf->pContext, sLen, len);
-        remain = httpWriteBufNoTrace(buf->pContext, (const char*)compressBuf, compressBufLen);
+        if (httpWriteBufNoTrace(buf->pContext, sLen, len) != len) buf->failed = true;
+        remain = buf->failed ? 0 : httpWriteBufNoTrace(buf->pContext, (const char*)compressBuf, compressBufLen);
+        if (remain != compressBufLen) buf->failed = true;
       } else {
         httpDebug("context:%p, fd:%d, last:%d, compress already dumped, response:\n%s", buf->pContext,
                   buf->pContext->fd, isTheLast, buf->buf);
@@ -143,8 +182,13 @@ int32_t httpWriteJsonBufBody(JsonBuf* buf, bool isTheLast) {
     }
   }
 
-  httpWriteBufNoTrace(buf->pContext, "\r\n", 2);
+  if (!buf->failed && httpWriteBufNoTrace(buf->pContext, "\r\n", 2) != 2) buf->failed = true;
+
+  // the connection is closed after the response, instead of being kept alive with a broken response
+  if (buf->failed) buf->pContext->error = true;
+
   buf->total += (int32_t)(buf->lst - buf->buf);
+  if (buf->lst > buf->buf) buf->slot = *(buf->lst - 1);
   buf->lst = buf->buf;
   memset(buf->buf, 0, (size_t)buf->size);
   return remain;
@@ -176,12 +220,14 @@ void httpWriteJsonBufEnd(JsonBuf* buf) {
   }
 
   httpWriteJsonBufBody(buf, true);
-  httpWriteBufNoTrace(buf->pContext, "0\r\n\r\n", 5);  // end of chunked resp
+  if (!buf->failed) httpWriteBufNoTrace(buf->pContext, "0\r\n\r\n", 5);  // end of chunked resp
 }
 
 void httpInitJsonBuf(JsonBuf* buf, struct HttpContext* pContext) {
   buf->lst = buf->buf;
   buf->total = 0;
+  buf->failed = false;
+  buf->slot = 0;
   buf->size = JSON_BUFFER_SIZE;  // option setting
   buf->pContext = pContext;
   memset(buf->lst, 0, JSON_BUFFER_SIZE);
@@ -194,11 +240,12 @@ void httpInitJsonBuf(JsonBuf* buf, struct HttpContext* pContext) {
 }
 
 void httpJsonItemToken(JsonBuf* buf) {
-  char c = *(buf->lst - 1);
-  if (c == JsonArrStt || c == JsonObjStt || c == JsonPairTkn || c == JsonItmTkn) {
+  // the buffer is empty after flushed, then the token depends on the last char sent
+  char c = (buf->lst > buf->buf) ? *(buf->lst - 1) : buf->slot;
+  if (c == 0 || c == JsonArrStt || c == JsonObjStt || c == JsonPairTkn || c == JsonItmTkn) {
     return;
   }
-  if (buf->lst > buf->buf) httpJsonToken(buf, JsonItmTkn);
+  httpJsonToken(buf, JsonItmTkn);
 }
 
 void httpJsonString(JsonBuf* buf, char* sVal, int32_t len) {
@@ -217,7 +217,7 @@ bool restBuildSqlJson(HttpContext *pContext, HttpSqlCmd *cmd, TAOS_RES *result,
     httpJsonToken(jsonBuf, JsonArrEnd);
     cmd->numOfRows++;
 
-    if (pContext->fd <= 0) {
+    if (pContext->fd <= 0 || jsonBuf->failed) {
       httpError("context:%p, fd:%d, user:%s, conn closed, abort retrieve", pContext, pContext->fd, pContext->user);
       return false;
     }
@@ -229,6 +229,13 @@ bool restBuildSqlJson(HttpContext *pContext, HttpSqlCmd *cmd, TAOS_RES *result,
     }
   }
 
+  // the rows of each block are sent before the next block is fetched, which is only fetched when the client reads them
+  httpWriteJsonBufBody(jsonBuf, false);
+  if (jsonBuf->failed) {
+    httpError("context:%p, fd:%d, user:%s, failed to send rows, abort retrieve", pContext, pContext->fd, pContext->user);
+    return false;
+  }
+
   httpDebug("context:%p, fd:%d, user:%s, retrieved row:%d", pContext, pContext->fd, pContext->user, cmd->numOfRows);
   return true;
 }
@@ -445,7 +445,8 @@ int32_t httpGzipCompress(HttpContext *pContext, char *srcData, int32_t nSrcData,
   pContext->gzipStream.avail_out = (uLong)(*nDestData);
 
   while (pContext->gzipStream.avail_in != 0) {
-    if (deflate(&pContext->gzipStream, Z_FULL_FLUSH) != Z_OK) {
+    // each chunk is decodable once received, without resetting the dictionary as Z_FULL_FLUSH does
+    if (deflate(&pContext->gzipStream, Z_SYNC_FLUSH) != Z_OK) {
       return -1;
     }
 
@@ -512,6 +512,18 @@ static void monGetSysStats() {
 
   tsMonStat.dInfo = dnodeGetStatisInfo();
   tsMonStat.vInfo = vnodeGetStatisInfo();
+  if (tsMonStat.vInfo.blkCacheHitNum + tsMonStat.vInfo.blkCacheMissNum > 0) {
+    monInfo("tsdb block cache hit:%" PRId64 " miss:%" PRId64 " used:%" PRId64 " bytes", tsMonStat.vInfo.blkCacheHitNum,
+            tsMonStat.vInfo.blkCacheMissNum, tsMonStat.vInfo.blkCacheUsed);
+  }
+  if (tsMonStat.vInfo.syncSentBytes + tsMonStat.vInfo.syncSkippedBytes > 0) {
+    monInfo("tsdb sync sent:%" PRId64 " skipped:%" PRId64 " bytes", tsMonStat.vInfo.syncSentBytes,
+            tsMonStat.vInfo.syncSkippedBytes);
+  }
+  if (tsMonStat.vInfo.walWrittenBytes < tsMonStat.vInfo.walRawBytes) {
+    monInfo("wal raw:%" PRId64 " written:%" PRId64 " bytes", tsMonStat.vInfo.walRawBytes,
+            tsMonStat.vInfo.walWrittenBytes);
+  }
 
   tsMonStat.monQueryReqCnt = monFetchQueryReqCnt();
   tsMonStat.monSubmitReqCnt = monFetchSubmitReqCnt();
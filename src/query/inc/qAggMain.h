@@ -149,6 +149,21 @@ typedef struct SQLPreAggVal {
   SDataStatis statis;
 } SQLPreAggVal;
 
+#define AGG_KERNEL_COUNT  0x1
+#define AGG_KERNEL_SUM    0x2
+#define AGG_KERNEL_MINMAX 0x4
+
+// result of the aggregate kernels on one column of the data block, shared by count/sum/avg/min/max of the column
+typedef struct SColumnAggRes {
+  void   *pInput;      // data the result is computed on, NULL if not computed for the current data block yet
+  int32_t size;
+  int8_t  required;    // union of AGG_KERNEL_XXX required by the functions sharing the result
+  int32_t numOfElem;   // number of not null values
+  int64_t sum;         // the same layout as SDataStatis, double for float/double columns
+  int64_t min;
+  int64_t max;
+} SColumnAggRes;
+
 typedef struct SInterpInfoDetail {
   TSKEY  ts;  // interp specified timestamp
   int8_t type;
@@ -217,6 +232,8 @@ typedef struct SQLFunctionCtx {
   SHashObj     **pModeSet;     // for mode function
   STimeWindow  qWindow;        // for _qstart/_qstop/_qduration column
   int32_t      allocRows;      // rows allocated for output buffer
+  SColumnAggRes  colAgg;
+  SColumnAggRes *pColAgg;      // kernel result of the input column, NULL if the aggregate kernels are not used
 } SQLFunctionCtx;
 
 typedef struct SAggFunctionInfo {
@@ -242,6 +259,7 @@ int32_t getResultDataInfo(int32_t dataType, int32_t dataBytes, int32_t functionI
 int16_t getTimeWindowFunctionID(int16_t colIndex);
 
 bool isTimeWindowFunction(int32_t functionId);
+int8_t getAggKernelRequired(int32_t functionId, int32_t type);
 int32_t isValidFunction(const char* name, int32_t len);
 bool isValidStateOper(char *oper, int32_t len);
 
@@ -561,6 +561,7 @@ typedef struct SGroupbyOperatorInfo {
   SArray         *pGroupbyDataInfo;
   int32_t        totalBytes;
   char           *prevData;   // previous data buf
+  char           *keyBuf;     // group key of the current row, swapped with prevData
 } SGroupbyOperatorInfo;
 
 typedef struct SSWindowOperatorInfo {
@@ -621,11 +622,28 @@ typedef struct SMultiwayMergeInfo {
   bool                 multiGroupResults;
 } SMultiwayMergeInfo;
 
-// todo support the disk-based sort
+// one sorted run flushed to disk by the order operator
+typedef struct SOrderSource {
+  int32_t    flushoutIdx;  // index of the run in the flush out info of the external buffer
+  int32_t    pageId;       // page of the run that is loaded in filePage
+  int32_t    rowIdx;       // -1 if this run is exhausted
+  tFilePage  filePage;     // must be the last member
+} SOrderSource;
+
 typedef struct SOrderOperatorInfo {
-  int32_t      colIndex;
-  int32_t      order;
-  SSDataBlock *pDataBlock;
+  int32_t         colIndex;
+  int32_t         order;
+  SSDataBlock    *pDataBlock;
+  int32_t         capacity;     // max number of rows sorted in memory before spilling to disk
+  int64_t         topN;         // limit + offset, 0 if all rows are required
+  int64_t         numOfOutput;  // rows that have been returned during the merge stage
+  __compar_fn_t   comp;
+  SColumnModel   *pModel;
+  tExtMemBuffer  *pExtBuf;      // sorted runs spilled to disk
+  SOrderSource  **pSource;
+  int32_t         numOfSource;
+  int32_t         numOfCompleted;
+  struct SLoserTreeInfo *pTree;
 } SOrderOperatorInfo;
 
 void appendUpstream(SOperatorInfo* p, SOperatorInfo* pUpstream);
@@ -740,5 +758,6 @@ void qInfoLogSSDataBlock(SSDataBlock* block, char* location);
 void addTableReadRows(SQueryRuntimeEnv* pEnv, int32_t tid, int32_t rows);
 // tsdb scan table callback table or query is over. param is SQueryRuntimeEnv*
 bool qReadOverCB(void* param, int8_t type, int32_t tid);
+bool qFilterStatisCB(void* param, SDataStatis* pStatis, int32_t numOfCols, int32_t numOfRows);
 
 #endif  // TDENGINE_QEXECUTOR_H
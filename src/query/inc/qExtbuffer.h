@@ -121,6 +121,9 @@ typedef struct tExtMemBuffer {
   FILE *    file;
   SExtFileInfo fileMeta;
 
+  bool      flushToMem;     // keep the flushed pages in memory instead of the temp file, within mergeMemBufferSize
+  SArray *  pFlushedPages;  // tFilePagesItem* flushed but kept in memory, ordered by the page id in the file
+
   SColumnModel *         pColumnModel;
   EXT_BUFFER_FLUSH_MODEL flushModel;
 } tExtMemBuffer;
@@ -157,6 +160,13 @@ int16_t tExtMemBufferPut(tExtMemBuffer *pMemBuffer, void *data, int32_t numOfRow
  */
 int32_t tExtMemBufferFlush(tExtMemBuffer *pMemBuffer);
 
+/**
+ * merge the flush out info from flushIdx to the last one into one, the pages of them must be contiguous
+ * @param pMemBuffer
+ * @param flushIdx   the first flush out info to merge
+ */
+void tExtMemBufferMergeFlushoutInfo(tExtMemBuffer *pMemBuffer, int32_t flushIdx);
+
 /**
  *
  * remove all data that has been put into buffer, including in buffer or
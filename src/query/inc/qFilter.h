@@ -106,6 +106,8 @@ typedef int32_t(*filter_desc_compare_func)(const void *, const void *);
 typedef bool(*filter_exec_func)(void *, int32_t, int8_t**, SDataStatis *, int16_t);
 typedef int32_t (*filer_get_col_from_id)(void *, int32_t, void **);
 typedef int32_t (*filer_get_col_from_name)(void *, int32_t, char*, void **);
+typedef void (*filter_range_kernel_func)(const void *, int32_t, const void *, const void *, int8_t *);
+typedef void (*filter_in_kernel_func)(const void *, int32_t, const void *, int32_t, int8_t *);
 
 typedef struct SFilterRangeCompare {
   int64_t s;
@@ -214,6 +216,19 @@ typedef struct SFilterComUnit {
   int8_t rfunc;
 } SFilterComUnit;
 
+#define FILTER_KERNEL_MAX_IN_NUM 8
+
+// vectorized execution of a single integer/timestamp range or equal unit, or of a small in list
+typedef struct SFilterKernel {
+  int8_t                   empty;   // the normalized range matches nothing
+  int32_t                  inNum;
+  filter_range_kernel_func rangeFp;
+  filter_in_kernel_func    inFp;
+  int64_t                  lo;      // inclusive bounds, stored in the column type
+  int64_t                  hi;
+  int64_t                  inVals[FILTER_KERNEL_MAX_IN_NUM];
+} SFilterKernel;
+
 typedef struct SFilterPCtx {
   SHashObj *valHash;
   SHashObj *unitHash;
@@ -239,6 +254,7 @@ typedef struct SFilterInfo {
   uint32_t         *blkUnits;
   int8_t           *blkUnitRes;
   void             *pTable;
+  SFilterKernel    *kernel;
 
   SFilterPCtx       pctx;
 } SFilterInfo;
@@ -896,6 +896,273 @@ static void function_finalizer(SQLFunctionCtx *pCtx) {
   doFinalizer(pCtx);
 }
 
+/*
+ * Type specialized kernels of count/sum/min/max. The not null values of one column are counted, summed and
+ * reduced to min/max in a single sweep, the result is kept in SColumnAggRes and shared by all these functions
+ * on the same column, so "select count(c), avg(c), min(c), max(c)" scans the column once. Nulls are sentinel
+ * values, they are masked with branch free selects, and every lane of AGG_KERNEL_LANES accumulates independently
+ * so that the loops are turned into packed operations, float sums included. The index of min/max is only
+ * searched when the value is selected and tags or timestamp are queried with it.
+ */
+#define AGG_KERNEL_LANES 8
+
+#define AGG_KERNEL_STEP(_i, _j, _checkNull)                                                    \
+  do {                                                                                        \
+    int32_t _notNull = (_checkNull) ? (b[_i] != nullVal) : 1;                                 \
+    num += _notNull;                                                                          \
+    if (flag & AGG_KERNEL_SUM) {                                                              \
+      sum[_j] += _notNull ? (agg_sum_t)v[_i] : 0;                                             \
+    }                                                                                         \
+    if (flag & AGG_KERNEL_MINMAX) {                                                           \
+      agg_t _a = _notNull ? v[_i] : minInit;                                                  \
+      agg_t _b = _notNull ? v[_i] : maxInit;                                                  \
+      mn[_j] = (_a < mn[_j]) ? _a : mn[_j];                                                   \
+      mx[_j] = (_b > mx[_j]) ? _b : mx[_j];                                                   \
+    }                                                                                         \
+  } while (0)
+
+#define AGG_KERNEL_LOOP(_checkNull)                                                            \
+  do {                                                                                        \
+    int32_t i = 0;                                                                            \
+    for (; i + AGG_KERNEL_LANES <= numOfRows; i += AGG_KERNEL_LANES) {                        \
+      for (int32_t j = 0; j < AGG_KERNEL_LANES; ++j) {                                        \
+        AGG_KERNEL_STEP(i + j, j, _checkNull);                                                \
+      }                                                                                       \
+    }                                                                                         \
+    for (; i < numOfRows; ++i) {                                                              \
+      AGG_KERNEL_STEP(i, 0, _checkNull);                                                      \
+    }                                                                                         \
+  } while (0)
+
+// min/max are kept in the type of the sum, as SDataStatis does
+#define AGG_KERNEL_BODY(_type, _bits, _null, _sumType, _minInit, _maxInit, _flag)              \
+  do {                                                                                        \
+    typedef _type    agg_t;                                                                   \
+    typedef _bits    agg_bits_t;                                                              \
+    typedef _sumType agg_sum_t;                                                               \
+    const int32_t    flag = (_flag);                                                          \
+    const agg_bits_t nullVal = (agg_bits_t)(_null);                                           \
+    const agg_t      minInit = (agg_t)(_minInit);                                             \
+    const agg_t      maxInit = (agg_t)(_maxInit);                                             \
+    const agg_t     *v = (const agg_t *)data;                                                 \
+    const agg_bits_t *b = (const agg_bits_t *)data;                                           \
+    agg_sum_t        sum[AGG_KERNEL_LANES];                                                   \
+    agg_t            mn[AGG_KERNEL_LANES];                                                    \
+    agg_t            mx[AGG_KERNEL_LANES];                                                    \
+    int32_t          num = 0;                                                                 \
+    for (int32_t j = 0; j < AGG_KERNEL_LANES; ++j) {                                          \
+      sum[j] = 0;                                                                             \
+      mn[j] = minInit;                                                                        \
+      mx[j] = maxInit;                                                                        \
+    }                                                                                         \
+    if (hasNull) {                                                                            \
+      AGG_KERNEL_LOOP(1);                                                                     \
+    } else {                                                                                  \
+      AGG_KERNEL_LOOP(0);                                                                     \
+    }                                                                                         \
+    agg_sum_t s = 0;                                                                          \
+    agg_t     l = minInit;                                                                    \
+    agg_t     h = maxInit;                                                                    \
+    for (int32_t j = 0; j < AGG_KERNEL_LANES; ++j) {                                          \
+      s += sum[j];                                                                            \
+      l = (mn[j] < l) ? mn[j] : l;                                                            \
+      h = (mx[j] > h) ? mx[j] : h;                                                            \
+    }                                                                                         \
+    agg_sum_t lv = (agg_sum_t)l;                                                              \
+    agg_sum_t hv = (agg_sum_t)h;                                                              \
+    pRes->numOfElem = num;                                                                    \
+    memcpy(&pRes->sum, &s, sizeof(int64_t));                                                  \
+    memcpy(&pRes->min, &lv, sizeof(int64_t));                                                 \
+    memcpy(&pRes->max, &hv, sizeof(int64_t));                                                 \
+  } while (0)
+
+typedef void (*agg_kernel_func)(const void *data, int32_t numOfRows, bool hasNull, SColumnAggRes *pRes);
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define AGG_KERNEL_AVX2
+#endif
+
+#define AGG_DEFINE_KERNEL_FUNC(_name, _attr, _type, _bits, _null, _sumType, _minInit, _maxInit)                      \
+  _attr static void aggKernel##_name##Sum(const void *data, int32_t numOfRows, bool hasNull, SColumnAggRes *pRes) {    \
+    AGG_KERNEL_BODY(_type, _bits, _null, _sumType, _minInit, _maxInit, AGG_KERNEL_SUM);                              \
+  }                                                                                                                  \
+  _attr static void aggKernel##_name##MinMax(const void *data, int32_t numOfRows, bool hasNull, SColumnAggRes *pRes) { \
+    AGG_KERNEL_BODY(_type, _bits, _null, _sumType, _minInit, _maxInit, AGG_KERNEL_MINMAX);                           \
+  }                                                                                                                  \
+  _attr static void aggKernel##_name##All(const void *data, int32_t numOfRows, bool hasNull, SColumnAggRes *pRes) {    \
+    AGG_KERNEL_BODY(_type, _bits, _null, _sumType, _minInit, _maxInit, AGG_KERNEL_SUM | AGG_KERNEL_MINMAX);          \
+  }
+
+#ifdef AGG_KERNEL_AVX2
+#define AGG_DEFINE_KERNEL(_name, ...)                                       \
+  AGG_DEFINE_KERNEL_FUNC(_name, , __VA_ARGS__)                              \
+  AGG_DEFINE_KERNEL_FUNC(_name##Avx2, __attribute__((target("avx2"))), __VA_ARGS__)
+#define AGG_KERNEL_ENTRY(_name)                                                           \
+  {{aggKernel##_name##Sum, aggKernel##_name##MinMax, aggKernel##_name##All},             \
+   {aggKernel##_name##Avx2Sum, aggKernel##_name##Avx2MinMax, aggKernel##_name##Avx2All}}
+#else
+#define AGG_DEFINE_KERNEL(_name, ...) AGG_DEFINE_KERNEL_FUNC(_name, , __VA_ARGS__)
+#define AGG_KERNEL_ENTRY(_name)                                                           \
+  {{aggKernel##_name##Sum, aggKernel##_name##MinMax, aggKernel##_name##All},             \
+   {aggKernel##_name##Sum, aggKernel##_name##MinMax, aggKernel##_name##All}}
+#endif
+
+AGG_DEFINE_KERNEL(Int8, int8_t, int8_t, TSDB_DATA_TINYINT_NULL, int64_t, INT8_MAX, INT8_MIN)
+AGG_DEFINE_KERNEL(Int16, int16_t, int16_t, TSDB_DATA_SMALLINT_NULL, int64_t, INT16_MAX, INT16_MIN)
+AGG_DEFINE_KERNEL(Int32, int32_t, int32_t, TSDB_DATA_INT_NULL, int64_t, INT32_MAX, INT32_MIN)
+AGG_DEFINE_KERNEL(Int64, int64_t, int64_t, TSDB_DATA_BIGINT_NULL, int64_t, INT64_MAX, INT64_MIN)
+AGG_DEFINE_KERNEL(Uint8, uint8_t, uint8_t, TSDB_DATA_UTINYINT_NULL, uint64_t, UINT8_MAX, 0)
+AGG_DEFINE_KERNEL(Uint16, uint16_t, uint16_t, TSDB_DATA_USMALLINT_NULL, uint64_t, UINT16_MAX, 0)
+AGG_DEFINE_KERNEL(Uint32, uint32_t, uint32_t, TSDB_DATA_UINT_NULL, uint64_t, UINT32_MAX, 0)
+AGG_DEFINE_KERNEL(Uint64, uint64_t, uint64_t, TSDB_DATA_UBIGINT_NULL, uint64_t, UINT64_MAX, 0)
+AGG_DEFINE_KERNEL(Float, float, uint32_t, TSDB_DATA_FLOAT_NULL, double, INFINITY, -INFINITY)
+AGG_DEFINE_KERNEL(Double, double, uint64_t, TSDB_DATA_DOUBLE_NULL, double, INFINITY, -INFINITY)
+
+// kernels of each type, indexed by [avx2][sum, minmax, all]
+static agg_kernel_func gAggKernel[][2][3] = {
+  AGG_KERNEL_ENTRY(Int8),   AGG_KERNEL_ENTRY(Int16),  AGG_KERNEL_ENTRY(Int32), AGG_KERNEL_ENTRY(Int64),
+  AGG_KERNEL_ENTRY(Uint8),  AGG_KERNEL_ENTRY(Uint16), AGG_KERNEL_ENTRY(Uint32), AGG_KERNEL_ENTRY(Uint64),
+  AGG_KERNEL_ENTRY(Float),  AGG_KERNEL_ENTRY(Double),
+};
+
+static int32_t getAggKernelIdx(int32_t type) {
+  switch (type) {
+    case TSDB_DATA_TYPE_TINYINT:   return 0;
+    case TSDB_DATA_TYPE_SMALLINT:  return 1;
+    case TSDB_DATA_TYPE_INT:       return 2;
+    case TSDB_DATA_TYPE_BIGINT:    return 3;
+    case TSDB_DATA_TYPE_UTINYINT:  return 4;
+    case TSDB_DATA_TYPE_USMALLINT: return 5;
+    case TSDB_DATA_TYPE_UINT:      return 6;
+    case TSDB_DATA_TYPE_UBIGINT:   return 7;
+    case TSDB_DATA_TYPE_FLOAT:     return 8;
+    case TSDB_DATA_TYPE_DOUBLE:    return 9;
+    default:                       return -1;
+  }
+}
+
+static bool aggKernelUseAvx2() {
+#ifdef AGG_KERNEL_AVX2
+  static int8_t avx2 = -1;
+  if (avx2 < 0) {
+    avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+  }
+  return avx2 == 1;
+#else
+  return false;
+#endif
+}
+
+int8_t getAggKernelRequired(int32_t functionId, int32_t type) {
+  if (getAggKernelIdx(type) < 0) {
+    return 0;
+  }
+
+  switch (functionId) {
+    case TSDB_FUNC_COUNT: return AGG_KERNEL_COUNT;
+    case TSDB_FUNC_SUM:   return AGG_KERNEL_SUM;
+    case TSDB_FUNC_AVG:
+      // the kernel sums 64 bits integers in the integer, which may overflow while the scalar loop of avg does not
+      return (type == TSDB_DATA_TYPE_BIGINT || type == TSDB_DATA_TYPE_UBIGINT) ? 0 : AGG_KERNEL_SUM;
+    case TSDB_FUNC_MIN:
+    case TSDB_FUNC_MAX:   return AGG_KERNEL_MINMAX;
+    default:              return 0;
+  }
+}
+
+// compute the kernel result of the input column, unless it is computed already by another function of the column
+static SColumnAggRes *getColumnAggRes(SQLFunctionCtx *pCtx) {
+  SColumnAggRes *pRes = pCtx->pColAgg;
+  if (pRes == NULL || pCtx->pInput == NULL || pCtx->currentStage == MERGE_STAGE) {
+    return NULL;
+  }
+
+  if (pRes->pInput != pCtx->pInput || pRes->size != pCtx->size) {
+    int32_t k = 0;
+    if ((pRes->required & AGG_KERNEL_MINMAX) != 0) {
+      k = ((pRes->required & AGG_KERNEL_SUM) != 0) ? 2 : 1;
+    }
+
+    agg_kernel_func fp = gAggKernel[getAggKernelIdx(pCtx->inputType)][aggKernelUseAvx2() ? 1 : 0][k];
+    (*fp)(pCtx->pInput, pCtx->size, pCtx->hasNull, pRes);
+
+    pRes->pInput = pCtx->pInput;
+    pRes->size = pCtx->size;
+  }
+
+  return pRes;
+}
+
+// the position min/max is found at, the last one for min and the first one for max, as the scalar loop does
+#define AGG_KERNEL_FIND_INDEX(_type, _v)                   \
+  do {                                                   \
+    const _type *d = (const _type *)pCtx->pInput;        \
+    _type        t = (_type)(_v);                        \
+    if (isMin) {                                         \
+      for (int32_t i = pCtx->size - 1; i >= 0; --i) {    \
+        if (d[i] == t) return i;                         \
+      }                                                  \
+    } else {                                             \
+      for (int32_t i = 0; i < pCtx->size; ++i) {         \
+        if (d[i] == t) return i;                         \
+      }                                                  \
+    }                                                    \
+  } while (0)
+
+static int32_t aggKernelFindIndex(SQLFunctionCtx *pCtx, const int64_t *pVal, int32_t isMin) {
+  switch (pCtx->inputType) {
+    case TSDB_DATA_TYPE_TINYINT:   AGG_KERNEL_FIND_INDEX(int8_t, *pVal); break;
+    case TSDB_DATA_TYPE_SMALLINT:  AGG_KERNEL_FIND_INDEX(int16_t, *pVal); break;
+    case TSDB_DATA_TYPE_INT:       AGG_KERNEL_FIND_INDEX(int32_t, *pVal); break;
+    case TSDB_DATA_TYPE_BIGINT:    AGG_KERNEL_FIND_INDEX(int64_t, *pVal); break;
+    case TSDB_DATA_TYPE_UTINYINT:  AGG_KERNEL_FIND_INDEX(uint8_t, *(uint64_t *)pVal); break;
+    case TSDB_DATA_TYPE_USMALLINT: AGG_KERNEL_FIND_INDEX(uint16_t, *(uint64_t *)pVal); break;
+    case TSDB_DATA_TYPE_UINT:      AGG_KERNEL_FIND_INDEX(uint32_t, *(uint64_t *)pVal); break;
+    case TSDB_DATA_TYPE_UBIGINT:   AGG_KERNEL_FIND_INDEX(uint64_t, *(uint64_t *)pVal); break;
+    case TSDB_DATA_TYPE_FLOAT:     AGG_KERNEL_FIND_INDEX(float, GET_DOUBLE_VAL(pVal)); break;
+    case TSDB_DATA_TYPE_DOUBLE:    AGG_KERNEL_FIND_INDEX(double, GET_DOUBLE_VAL(pVal)); break;
+    default: break;
+  }
+
+  assert(0);
+  return 0;
+}
+
+#define AGG_KERNEL_UPDATE(_type, _v)             \
+  do {                                         \
+    _type *o = (_type *)pOutput;               \
+    _type  n = (_type)(_v);                    \
+    if ((*o < n) ^ isMin) {                    \
+      *o = n;                                  \
+      updated = true;                          \
+    }                                          \
+  } while (0)
+
+// merge min/max of the kernel result into the output, and update the tags queried with it
+static void aggKernelUpdateMinMax(SQLFunctionCtx *pCtx, char *pOutput, int32_t isMin, SColumnAggRes *pRes) {
+  int64_t *pVal = isMin ? &pRes->min : &pRes->max;
+  bool     updated = false;
+
+  switch (pCtx->inputType) {
+    case TSDB_DATA_TYPE_TINYINT:   AGG_KERNEL_UPDATE(int8_t, *pVal); break;
+    case TSDB_DATA_TYPE_SMALLINT:  AGG_KERNEL_UPDATE(int16_t, *pVal); break;
+    case TSDB_DATA_TYPE_INT:       AGG_KERNEL_UPDATE(int32_t, *pVal); break;
+    case TSDB_DATA_TYPE_BIGINT:    AGG_KERNEL_UPDATE(int64_t, *pVal); break;
+    case TSDB_DATA_TYPE_UTINYINT:  AGG_KERNEL_UPDATE(uint8_t, *(uint64_t *)pVal); break;
+    case TSDB_DATA_TYPE_USMALLINT: AGG_KERNEL_UPDATE(uint16_t, *(uint64_t *)pVal); break;
+    case TSDB_DATA_TYPE_UINT:      AGG_KERNEL_UPDATE(uint32_t, *(uint64_t *)pVal); break;
+    case TSDB_DATA_TYPE_UBIGINT:   AGG_KERNEL_UPDATE(uint64_t, *(uint64_t *)pVal); break;
+    case TSDB_DATA_TYPE_FLOAT:     AGG_KERNEL_UPDATE(float, GET_DOUBLE_VAL(pVal)); break;
+    case TSDB_DATA_TYPE_DOUBLE:    AGG_KERNEL_UPDATE(double, GET_DOUBLE_VAL(pVal)); break;
+    default: break;
+  }
+
+  if (updated && pCtx->tagInfo.numOfTagCols > 0) {
+    TSKEY key = (pCtx->ptsList != NULL) ? pCtx->ptsList[aggKernelFindIndex(pCtx, pVal, isMin)] : 0;
+    DO_UPDATE_TAG_COLUMNS(pCtx, key);
+  }
+}
+
 /*
  * count function does need the finalize, if data is missing, the default value, which is 0, is used
  * count function does not use the pCtx->interResBuf to keep the intermediate buffer
@@ -911,7 +1178,10 @@ static void count_function(SQLFunctionCtx *pCtx) {
   if (pCtx->preAggVals.isSet) {
     numOfElem = pCtx->size - pCtx->preAggVals.statis.numOfNull;
   } else {
-    if (pCtx->hasNull) {
+    SColumnAggRes *pRes = NULL;
+    if (pCtx->hasNull && (pRes = getColumnAggRes(pCtx)) != NULL) {
+      numOfElem = pRes->numOfElem;
+    } else if (pCtx->hasNull) {
       for (int32_t i = 0; i < pCtx->size; ++i) {
         char *val = GET_INPUT_DATA(pCtx, i);
         if (isNull(val, pCtx->inputType)) {
@@ -1033,7 +1303,8 @@ int32_t noDataRequired(SQLFunctionCtx *pCtx, STimeWindow* w, int32_t colId) {
   } while (0)
 
 static void do_sum(SQLFunctionCtx *pCtx) {
-  int32_t notNullElems = 0;
+  int32_t        notNullElems = 0;
+  SColumnAggRes *pRes = NULL;
 
   // Only the pre-computing information loaded and actual data does not loaded
   if (pCtx->preAggVals.isSet) {
@@ -1050,6 +1321,17 @@ static void do_sum(SQLFunctionCtx *pCtx) {
       double *retVal = (double*) pCtx->pOutput;
       SET_DOUBLE_VAL(retVal, *retVal + GET_DOUBLE_VAL((const char*)&(pCtx->preAggVals.statis.sum)));
     }
+  } else if ((pRes = getColumnAggRes(pCtx)) != NULL) {
+    notNullElems = pRes->numOfElem;
+
+    if (IS_SIGNED_NUMERIC_TYPE(pCtx->inputType)) {
+      *(int64_t *)pCtx->pOutput += pRes->sum;
+    } else if (IS_UNSIGNED_NUMERIC_TYPE(pCtx->inputType)) {
+      *(uint64_t *)pCtx->pOutput += (uint64_t)pRes->sum;
+    } else {
+      double *retVal = (double *)pCtx->pOutput;
+      SET_DOUBLE_VAL(retVal, *retVal + GET_DOUBLE_VAL((const char *)&pRes->sum));
+    }
   } else {  // computing based on the true data block
     void *pData = GET_INPUT_DATA_LIST(pCtx);
     notNullElems = 0;
@@ -1245,6 +1527,8 @@ static void avg_function(SQLFunctionCtx *pCtx) {
   SAvgInfo *pAvgInfo = (SAvgInfo *)GET_ROWCELL_INTERBUF(pResInfo);
   double   *pVal = &pAvgInfo->sum;
 
+  SColumnAggRes *pRes = NULL;
+
   if (pCtx->preAggVals.isSet) { // Pre-aggregation
     notNullElems = pCtx->size - pCtx->preAggVals.statis.numOfNull;
     assert(notNullElems >= 0);
@@ -1256,6 +1540,16 @@ static void avg_function(SQLFunctionCtx *pCtx) {
     } else if (pCtx->inputType == TSDB_DATA_TYPE_DOUBLE || pCtx->inputType == TSDB_DATA_TYPE_FLOAT) {
       *pVal += GET_DOUBLE_VAL((const char *)&(pCtx->preAggVals.statis.sum));
     }
+  } else if ((pRes = getColumnAggRes(pCtx)) != NULL) {
+    notNullElems = pRes->numOfElem;
+
+    if (IS_SIGNED_NUMERIC_TYPE(pCtx->inputType)) {
+      *pVal += pRes->sum;
+    } else if (IS_UNSIGNED_NUMERIC_TYPE(pCtx->inputType)) {
+      *pVal += (uint64_t)pRes->sum;
+    } else {
+      *pVal += GET_DOUBLE_VAL((const char *)&pRes->sum);
+    }
   } else {
     void *pData = GET_INPUT_DATA_LIST(pCtx);
 
@@ -1452,6 +1746,16 @@ static void minMax_function(SQLFunctionCtx *pCtx, char *pOutput, int32_t isMin,
     return;
   }
 
+  SColumnAggRes *pRes = getColumnAggRes(pCtx);
+  if (pRes != NULL) {
+    *notNullElems = pRes->numOfElem;
+    if (*notNullElems > 0) {
+      aggKernelUpdateMinMax(pCtx, pOutput, isMin, pRes);
+    }
+
+    return;
+  }
+
   void  *p = GET_INPUT_DATA_LIST(pCtx);
   TSKEY *tsList = GET_TS_LIST(pCtx);
 
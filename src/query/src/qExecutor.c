@@ -47,6 +47,11 @@
 
 #define MULTI_KEY_DELIM  "-"
 
+#define ORDER_MIN_CAPACITY       4096
+#define ORDER_SPILL_PAGES        4  // pages of a sorted run buffered before they are written to disk
+#define ORDER_PAGE_SIZE          (64 * 1024)
+#define ORDER_MIN_ROWS_PER_PAGE  16
+
 enum {
   TS_JOIN_TS_EQUAL       = 0,
   TS_JOIN_TS_NOT_EQUALS  = 1,
@@ -1597,10 +1602,6 @@ static bool initGroupbyInfo(const SSDataBlock *pSDataBlock, const SGroupbyExpr *
     for (int32_t i = 0; i < pSDataBlock->info.numOfCols; ++i) {
       SColumnInfoData* pColInfo = taosArrayGet(pSDataBlock->pDataBlock, i);
       if (pColInfo->info.colId == pColIndex->colId) {
-        int32_t type = pColInfo->info.type;
-        if (type == TSDB_DATA_TYPE_FLOAT || type == TSDB_DATA_TYPE_DOUBLE) {
-          return false;
-        }
         pInfo->totalBytes += pColInfo->info.bytes;
 
         SGroupbyDataInfo info =  {.index = i, .type = pColInfo->info.type, .bytes = pColInfo->info.bytes};
@@ -1615,21 +1616,24 @@ static bool initGroupbyInfo(const SSDataBlock *pSDataBlock, const SGroupbyExpr *
   }
   pInfo->totalBytes += (int32_t)strlen(MULTI_KEY_DELIM) * pGroupbyExpr->numOfGroupCols;
 
+  // the key buffers are reused for all rows of all data blocks
+  pInfo->prevData = malloc(pInfo->totalBytes);
+  pInfo->keyBuf = malloc(pInfo->totalBytes);
+  if (pInfo->prevData == NULL || pInfo->keyBuf == NULL) {
+    return false;
+  }
+
   return true;
 }
 
-static void buildGroupbyKeyBuf(const SSDataBlock *pSDataBlock, SGroupbyOperatorInfo *pInfo, int32_t rowId, char **buf) {
-  char *p = calloc(1, pInfo->totalBytes);
-  if (p == NULL) {
-    *buf = NULL;
-    return;
-  }
-  *buf  = p;
+static void buildGroupbyKeyBuf(const SSDataBlock *pSDataBlock, SGroupbyOperatorInfo *pInfo, int32_t rowId, char *buf) {
+  char *p = buf;
+  memset(buf, 0, pInfo->totalBytes);
+
   for (int32_t i = 0; i < taosArrayGetSize(pInfo->pGroupbyDataInfo); i++) {
     SGroupbyDataInfo *pDataInfo = taosArrayGet(pInfo->pGroupbyDataInfo, i);
 
     SColumnInfoData* pColData = taosArrayGet(pSDataBlock->pDataBlock, pDataInfo->index);
-    //TODO(yihaoDeng): handle float & double
     char *val = ((char *)pColData->pData) + pDataInfo->bytes * rowId;
     if (isNull(val, pDataInfo->type)) {
       p += pDataInfo->bytes;
@@ -1638,6 +1642,17 @@ static void buildGroupbyKeyBuf(const SSDataBlock *pSDataBlock, SGroupbyOperatorI
     if (IS_VAR_DATA_TYPE(pDataInfo->type)) {
       memcpy(p, varDataVal(val), varDataLen(val));
       p +=  varDataLen(val);
+    } else if (pDataInfo->type == TSDB_DATA_TYPE_FLOAT) {
+      // the key is compared bitwise, so -0.0 and 0.0 as well as all the NaNs must fall into the same group
+      float v = GET_FLOAT_VAL(val);
+      v = (v == 0) ? 0 : (isnan(v) ? NAN : v);
+      SET_FLOAT_VAL(p, v);
+      p += pDataInfo->bytes;
+    } else if (pDataInfo->type == TSDB_DATA_TYPE_DOUBLE) {
+      double v = GET_DOUBLE_VAL(val);
+      v = (v == 0) ? 0 : (isnan(v) ? NAN : v);
+      SET_DOUBLE_VAL(p, v);
+      p += pDataInfo->bytes;
     } else {
       memcpy(p, val, pDataInfo->bytes);
       p += pDataInfo->bytes;
@@ -1648,24 +1663,9 @@ static void buildGroupbyKeyBuf(const SSDataBlock *pSDataBlock, SGroupbyOperatorI
   }
 }
 
-static bool isGroupbyKeyEqual(void *a, void *b, void *ext) {
-  SGroupbyOperatorInfo *pInfo = (SGroupbyOperatorInfo *)ext;
-  if (memcmp(a, b, pInfo->totalBytes) == 0) {
-    return true;
-  }
-  int32_t offset = 0;
-  for (int32_t i = 0; i < taosArrayGetSize(pInfo->pGroupbyDataInfo); i++) {
-    SGroupbyDataInfo *pDataInfo = taosArrayGet(pInfo->pGroupbyDataInfo, i);
-
-    char *k1 = (char *)a + offset;
-    char *k2 = (char *)b + offset;
-    if (getComparFunc(pDataInfo->type, 0)(k1, k2) != 0) {
-       return false;
-    }
-    offset += pDataInfo->bytes;
-    offset += (int32_t)strlen(MULTI_KEY_DELIM);
-  }
-  return true;
+static FORCE_INLINE bool isGroupbyKeyEqual(void *a, void *b, SGroupbyOperatorInfo *pInfo) {
+  // keys are built into zeroed buffers, the same bytes are used as the key of the result row hash table
+  return memcmp(a, b, pInfo->totalBytes) == 0;
 }
 
 static void doHashGroupbyAgg(SOperatorInfo* pOperator, SGroupbyOperatorInfo *pInfo, SSDataBlock *pSDataBlock) {
@@ -1675,8 +1675,8 @@ static void doHashGroupbyAgg(SOperatorInfo* pOperator, SGroupbyOperatorInfo *pIn
   SQueryAttr* pQueryAttr = pRuntimeEnv->pQueryAttr;
 
   if (!initGroupbyInfo(pSDataBlock, pRuntimeEnv->pQueryAttr->pGroupbyExpr, pInfo)) {
-    qError("QInfo:0x%"PRIx64" group by not supported on double/float columns, abort", GET_QID(pRuntimeEnv));
-    return;
+    qError("QInfo:0x%"PRIx64" failed to init group by columns, abort", GET_QID(pRuntimeEnv));
+    longjmp(pRuntimeEnv->env, TSDB_CODE_QRY_APP_ERROR);
   }
   //realloc pRuntimeEnv->keyBuf
   pRuntimeEnv->keyBuf = realloc(pRuntimeEnv->keyBuf, pInfo->totalBytes + sizeof(int64_t) + POINTER_BYTES);
@@ -1686,21 +1686,20 @@ static void doHashGroupbyAgg(SOperatorInfo* pOperator, SGroupbyOperatorInfo *pIn
 
   STimeWindow w = TSWINDOW_INITIALIZER;
 
-  char *key = NULL;
-  int16_t num = 0;
+  int32_t num = 0;
   int32_t type = 0;
+
+  // rows with the same key are aggregated as one run, the result row of each run is found in the result row hash
+  // table, so the input does not need to be sorted by the group by columns
   for (int32_t j = 0; j < pSDataBlock->info.rows; ++j) {
-    buildGroupbyKeyBuf(pSDataBlock, pInfo, j, &key);
-    if (!key)  { continue; }
+    buildGroupbyKeyBuf(pSDataBlock, pInfo, j, pInfo->keyBuf);
 
-    if (pInfo->prevData == NULL) {
-      // first row of
-      pInfo->prevData = key;
+    if (num == 0) {
+      SWAP(pInfo->prevData, pInfo->keyBuf, char*);
       num++;
       continue;
-    } else if (isGroupbyKeyEqual(pInfo->prevData, key, pInfo)) {
+    } else if (isGroupbyKeyEqual(pInfo->prevData, pInfo->keyBuf, pInfo)) {
       num++;
-      tfree(key);
       continue;
     }
 
@@ -1716,28 +1715,19 @@ static void doHashGroupbyAgg(SOperatorInfo* pOperator, SGroupbyOperatorInfo *pIn
     doApplyFunctions(pRuntimeEnv, pInfo->binfo.pCtx, &w, j - num, num, tsList, pSDataBlock->info.rows, pOperator->numOfOutput);
 
     num = 1;
-
-    tfree(pInfo->prevData);
-    pInfo->prevData = key;
+    SWAP(pInfo->prevData, pInfo->keyBuf, char*);
   }
 
   if (num > 0) {
-    buildGroupbyKeyBuf(pSDataBlock, pInfo, pSDataBlock->info.rows - num, &key);
-    if (key) {
-      tfree(pInfo->prevData);
-      pInfo->prevData = key;
-      if (pQueryAttr->stableQuery && pQueryAttr->stabledev && (pRuntimeEnv->prevResult != NULL)) {
-        setParamForStableStddevByColData(pRuntimeEnv, pInfo->binfo.pCtx, pOperator->numOfOutput, pOperator->pExpr, pInfo);
-      }
-      int32_t ret = setGroupResultOutputBuf(pRuntimeEnv, &(pInfo->binfo), pOperator->numOfOutput, pInfo->prevData, type, pInfo->totalBytes, item->groupIndex);
-      if (ret != TSDB_CODE_SUCCESS) {  // null data, too many state code
-        longjmp(pRuntimeEnv->env, TSDB_CODE_QRY_APP_ERROR);
-      }
-      doApplyFunctions(pRuntimeEnv, pInfo->binfo.pCtx, &w, pSDataBlock->info.rows - num, num, tsList, pSDataBlock->info.rows, pOperator->numOfOutput);
+    if (pQueryAttr->stableQuery && pQueryAttr->stabledev && (pRuntimeEnv->prevResult != NULL)) {
+      setParamForStableStddevByColData(pRuntimeEnv, pInfo->binfo.pCtx, pOperator->numOfOutput, pOperator->pExpr, pInfo);
+    }
+    int32_t ret = setGroupResultOutputBuf(pRuntimeEnv, &(pInfo->binfo), pOperator->numOfOutput, pInfo->prevData, type, pInfo->totalBytes, item->groupIndex);
+    if (ret != TSDB_CODE_SUCCESS) {  // null data, too many state code
+      longjmp(pRuntimeEnv->env, TSDB_CODE_QRY_APP_ERROR);
     }
+    doApplyFunctions(pRuntimeEnv, pInfo->binfo.pCtx, &w, pSDataBlock->info.rows - num, num, tsList, pSDataBlock->info.rows, pOperator->numOfOutput);
   }
-
-  tfree(pInfo->prevData);
 }
 
 static void doSessionWindowAggImpl(SOperatorInfo* pOperator, SSWindowOperatorInfo *pInfo, SSDataBlock *pSDataBlock) {
@@ -1914,6 +1904,7 @@ void setBlockStatisInfo(SQLFunctionCtx *pCtx, SSDataBlock* pSDataBlock, SColInde
   }
 
   pCtx->hasNull = hasNull(pColIndex, pStatis);
+  pCtx->colAgg.pInput = NULL;
 
   // set the statistics data for primary time stamp column
   if ((pCtx->functionId == TSDB_FUNC_SPREAD || pCtx->functionId == TSDB_FUNC_ELAPSED) && pColIndex->colId == PRIMARYKEY_TIMESTAMP_COL_INDEX) {
@@ -1968,6 +1959,29 @@ static int32_t setCtxTagColumnInfo(SQLFunctionCtx *pCtx, int32_t numOfOutput) {
   return TSDB_CODE_SUCCESS;
 }
 
+// functions of count/sum/avg/min/max on the same normal column share the result of one aggregate kernel sweep
+static void setCtxColumnAggInfo(SQLFunctionCtx *pCtx, SExprInfo* pExpr, int32_t numOfOutput) {
+  for (int32_t i = 0; i < numOfOutput; ++i) {
+    SColIndex *pIndex = &pExpr[i].base.colInfo;
+
+    int8_t required = getAggKernelRequired(pCtx[i].functionId, pCtx[i].inputType);
+    if (required == 0 || !TSDB_COL_IS_NORMAL_COL(pIndex->flag) || TSDB_COL_IS_TSWIN_COL(pIndex->colId)) {
+      continue;
+    }
+
+    pCtx[i].pColAgg = &pCtx[i].colAgg;
+    for (int32_t j = 0; j < i; ++j) {
+      SColIndex *pPrev = &pExpr[j].base.colInfo;
+      if (pCtx[j].pColAgg != NULL && pPrev->colIndex == pIndex->colIndex && pPrev->colId == pIndex->colId) {
+        pCtx[i].pColAgg = pCtx[j].pColAgg;
+        break;
+      }
+    }
+
+    pCtx[i].pColAgg->required |= required;
+  }
+}
+
 static SQLFunctionCtx* createSQLFunctionCtx(SQueryRuntimeEnv* pRuntimeEnv, SExprInfo* pExpr, int32_t numOfOutput,
                                             int32_t** rowCellInfoOffset, int32_t numOfRows) {
   SQueryAttr* pQueryAttr = pRuntimeEnv->pQueryAttr;
@@ -2079,6 +2093,7 @@ static SQLFunctionCtx* createSQLFunctionCtx(SQueryRuntimeEnv* pRuntimeEnv, SExpr
   }
 
   setCtxTagColumnInfo(pFuncCtx, numOfOutput);
+  setCtxColumnAggInfo(pFuncCtx, pExpr, numOfOutput);
 
   return pFuncCtx;
 }
@@ -2122,7 +2137,8 @@ static int32_t setupQueryRuntimeEnv(SQueryRuntimeEnv *pRuntimeEnv, int32_t numOf
       pQueryAttr->limit.offset == 0 && // if have offset, ignore limit optimization 
       pQueryAttr->stableQuery &&
       isProjQuery(pQueryAttr) &&
-      pQueryAttr->order.orderColId != -1 ) {
+      pQueryAttr->order.orderColId != -1 &&
+      pQueryAttr->order.orderColId <= PRIMARYKEY_TIMESTAMP_COL_INDEX) {  // not for the order by a normal column
         // can be optimizate limit 
         pRuntimeEnv->pTablesRead = taosHashInit(numOfTables, taosGetDefaultHashFunction(TSDB_DATA_TYPE_INT), true, HASH_NO_LOCK);
         if (pRuntimeEnv->pTablesRead) // must malloc ok, set callback to tsdb
@@ -2132,6 +2148,11 @@ static int32_t setupQueryRuntimeEnv(SQueryRuntimeEnv *pRuntimeEnv, int32_t numOf
   }
   pRuntimeEnv->cntTableReadOver= 0;
 
+  // skip the tables in a file set whose column ranges can not match the filter
+  if (pRuntimeEnv->pQueryHandle && pQueryAttr->pFilters) {
+    tsdbAddFilterCallback(pRuntimeEnv->pQueryHandle, qFilterStatisCB, pRuntimeEnv);
+  }
+
   // NOTE: pTableCheckInfo need to update the query time range and the lastKey info
   pRuntimeEnv->pTableRetrieveTsMap = taosHashInit(numOfTables, taosGetDefaultHashFunction(TSDB_DATA_TYPE_INT), false, HASH_NO_LOCK);
 
@@ -5880,6 +5901,259 @@ static int32_t doMergeSDatablock(SSDataBlock* pDest, SSDataBlock* pSrc) {
   return TSDB_CODE_SUCCESS;
 }
 
+static void doSortDataBlock(SOrderOperatorInfo* pInfo) {
+  SSDataBlock* pBlock = pInfo->pDataBlock;
+  if (pBlock->info.rows == 0) {
+    return;
+  }
+
+  int32_t numOfCols = pBlock->info.numOfCols;
+  void** pCols     = calloc(numOfCols, POINTER_BYTES);
+  SSchema* pSchema = calloc(numOfCols, sizeof(SSchema));
+
+  for(int32_t i = 0; i < numOfCols; ++i) {
+    SColumnInfoData* p1 = taosArrayGet(pBlock->pDataBlock, i);
+    pCols[i] = p1->pData;
+    pSchema[i].colId = p1->info.colId;
+    pSchema[i].bytes = p1->info.bytes;
+    pSchema[i].type  = (uint8_t) p1->info.type;
+  }
+
+  taoscQSort(pCols, pSchema, numOfCols, pBlock->info.rows, pInfo->colIndex, pInfo->comp);
+
+  tfree(pCols);
+  tfree(pSchema);
+}
+
+static int32_t createOrderExtBuffer(SOrderOperatorInfo* pInfo) {
+  SSDataBlock* pBlock = pInfo->pDataBlock;
+  int32_t numOfCols = pBlock->info.numOfCols;
+
+  SSchema1* pSchema = calloc(numOfCols, sizeof(SSchema1));
+  if (pSchema == NULL) {
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+
+  int32_t rowSize = 0;
+  for(int32_t i = 0; i < numOfCols; ++i) {
+    SColumnInfoData* p1 = taosArrayGet(pBlock->pDataBlock, i);
+    pSchema[i].colId = p1->info.colId;
+    pSchema[i].bytes = p1->info.bytes;
+    pSchema[i].type  = (uint8_t) p1->info.type;
+    rowSize += p1->info.bytes;
+  }
+
+  pInfo->pModel = createColumnModel(pSchema, numOfCols, pInfo->capacity);
+  tfree(pSchema);
+  if (pInfo->pModel == NULL) {
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+
+  // at least ORDER_MIN_ROWS_PER_PAGE rows in one page of the sorted runs
+  int32_t pageSize = ORDER_PAGE_SIZE;
+  while ((pageSize - (int32_t)sizeof(tFilePage)) / rowSize < ORDER_MIN_ROWS_PER_PAGE) {
+    pageSize <<= 1;
+  }
+
+  // the run is already held by the data block, so only a few pages of it are buffered while it is written out
+  pInfo->pExtBuf = createExtMemBuffer(ORDER_SPILL_PAGES * pageSize, rowSize, pageSize, pInfo->pModel);
+  if (pInfo->pExtBuf == NULL) {
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+
+  pInfo->pExtBuf->flushModel = MULTIPLE_APPEND_MODEL;
+  return TSDB_CODE_SUCCESS;
+}
+
+// sort the rows kept in memory and flush them to disk as a new sorted run
+static int32_t doSpillSortedRun(SOrderOperatorInfo* pInfo) {
+  SSDataBlock* pBlock = pInfo->pDataBlock;
+  if (pBlock->info.rows == 0) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  if (pInfo->pExtBuf == NULL) {
+    int32_t code = createOrderExtBuffer(pInfo);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+  }
+
+  doSortDataBlock(pInfo);
+
+  tExtMemBuffer* pExtBuf = pInfo->pExtBuf;
+  SColumnModel*  pModel = pExtBuf->pColumnModel;
+  int32_t        firstFlush = (int32_t) pExtBuf->fileMeta.flushoutData.nLength;
+
+  int32_t pageRows = pExtBuf->numOfElemsPerPage;
+  char* buf = malloc((size_t)pageRows * pExtBuf->nElemSize);
+  if (buf == NULL) {
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+
+  // data in the column model is stored column by column, with the number of rows as the column capacity
+  for(int32_t start = 0; start < pBlock->info.rows; start += pageRows) {
+    int32_t num = MIN(pageRows, pBlock->info.rows - start);
+
+    for(int32_t i = 0; i < pBlock->info.numOfCols; ++i) {
+      SColumnInfoData* p1 = taosArrayGet(pBlock->pDataBlock, i);
+      memcpy(buf + pModel->pFields[i].offset * num, p1->pData + start * p1->info.bytes, num * p1->info.bytes);
+    }
+
+    if (tExtMemBufferPut(pExtBuf, buf, num) < 0) {
+      tfree(buf);
+      return TSDB_CODE_QRY_OUT_OF_MEMORY;
+    }
+  }
+
+  tfree(buf);
+  pBlock->info.rows = 0;
+
+  int32_t code = tExtMemBufferFlush(pExtBuf);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  // the pages written out while the run was put into the buffer are one sorted run
+  tExtMemBufferMergeFlushoutInfo(pExtBuf, firstFlush);
+  return TSDB_CODE_SUCCESS;
+}
+
+static FORCE_INLINE char* getOrderSourceVal(SOrderOperatorInfo* pInfo, SOrderSource* pSource) {
+  SColumnModel* pModel = pInfo->pExtBuf->pColumnModel;
+  SSchemaEx*    pField = &pModel->pFields[pInfo->colIndex];
+  return pSource->filePage.data + pField->offset * pModel->capacity + pSource->rowIdx * pField->field.bytes;
+}
+
+static int32_t orderSourceComparator(const void* pLeft, const void* pRight, void* param) {
+  SOrderOperatorInfo* pInfo = (SOrderOperatorInfo*) param;
+
+  SOrderSource* pLeftSource  = pInfo->pSource[*(int32_t*) pLeft];
+  SOrderSource* pRightSource = pInfo->pSource[*(int32_t*) pRight];
+
+  // this run is exhausted
+  if (pLeftSource->rowIdx == -1) {
+    return 1;
+  }
+
+  if (pRightSource->rowIdx == -1) {
+    return -1;
+  }
+
+  return pInfo->comp(getOrderSourceVal(pInfo, pLeftSource), getOrderSourceVal(pInfo, pRightSource));
+}
+
+static int32_t loadOrderSourcePage(SOrderOperatorInfo* pInfo, SOrderSource* pSource) {
+  tFlushoutInfo* pFlushoutInfo = &pInfo->pExtBuf->fileMeta.flushoutData.pFlushoutInfo[pSource->flushoutIdx];
+
+  while (pSource->pageId < (int32_t) pFlushoutInfo->numOfPages) {
+    if (!tExtMemBufferLoadData(pInfo->pExtBuf, &pSource->filePage, pSource->flushoutIdx, pSource->pageId)) {
+      return TSDB_CODE_QRY_SYS_ERROR;
+    }
+
+    if (pSource->filePage.num > 0) {
+      pSource->rowIdx = 0;
+      return TSDB_CODE_SUCCESS;
+    }
+
+    pSource->pageId += 1;
+  }
+
+  pSource->rowIdx = -1;
+  pInfo->numOfCompleted += 1;
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t prepareMergeSortedRuns(SOrderOperatorInfo* pInfo) {
+  tExtMemBuffer* pExtBuf = pInfo->pExtBuf;
+
+  pInfo->numOfSource = pExtBuf->fileMeta.flushoutData.nLength;
+  pInfo->pSource = calloc(pInfo->numOfSource, POINTER_BYTES);
+  if (pInfo->pSource == NULL) {
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+
+  for(int32_t i = 0; i < pInfo->numOfSource; ++i) {
+    SOrderSource* pSource = calloc(1, sizeof(SOrderSource) + pExtBuf->pageSize);
+    if (pSource == NULL) {
+      return TSDB_CODE_QRY_OUT_OF_MEMORY;
+    }
+
+    pInfo->pSource[i] = pSource;
+    pSource->flushoutIdx = i;
+
+    int32_t code = loadOrderSourcePage(pInfo, pSource);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+  }
+
+  int32_t code = tLoserTreeCreate(&pInfo->pTree, pInfo->numOfSource, pInfo, orderSourceComparator);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  // the rows of the output block are produced by the multiway merge from now on
+  SSDataBlock* pBlock = pInfo->pDataBlock;
+  for(int32_t i = 0; i < pBlock->info.numOfCols; ++i) {
+    SColumnInfoData* p1 = taosArrayGet(pBlock->pDataBlock, i);
+
+    char* tmp = realloc(p1->pData, (size_t)pInfo->capacity * p1->info.bytes);
+    if (tmp == NULL) {
+      return TSDB_CODE_QRY_OUT_OF_MEMORY;
+    }
+
+    p1->pData = tmp;
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+static SSDataBlock* doMergeSortedRuns(SOperatorInfo* pOperator) {
+  SOrderOperatorInfo* pInfo = pOperator->info;
+  SQueryRuntimeEnv*   pRuntimeEnv = pOperator->pRuntimeEnv;
+
+  SSDataBlock*  pBlock = pInfo->pDataBlock;
+  SColumnModel* pModel = pInfo->pExtBuf->pColumnModel;
+
+  pBlock->info.rows = 0;
+  while (pInfo->numOfCompleted < pInfo->numOfSource && pBlock->info.rows < pInfo->capacity) {
+    if (pInfo->topN > 0 && pInfo->numOfOutput >= pInfo->topN) {
+      break;
+    }
+
+    int32_t       idx = pInfo->pTree->pNode[0].index;
+    SOrderSource* pSource = pInfo->pSource[idx];
+
+    for(int32_t i = 0; i < pBlock->info.numOfCols; ++i) {
+      SColumnInfoData* p1 = taosArrayGet(pBlock->pDataBlock, i);
+      char* src = pSource->filePage.data + pModel->pFields[i].offset * pModel->capacity + pSource->rowIdx * p1->info.bytes;
+      memcpy(p1->pData + pBlock->info.rows * p1->info.bytes, src, p1->info.bytes);
+    }
+
+    pBlock->info.rows += 1;
+    pInfo->numOfOutput += 1;
+
+    pSource->rowIdx += 1;
+    if (pSource->rowIdx >= (int32_t) pSource->filePage.num) {
+      pSource->pageId += 1;
+
+      int32_t code = loadOrderSourcePage(pInfo, pSource);
+      if (code != TSDB_CODE_SUCCESS) {
+        longjmp(pRuntimeEnv->env, code);
+      }
+    }
+
+    tLoserTreeAdjust(pInfo->pTree, idx + pInfo->pTree->numOfEntries);
+  }
+
+  if (pInfo->numOfCompleted >= pInfo->numOfSource || (pInfo->topN > 0 && pInfo->numOfOutput >= pInfo->topN)) {
+    doSetOperatorCompleted(pOperator);
+  }
+
+  return (pBlock->info.rows > 0)? pBlock:NULL;
+}
+
 static SSDataBlock* doSort(void* param, bool* newgroup) {
   SOperatorInfo* pOperator = (SOperatorInfo*) param;
   if (pOperator->status == OP_EXEC_DONE) {
@@ -5887,6 +6161,16 @@ static SSDataBlock* doSort(void* param, bool* newgroup) {
   }
 
   SOrderOperatorInfo* pInfo = pOperator->info;
+  SQueryRuntimeEnv*   pRuntimeEnv = pOperator->pRuntimeEnv;
+
+  // sorted runs have been spilled to disk, continue the multiway merge
+  if (pInfo->pTree != NULL) {
+    return doMergeSortedRuns(pOperator);
+  }
+
+  // only the first topN rows are required, so keep at most topN rows in memory
+  bool    truncate = (pInfo->topN > 0 && pInfo->topN <= pInfo->capacity / 2);
+  int64_t threshold = truncate? MAX(pInfo->topN * 2, ORDER_MIN_CAPACITY) : pInfo->capacity;
 
   SSDataBlock* pBlock = NULL;
   while(1) {
@@ -5894,38 +6178,53 @@ static SSDataBlock* doSort(void* param, bool* newgroup) {
     pBlock = pOperator->upstream[0]->exec(pOperator->upstream[0], newgroup);
     publishOperatorProfEvent(pOperator->upstream[0], QUERY_PROF_AFTER_OPERATOR_EXEC);
 
-    // start to flush data into disk and try do multiway merge sort
     if (pBlock == NULL) {
-      doSetOperatorCompleted(pOperator);
       break;
     }
 
     int32_t code = doMergeSDatablock(pInfo->pDataBlock, pBlock);
     if (code != TSDB_CODE_SUCCESS) {
-      // todo handle error
+      longjmp(pRuntimeEnv->env, code);
+    }
+
+    if (pInfo->pDataBlock->info.rows >= threshold) {
+      if (truncate) {
+        doSortDataBlock(pInfo);
+        pInfo->pDataBlock->info.rows = (int32_t) pInfo->topN;
+      } else {
+        code = doSpillSortedRun(pInfo);
+        if (code != TSDB_CODE_SUCCESS) {
+          longjmp(pRuntimeEnv->env, code);
+        }
+      }
     }
   }
 
-  int32_t numOfCols = pInfo->pDataBlock->info.numOfCols;
-  void** pCols     = calloc(numOfCols, POINTER_BYTES);
-  SSchema* pSchema = calloc(numOfCols, sizeof(SSchema));
+  // all data are in memory
+  if (pInfo->pExtBuf == NULL) {
+    doSetOperatorCompleted(pOperator);
 
-  for(int32_t i = 0; i < numOfCols; ++i) {
-    SColumnInfoData* p1 = taosArrayGet(pInfo->pDataBlock->pDataBlock, i);
-    pCols[i] = p1->pData;
-    pSchema[i].colId = p1->info.colId;
-    pSchema[i].bytes = p1->info.bytes;
-    pSchema[i].type  = (uint8_t) p1->info.type;
+    doSortDataBlock(pInfo);
+    if (pInfo->topN > 0 && pInfo->pDataBlock->info.rows > pInfo->topN) {
+      pInfo->pDataBlock->info.rows = (int32_t) pInfo->topN;
+    }
+
+    return (pInfo->pDataBlock->info.rows > 0)? pInfo->pDataBlock:NULL;
   }
 
-  __compar_fn_t  comp = getKeyComparFunc(pSchema[pInfo->colIndex].type, pInfo->order);
-  if (pInfo->pDataBlock->info.rows) {
-    taoscQSort(pCols, pSchema, numOfCols, pInfo->pDataBlock->info.rows, pInfo->colIndex, comp);
+  // flush the last run and do multiway merge sort on the sorted runs in disk
+  int32_t code = doSpillSortedRun(pInfo);
+  if (code == TSDB_CODE_SUCCESS) {
+    code = prepareMergeSortedRuns(pInfo);
   }
 
-  tfree(pCols);
-  tfree(pSchema);
-  return (pInfo->pDataBlock->info.rows > 0)? pInfo->pDataBlock:NULL;
+  if (code != TSDB_CODE_SUCCESS) {
+    longjmp(pRuntimeEnv->env, code);
+  }
+
+  qDebug("QInfo:0x%"PRIx64" %d sorted runs spilled to disk, start multiway merge sort", GET_QID(pRuntimeEnv),
+         pInfo->numOfSource);
+  return doMergeSortedRuns(pOperator);
 }
 
 SOperatorInfo *createOrderOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperatorInfo* upstream, SExprInfo* pExpr, int32_t numOfOutput, SOrderVal* pOrderVal) {
@@ -5960,6 +6259,24 @@ SOperatorInfo *createOrderOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperatorI
       pDataBlock->info.numOfCols = numOfOutput;
       pInfo->order = pOrderVal->order;
       pInfo->pDataBlock = pDataBlock;
+
+      SColumnInfoData* pCol = taosArrayGet(pDataBlock->pDataBlock, pInfo->colIndex);
+      pInfo->comp = getKeyComparFunc(pCol->info.type, pInfo->order);
+  }
+
+  {
+      int32_t rowSize = 0;
+      for (int32_t i = 0; i < numOfOutput; ++i) {
+        rowSize += pExpr[i].base.resBytes;
+      }
+
+      int64_t capacity = MAX(((int64_t)tsOrderMemBufferSize << 20) / rowSize, ORDER_MIN_CAPACITY);
+      pInfo->capacity = (int32_t) MIN(capacity, INT32_MAX);
+
+      SLimitVal* pLimit = &pRuntimeEnv->pQueryAttr->limit;
+      if (pLimit->limit > 0) {
+        pInfo->topN = pLimit->limit + MAX(pLimit->offset, 0);
+      }
   }
 
   SOperatorInfo* pOperator = calloc(1, sizeof(SOperatorInfo));
@@ -5967,7 +6284,7 @@ SOperatorInfo *createOrderOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperatorI
     goto _clean;
   }
 
-  pOperator->name          = "InMemoryOrder";
+  pOperator->name          = "ExternalOrder";
   pOperator->operatorType  = OP_Order;
   pOperator->blockingOptr  = true;
   pOperator->status        = OP_IN_EXECUTING;
@@ -7472,9 +7789,8 @@ static void destroyGroupbyOperatorInfo(void* param, int32_t numOfOutput) {
   doDestroyBasicInfo(&pInfo->binfo, numOfOutput);
   taosArrayDestroy(&pInfo->pGroupbyDataInfo);
 
-  if (pInfo->prevData) {
-    tfree(pInfo->prevData);
-  }
+  tfree(pInfo->prevData);
+  tfree(pInfo->keyBuf);
 }
 
 static void destroyProjectOperatorInfo(void* param, int32_t numOfOutput) {
@@ -7506,6 +7822,21 @@ static void destroyOrderOperatorInfo(void* param, int32_t numOfOutput) {
   if (pInfo->pDataBlock) {
     pInfo->pDataBlock = destroyOutputBuf(pInfo->pDataBlock);
   }
+
+  if (pInfo->pSource != NULL) {
+    for(int32_t i = 0; i < pInfo->numOfSource; ++i) {
+      tfree(pInfo->pSource[i]);
+    }
+
+    tfree(pInfo->pSource);
+  }
+
+  tfree(pInfo->pTree);
+  pInfo->pExtBuf = destoryExtMemBuffer(pInfo->pExtBuf);
+  if (pInfo->pModel != NULL) {
+    destroyColumnModel(pInfo->pModel);
+    pInfo->pModel = NULL;
+  }
 }
 
 static void destroyConditionOperatorInfo(void* param, int32_t numOfOutput) {
@@ -10234,6 +10565,11 @@ void addTableReadRows(SQueryRuntimeEnv* pEnv, int32_t tid, int32_t rows) {
 }
 
 // tsdb scan table callback table or query is over. param is SQueryRuntimeEnv*
+bool qFilterStatisCB(void* param, SDataStatis* pStatis, int32_t numOfCols, int32_t numOfRows) {
+  SQueryRuntimeEnv* pEnv = (SQueryRuntimeEnv* )param;
+  return filterRangeExecute(pEnv->pQueryAttr->pFilters, pStatis, numOfCols, numOfRows);
+}
+
 bool qReadOverCB(void* param, int8_t type, int32_t tid) {
   SQueryRuntimeEnv* pEnv = (SQueryRuntimeEnv* )param;
   if (pEnv->pTablesRead == NULL) {
@@ -18,6 +18,7 @@
 #include "taos.h"
 #include "taosdef.h"
 #include "taosmsg.h"
+#include "tglobal.h"
 #include "tulog.h"
 #include "qExecutor.h"
 #include "qExtbuffer.h"
@@ -26,6 +27,38 @@
 #define COLMODEL_GET_VAL(data, schema, allrow, rowId, colId) \
   (data + (schema)->pFields[colId].offset * (allrow) + (rowId) * (schema)->pFields[colId].field.bytes)
 
+// bytes of the flushed pages kept in memory by all the buffers of the process, limited by mergeMemBufferSize
+static int64_t tsExtMemFlushedBytes = 0;
+
+static bool tExtMemBufferAcquireMem(int64_t bytes) {
+  int64_t limit = ((int64_t)tsMergeMemBufferSize) << 20;
+  if (atomic_add_fetch_64(&tsExtMemFlushedBytes, bytes) > limit) {
+    atomic_sub_fetch_64(&tsExtMemFlushedBytes, bytes);
+    return false;
+  }
+
+  return true;
+}
+
+static void tExtMemBufferReleaseMem(int64_t bytes) {
+  atomic_sub_fetch_64(&tsExtMemFlushedBytes, bytes);
+}
+
+static void tExtMemBufferFreeFlushedPages(tExtMemBuffer *pMemBuffer) {
+  if (pMemBuffer->pFlushedPages == NULL) {
+    return;
+  }
+
+  size_t num = taosArrayGetSize(pMemBuffer->pFlushedPages);
+  for (size_t i = 0; i < num; ++i) {
+    tFilePagesItem *item = taosArrayGetP(pMemBuffer->pFlushedPages, i);
+    tfree(item);
+  }
+
+  taosArrayClear(pMemBuffer->pFlushedPages);
+  tExtMemBufferReleaseMem((int64_t)num * pMemBuffer->pageSize);
+}
+
 /*
  * SColumnModel is deeply copy
  */
@@ -77,6 +110,9 @@ void* destoryExtMemBuffer(tExtMemBuffer *pMemBuffer) {
     tfree(pTmp);
   }
 
+  tExtMemBufferFreeFlushedPages(pMemBuffer);
+  taosArrayDestroy(&pMemBuffer->pFlushedPages);
+
   // close temp file
   if (pMemBuffer->file != 0) {
     if (fclose(pMemBuffer->file) != 0) {
@@ -245,33 +281,125 @@ static void tExtMemBufferClearFlushoutInfo(tExtMemBuffer *pMemBuffer) {
   memset(pFileMeta->flushoutData.pFlushoutInfo, 0, sizeof(tFlushoutInfo) * pFileMeta->flushoutData.nAllocSize);
 }
 
+static void tExtMemBufferResetInMemPages(tExtMemBuffer *pMemBuffer) {
+  pMemBuffer->numOfElemsInBuffer = 0;
+  pMemBuffer->numOfInMemPages = 0;
+  pMemBuffer->pHead = NULL;
+  pMemBuffer->pTail = NULL;
+}
+
+/*
+ * The pages in buffer are kept in memory as flushed pages, which are read in the same way as the pages in file.
+ * The memory of the pages is acquired by the caller. If it fails, the buffer is left as it was.
+ */
+static int32_t tExtMemBufferFlushToMem(tExtMemBuffer *pMemBuffer) {
+  if (pMemBuffer->pFlushedPages == NULL) {
+    pMemBuffer->pFlushedPages = taosArrayInit(pMemBuffer->numOfInMemPages, POINTER_BYTES);
+    if (pMemBuffer->pFlushedPages == NULL) {
+      return TSDB_CODE_QRY_OUT_OF_MEMORY;
+    }
+  }
+
+  size_t numOfPages = taosArrayGetSize(pMemBuffer->pFlushedPages);
+  for (tFilePagesItem *item = pMemBuffer->pHead; item != NULL; item = item->pNext) {
+    if (taosArrayPush(pMemBuffer->pFlushedPages, &item) == NULL) {
+      taosArraySetSize(pMemBuffer->pFlushedPages, numOfPages);
+      return TSDB_CODE_QRY_OUT_OF_MEMORY;
+    }
+  }
+
+  if (!tExtMemBufferUpdateFlushoutInfo(pMemBuffer)) {
+    taosArraySetSize(pMemBuffer->pFlushedPages, numOfPages);
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+
+  tFilePagesItem *first = pMemBuffer->pHead;
+  while (first != NULL) {
+    pMemBuffer->fileMeta.numOfElemsInFile += (uint32_t)first->item.num;
+    pMemBuffer->fileMeta.nFileSize += 1;
+
+    tFilePagesItem *ptmp = first;
+    first = first->pNext;
+    ptmp->pNext = NULL;
+  }
+
+  tExtMemBufferResetInMemPages(pMemBuffer);
+  return 0;
+}
+
+/*
+ * Move the flushed pages kept in memory to the head of the temp file, once the pages can not be kept in memory.
+ * If it fails, the temp file is dropped and the pages are still read from memory.
+ */
+static int32_t tExtMemBufferSpillFlushedPages(tExtMemBuffer *pMemBuffer) {
+  size_t num = taosArrayGetSize(pMemBuffer->pFlushedPages);
+  for (size_t i = 0; i < num; ++i) {
+    tFilePagesItem *item = taosArrayGetP(pMemBuffer->pFlushedPages, i);
+    if (fwrite((char *)&(item->item), pMemBuffer->pageSize, 1, pMemBuffer->file) <= 0) {
+      int32_t code = TAOS_SYSTEM_ERROR(errno);
+      fclose(pMemBuffer->file);
+      pMemBuffer->file = NULL;
+      unlink(pMemBuffer->path);
+      return code;
+    }
+  }
+
+  tExtMemBufferFreeFlushedPages(pMemBuffer);
+  return 0;
+}
+
 int32_t tExtMemBufferFlush(tExtMemBuffer *pMemBuffer) {
   int32_t ret = 0;
   if (pMemBuffer->numOfTotalElems == 0) {
     return ret;
   }
 
+  /* all data has been flushed, ignore flush operation */
+  if (pMemBuffer->numOfElemsInBuffer == 0) {
+    return ret;
+  }
+
+  if (pMemBuffer->file == NULL && pMemBuffer->flushToMem) {
+    int64_t bytes = (int64_t)pMemBuffer->numOfInMemPages * pMemBuffer->pageSize;
+    if (tExtMemBufferAcquireMem(bytes)) {
+      if ((ret = tExtMemBufferFlushToMem(pMemBuffer)) != 0) {
+        tExtMemBufferReleaseMem(bytes);
+      }
+      return ret;
+    }
+  }
+
   if (pMemBuffer->file == NULL) {
     if ((pMemBuffer->file = fopen(pMemBuffer->path, "wb+")) == NULL) {
       ret = TAOS_SYSTEM_ERROR(errno);
       return ret;
     }
-  }
 
-  /* all data has been flushed to disk, ignore flush operation */
-  if (pMemBuffer->numOfElemsInBuffer == 0) {
-    return ret;
+    if (pMemBuffer->pFlushedPages != NULL && (ret = tExtMemBufferSpillFlushedPages(pMemBuffer)) != 0) {
+      return ret;
+    }
   }
 
-  tFilePagesItem *first = pMemBuffer->pHead;
-  while (first != NULL) {
-    size_t retVal = fwrite((char *)&(first->item), pMemBuffer->pageSize, 1, pMemBuffer->file);
+  // the pages are released only if all of them are written, and a failed write is overwritten by the next flush
+  long offset = (long)pMemBuffer->fileMeta.nFileSize * pMemBuffer->pageSize;
+  for (tFilePagesItem *item = pMemBuffer->pHead; item != NULL; item = item->pNext) {
+    size_t retVal = fwrite((char *)&(item->item), pMemBuffer->pageSize, 1, pMemBuffer->file);
     if (retVal <= 0) {  // failed to write to buffer, may be not enough space
       ret = TAOS_SYSTEM_ERROR(errno);
-      pMemBuffer->pHead = first;
+      fseek(pMemBuffer->file, offset, SEEK_SET);
       return ret;
     }
+  }
+
+  fflush(pMemBuffer->file);  // flush to disk
 
+  if (!tExtMemBufferUpdateFlushoutInfo(pMemBuffer)) {
+    fseek(pMemBuffer->file, offset, SEEK_SET);
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+
+  tFilePagesItem *first = pMemBuffer->pHead;
+  while (first != NULL) {
     pMemBuffer->fileMeta.numOfElemsInFile += (uint32_t)first->item.num;
     pMemBuffer->fileMeta.nFileSize += 1;
 
@@ -281,16 +409,25 @@ int32_t tExtMemBufferFlush(tExtMemBuffer *pMemBuffer) {
     tfree(ptmp);  // release all data in memory buffer
   }
 
-  fflush(pMemBuffer->file);  // flush to disk
+  tExtMemBufferResetInMemPages(pMemBuffer);
 
-  tExtMemBufferUpdateFlushoutInfo(pMemBuffer);
+  return ret;
+}
 
-  pMemBuffer->numOfElemsInBuffer = 0;
-  pMemBuffer->numOfInMemPages = 0;
-  pMemBuffer->pHead = NULL;
-  pMemBuffer->pTail = NULL;
+void tExtMemBufferMergeFlushoutInfo(tExtMemBuffer *pMemBuffer, int32_t flushIdx) {
+  tFlushoutData *pData = &pMemBuffer->fileMeta.flushoutData;
+  if (flushIdx < 0 || flushIdx + 1 >= (int32_t)pData->nLength) {
+    return;
+  }
 
-  return ret;
+  tFlushoutInfo *pFirst = &pData->pFlushoutInfo[flushIdx];
+  for (int32_t i = flushIdx + 1; i < (int32_t)pData->nLength; ++i) {
+    assert(pData->pFlushoutInfo[i].startPageId == pFirst->startPageId + pFirst->numOfPages);
+    pFirst->numOfPages += pData->pFlushoutInfo[i].numOfPages;
+  }
+
+  memset(&pData->pFlushoutInfo[flushIdx + 1], 0, sizeof(tFlushoutInfo) * (pData->nLength - flushIdx - 1));
+  pData->nLength = flushIdx + 1;
 }
 
 void tExtMemBufferClear(tExtMemBuffer *pMemBuffer) {
@@ -306,6 +443,8 @@ void tExtMemBufferClear(tExtMemBuffer *pMemBuffer) {
     tfree(ptmp);
   }
 
+  tExtMemBufferFreeFlushedPages(pMemBuffer);
+
   pMemBuffer->fileMeta.numOfElemsInFile = 0;
   pMemBuffer->fileMeta.nFileSize = 0;
 
@@ -333,6 +472,18 @@ bool tExtMemBufferLoadData(tExtMemBuffer *pMemBuffer, tFilePage *pFilePage, int3
     return false;
   }
 
+  // all flushed pages are still in memory
+  if (pMemBuffer->file == NULL) {
+    size_t pageId = pInfo->startPageId + pageIdx;
+    if (pMemBuffer->pFlushedPages == NULL || pageId >= taosArrayGetSize(pMemBuffer->pFlushedPages)) {
+      return false;
+    }
+
+    tFilePagesItem *item = taosArrayGetP(pMemBuffer->pFlushedPages, pageId);
+    memcpy(pFilePage, &item->item, pMemBuffer->pageSize);
+    return true;
+  }
+
   size_t ret = fseek(pMemBuffer->file, (pInfo->startPageId + pageIdx) * pMemBuffer->pageSize, SEEK_SET);
   ret = fread(pFilePage, pMemBuffer->pageSize, 1, pMemBuffer->file);
 
@@ -1775,6 +1775,7 @@ void filterFreeInfo(SFilterInfo *info) {
   CHK_RETV(info == NULL);
 
   tfree(info->cunits);
+  tfree(info->kernel);
   tfree(info->blkUnitRes);
   tfree(info->blkUnits);
   
@@ -2761,8 +2762,11 @@ int32_t filterRmUnitByRange(SFilterInfo *info, SDataStatis *pDataStatis, int32_t
       maxRes = (*gRangeCompare[cunit->rfunc])(maxVal, maxVal, cunit->valData, cunit->valData2, gDataCompare[cunit->func]);
 
       if (minRes && maxRes) {
-        info->blkUnitRes[k] = 1;
-        rmUnit = 1;
+        // the NULL values of the block do not match, so not all the rows match
+        if (pDataBlockst->numOfNull <= 0) {
+          info->blkUnitRes[k] = 1;
+          rmUnit = 1;
+        }
       } else if ((!minRes) && (!maxRes)) {
         minRes = filterDoCompare(gDataCompare[cunit->func], TSDB_RELATION_LESS_EQUAL, minVal, cunit->valData);
         maxRes = filterDoCompare(gDataCompare[cunit->func], TSDB_RELATION_GREATER_EQUAL, maxVal, cunit->valData2);
@@ -2779,8 +2783,10 @@ int32_t filterRmUnitByRange(SFilterInfo *info, SDataStatis *pDataStatis, int32_t
       maxRes = filterDoCompare(gDataCompare[cunit->func], cunit->optr, maxVal, cunit->valData);
 
       if (minRes && maxRes) {
-        info->blkUnitRes[k] = 1;
-        rmUnit = 1;
+        if (pDataBlockst->numOfNull <= 0) {
+          info->blkUnitRes[k] = 1;
+          rmUnit = 1;
+        }
       } else if ((!minRes) && (!maxRes)) {
         if (cunit->optr == TSDB_RELATION_EQUAL) {
           minRes = filterDoCompare(gDataCompare[cunit->func], TSDB_RELATION_GREATER, minVal, cunit->valData);
@@ -3073,6 +3079,282 @@ static void doJsonCompare(SFilterComUnit *cunit, int8_t *result, void* colData){
   }
 }
 
+/*
+ * Branch free kernels for integer and timestamp columns. Ranges and single values are normalized to inclusive
+ * bounds of the column type so that the loops below only use plain comparisons, which the compiler turns into
+ * packed compares. An AVX2 clone of each kernel is selected at runtime on x86_64, SSE4.2 is the build baseline.
+ * Float and double columns are left to the scalar path since they are compared with an epsilon.
+ */
+#if defined(__x86_64__) && defined(__GNUC__)
+#define FILTER_KERNEL_AVX2
+#endif
+
+#define FILTER_RANGE_KERNEL_BODY(_type, _null)                                                  \
+  do {                                                                                        \
+    const _type *v = (const _type *)data;                                                     \
+    _type        l = *(const _type *)lo;                                                      \
+    _type        h = *(const _type *)hi;                                                      \
+    for (int32_t i = 0; i < numOfRows; ++i) {                                                 \
+      res[i] = (int8_t)((v[i] >= l) & (v[i] <= h) & (v[i] != (_type)(_null)));                \
+    }                                                                                         \
+  } while (0)
+
+#define FILTER_IN_KERNEL_BODY(_type, _null)                                                     \
+  do {                                                                                        \
+    const _type *v = (const _type *)data;                                                     \
+    const int64_t *k = (const int64_t *)vals;                                                 \
+    memset(res, 0, numOfRows);                                                                \
+    for (int32_t j = 0; j < num; ++j) {                                                       \
+      _type kv = (_type)k[j];                                                                 \
+      for (int32_t i = 0; i < numOfRows; ++i) {                                               \
+        res[i] |= (int8_t)(v[i] == kv);                                                       \
+      }                                                                                       \
+    }                                                                                         \
+    for (int32_t i = 0; i < numOfRows; ++i) {                                                 \
+      res[i] &= (int8_t)(v[i] != (_type)(_null));                                             \
+    }                                                                                         \
+  } while (0)
+
+#ifdef FILTER_KERNEL_AVX2
+#define FILTER_DEFINE_KERNEL(_name, _type, _null)                                                                    \
+  static void filterRange##_name(const void *data, int32_t numOfRows, const void *lo, const void *hi, int8_t *res) { \
+    FILTER_RANGE_KERNEL_BODY(_type, _null);                                                                          \
+  }                                                                                                                  \
+  __attribute__((target("avx2"))) static void filterRange##_name##Avx2(const void *data, int32_t numOfRows,         \
+                                                                       const void *lo, const void *hi, int8_t *res) { \
+    FILTER_RANGE_KERNEL_BODY(_type, _null);                                                                          \
+  }                                                                                                                  \
+  static void filterIn##_name(const void *data, int32_t numOfRows, const void *vals, int32_t num, int8_t *res) {     \
+    FILTER_IN_KERNEL_BODY(_type, _null);                                                                             \
+  }                                                                                                                  \
+  __attribute__((target("avx2"))) static void filterIn##_name##Avx2(const void *data, int32_t numOfRows,            \
+                                                                    const void *vals, int32_t num, int8_t *res) {    \
+    FILTER_IN_KERNEL_BODY(_type, _null);                                                                             \
+  }
+#define FILTER_KERNEL_ENTRY(_name) {filterRange##_name, filterRange##_name##Avx2, filterIn##_name, filterIn##_name##Avx2}
+#else
+#define FILTER_DEFINE_KERNEL(_name, _type, _null)                                                                    \
+  static void filterRange##_name(const void *data, int32_t numOfRows, const void *lo, const void *hi, int8_t *res) { \
+    FILTER_RANGE_KERNEL_BODY(_type, _null);                                                                          \
+  }                                                                                                                  \
+  static void filterIn##_name(const void *data, int32_t numOfRows, const void *vals, int32_t num, int8_t *res) {     \
+    FILTER_IN_KERNEL_BODY(_type, _null);                                                                             \
+  }
+#define FILTER_KERNEL_ENTRY(_name) {filterRange##_name, filterRange##_name, filterIn##_name, filterIn##_name}
+#endif
+
+FILTER_DEFINE_KERNEL(Int8, int8_t, TSDB_DATA_TINYINT_NULL)
+FILTER_DEFINE_KERNEL(Int16, int16_t, TSDB_DATA_SMALLINT_NULL)
+FILTER_DEFINE_KERNEL(Int32, int32_t, TSDB_DATA_INT_NULL)
+FILTER_DEFINE_KERNEL(Int64, int64_t, TSDB_DATA_BIGINT_NULL)
+FILTER_DEFINE_KERNEL(Uint8, uint8_t, TSDB_DATA_UTINYINT_NULL)
+FILTER_DEFINE_KERNEL(Uint16, uint16_t, TSDB_DATA_USMALLINT_NULL)
+FILTER_DEFINE_KERNEL(Uint32, uint32_t, TSDB_DATA_UINT_NULL)
+FILTER_DEFINE_KERNEL(Uint64, uint64_t, TSDB_DATA_UBIGINT_NULL)
+
+typedef struct SFilterKernelEntry {
+  filter_range_kernel_func range;
+  filter_range_kernel_func rangeAvx2;
+  filter_in_kernel_func    in;
+  filter_in_kernel_func    inAvx2;
+} SFilterKernelEntry;
+
+static SFilterKernelEntry gFilterKernel[] = {
+  FILTER_KERNEL_ENTRY(Int8),  FILTER_KERNEL_ENTRY(Int16),  FILTER_KERNEL_ENTRY(Int32),  FILTER_KERNEL_ENTRY(Int64),
+  FILTER_KERNEL_ENTRY(Uint8), FILTER_KERNEL_ENTRY(Uint16), FILTER_KERNEL_ENTRY(Uint32), FILTER_KERNEL_ENTRY(Uint64),
+};
+
+static int32_t filterGetKernelIdx(uint8_t type) {
+  switch (type) {
+    case TSDB_DATA_TYPE_TINYINT:   return 0;
+    case TSDB_DATA_TYPE_SMALLINT:  return 1;
+    case TSDB_DATA_TYPE_INT:       return 2;
+    case TSDB_DATA_TYPE_BIGINT:
+    case TSDB_DATA_TYPE_TIMESTAMP: return 3;
+    case TSDB_DATA_TYPE_UTINYINT:  return 4;
+    case TSDB_DATA_TYPE_USMALLINT: return 5;
+    case TSDB_DATA_TYPE_UINT:      return 6;
+    case TSDB_DATA_TYPE_UBIGINT:   return 7;
+    default:                       return -1;
+  }
+}
+
+static bool filterKernelUseAvx2() {
+#ifdef FILTER_KERNEL_AVX2
+  static int8_t avx2 = -1;
+  if (avx2 < 0) {
+    avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+  }
+  return avx2 == 1;
+#else
+  return false;
+#endif
+}
+
+static FORCE_INLINE int64_t filterKernelGetVal(uint8_t type, const void *v) {
+  switch (type) {
+    case TSDB_DATA_TYPE_TINYINT:   return GET_INT8_VAL(v);
+    case TSDB_DATA_TYPE_SMALLINT:  return GET_INT16_VAL(v);
+    case TSDB_DATA_TYPE_INT:       return GET_INT32_VAL(v);
+    case TSDB_DATA_TYPE_UTINYINT:  return GET_UINT8_VAL(v);
+    case TSDB_DATA_TYPE_USMALLINT: return GET_UINT16_VAL(v);
+    case TSDB_DATA_TYPE_UINT:      return GET_UINT32_VAL(v);
+    default:                       return GET_INT64_VAL(v);
+  }
+}
+
+static FORCE_INLINE void filterKernelSetVal(uint8_t type, int64_t *dst, int64_t v) {
+  switch (type) {
+    case TSDB_DATA_TYPE_TINYINT:
+    case TSDB_DATA_TYPE_UTINYINT:  *(int8_t *)dst = (int8_t)v; break;
+    case TSDB_DATA_TYPE_SMALLINT:
+    case TSDB_DATA_TYPE_USMALLINT: *(int16_t *)dst = (int16_t)v; break;
+    case TSDB_DATA_TYPE_INT:
+    case TSDB_DATA_TYPE_UINT:      *(int32_t *)dst = (int32_t)v; break;
+    default:                       *dst = v; break;
+  }
+}
+
+// normalize the range unit into [lo, hi], 64 bit values are compared in the signedness of the column type
+static void filterKernelSetRange(SFilterKernel *kernel, SFilterComUnit *cunit) {
+  uint8_t type = cunit->dataType;
+  bool    isUnsigned = IS_UNSIGNED_NUMERIC_TYPE(type);
+  int64_t tmin = tDataTypes[type].minValue;
+  int64_t tmax = tDataTypes[type].maxValue;
+  bool    loEx = false, hiEx = false;
+  int64_t lo, hi;
+
+  switch (cunit->rfunc) {
+    case 0: loEx = hiEx = true; break;
+    case 1: loEx = true; break;
+    case 2: hiEx = true; break;
+    case 4: loEx = true; break;
+    case 6: hiEx = true; break;
+    default: break;
+  }
+
+  lo = (cunit->rfunc == 6 || cunit->rfunc == 7) ? tmin : filterKernelGetVal(type, cunit->valData);
+  hi = (cunit->rfunc == 4 || cunit->rfunc == 5) ? tmax : filterKernelGetVal(type, cunit->valData2);
+
+  if ((loEx && lo == tmax) || (hiEx && hi == tmin)) {
+    kernel->empty = 1;
+    return;
+  }
+
+  lo = loEx ? (int64_t)((uint64_t)lo + 1) : lo;
+  hi = hiEx ? (int64_t)((uint64_t)hi - 1) : hi;
+
+  if (isUnsigned ? ((uint64_t)lo > (uint64_t)hi) : (lo > hi)) {
+    kernel->empty = 1;
+    return;
+  }
+
+  filterKernelSetVal(type, &kernel->lo, lo);
+  filterKernelSetVal(type, &kernel->hi, hi);
+}
+
+/*
+ * An IN list of integers is split into one group with an equal unit per value, so the filter is an IN kernel
+ * when every group holds a single equal unit of the same column.
+ */
+static bool filterKernelIsIn(SFilterInfo *info) {
+  if (info->unitNum <= 1 || info->unitNum > FILTER_KERNEL_MAX_IN_NUM || info->groupNum != info->unitNum) {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < info->groupNum; ++i) {
+    SFilterGroup   *group = &info->groups[i];
+    SFilterComUnit *cunit = &info->cunits[group->unitIdxs[0]];
+    if (group->unitNum != 1 || cunit->optr != TSDB_RELATION_EQUAL || cunit->colId != info->cunits[0].colId ||
+        cunit->dataType != info->cunits[0].dataType) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static void filterKernelSetIn(SFilterKernel *kernel, SFilterInfo *info) {
+  for (uint32_t i = 0; i < info->groupNum; ++i) {
+    SFilterComUnit *cunit = &info->cunits[info->groups[i].unitIdxs[0]];
+    kernel->inVals[kernel->inNum++] = filterKernelGetVal(cunit->dataType, cunit->valData);
+  }
+}
+
+static int32_t filterSetKernel(SFilterInfo *info) {
+  SFilterComUnit *cunit = &info->cunits[0];
+  int32_t         idx = filterGetKernelIdx(cunit->dataType);
+  bool            in = filterKernelIsIn(info);
+
+  if (idx < 0 || cunit->dataSize != tDataTypes[cunit->dataType].bytes) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  if (info->unitNum > 1 && !in) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  if (cunit->rfunc < 0 && cunit->optr != TSDB_RELATION_EQUAL) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  SFilterKernel *kernel = calloc(1, sizeof(SFilterKernel));
+  if (kernel == NULL) {
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+
+  if (in) {
+    filterKernelSetIn(kernel, info);
+    kernel->inFp = filterKernelUseAvx2() ? gFilterKernel[idx].inAvx2 : gFilterKernel[idx].in;
+  } else {
+    if (cunit->rfunc >= 0) {
+      filterKernelSetRange(kernel, cunit);
+    } else {
+      int64_t v = filterKernelGetVal(cunit->dataType, cunit->valData);
+      filterKernelSetVal(cunit->dataType, &kernel->lo, v);
+      filterKernelSetVal(cunit->dataType, &kernel->hi, v);
+    }
+
+    kernel->rangeFp = filterKernelUseAvx2() ? gFilterKernel[idx].rangeAvx2 : gFilterKernel[idx].range;
+  }
+
+  info->kernel = kernel;
+  return TSDB_CODE_SUCCESS;
+}
+
+bool filterExecuteImplKernel(void *pinfo, int32_t numOfRows, int8_t** p, SDataStatis *statis, int16_t numOfCols) {
+  SFilterInfo   *info = (SFilterInfo *)pinfo;
+  SFilterKernel *kernel = info->kernel;
+  void          *colData = info->cunits[0].colData;
+  bool           all = true;
+
+  if (filterExecuteBasedOnStatis(info, numOfRows, p, statis, numOfCols, &all) == 0) {
+    return all;
+  }
+
+  if (*p == NULL) {
+    *p = calloc(numOfRows, sizeof(int8_t));
+  }
+
+  if (colData == NULL || kernel->empty) {
+    memset(*p, 0, numOfRows);
+    return numOfRows <= 0;
+  }
+
+  if (kernel->inFp) {
+    (*kernel->inFp)(colData, numOfRows, kernel->inVals, kernel->inNum, *p);
+  } else {
+    (*kernel->rangeFp)(colData, numOfRows, &kernel->lo, &kernel->hi, *p);
+  }
+
+  int32_t num = 0;
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    num += (*p)[i];
+  }
+
+  return num == numOfRows;
+}
+
 bool filterExecuteImplRange(void *pinfo, int32_t numOfRows, int8_t** p, SDataStatis *statis, int16_t numOfCols) {
   SFilterInfo *info = (SFilterInfo *)pinfo;
   bool all = true;
@@ -3248,6 +3530,16 @@ int32_t filterSetExecFunc(SFilterInfo *info) {
     return TSDB_CODE_SUCCESS;
   }
 
+  int32_t code = filterSetKernel(info);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  if (info->kernel) {
+    info->func = filterExecuteImplKernel;
+    return TSDB_CODE_SUCCESS;
+  }
+
   if (info->unitNum > 1) {
     info->func = filterExecuteImpl;
     return TSDB_CODE_SUCCESS;
@@ -3277,6 +3569,7 @@ int32_t filterSetExecFunc(SFilterInfo *info) {
 int32_t filterPreprocess(SFilterInfo *info) {
   SFilterGroupCtx** gRes = calloc(info->groupNum, sizeof(SFilterGroupCtx *));
   int32_t gResNum = 0;
+  int32_t code = TSDB_CODE_SUCCESS;
   
   filterMergeGroupUnits(info, gRes, &gResNum);
 
@@ -3305,7 +3598,7 @@ int32_t filterPreprocess(SFilterInfo *info) {
 
 _return:
 
-  filterSetExecFunc(info);
+  code = filterSetExecFunc(info);
 
   for (int32_t i = 0; i < gResNum; ++i) {
     filterFreeGroupCtx(gRes[i]);
@@ -3313,7 +3606,7 @@ _return:
 
   tfree(gRes);
   
-  return TSDB_CODE_SUCCESS;
+  return code;
 }
 
 int32_t filterSetColFieldData(SFilterInfo *info, void *param, filer_get_col_from_id fp) {
@@ -663,9 +663,10 @@ SArray* createExecOperatorPlan(SQueryAttr* pQueryAttr) {
       }
     }
 
-    // outer query order by support
+    // outer query order by support, and the top N rows of each vnode for the super table ordered by a column
     int32_t orderColId = pQueryAttr->order.orderColId;
-    if (pQueryAttr->vgId == 0 && orderColId != INT32_MIN) {
+    if ((pQueryAttr->vgId == 0 && orderColId != INT32_MIN) ||
+        (pQueryAttr->stableQuery && orderColId > PRIMARYKEY_TIMESTAMP_COL_INDEX && pQueryAttr->limit.limit > 0)) {
       op = OP_Order;
       taosArrayPush(plan, &op);
     }
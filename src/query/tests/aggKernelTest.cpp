@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+#include "taos.h"
+#include "taosdef.h"
+#include "tvariant.h"
+
+#include "qAggMain.h"
+
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+
+namespace {
+
+const int32_t numOfRows = 1003;
+
+typedef struct SAggCtx {
+  SQLFunctionCtx ctx;
+  char           resInfo[sizeof(SResultRowCellInfo) + 64];
+  char           output[64];
+} SAggCtx;
+
+void initAggCtx(SAggCtx *p, int16_t functionId, int16_t type, void *data, bool hasNull) {
+  memset(p, 0, sizeof(SAggCtx));
+
+  SQLFunctionCtx *pCtx = &p->ctx;
+  pCtx->functionId = functionId;
+  pCtx->inputType = type;
+  pCtx->inputBytes = tDataTypes[type].bytes;
+  pCtx->order = TSDB_ORDER_ASC;
+  pCtx->pInput = data;
+  pCtx->size = numOfRows;
+  pCtx->hasNull = hasNull;
+  pCtx->pOutput = p->output;
+  pCtx->resultInfo = (SResultRowCellInfo *)p->resInfo;
+
+  int32_t interBytes = 0;
+  getResultDataInfo(type, pCtx->inputBytes, functionId, 0, &pCtx->outputType, &pCtx->outputBytes, &interBytes, 0,
+                    false, NULL);
+  pCtx->interBufBytes = interBytes;
+
+  aAggs[functionId].init(pCtx, pCtx->resultInfo);
+}
+
+void runAggCtx(SAggCtx *p) {
+  aAggs[p->ctx.functionId].xFunction(&p->ctx);
+  aAggs[p->ctx.functionId].xFinalize(&p->ctx);
+}
+
+// the result of the kernel must be the same as the one of the scalar loop
+template <typename T>
+void checkAggKernel(int16_t type, bool withNull) {
+  T data[numOfRows];
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    // keep away from the null value of unsigned types, which is the max value
+    data[i] = (T)((i * 37) % 201 - (std::numeric_limits<T>::is_signed ? 100 : 0));
+    if (withNull && i % 5 == 0) {
+      setNull((char *)&data[i], type, sizeof(T));
+    }
+  }
+
+  int16_t functions[] = {TSDB_FUNC_COUNT, TSDB_FUNC_SUM, TSDB_FUNC_AVG, TSDB_FUNC_MIN, TSDB_FUNC_MAX};
+  int32_t num = sizeof(functions) / sizeof(functions[0]);
+
+  SAggCtx       scalar[5];
+  SAggCtx       kernel[5];
+  SColumnAggRes colAgg = {0};
+
+  for (int32_t i = 0; i < num; ++i) {
+    initAggCtx(&scalar[i], functions[i], type, data, true);
+    initAggCtx(&kernel[i], functions[i], type, data, withNull);
+
+    // all the functions share one sweep of the column
+    int8_t required = getAggKernelRequired(functions[i], type);
+    if (required != 0) {
+      kernel[i].ctx.pColAgg = &colAgg;
+      colAgg.required |= required;
+    }
+  }
+
+  for (int32_t i = 0; i < num; ++i) {
+    runAggCtx(&scalar[i]);
+    runAggCtx(&kernel[i]);
+
+    SQLFunctionCtx *s = &scalar[i].ctx;
+    SQLFunctionCtx *k = &kernel[i].ctx;
+    ASSERT_EQ(s->outputType, k->outputType);
+
+    if (s->outputType == TSDB_DATA_TYPE_DOUBLE) {
+      double sv = GET_DOUBLE_VAL(s->pOutput);
+      double kv = GET_DOUBLE_VAL(k->pOutput);
+      ASSERT_LE(fabs(sv - kv), fabs(sv) * 1e-12) << "type " << type << " function " << functions[i];
+    } else {
+      ASSERT_EQ(memcmp(s->pOutput, k->pOutput, s->outputBytes), 0) << "type " << type << " function " << functions[i];
+    }
+  }
+
+  ASSERT_EQ(colAgg.pInput, (void *)data);
+  ASSERT_EQ(colAgg.numOfElem, withNull ? numOfRows - (numOfRows + 4) / 5 : numOfRows);
+}
+
+}  // namespace
+
+TEST(testCase, aggKernelTest) {
+  for (int32_t n = 0; n < 2; ++n) {
+    checkAggKernel<int8_t>(TSDB_DATA_TYPE_TINYINT, n);
+    checkAggKernel<int16_t>(TSDB_DATA_TYPE_SMALLINT, n);
+    checkAggKernel<int32_t>(TSDB_DATA_TYPE_INT, n);
+    checkAggKernel<int64_t>(TSDB_DATA_TYPE_BIGINT, n);
+    checkAggKernel<uint8_t>(TSDB_DATA_TYPE_UTINYINT, n);
+    checkAggKernel<uint16_t>(TSDB_DATA_TYPE_USMALLINT, n);
+    checkAggKernel<uint32_t>(TSDB_DATA_TYPE_UINT, n);
+    checkAggKernel<uint64_t>(TSDB_DATA_TYPE_UBIGINT, n);
+    checkAggKernel<float>(TSDB_DATA_TYPE_FLOAT, n);
+    checkAggKernel<double>(TSDB_DATA_TYPE_DOUBLE, n);
+  }
+}
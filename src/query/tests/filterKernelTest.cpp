@@ -0,0 +1,227 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <vector>
+
+#include "taos.h"
+#include "taosdef.h"
+#include "tbuffer.h"
+#include "texpr.h"
+#include "tvariant.h"
+
+#include "qFilter.h"
+
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+
+namespace {
+
+const int32_t numOfRows = 1000;
+
+tExprNode *createColNode(int32_t type) {
+  tExprNode *pNode = (tExprNode *)calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_COL;
+  pNode->pSchema = (SSchema *)calloc(1, sizeof(SSchema));
+  pNode->pSchema->type = type;
+  pNode->pSchema->bytes = tDataTypes[type].bytes;
+  pNode->pSchema->colId = 1;
+  strcpy(pNode->pSchema->name, "c1");
+  return pNode;
+}
+
+tExprNode *createValNode(int64_t v) {
+  tExprNode *pNode = (tExprNode *)calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_VALUE;
+  pNode->pVal = (tVariant *)calloc(1, sizeof(tVariant));
+  tVariantCreateFromBinary(pNode->pVal, (char *)&v, sizeof(v), TSDB_DATA_TYPE_BIGINT);
+  return pNode;
+}
+
+tExprNode *createExprNode(uint8_t optr, tExprNode *pLeft, tExprNode *pRight) {
+  tExprNode *pNode = (tExprNode *)calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_EXPR;
+  pNode->_node.optr = optr;
+  pNode->_node.pLeft = pLeft;
+  pNode->_node.pRight = pRight;
+  return pNode;
+}
+
+tExprNode *createCondNode(int32_t type, uint8_t optr, int64_t v) {
+  return createExprNode(optr, createColNode(type), createValNode(v));
+}
+
+// the in list is serialized the way the client parser sends it
+tExprNode *createInNode(int32_t type, const std::vector<int64_t> &vals) {
+  SBufferWriter bw = tbufInitWriter(NULL, false);
+  tbufWriteUint32(&bw, (type == TSDB_DATA_TYPE_TIMESTAMP) ? TSDB_DATA_TYPE_BIGINT : type);
+  tbufWriteInt32(&bw, (int32_t)vals.size());
+  for (size_t i = 0; i < vals.size(); ++i) {
+    tbufWriteInt64(&bw, vals[i]);
+  }
+
+  tExprNode *pNode = (tExprNode *)calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_VALUE;
+  pNode->pVal = (tVariant *)calloc(1, sizeof(tVariant));
+  tVariantCreateFromBinary(pNode->pVal, tbufGetData(&bw, false), tbufTell(&bw), TSDB_DATA_TYPE_BINARY);
+  tbufCloseWriter(&bw);
+
+  return createExprNode(TSDB_RELATION_IN, createColNode(type), pNode);
+}
+
+int32_t getColData(void *param, int32_t colId, void **data) {
+  *data = param;
+  return TSDB_CODE_SUCCESS;
+}
+
+template <typename T>
+bool matchCond(T v, uint8_t optr, int64_t c) {
+  switch (optr) {
+    case TSDB_RELATION_GREATER:
+      return (int64_t)v > c;
+    case TSDB_RELATION_GREATER_EQUAL:
+      return (int64_t)v >= c;
+    case TSDB_RELATION_LESS:
+      return (int64_t)v < c;
+    case TSDB_RELATION_LESS_EQUAL:
+      return (int64_t)v <= c;
+    case TSDB_RELATION_EQUAL:
+      return (int64_t)v == c;
+    default:
+      return false;
+  }
+}
+
+// run the filter "c1 optr1 v1 [and c1 optr2 v2]" on generated data and compare with the expected result
+template <typename T>
+void checkFilter(int32_t type, uint8_t optr1, int64_t v1, uint8_t optr2 = 0, int64_t v2 = 0) {
+  T data[numOfRows];
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    data[i] = (T)(i - numOfRows / 2);
+    if (i % 7 == 0) {
+      setNull((char *)&data[i], type, sizeof(T));
+    }
+  }
+
+  tExprNode *tree = createCondNode(type, optr1, v1);
+  if (optr2 != 0) {
+    tree = createExprNode(TSDB_RELATION_AND, tree, createCondNode(type, optr2, v2));
+  }
+
+  SFilterInfo *info = NULL;
+  ASSERT_EQ(filterInitFromTree(tree, (void **)&info, 0), TSDB_CODE_SUCCESS);
+
+  int8_t *res = NULL;
+  bool    all = false;
+  if (info != NULL) {
+    // single integer unit must be executed by the vectorized kernel
+    ASSERT_TRUE(info->kernel != NULL || FILTER_ALL_RES(info) || FILTER_EMPTY_RES(info));
+    filterSetColFieldData(info, data, getColData);
+    all = filterExecute(info, numOfRows, &res, NULL, 0);
+  }
+
+  bool expectAll = true;
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    bool expect = !isNull((char *)&data[i], type) && matchCond(data[i], optr1, v1) &&
+                  (optr2 == 0 || matchCond(data[i], optr2, v2));
+    expectAll = expectAll && expect;
+    if (res != NULL) {
+      ASSERT_EQ(res[i] != 0, expect) << "row " << i;
+    } else if (info != NULL) {
+      ASSERT_EQ(all, expect) << "row " << i;
+    } else {
+      ASSERT_TRUE(expect) << "row " << i;
+    }
+  }
+
+  if (res != NULL) {
+    ASSERT_EQ(all, expectAll);
+  }
+
+  tfree(res);
+  filterFreeInfo(info);
+  tExprTreeDestroy(tree, NULL);
+}
+
+// run the filter "c1 in (vals)" on generated data, check the in kernel is used when expected and the result
+template <typename T>
+void checkInFilter(int32_t type, const std::vector<int64_t> &vals, bool useKernel) {
+  T data[numOfRows];
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    data[i] = (T)(i - numOfRows / 2);
+    if (i % 7 == 0) {
+      setNull((char *)&data[i], type, sizeof(T));
+    }
+  }
+
+  tExprNode   *tree = createInNode(type, vals);
+  SFilterInfo *info = NULL;
+  ASSERT_EQ(filterInitFromTree(tree, (void **)&info, 0), TSDB_CODE_SUCCESS);
+  ASSERT_TRUE(info != NULL);
+
+  if (useKernel) {
+    int32_t num = 0;
+    for (size_t j = 0; j < vals.size(); ++j) {
+      T v = (T)vals[j];
+      num += isNull((char *)&v, type) ? 0 : 1;
+    }
+
+    ASSERT_TRUE(info->kernel != NULL && info->kernel->inFp != NULL);
+    ASSERT_EQ(info->kernel->inNum, num);
+  } else {
+    ASSERT_TRUE(info->kernel == NULL || info->kernel->inFp == NULL);
+  }
+
+  int8_t *res = NULL;
+  filterSetColFieldData(info, data, getColData);
+  bool all = filterExecute(info, numOfRows, &res, NULL, 0);
+  ASSERT_TRUE(res != NULL);
+
+  bool expectAll = true;
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    bool expect = false;
+    for (size_t j = 0; j < vals.size() && !isNull((char *)&data[i], type); ++j) {
+      expect = expect || (data[i] == (T)vals[j]);
+    }
+
+    expectAll = expectAll && expect;
+    ASSERT_EQ(res[i] != 0, expect) << "row " << i;
+  }
+  ASSERT_EQ(all, expectAll);
+
+  tfree(res);
+  filterFreeInfo(info);
+  tExprTreeDestroy(tree, NULL);
+}
+
+}  // namespace
+
+TEST(testCase, filterKernelTest) {
+  checkFilter<int32_t>(TSDB_DATA_TYPE_INT, TSDB_RELATION_GREATER, 10);
+  checkFilter<int32_t>(TSDB_DATA_TYPE_INT, TSDB_RELATION_GREATER_EQUAL, -5, TSDB_RELATION_LESS, 7);
+  checkFilter<int32_t>(TSDB_DATA_TYPE_INT, TSDB_RELATION_LESS_EQUAL, -600);
+  checkFilter<int64_t>(TSDB_DATA_TYPE_BIGINT, TSDB_RELATION_EQUAL, 42);
+  checkFilter<int64_t>(TSDB_DATA_TYPE_TIMESTAMP, TSDB_RELATION_GREATER, -100, TSDB_RELATION_LESS_EQUAL, 100);
+  checkFilter<int16_t>(TSDB_DATA_TYPE_SMALLINT, TSDB_RELATION_LESS, 0);
+  checkFilter<int8_t>(TSDB_DATA_TYPE_TINYINT, TSDB_RELATION_GREATER, 100);
+  checkFilter<int8_t>(TSDB_DATA_TYPE_TINYINT, TSDB_RELATION_LESS, -100);
+  checkFilter<uint32_t>(TSDB_DATA_TYPE_UINT, TSDB_RELATION_GREATER, 4294966900LL);
+  checkFilter<uint8_t>(TSDB_DATA_TYPE_UTINYINT, TSDB_RELATION_GREATER_EQUAL, 10, TSDB_RELATION_LESS, 20);
+}
+
+TEST(testCase, filterKernelInTest) {
+  checkInFilter<int32_t>(TSDB_DATA_TYPE_INT, {1, 5, 9, -200}, true);
+  checkInFilter<int64_t>(TSDB_DATA_TYPE_BIGINT, {-500, 0, 499, 12345}, true);
+  checkInFilter<int64_t>(TSDB_DATA_TYPE_TIMESTAMP, {3, 4}, true);
+  checkInFilter<int16_t>(TSDB_DATA_TYPE_SMALLINT, {-3, 8, 100, 101, 102, 103, 104, 105}, true);
+  checkInFilter<int8_t>(TSDB_DATA_TYPE_TINYINT, {-12, 12, 127}, true);
+  checkInFilter<uint8_t>(TSDB_DATA_TYPE_UTINYINT, {0, 7, 200}, true);
+  checkInFilter<uint32_t>(TSDB_DATA_TYPE_UINT, {1, 4294966900LL}, true);
+  checkInFilter<uint64_t>(TSDB_DATA_TYPE_UBIGINT, {2, 3, 10}, true);
+
+  // the null value of the column type never matches, the rest of the list is an equal unit
+  checkInFilter<int32_t>(TSDB_DATA_TYPE_INT, {TSDB_DATA_INT_NULL, 2, 3}, true);
+  checkInFilter<int32_t>(TSDB_DATA_TYPE_INT, {TSDB_DATA_INT_NULL, 2}, false);
+
+  // a single value is an equal unit, a longer list is left to the scalar path
+  checkInFilter<int32_t>(TSDB_DATA_TYPE_INT, {6}, false);
+  checkInFilter<int32_t>(TSDB_DATA_TYPE_INT, {1, 2, 3, 4, 5, 6, 7, 8, 9}, false);
+}
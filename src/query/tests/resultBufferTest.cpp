@@ -2,8 +2,10 @@
 #include <cassert>
 #include <iostream>
 
+#include "qExtbuffer.h"
 #include "qResultbuf.h"
 #include "taos.h"
+#include "tglobal.h"
 #include "tsdb.h"
 
 #pragma GCC diagnostic ignored "-Wunused-function"
@@ -152,6 +154,90 @@ void recyclePageTest() {
 
   destroyResultBuf(pResultBuf);
 }
+
+// put the rows of numOfPages full pages into the ext buffer, 16 pages are kept in buffer before each flush
+tExtMemBuffer* createFlushedExtBuffer(SColumnModel* pModel, int32_t numOfPages) {
+  const int32_t pageSize = 4096;
+  tExtMemBuffer* pBuf = createExtMemBuffer(16 * pageSize, sizeof(int64_t), pageSize, pModel);
+  pBuf->flushModel = MULTIPLE_APPEND_MODEL;
+  pBuf->flushToMem = true;
+
+  int64_t numOfRows = (int64_t)numOfPages * pBuf->numOfElemsPerPage;
+  int64_t rows[1000];
+  for (int64_t start = 0; start < numOfRows; start += 1000) {
+    int32_t num = (int32_t)((numOfRows - start < 1000) ? numOfRows - start : 1000);
+    for (int32_t i = 0; i < num; ++i) {
+      rows[i] = start + i;
+    }
+    EXPECT_GE(tExtMemBufferPut(pBuf, rows, num), 0);
+  }
+
+  EXPECT_EQ(tExtMemBufferFlush(pBuf), 0);
+  return pBuf;
+}
+
+// the pages are read back in the order of the flushes, either from memory or from the temp file
+void checkFlushedExtBuffer(tExtMemBuffer* pBuf, int32_t numOfPages) {
+  tFilePage* pPage = (tFilePage*)malloc(pBuf->pageSize);
+  int64_t    next = 0;
+  int32_t    loaded = 0;
+
+  tFlushoutData* pData = &pBuf->fileMeta.flushoutData;
+  for (uint32_t i = 0; i < pData->nLength; ++i) {
+    for (uint32_t j = 0; j < pData->pFlushoutInfo[i].numOfPages; ++j) {
+      ASSERT_TRUE(tExtMemBufferLoadData(pBuf, pPage, i, j));
+      ASSERT_EQ(pPage->num, (uint64_t)pBuf->numOfElemsPerPage);
+
+      int64_t* v = (int64_t*)pPage->data;
+      for (uint64_t k = 0; k < pPage->num; ++k) {
+        ASSERT_EQ(v[k], next++);
+      }
+      loaded += 1;
+    }
+  }
+
+  ASSERT_EQ(loaded, numOfPages);
+  ASSERT_EQ(pBuf->fileMeta.nFileSize, (uint32_t)numOfPages);
+  ASSERT_EQ(pBuf->fileMeta.numOfElemsInFile, (uint32_t)next);
+  free(pPage);
+}
+
+void extBufferMemFlushTest() {
+  SSchema1 field[1] = {{0}};
+  field[0].type = TSDB_DATA_TYPE_BIGINT;
+  field[0].bytes = sizeof(int64_t);
+  strcpy(field[0].name, "k");
+
+  SColumnModel* pModel = createColumnModel(field, 1, 1000);
+
+  // 256 pages of 4KB are kept in memory by all the buffers
+  int32_t mergeMemBufferSize = tsMergeMemBufferSize;
+  tsMergeMemBufferSize = 1;
+
+  tExtMemBuffer* pMem = createFlushedExtBuffer(pModel, 100);
+  ASSERT_TRUE(pMem->file == NULL);
+  ASSERT_EQ(taosArrayGetSize(pMem->pFlushedPages), 100);
+
+  // the budget left is crossed, so the pages kept in memory are moved to the file
+  tExtMemBuffer* pFile = createFlushedExtBuffer(pModel, 300);
+  ASSERT_TRUE(pFile->file != NULL);
+  ASSERT_EQ(taosArrayGetSize(pFile->pFlushedPages), 0);
+
+  checkFlushedExtBuffer(pMem, 100);
+  checkFlushedExtBuffer(pFile, 300);
+
+  destoryExtMemBuffer(pMem);
+  destoryExtMemBuffer(pFile);
+
+  // the memory of the destroyed buffers is returned to the budget
+  pMem = createFlushedExtBuffer(pModel, 240);
+  ASSERT_TRUE(pMem->file == NULL);
+  checkFlushedExtBuffer(pMem, 240);
+  destoryExtMemBuffer(pMem);
+
+  tsMergeMemBufferSize = mergeMemBufferSize;
+  destroyColumnModel(pModel);
+}
 } // namespace
 
 
@@ -161,3 +247,7 @@ TEST(testCase, resultBufferTest) {
   writeDownTest();
   recyclePageTest();
 }
+
+TEST(testCase, extBufferMemFlushTest) {
+  extBufferMemFlushTest();
+}
@@ -30,6 +30,11 @@ typedef struct SFdObj {
   uint16_t           port;
   int16_t            closedByApp; // 1: already closed by App
   struct SThreadObj *pThreadObj;
+  SRpcHead           rpcHead;     // header of the message being received
+  int32_t            headLen;     // received bytes of rpcHead
+  int32_t            msgLen;      // length of the message being received, header included
+  int32_t            recvLen;     // received bytes of the message, header included
+  char              *buffer;      // allocated once the header is received, handed over to the upper layer
   struct SFdObj     *prev;
   struct SFdObj     *next;
 } SFdObj;
@@ -68,6 +73,18 @@ typedef struct {
   pthread_t   thread;
 } SServerObj;
 
+#if defined(_TD_WINDOWS_64) || defined(_TD_WINDOWS_32)
+  // wepoll supports level triggered mode only and recv may block, so read once for each event
+  #define TCP_EPOLL_EVENTS     (EPOLLIN | EPOLLRDHUP)
+  #define TCP_RECV_FLAGS       0
+  #define TCP_READS_PER_EVENT  1
+#else
+  // edge triggered, drain the socket for each event without blocking
+  #define TCP_EPOLL_EVENTS     (EPOLLIN | EPOLLRDHUP | EPOLLET)
+  #define TCP_RECV_FLAGS       MSG_DONTWAIT
+  #define TCP_READS_PER_EVENT  INT32_MAX
+#endif
+
 static void   *taosProcessTcpData(void *param);
 static SFdObj *taosMallocFdObj(SThreadObj *pThreadObj, SOCKET fd);
 static void    taosFreeFdObj(SFdObj *pFdObj);
@@ -473,63 +490,113 @@ static void taosReportBrokenLink(SFdObj *pFdObj) {
   taosFreeFdObj(pFdObj);
 }
 
-static int taosReadTcpData(SFdObj *pFdObj, SRecvInfo *pInfo) {
-  SRpcHead    rpcHead;
-  int32_t     msgLen, leftLen, retLen, headLen;
-  char       *buffer, *msg;
+static void taosResetTcpRecvState(SFdObj *pFdObj) {
+  pFdObj->headLen = 0;
+  pFdObj->msgLen = 0;
+  pFdObj->recvLen = 0;
+  pFdObj->buffer = NULL;
+}
 
+static int taosAllocTcpRecvBuffer(SFdObj *pFdObj) {
   SThreadObj *pThreadObj = pFdObj->pThreadObj;
 
-  headLen = taosReadMsg(pFdObj->fd, &rpcHead, sizeof(SRpcHead));
-  if (headLen != sizeof(SRpcHead)) {
-    tDebug("%s %p read error, FD:%p headLen:%d", pThreadObj->label, pFdObj->thandle, pFdObj, headLen);
-    return -1;
-  }
-
-  msgLen = (int32_t)htonl((uint32_t)rpcHead.msgLen);
+  int32_t msgLen = (int32_t)htonl((uint32_t)pFdObj->rpcHead.msgLen);
   int32_t size = msgLen + tsRpcOverhead;
   // TODO: reason not found yet, workaround to avoid first
-  if (msgLen <= 0 || size < 0) {
+  if (msgLen < (int32_t)sizeof(SRpcHead) || size < 0) {
     tError("%s %p invalid size for malloc, msgLen:%d, size:%d", pThreadObj->label, pFdObj->thandle, msgLen, size);
     return -1;
   }
 
-  buffer = malloc(size);
-  if (NULL == buffer) {
+  pFdObj->buffer = malloc(size);
+  if (NULL == pFdObj->buffer) {
     tError("%s %p TCP malloc(size:%d) fail", pThreadObj->label, pFdObj->thandle, msgLen);
     return -1;
   } else {
-    tTrace("%s %p read data, FD:%p fd:%d TCP malloc mem:%p", pThreadObj->label, pFdObj->thandle, pFdObj, pFdObj->fd, buffer);
+    tTrace("%s %p read data, FD:%p fd:%d TCP malloc mem:%p", pThreadObj->label, pFdObj->thandle, pFdObj, pFdObj->fd,
+           pFdObj->buffer);
   }
 
-  msg = buffer + tsRpcOverhead;
-  leftLen = msgLen - headLen;
-  retLen = taosReadMsg(pFdObj->fd, msg + headLen, leftLen);
+  memcpy(pFdObj->buffer + tsRpcOverhead, &pFdObj->rpcHead, sizeof(SRpcHead));
+  pFdObj->msgLen = msgLen;
+  pFdObj->recvLen = sizeof(SRpcHead);
+  return 0;
+}
 
-  if (leftLen != retLen) {
-    tError("%s %p read error, leftLen:%d retLen:%d FD:%p",
-            pThreadObj->label, pFdObj->thandle, leftLen, retLen, pFdObj);
-    free(buffer);
-    return -1;
-  }
+/*
+ * Read the message in a non-blocking way, the partially received message is kept in FdObj until the rest arrives.
+ * return 1 if a complete message is received, 0 if no more data to read, -1 if the link is broken
+ */
+static int taosReadTcpData(SFdObj *pFdObj, SRecvInfo *pInfo, int32_t *pReads) {
+  SThreadObj *pThreadObj = pFdObj->pThreadObj;
 
-  memcpy(msg, &rpcHead, sizeof(SRpcHead));
+  while (1) {
+    char   *ptr;
+    int32_t expectLen;
+    if (pFdObj->buffer == NULL) {
+      ptr = (char *)&pFdObj->rpcHead + pFdObj->headLen;
+      expectLen = sizeof(SRpcHead) - pFdObj->headLen;
+    } else {
+      ptr = pFdObj->buffer + tsRpcOverhead + pFdObj->recvLen;
+      expectLen = pFdObj->msgLen - pFdObj->recvLen;
+    }
 
-  pInfo->msg = msg;
-  pInfo->msgLen = msgLen;
-  pInfo->ip = pFdObj->ip;
-  pInfo->port = pFdObj->port;
-  pInfo->shandle = pThreadObj->shandle;
-  pInfo->thandle = pFdObj->thandle;
-  pInfo->chandle = pFdObj;
-  pInfo->connType = RPC_CONN_TCP;
+    if (expectLen > 0) {
+      if (*pReads >= TCP_READS_PER_EVENT) return 0;
+      (*pReads)++;
+
+      int32_t retLen = (int32_t)recv(pFdObj->fd, ptr, (size_t)expectLen, TCP_RECV_FLAGS);
+      if (retLen == 0) {
+        tDebug("%s %p read error, FD:%p link is closed, headLen:%d recvLen:%d", pThreadObj->label, pFdObj->thandle,
+               pFdObj, pFdObj->headLen, pFdObj->recvLen);
+        return -1;
+      } else if (retLen < 0) {
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+
+        tDebug("%s %p read error, FD:%p reason:%s", pThreadObj->label, pFdObj->thandle, pFdObj, strerror(errno));
+        return -1;
+      }
 
-  if (pFdObj->closedByApp) {
-    free(buffer);
-    return -1;
-  }
+      if (pFdObj->buffer == NULL) {
+        pFdObj->headLen += retLen;
+      } else {
+        pFdObj->recvLen += retLen;
+      }
 
-  return 0;
+      if (retLen < expectLen) {
+        // the socket buffer is drained
+        if (TCP_READS_PER_EVENT > 1) return 0;
+        continue;
+      }
+    }
+
+    if (pFdObj->buffer == NULL) {
+      if (taosAllocTcpRecvBuffer(pFdObj) < 0) return -1;
+      continue;
+    }
+
+    // a complete message is received
+    char *buffer = pFdObj->buffer;
+    int32_t msgLen = pFdObj->msgLen;
+    taosResetTcpRecvState(pFdObj);
+
+    if (pFdObj->closedByApp) {
+      free(buffer);
+      return -1;
+    }
+
+    pInfo->msg = buffer + tsRpcOverhead;
+    pInfo->msgLen = msgLen;
+    pInfo->ip = pFdObj->ip;
+    pInfo->port = pFdObj->port;
+    pInfo->shandle = pThreadObj->shandle;
+    pInfo->thandle = pFdObj->thandle;
+    pInfo->chandle = pFdObj;
+    pInfo->connType = RPC_CONN_TCP;
+
+    return 1;
+  }
 }
 
 #define maxEvents 10
@@ -573,13 +640,22 @@ static void *taosProcessTcpData(void *param) {
         continue;
       }
 
-      if (taosReadTcpData(pFdObj, &recvInfo) < 0) {
-        shutdown(pFdObj->fd, SHUT_WR);
-        continue;
+      int32_t reads = 0;
+      while (1) {
+        int ret = taosReadTcpData(pFdObj, &recvInfo, &reads);
+        if (ret < 0) {
+          shutdown(pFdObj->fd, SHUT_WR);
+          break;
+        }
+
+        if (ret == 0) break;
+
+        pFdObj->thandle = (*(pThreadObj->processData))(&recvInfo);
+        if (pFdObj->thandle == NULL) {
+          taosFreeFdObj(pFdObj);
+          break;
+        }
       }
-
-      pFdObj->thandle = (*(pThreadObj->processData))(&recvInfo);
-      if (pFdObj->thandle == NULL) taosFreeFdObj(pFdObj);
     }
 
     if (pThreadObj->stop) break;
@@ -616,7 +692,7 @@ static SFdObj *taosMallocFdObj(SThreadObj *pThreadObj, SOCKET fd) {
   pFdObj->pThreadObj = pThreadObj;
   pFdObj->signature = pFdObj;
 
-  event.events = EPOLLIN | EPOLLRDHUP;
+  event.events = TCP_EPOLL_EVENTS;
   event.data.ptr = pFdObj;
   if (epoll_ctl(pThreadObj->pollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
     tfree(pFdObj);
@@ -672,5 +748,6 @@ static void taosFreeFdObj(SFdObj *pFdObj) {
   tDebug("%s %p TCP connection is closed, FD:%p fd:%d numOfFds:%d",
           pThreadObj->label, pFdObj->thandle, pFdObj, pFdObj->fd, pThreadObj->numOfFds);
 
+  tfree(pFdObj->buffer);
   tfree(pFdObj);
 }
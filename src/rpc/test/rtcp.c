@@ -0,0 +1,326 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "os.h"
+#include "tsocket.h"
+#include "rpcLog.h"
+#include "rpcHead.h"
+#include "rpcTcp.h"
+
+/*
+ * Test of the reading of messages by the TCP server thread, which keeps a partially received message until the rest
+ * arrives: a header and a body received in parts, a message split across many reads, a slow peer which must not hold
+ * back the others served by the same thread, and a peer closing the connection in the middle of a message.
+ *
+ * usage: rtcp [-p port], it exits with 1 if a check fails
+ */
+
+#define WAIT_MS 3000
+#define MAX_MSGS 16
+
+#define CHECK(cond)                                                   \
+  do {                                                                \
+    if (!(cond)) {                                                    \
+      printf("%s:%d, check failed: %s\n", __FILE__, __LINE__, #cond); \
+      numOfFailed++;                                                  \
+    }                                                                 \
+  } while (0)
+
+typedef struct {
+  uint8_t msgType;
+  int32_t msgLen;
+  bool    bodyOK;
+} SRecvMsg;
+
+static int32_t         numOfFailed = 0;
+static pthread_mutex_t recvMutex = PTHREAD_MUTEX_INITIALIZER;
+static SRecvMsg        recvMsgs[MAX_MSGS];
+static int32_t         numOfMsgs = 0;
+static int32_t         numOfBroken = 0;
+
+static void *processTcpData(SRecvInfo *pRecv) {
+  pthread_mutex_lock(&recvMutex);
+
+  if (pRecv->msg == NULL) {
+    numOfBroken++;
+  } else {
+    SRpcHead *pHead = (SRpcHead *)pRecv->msg;
+    SRecvMsg *pMsg = &recvMsgs[numOfMsgs % MAX_MSGS];
+    pMsg->msgType = pHead->msgType;
+    pMsg->msgLen = pRecv->msgLen;
+    pMsg->bodyOK = ((int32_t)htonl(pHead->msgLen) == pRecv->msgLen);
+    for (int32_t i = 0; i < pRecv->msgLen - (int32_t)sizeof(SRpcHead); ++i) {
+      if (pHead->content[i] != (uint8_t)(pHead->msgType + i)) pMsg->bodyOK = false;
+    }
+    numOfMsgs++;
+    free((char *)pRecv->msg - tsRpcOverhead);
+  }
+
+  pthread_mutex_unlock(&recvMutex);
+
+  // any handle other than NULL keeps the connection
+  return &recvMutex;
+}
+
+static int32_t getNumOfMsgs() {
+  pthread_mutex_lock(&recvMutex);
+  int32_t num = numOfMsgs;
+  pthread_mutex_unlock(&recvMutex);
+  return num;
+}
+
+static int32_t getNumOfBroken() {
+  pthread_mutex_lock(&recvMutex);
+  int32_t num = numOfBroken;
+  pthread_mutex_unlock(&recvMutex);
+  return num;
+}
+
+static bool waitForMsgs(int32_t num) {
+  for (int32_t ms = 0; ms < WAIT_MS; ms += 10) {
+    if (getNumOfMsgs() >= num) return true;
+    taosMsleep(10);
+  }
+  return false;
+}
+
+static bool waitForBroken(int32_t num) {
+  for (int32_t ms = 0; ms < WAIT_MS; ms += 10) {
+    if (getNumOfBroken() >= num) return true;
+    taosMsleep(10);
+  }
+  return false;
+}
+
+// the message received at idx has the type and the length it was sent with, and a body as built by buildMsg
+static bool recvMsgIs(int32_t idx, uint8_t msgType, int32_t bodyLen) {
+  pthread_mutex_lock(&recvMutex);
+  SRecvMsg msg = recvMsgs[idx % MAX_MSGS];
+  pthread_mutex_unlock(&recvMutex);
+
+  return msg.msgType == msgType && msg.msgLen == (int32_t)sizeof(SRpcHead) + bodyLen && msg.bodyOK;
+}
+
+static char *buildMsg(uint8_t msgType, int32_t bodyLen, int32_t *pLen) {
+  int32_t   len = sizeof(SRpcHead) + bodyLen;
+  char     *pMsg = calloc(1, len);
+  SRpcHead *pHead = (SRpcHead *)pMsg;
+
+  pHead->msgType = msgType;
+  pHead->msgLen = (int32_t)htonl(len);
+  for (int32_t i = 0; i < bodyLen; ++i) {
+    pHead->content[i] = (uint8_t)(msgType + i);
+  }
+
+  *pLen = len;
+  return pMsg;
+}
+
+static SOCKET connectTo(uint16_t port) {
+  SOCKET fd = taosOpenTcpClientSocket(inet_addr("127.0.0.1"), port, 0);
+  if (fd < 0) {
+    printf("failed to connect to port:%d\n", port);
+    exit(1);
+  }
+
+  // each write goes out on its own
+  int32_t noDelay = 1;
+  taosSetSockOpt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+  return fd;
+}
+
+// send the bytes from offset to offset+len, then leave the time to the server to read them
+static void sendPart(SOCKET fd, char *pMsg, int32_t offset, int32_t len) {
+  CHECK(taosWriteMsg(fd, pMsg + offset, len) == len);
+  taosMsleep(50);
+}
+
+static void testPartialHeadAndBody(uint16_t port) {
+  int32_t base = getNumOfMsgs();
+  int32_t len;
+  char   *pMsg = buildMsg(1, 1000, &len);
+  SOCKET  fd = connectTo(port);
+
+  sendPart(fd, pMsg, 0, 10);
+  CHECK(getNumOfMsgs() == base);
+
+  sendPart(fd, pMsg, 10, sizeof(SRpcHead) - 10 + 300);
+  CHECK(getNumOfMsgs() == base);
+
+  sendPart(fd, pMsg, sizeof(SRpcHead) + 300, len - sizeof(SRpcHead) - 300);
+  CHECK(waitForMsgs(base + 1));
+  CHECK(recvMsgIs(base, 1, 1000));
+
+  // a message with no body
+  free(pMsg);
+  pMsg = buildMsg(2, 0, &len);
+  sendPart(fd, pMsg, 0, 20);
+  sendPart(fd, pMsg, 20, len - 20);
+  CHECK(waitForMsgs(base + 2));
+  CHECK(recvMsgIs(base + 1, 2, 0));
+
+  CHECK(getNumOfMsgs() == base + 2);
+  CHECK(getNumOfBroken() == 0);
+
+  free(pMsg);
+  taosCloseSocket(fd);
+  CHECK(waitForBroken(1));
+}
+
+static void testManyReads(uint16_t port) {
+  int32_t base = getNumOfMsgs();
+  int32_t broken = getNumOfBroken();
+  int32_t len;
+  char   *pMsg = buildMsg(3, 2000, &len);
+  SOCKET  fd = connectTo(port);
+
+  // 7 bytes per write, so the header is read in 7 parts and the body in about 300
+  for (int32_t offset = 0; offset < len; offset += 7) {
+    CHECK(taosWriteMsg(fd, pMsg + offset, MIN(7, len - offset)) == MIN(7, len - offset));
+    if (offset % 70 == 0) taosMsleep(1);
+  }
+  CHECK(waitForMsgs(base + 1));
+  CHECK(recvMsgIs(base, 3, 2000));
+
+  // the messages in a single write are all read by the events of the socket
+  int32_t len1, len2, len3;
+  char   *pMsg1 = buildMsg(4, 100, &len1);
+  char   *pMsg2 = buildMsg(5, 0, &len2);
+  char   *pMsg3 = buildMsg(6, 5000, &len3);
+  char   *pAll = malloc(len1 + len2 + len3);
+  memcpy(pAll, pMsg1, len1);
+  memcpy(pAll + len1, pMsg2, len2);
+  memcpy(pAll + len1 + len2, pMsg3, len3);
+  CHECK(taosWriteMsg(fd, pAll, len1 + len2 + len3) == len1 + len2 + len3);
+
+  CHECK(waitForMsgs(base + 4));
+  CHECK(recvMsgIs(base + 1, 4, 100));
+  CHECK(recvMsgIs(base + 2, 5, 0));
+  CHECK(recvMsgIs(base + 3, 6, 5000));
+  CHECK(getNumOfBroken() == broken);
+
+  free(pAll);
+  free(pMsg1);
+  free(pMsg2);
+  free(pMsg3);
+  free(pMsg);
+  taosCloseSocket(fd);
+  CHECK(waitForBroken(broken + 1));
+}
+
+static void testSlowPeer(uint16_t port) {
+  int32_t base = getNumOfMsgs();
+  int32_t broken = getNumOfBroken();
+  int32_t slowLen, fastLen;
+  char   *pSlow = buildMsg(7, 3000, &slowLen);
+  char   *pFast = buildMsg(8, 500, &fastLen);
+  SOCKET  slowFd = connectTo(port);
+  SOCKET  fastFd = connectTo(port);
+
+  // the messages of the other connection are read while the slow one has half of its message sent
+  sendPart(slowFd, pSlow, 0, slowLen / 2);
+  sendPart(fastFd, pFast, 0, fastLen);
+  CHECK(waitForMsgs(base + 1));
+  CHECK(recvMsgIs(base, 8, 500));
+
+  sendPart(fastFd, pFast, 0, fastLen);
+  CHECK(waitForMsgs(base + 2));
+  CHECK(recvMsgIs(base + 1, 8, 500));
+
+  sendPart(slowFd, pSlow, slowLen / 2, slowLen - slowLen / 2);
+  CHECK(waitForMsgs(base + 3));
+  CHECK(recvMsgIs(base + 2, 7, 3000));
+  CHECK(getNumOfBroken() == broken);
+
+  free(pSlow);
+  free(pFast);
+  taosCloseSocket(slowFd);
+  taosCloseSocket(fastFd);
+  CHECK(waitForBroken(broken + 2));
+}
+
+static void testPeerClose(uint16_t port) {
+  int32_t base = getNumOfMsgs();
+  int32_t broken = getNumOfBroken();
+  int32_t len;
+  char   *pMsg = buildMsg(9, 4000, &len);
+
+  // closed in the middle of the header
+  SOCKET fd = connectTo(port);
+  sendPart(fd, pMsg, 0, 10);
+  taosCloseSocket(fd);
+  CHECK(waitForBroken(broken + 1));
+
+  // closed in the middle of the body
+  fd = connectTo(port);
+  sendPart(fd, pMsg, 0, sizeof(SRpcHead) + 1000);
+  taosCloseSocket(fd);
+  CHECK(waitForBroken(broken + 2));
+
+  // a complete message, then a part of the next one
+  fd = connectTo(port);
+  sendPart(fd, pMsg, 0, len);
+  CHECK(waitForMsgs(base + 1));
+  sendPart(fd, pMsg, 0, len - 1);
+  taosCloseSocket(fd);
+  CHECK(waitForBroken(broken + 3));
+
+  // no partial message is handed over
+  taosMsleep(100);
+  CHECK(getNumOfMsgs() == base + 1);
+  CHECK(recvMsgIs(base, 9, 4000));
+  CHECK(getNumOfBroken() == broken + 3);
+
+  free(pMsg);
+}
+
+int main(int argc, char *argv[]) {
+  uint16_t port = 7400;
+
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-p") == 0 && i < argc - 1) {
+      port = (uint16_t)atoi(argv[++i]);
+    } else {
+      printf("\nusage: %s [options] \n", argv[0]);
+      printf("  [-p port]: server port number, default is:%d\n", port);
+      exit(0);
+    }
+  }
+
+  taosInitLog("rtcp.log", 100000, 10);
+
+  // a single thread serves all the connections
+  void *pServer = taosInitTcpServer(inet_addr("127.0.0.1"), port, "TCP", 1, processTcpData, NULL);
+  if (pServer == NULL) {
+    printf("failed to init TCP server on port:%d\n", port);
+    exit(1);
+  }
+
+  testPartialHeadAndBody(port);
+  testManyReads(port);
+  testSlowPeer(port);
+  testPeerClose(port);
+
+  taosStopTcpServer(pServer);
+  taosCleanUpTcpServer(pServer);
+
+  if (numOfFailed > 0) {
+    printf("%d checks failed\n", numOfFailed);
+    return 1;
+  }
+
+  printf("all checks passed\n");
+  return 0;
+}
@@ -36,6 +36,9 @@ extern "C" {
 #define SYNC_RECV_BUFFER_SIZE (5*1024*1024)
 
 #define SYNC_MAX_FWDS 4096
+#define SYNC_FWD_THREADS 2
+#define SYNC_MAX_FWD_BUFFER_SIZE (4 * SYNC_MAX_SIZE)  // max bytes of forwards not sent to a peer
+#define SYNC_FWD_BUFFER_SIZE (1024 * 1024)            // larger forward buffers are freed once they are sent
 #define SYNC_FWD_TIMER 300
 #define SYNC_ROLE_TIMER 15000             // ms
 #define SYNC_CHECK_INTERVAL 1000          // ms
@@ -92,6 +95,15 @@ typedef struct SsyncPeer {
   void *   timer;
   void *   pConn;
   struct   SSyncNode *pSyncNode;
+  pthread_mutex_t fwdMutex;    // protects the forwards appended by the write thread
+  char *   fwdBuf;             // forwards appended but not taken by the forward thread
+  int32_t  fwdLen;
+  int32_t  fwdSize;
+  int32_t  fwdNum;             // number of the forwards in fwdBuf
+  int8_t   fwdQueued;          // the peer is in the queue of its forward thread
+  char *   sendBuf;            // forwards being sent by the forward thread
+  int32_t  sendSize;
+  pthread_mutex_t writeMutex;  // serializes the messages written to peerFd
 } SSyncPeer;
 
 typedef struct SSyncNode {
@@ -126,6 +138,7 @@ typedef struct SSyncNode {
 extern int32_t tsSyncNum;
 extern char    tsNodeFqdn[TSDB_FQDN_LEN];
 extern char *  syncStatus[];
+extern char *  syncRole[];
 
 void *     syncRetrieveData(void *param);
 void *     syncRestoreData(void *param);
@@ -135,6 +148,11 @@ void       syncBroadcastStatus(SSyncNode *pNode);
 uint32_t   syncResolvePeerFqdn(SSyncPeer *pPeer);
 SSyncPeer *syncAcquirePeer(int64_t rid);
 void       syncReleasePeer(SSyncPeer *pPeer);
+int32_t    syncOpenFwdThreads();
+void       syncCloseFwdThreads();
+int32_t    syncAppendFwd(SSyncPeer *pPeer, SWalHead *pHead);
+void       syncClearFwds(SSyncPeer *pPeer);
+int32_t    syncWritePeerMsg(SSyncPeer *pPeer, SOCKET fd, void *buf, int32_t len);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE
+#include "os.h"
+#include "tulog.h"
+#include "tutil.h"
+#include "tarray.h"
+#include "tsocket.h"
+#include "taoserror.h"
+#include "twal.h"
+#include "tsync.h"
+#include "syncInt.h"
+
+/*
+ * The forwards of the master are appended to the forward buffer of each peer by the write thread, and written to the
+ * peer by a forward thread. All the forwards appended since the last write are sent in one write, each one still
+ * framed by its own SSyncHead, so the peer reads them as before.
+ */
+typedef struct {
+  pthread_t       thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t  cond;
+  SArray *        peers;  // rid of the peers with forwards to send
+  int8_t          stop;
+} SFwdThread;
+
+static SFwdThread *tsFwdThreads = NULL;
+
+static void *syncSendFwds(void *param);
+
+int32_t syncOpenFwdThreads() {
+  tsFwdThreads = calloc(SYNC_FWD_THREADS, sizeof(SFwdThread));
+  if (tsFwdThreads == NULL) return -1;
+
+  for (int32_t i = 0; i < SYNC_FWD_THREADS; ++i) {
+    SFwdThread *pThread = tsFwdThreads + i;
+    pthread_mutex_init(&pThread->mutex, NULL);
+    pthread_cond_init(&pThread->cond, NULL);
+
+    pThread->peers = taosArrayInit(16, sizeof(int64_t));
+    if (pThread->peers == NULL) return -1;
+
+    pthread_attr_t thattr;
+    pthread_attr_init(&thattr);
+    pthread_attr_setdetachstate(&thattr, PTHREAD_CREATE_JOINABLE);
+    int32_t ret = pthread_create(&pThread->thread, &thattr, syncSendFwds, pThread);
+    pthread_attr_destroy(&thattr);
+
+    if (ret != 0) {
+      sError("failed to create forward thread since %s", strerror(ret));
+      taosArrayDestroy(&pThread->peers);
+      return -1;
+    }
+  }
+
+  sDebug("%d forward threads are created", SYNC_FWD_THREADS);
+  return 0;
+}
+
+void syncCloseFwdThreads() {
+  if (tsFwdThreads == NULL) return;
+
+  for (int32_t i = 0; i < SYNC_FWD_THREADS; ++i) {
+    SFwdThread *pThread = tsFwdThreads + i;
+    if (pThread->peers == NULL) continue;  // the thread is not created
+
+    pthread_mutex_lock(&pThread->mutex);
+    pThread->stop = 1;
+    pthread_cond_signal(&pThread->cond);
+    pthread_mutex_unlock(&pThread->mutex);
+
+    pthread_join(pThread->thread, NULL);
+    taosArrayDestroy(&pThread->peers);
+    pthread_cond_destroy(&pThread->cond);
+    pthread_mutex_destroy(&pThread->mutex);
+  }
+
+  tfree(tsFwdThreads);
+  sDebug("forward threads are closed");
+}
+
+int32_t syncAppendFwd(SSyncPeer *pPeer, SWalHead *pHead) {
+  SSyncNode *pNode = pPeer->pSyncNode;
+  int32_t    len = (int32_t)(sizeof(SSyncHead) + sizeof(SWalHead)) + pHead->len;
+
+  pthread_mutex_lock(&pPeer->fwdMutex);
+
+  if (pPeer->fwdLen + len > SYNC_MAX_FWD_BUFFER_SIZE) {
+    pthread_mutex_unlock(&pPeer->fwdMutex);
+    sError("%s, failed to forward since %d bytes are not sent, hver:%" PRIu64, pPeer->id, pPeer->fwdLen,
+           pHead->version);
+    return TSDB_CODE_SYN_TOO_MANY_FWDINFO;
+  }
+
+  if (pPeer->fwdLen + len > pPeer->fwdSize) {
+    int32_t size = MAX(pPeer->fwdSize * 2, pPeer->fwdLen + len);
+    char *  buf = realloc(pPeer->fwdBuf, size);
+    if (buf == NULL) {
+      pthread_mutex_unlock(&pPeer->fwdMutex);
+      return TSDB_CODE_COM_OUT_OF_MEMORY;
+    }
+
+    pPeer->fwdBuf = buf;
+    pPeer->fwdSize = size;
+  }
+
+  SSyncHead *pSyncHead = (SSyncHead *)(pPeer->fwdBuf + pPeer->fwdLen);
+  syncBuildSyncFwdMsg(pSyncHead, pNode->vgId, (int32_t)sizeof(SWalHead) + pHead->len);
+  memcpy(pSyncHead + 1, pHead, sizeof(SWalHead) + pHead->len);
+  pPeer->fwdLen += len;
+  pPeer->fwdNum += 1;
+
+  bool queued = pPeer->fwdQueued;
+  pPeer->fwdQueued = 1;
+
+  pthread_mutex_unlock(&pPeer->fwdMutex);
+
+  // the forward thread sends the forwards of a peer in the order they are appended
+  if (!queued) {
+    SFwdThread *pThread = tsFwdThreads + pPeer->rid % SYNC_FWD_THREADS;
+    pthread_mutex_lock(&pThread->mutex);
+    taosArrayPush(pThread->peers, &pPeer->rid);
+    pthread_cond_signal(&pThread->cond);
+    pthread_mutex_unlock(&pThread->mutex);
+  }
+
+  return 0;
+}
+
+void syncClearFwds(SSyncPeer *pPeer) {
+  pthread_mutex_lock(&pPeer->fwdMutex);
+  pPeer->fwdLen = 0;
+  pPeer->fwdNum = 0;
+  if (pPeer->fwdSize > SYNC_FWD_BUFFER_SIZE) {
+    tfree(pPeer->fwdBuf);
+    pPeer->fwdSize = 0;
+  }
+  pthread_mutex_unlock(&pPeer->fwdMutex);
+}
+
+int32_t syncWritePeerMsg(SSyncPeer *pPeer, SOCKET fd, void *buf, int32_t len) {
+  pthread_mutex_lock(&pPeer->writeMutex);
+  int32_t retLen = taosWriteMsg(fd, buf, len);
+  pthread_mutex_unlock(&pPeer->writeMutex);
+
+  return retLen;
+}
+
+static void syncSendPeerFwds(int64_t rid) {
+  SSyncPeer *pPeer = syncAcquirePeer(rid);
+  if (pPeer == NULL) return;
+
+  SSyncNode *pNode = pPeer->pSyncNode;
+
+  // take the forwards appended so far, the write thread goes on appending to the other buffer
+  pthread_mutex_lock(&pPeer->fwdMutex);
+  SWAP(pPeer->fwdBuf, pPeer->sendBuf, char *);
+  SWAP(pPeer->fwdSize, pPeer->sendSize, int32_t);
+  int32_t len = pPeer->fwdLen;
+  int32_t num = pPeer->fwdNum;
+  pPeer->fwdLen = 0;
+  pPeer->fwdNum = 0;
+  pPeer->fwdQueued = 0;
+  pthread_mutex_unlock(&pPeer->fwdMutex);
+
+  SOCKET peerFd = pPeer->peerFd;
+  if (len > 0 && peerFd >= 0) {
+    int32_t retLen = syncWritePeerMsg(pPeer, peerFd, pPeer->sendBuf, len);
+    if (retLen == len) {
+      sTrace("%s, %d forwards are sent, role:%s sstatus:%s len:%d", pPeer->id, num, syncRole[pPeer->role],
+             syncStatus[pPeer->sstatus], len);
+    } else {
+      sError("%s, failed to forward, role:%s sstatus:%s len:%d retLen:%d", pPeer->id, syncRole[pPeer->role],
+             syncStatus[pPeer->sstatus], len, retLen);
+      pthread_mutex_lock(&pNode->mutex);
+      syncRestartConnection(pPeer);
+      pthread_mutex_unlock(&pNode->mutex);
+    }
+  }
+
+  // the buffer grown by a burst of forwards is not kept, it is only taken by this thread
+  if (pPeer->sendSize > SYNC_FWD_BUFFER_SIZE) {
+    tfree(pPeer->sendBuf);
+    pPeer->sendSize = 0;
+  }
+
+  syncReleasePeer(pPeer);
+}
+
+static void *syncSendFwds(void *param) {
+  SFwdThread *pThread = param;
+  setThreadName("syncFwd");
+
+  SArray *peers = taosArrayInit(16, sizeof(int64_t));
+  if (peers == NULL) {
+    sError("failed to start forward thread since no enough memory");
+    return NULL;
+  }
+
+  while (1) {
+    pthread_mutex_lock(&pThread->mutex);
+    while (taosArrayGetSize(pThread->peers) == 0 && !pThread->stop) {
+      pthread_cond_wait(&pThread->cond, &pThread->mutex);
+    }
+
+    if (pThread->stop) {
+      pthread_mutex_unlock(&pThread->mutex);
+      break;
+    }
+
+    SWAP(pThread->peers, peers, SArray *);
+    pthread_mutex_unlock(&pThread->mutex);
+
+    size_t num = taosArrayGetSize(peers);
+    for (size_t i = 0; i < num; ++i) {
+      syncSendPeerFwds(*(int64_t *)taosArrayGet(peers, i));
+    }
+
+    taosArrayClear(peers);
+  }
+
+  taosArrayDestroy(&peers);
+  return NULL;
+}
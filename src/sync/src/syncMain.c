@@ -98,6 +98,12 @@ int32_t syncInit() {
     return -1;
   }
 
+  if (syncOpenFwdThreads() != 0) {
+    sError("failed to init forward threads");
+    syncCleanUp();
+    return -1;
+  }
+
   tsSyncTmrCtrl = taosTmrInit(1000, 50, 10000, "SYNC");
   if (tsSyncTmrCtrl == NULL) {
     sError("failed to init tmrCtrl");
@@ -138,6 +144,8 @@ void syncCleanUp() {
     tsTcpPool = NULL;
   }
 
+  syncCloseFwdThreads();
+
   if (tsSyncTmrCtrl != NULL) {
     taosTmrCleanUp(tsSyncTmrCtrl);
     tsSyncTmrCtrl = NULL;
@@ -398,7 +406,7 @@ void syncConfirmForward(int64_t rid, uint64_t _version, int32_t code, bool force
     SFwdRsp rsp;
     syncBuildSyncFwdRsp(&rsp, pNode->vgId, _version, code);
 
-    if (taosWriteMsg(pPeer->peerFd, &rsp, sizeof(SFwdRsp)) == sizeof(SFwdRsp)) {
+    if (syncWritePeerMsg(pPeer, pPeer->peerFd, &rsp, sizeof(SFwdRsp)) == sizeof(SFwdRsp)) {
       sTrace("%s, forward-rsp is sent, code:0x%x hver:%" PRIu64, pPeer->id, code, _version);
     } else {
       sDebug("%s, failed to send forward-rsp, restart", pPeer->id);
@@ -523,6 +531,10 @@ static void syncFreePeer(void *param) {
   sDebug("%s, peer is freed, refCount:%d", pPeer->id, pPeer->refCount);
 
   syncReleaseNode(pPeer->pSyncNode);
+  pthread_mutex_destroy(&pPeer->fwdMutex);
+  pthread_mutex_destroy(&pPeer->writeMutex);
+  tfree(pPeer->fwdBuf);
+  tfree(pPeer->sendBuf);
   tfree(pPeer);
 }
 
@@ -550,6 +562,7 @@ static void syncClosePeerConn(SSyncPeer *pPeer) {
 
   taosTmrStopA(&pPeer->timer);
   taosCloseSocket(pPeer->syncFd);
+  syncClearFwds(pPeer);  // the forwards not sent are recovered by the sync of the new connection
   if (pPeer->peerFd >= 0) {
     pPeer->peerFd = -1;
     void *pConn = pPeer->pConn;
@@ -624,6 +637,8 @@ static SSyncPeer *syncAddPeer(SSyncNode *pNode, const SNodeInfo *pInfo) {
   pPeer->role = TAOS_SYNC_ROLE_OFFLINE;
   pPeer->pSyncNode = pNode;
   pPeer->refCount = 1;
+  pthread_mutex_init(&pPeer->fwdMutex, NULL);
+  pthread_mutex_init(&pPeer->writeMutex, NULL);
   pPeer->rid = taosAddRef(tsPeerRefId, pPeer);
 
   sInfo("%s, %p it is configured, ep:%s:%u rid:%" PRId64, pPeer->id, pPeer, pPeer->fqdn, pPeer->port, pPeer->rid);
@@ -1044,7 +1059,7 @@ static void syncRecoverFromMaster(SSyncPeer *pPeer) {
 
   taosTmrReset(syncNotStarted, tsSyncCheckInterval, (void *)pPeer->rid, tsSyncTmrCtrl, &pPeer->timer);
 
-  if (taosWriteMsg(pPeer->peerFd, &msg, sizeof(SSyncMsg)) != sizeof(SSyncMsg)) {
+  if (syncWritePeerMsg(pPeer, pPeer->peerFd, &msg, sizeof(SSyncMsg)) != sizeof(SSyncMsg)) {
     sError("%s, failed to send sync-req to peer", pPeer->id);
   } else {
     sInfo("%s, sync-req is sent to peer, tranId:%u, sstatus:%s", pPeer->id, msg.tranId, syncStatus[nodeSStatus]);
@@ -1057,17 +1072,22 @@ static void syncProcessFwdResponse(SFwdRsp *pFwdRsp, SSyncPeer *pPeer) {
   SFwdInfo * pFwdInfo;
 
   sTrace("%s, forward-rsp is received, code:%x hver:%" PRIu64, pPeer->id, pFwdRsp->code, pFwdRsp->version);
-  SFwdInfo *pFirst = pSyncFwds->fwdInfo + pSyncFwds->first;
-
-  if (pFirst->version <= pFwdRsp->version && pSyncFwds->fwds > 0) {
-    // find the forwardInfo from first
-    for (int32_t i = 0; i < pSyncFwds->fwds; ++i) {
-      pFwdInfo = pSyncFwds->fwdInfo + (i + pSyncFwds->first) % SYNC_MAX_FWDS;
-      if (pFwdRsp->version == pFwdInfo->version) {
-        syncProcessFwdAck(pNode, pFwdInfo, pFwdRsp->code);
-        syncRemoveConfirmedFwdInfo(pNode);
-        return;
-      }
+
+  // the forward infos are saved in the order of version, find the forwardInfo by binary search
+  int32_t low = 0;
+  int32_t high = pSyncFwds->fwds - 1;
+  while (low <= high) {
+    int32_t mid = low + (high - low) / 2;
+    pFwdInfo = pSyncFwds->fwdInfo + (mid + pSyncFwds->first) % SYNC_MAX_FWDS;
+
+    if (pFwdRsp->version == pFwdInfo->version) {
+      syncProcessFwdAck(pNode, pFwdInfo, pFwdRsp->code);
+      syncRemoveConfirmedFwdInfo(pNode);
+      return;
+    } else if (pFwdInfo->version < pFwdRsp->version) {
+      low = mid + 1;
+    } else {
+      high = mid - 1;
     }
   }
 }
@@ -1196,7 +1216,7 @@ static int32_t syncSendPeersStatusMsgToPeer(SSyncPeer *pPeer, char ack, int8_t t
     msg.peersStatus[i].version = pNode->peerInfo[i]->version;
   }
 
-  if (taosWriteMsg(pPeer->peerFd, &msg, sizeof(SPeersStatus)) == sizeof(SPeersStatus)) {
+  if (syncWritePeerMsg(pPeer, pPeer->peerFd, &msg, sizeof(SPeersStatus)) == sizeof(SPeersStatus)) {
     sDebug("%s, status is sent, self:%s:%s:%" PRIu64 ", peer:%s:%s:%" PRIu64 ", ack:%d tranId:%u type:%s pfd:%d",
            pPeer->id, syncRole[nodeRole], syncStatus[nodeSStatus], nodeVersion, syncRole[pPeer->role],
            syncStatus[pPeer->sstatus], pPeer->version, ack, tranId, statusType[type], pPeer->peerFd);
@@ -1536,9 +1556,7 @@ static void syncMonitorFwdInfos(void *param, void *tmrId) {
 
 static int32_t syncForwardToPeerImpl(SSyncNode *pNode, void *data, void *mhandle, int32_t qtype, bool force) {
   SSyncPeer *pPeer;
-  SSyncHead *pSyncHead;
   SWalHead * pWalHead = data;
-  int32_t    fwdLen;
   int32_t    code = 0;
 
   if (pWalHead->version > nodeVersion + 1) {
@@ -1566,11 +1584,6 @@ static int32_t syncForwardToPeerImpl(SSyncNode *pNode, void *data, void *mhandle
   // only msg from RPC or CQ can be forwarded
   if (qtype != TAOS_QTYPE_RPC && qtype != TAOS_QTYPE_CQ) return 0;
 
-    // a hacker way to improve the performance
-  pSyncHead = (SSyncHead *)(((char *)pWalHead) - sizeof(SSyncHead));
-  syncBuildSyncFwdMsg(pSyncHead, pNode->vgId, sizeof(SWalHead) + pWalHead->len);
-  fwdLen = pSyncHead->len + sizeof(SSyncHead);  // include the WAL and SYNC head
-
   pthread_mutex_lock(&pNode->mutex);
 
   for (int32_t i = 0; i < pNode->replica; ++i) {
@@ -1588,16 +1601,13 @@ static int32_t syncForwardToPeerImpl(SSyncNode *pNode, void *data, void *mhandle
       }
     }
 
-    SOCKET peerFd = pPeer->peerFd;
-    pthread_mutex_unlock(&pNode->mutex);
-    int32_t retLen = taosWriteMsg(peerFd, pSyncHead, fwdLen);
-    pthread_mutex_lock(&pNode->mutex);
-    if (retLen == fwdLen) {
-      sTrace("%s, forward is sent, role:%s sstatus:%s hver:%" PRIu64 " contLen:%d", pPeer->id, syncRole[pPeer->role],
-             syncStatus[pPeer->sstatus], pWalHead->version, pWalHead->len);
+    // the forward is sent by the forward thread, so a slow peer does not block the write thread
+    if (syncAppendFwd(pPeer, pWalHead) == 0) {
+      sTrace("%s, forward is appended, role:%s sstatus:%s hver:%" PRIu64 " contLen:%d", pPeer->id,
+             syncRole[pPeer->role], syncStatus[pPeer->sstatus], pWalHead->version, pWalHead->len);
     } else {
-      sError("%s, failed to forward, role:%s sstatus:%s hver:%" PRIu64 " retLen:%d", pPeer->id, syncRole[pPeer->role],
-             syncStatus[pPeer->sstatus], pWalHead->version, retLen);
+      sError("%s, failed to forward, role:%s sstatus:%s hver:%" PRIu64, pPeer->id, syncRole[pPeer->role],
+             syncStatus[pPeer->sstatus], pWalHead->version);
       syncRestartConnection(pPeer);
     }
   }
@@ -170,7 +170,11 @@ static int32_t syncReadOneWalRecord(int32_t sfd, SWalHead *pHead) {
   return sizeof(SWalHead) + pHead->len;
 }
 
-static int64_t syncRetrieveLastWal(SSyncPeer *pPeer, char *name, uint64_t fversion, int64_t offset) {
+/*
+ * Send the records of a wal file from offset, until the end of the file or the record of fversion. The compressed
+ * records are decompressed, so the peer always gets the records forwarded. Returns the bytes of the file sent.
+ */
+static int64_t syncRetrieveWalFile(SSyncPeer *pPeer, char *name, uint64_t fversion, int64_t offset) {
   int32_t sfd = open(name, O_RDONLY | O_BINARY);
   if (sfd < 0) {
     sError("%s, failed to open wal:%s for retrieve since:%s", pPeer->id, name, tstrerror(errno));
@@ -184,12 +188,13 @@ static int64_t syncRetrieveLastWal(SSyncPeer *pPeer, char *name, uint64_t fversi
     return -1;
   }
 
-  sInfo("%s, retrieve last wal:%s, offset:%" PRId64 " fver:%" PRIu64, pPeer->id, name, offset, fversion);
+  sInfo("%s, retrieve wal:%s, offset:%" PRId64 " fver:%" PRIu64, pPeer->id, name, offset, fversion);
 
   SWalHead *pHead = malloc(SYNC_MAX_SIZE);
+  void *    pBuf = malloc(SYNC_MAX_SIZE);
   int64_t   bytes = 0;
 
-  while (1) {
+  while (pHead != NULL && pBuf != NULL) {
     code = syncReadOneWalRecord(sfd, pHead);
     if (code < 0) {
       sError("%s, failed to read one record from wal:%s", pPeer->id, name);
@@ -202,27 +207,41 @@ static int64_t syncRetrieveLastWal(SSyncPeer *pPeer, char *name, uint64_t fversi
       break;
     }
 
-    sTrace("%s, last wal is forwarded, hver:%" PRIu64, pPeer->id, pHead->version);
+    int32_t   readLen = (int32_t)code;
+    SWalHead *pSend = walDecompressRecord(pHead, pBuf);
+    if (pSend == NULL) {
+      code = -1;
+      sError("%s, failed to decompress wal:%s, hver:%" PRIu64 " len:%d", pPeer->id, name, pHead->version, pHead->len);
+      break;
+    }
+
+    sTrace("%s, wal is forwarded, hver:%" PRIu64, pPeer->id, pSend->version);
 
-    int32_t wsize = (int32_t)code;
-    int32_t ret = taosWriteMsg(pPeer->syncFd, pHead, wsize);
+    int32_t wsize = (int32_t)sizeof(SWalHead) + pSend->len;
+    int32_t ret = taosWriteMsg(pPeer->syncFd, pSend, wsize);
     if (ret != wsize) {
       code = -1;
-      sError("%s, failed to forward wal since %s, hver:%" PRIu64, pPeer->id, strerror(errno), pHead->version);
+      sError("%s, failed to forward wal since %s, hver:%" PRIu64, pPeer->id, strerror(errno), pSend->version);
       break;
     }
 
-    pPeer->sversion = pHead->version;
-    bytes += wsize;
+    pPeer->sversion = pSend->version;
+    bytes += readLen;
 
-    if (pHead->version >= fversion && fversion > 0) {
+    if (pSend->version >= fversion && fversion > 0) {
       code = 0;
-      sInfo("%s, retrieve wal finished, hver:%" PRIu64 " fver:%" PRIu64, pPeer->id, pHead->version, fversion);
+      sInfo("%s, retrieve wal finished, hver:%" PRIu64 " fver:%" PRIu64, pPeer->id, pSend->version, fversion);
       break;
     }
   }
 
-  free(pHead);
+  if (pHead == NULL || pBuf == NULL) {
+    code = -1;
+    sError("%s, failed to retrieve wal:%s since no enough memory", pPeer->id, name);
+  }
+
+  tfree(pBuf);
+  tfree(pHead);
   close(sfd);
 
   return code;
@@ -243,7 +262,7 @@ static int64_t syncProcessLastWal(SSyncPeer *pPeer, char *wname, int64_t index)
     if (syncAreFilesModified(pNode, pPeer)) return -1;
     if (syncGetWalVersion(pNode, pPeer) < 0) return -1;
 
-    int64_t bytes = syncRetrieveLastWal(pPeer, fname, fversion, offset);
+    int64_t bytes = syncRetrieveWalFile(pPeer, fname, fversion, offset);
     if (bytes < 0) {
       sInfo("%s, failed to retrieve last wal, bytes:%" PRId64, pPeer->id, bytes);
       return bytes;
@@ -288,7 +307,6 @@ static int64_t syncRetrieveWal(SSyncPeer *pPeer) {
   SSyncNode * pNode = pPeer->pSyncNode;
   char        fname[TSDB_FILENAME_LEN * 3];
   char        wname[TSDB_FILENAME_LEN * 2];
-  int32_t     size;
   int64_t     code = -1;
   int64_t     index = 0;
 
@@ -316,26 +334,9 @@ static int64_t syncRetrieveWal(SSyncPeer *pPeer) {
     // get the full path to wal file
     snprintf(fname, sizeof(fname), "%s/%s", pNode->path, wname);
 
-    // send wal file, old wal file won't be modified, even remove is ok
-    struct stat fstat;
-    if (stat(fname, &fstat) < 0) {
-      code = -1;
-      sInfo("%s, failed to stat wal:%s for retrieve since %s, code:0x%" PRIx64, pPeer->id, fname, strerror(errno), code);
-      break;
-    }
-
-    size = fstat.st_size;
-    sInfo("%s, retrieve wal:%s size:%d", pPeer->id, fname, size);
-
-    int32_t sfd = open(fname, O_RDONLY | O_BINARY);
-    if (sfd < 0) {
-      code = -1;
-      sError("%s, failed to open wal:%s for retrieve since %s, code:0x%" PRIx64, pPeer->id, fname, strerror(errno), code);
-      break;
-    }
-
-    code = taosSendFile(pPeer->syncFd, sfd, NULL, size);
-    close(sfd);
+    // send wal file record by record, old wal file won't be modified, even remove is ok
+    sInfo("%s, retrieve wal:%s", pPeer->id, fname);
+    code = syncRetrieveWalFile(pPeer, fname, 0, 0);
     if (code < 0) {
       sError("%s, failed to send wal:%s for retrieve since %s, code:0x%" PRIx64, pPeer->id, fname, strerror(errno), code);
       break;
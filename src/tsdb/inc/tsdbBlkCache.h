@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TD_TSDB_BLK_CACHE_H_
+#define _TD_TSDB_BLK_CACHE_H_
+
+// Key of a decoded column chunk. The file name hash distinguishes a rewritten .data/.last file of the same fid,
+// since a new file version always comes with a new file name.
+typedef struct {
+  int32_t  fid;
+  uint32_t fnameHash;
+  int64_t  offset;  // offset of the SBlock in .data/.last
+  int16_t  colId;
+  int8_t   last;
+  int8_t   reserved[5];
+} SBlkCacheKey;
+
+typedef struct SBlkCacheNode SBlkCacheNode;
+
+typedef struct {
+  pthread_mutex_t lock;
+  int64_t         capacity;  // memory budget in bytes
+  int64_t         used;      // bytes held by cached column data
+  SHashObj*       map;       // SBlkCacheKey -> SBlkCacheNode*
+  SBlkCacheNode*  head;      // most recently used
+  SBlkCacheNode*  tail;      // least recently used
+} STsdbBlkCache;
+
+STsdbBlkCache* tsdbNewBlkCache(int64_t capacity);
+void           tsdbFreeBlkCache(STsdbBlkCache* pCache);
+void           tsdbInitBlkCacheKey(SBlkCacheKey* pKey, SDFile* pDFile, int fid, SBlock* pBlock, int16_t colId);
+bool           tsdbBlkCacheContains(STsdbBlkCache* pCache, SBlkCacheKey* pKey);
+bool           tsdbGetFromBlkCache(STsdbBlkCache* pCache, SBlkCacheKey* pKey, SDataCol* pDataCol, int numOfRows,
+                                   int maxPoints);
+void           tsdbPutToBlkCache(STsdbBlkCache* pCache, SBlkCacheKey* pKey, SDataCol* pDataCol);
+void           tsdbInvalidateBlkCache(STsdbBlkCache* pCache, int fid);
+
+#endif /* _TD_TSDB_BLK_CACHE_H_ */
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TD_TSDB_HEAD_MAP_H_
+#define _TD_TSDB_HEAD_MAP_H_
+
+// A .head file mapped into memory. The SBlockIdx part is decoded and verified once when the file is mapped, and the
+// SBlockInfo part of a table is verified the first time it is read, so later queries only touch the pages of the
+// tables they scan.
+typedef struct {
+  int        fid;
+  SDFInfo    info;      // info of the mapped .head file
+  char*      fname;
+  int32_t    refCount;  // one by the head map and one by each reader
+  void*      pMap;
+  int64_t    mapLen;
+  SArray*    aBlkIdx;   // decoded SBlockIdx part, ordered by tid
+  int8_t*    verified;  // whether the SBlockInfo of the i-th SBlockIdx has passed the checksum
+} SHeadMapEntry;
+
+typedef struct {
+  pthread_mutex_t lock;
+  SArray*         entries;  // SHeadMapEntry* of the current .head files
+} STsdbHeadMap;
+
+STsdbHeadMap*  tsdbNewHeadMap();
+void           tsdbFreeHeadMap(STsdbHeadMap* pHeadMap);
+SHeadMapEntry* tsdbAcquireHeadMap(STsdbHeadMap* pHeadMap, STsdbRepo* pRepo, SDFile* pHeadf, int fid);
+void           tsdbReleaseHeadMap(SHeadMapEntry* pEntry);
+SBlockInfo*    tsdbGetBlockInfoFromHeadMap(SHeadMapEntry* pEntry, SBlockIdx* pBlkIdx);
+void           tsdbInvalidateHeadMap(STsdbHeadMap* pHeadMap, int fid);
+
+#endif /* _TD_TSDB_HEAD_MAP_H_ */
@@ -27,20 +27,44 @@ typedef struct {
   TSKEY keyLast;
 } SMergeInfo;
 
-typedef struct {
-  STable *           pTable;
-  SSkipListIterator *pIter;
-} SCommitIter;
+#define TSDB_DATA_CHUNK_MIN_ROWS 64
+#define TSDB_DATA_CHUNK_MAX_ROWS 4096
+
+// rows appended in key order, all chunks but the last one are full
+typedef struct STableDataChunk {
+  struct STableDataChunk *prev;
+  struct STableDataChunk *next;
+  int32_t                 capacity;
+  int32_t                 numOfRows;
+  SMemRow                 rows[];
+} STableDataChunk;
 
 struct STableData {
-  uint64_t   uid;
-  TSKEY      keyFirst;
-  TSKEY      keyLast;
-  int64_t    numOfRows;
-  SSkipList* pData;
+  uint64_t         uid;
+  TSKEY            keyFirst;
+  TSKEY            keyLast;
+  int64_t          numOfRows;
+  SSkipList*       pData;   // rows out of key order in append mode, otherwise all rows
+  STableDataChunk* pHead;   // rows appended in key order, keys never overlap with the ones in pData
+  STableDataChunk* pTail;
+  bool             appendMode;
   T_REF_DECLARE()
 };
 
+// iterate the rows of a table in mem, the appended rows and the skiplist are merged by key
+typedef struct {
+  SSkipListIterator slIter;
+  STableDataChunk*  pChunk;  // current appended row is pChunk->rows[idx], NULL if no more
+  int32_t           idx;
+  int32_t           order;
+  bool              started;
+} STableDataIter;
+
+typedef struct {
+  STable *        pTable;
+  STableDataIter *pIter;
+} SCommitIter;
+
 enum { TSDB_UPDATE_META, TSDB_DROP_META };
 
 #ifdef WINDOWS
@@ -69,27 +93,30 @@ void* tsdbAllocBytes(STsdbRepo* pRepo, int bytes);
 // if pCtrlData is NULL, force must be true
 int   tsdbAsyncCommit(STsdbRepo* pRepo, SControlDataInfo* pCtlDataInfo);
 int   tsdbSyncCommitConfig(STsdbRepo* pRepo);
-int   tsdbLoadDataFromCache(STable* pTable, SSkipListIterator* pIter, TSKEY maxKey, int maxRowsToRead, SDataCols* pCols,
+int   tsdbLoadDataFromCache(STable* pTable, STableDataIter* pIter, TSKEY maxKey, int maxRowsToRead, SDataCols* pCols,
                             TKEY* filterKeys, int nFilterKeys, bool keepDup, SMergeInfo* pMergeInfo);
 void* tsdbCommitData(STsdbRepo* pRepo, bool end);
 
-static FORCE_INLINE SMemRow tsdbNextIterRow(SSkipListIterator* pIter) {
-  if (pIter == NULL) return NULL;
+// if pKey is not NULL, the iterator starts from the first row not before it in the given order
+STableDataIter* tsdbCreateTableDataIter(STableData* pTableData, TKEY* pKey, int32_t order);
+bool            tsdbTableDataIterNext(STableDataIter* pIter);
+SMemRow         tsdbTableDataIterGet(STableDataIter* pIter);
+void*           tsdbDestroyTableDataIter(STableDataIter* pIter);
 
-  SSkipListNode* node = tSkipListIterGet(pIter);
-  if (node == NULL) return NULL;
+static FORCE_INLINE SMemRow tsdbNextIterRow(STableDataIter* pIter) {
+  if (pIter == NULL) return NULL;
 
-  return (SMemRow)SL_GET_NODE_DATA(node);
+  return tsdbTableDataIterGet(pIter);
 }
 
-static FORCE_INLINE TSKEY tsdbNextIterKey(SSkipListIterator* pIter) {
+static FORCE_INLINE TSKEY tsdbNextIterKey(STableDataIter* pIter) {
   SMemRow row = tsdbNextIterRow(pIter);
   if (row == NULL) return TSDB_DATA_TIMESTAMP_NULL;
 
   return memRowKey(row);
 }
 
-static FORCE_INLINE TKEY tsdbNextIterTKey(SSkipListIterator* pIter) {
+static FORCE_INLINE TKEY tsdbNextIterTKey(STableDataIter* pIter) {
   SMemRow row = tsdbNextIterRow(pIter);
   if (row == NULL) return TKEY_NULL;
 
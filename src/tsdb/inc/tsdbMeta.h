@@ -26,6 +26,13 @@ typedef struct jsonMapValue{
 
 #pragma  pack (pop)
 
+// Inverted index of a tag column of a super table, from the tag value to the child tables with the value
+typedef struct {
+  int16_t   colId;
+  int8_t    type;
+  SHashObj* map;  // tag value -> SArray<STable*> ordered by the table pointer, NULL values are not indexed
+} STagIndex;
+
 typedef struct STable {
   STableId       tableId;
   ETableType     type;
@@ -36,6 +43,7 @@ typedef struct STable {
   STSchema*      tagSchema;
   SKVRow         tagVal;
   SSkipList*     pIndex;         // For TSDB_SUPER_TABLE, it is the skiplist index
+  SArray*        tagIndex;       // For TSDB_SUPER_TABLE, STagIndex of the other tag columns if tsdbTagIndex is set
   SHashObj*      jsonKeyMap;     // For json tag key  {"key":[t1, t2, t3]}
   void*          eventHandler;   // TODO
   void*          streamHandler;  // TODO
@@ -99,7 +107,10 @@ int        tsdbUpdateLastColSchema(STable *pTable, STSchema *pNewSchema);
 STSchema*  tsdbGetTableLatestSchema(STable *pTable);
 void       tsdbFreeLastColumns(STable* pTable);
 int        tsdbCompareJsonMapValue(const void* a, const void* b);
+int        tsdbCompareTablePtr(const void* a, const void* b);
 void*      tsdbGetJsonTagValue(STable* pTable, char* key, int32_t keyLen, int16_t* colId);
+STagIndex* tsdbGetTagIndex(STable* pSTable, int16_t colId, int8_t type);
+SArray*    tsdbGetTagIndexTables(STagIndex* pTagIdx, const void* val);
 
 static FORCE_INLINE int tsdbCompareSchemaVersion(const void *key1, const void *key2) {
   if (*(int16_t *)key1 < schemaVersion(*(STSchema **)key2)) {
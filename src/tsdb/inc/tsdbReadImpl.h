@@ -175,6 +175,9 @@ struct SReadH {
   void *      pBuf;   // buffer
   void *      pCBuf;  // compression buffer
   void *      pExBuf;  // extra buffer
+  void *      pBlkCache;  // STsdbBlkCache to lookup decoded columns, NULL if not used
+  void *      pHeadMap;   // STsdbHeadMap to share the mapped .head files, NULL if not used
+  void *      pHeadEntry; // SHeadMapEntry of the current file set, NULL if read by pread
 };
 
 #define TSDB_READ_REPO(rh) ((rh)->pRepo)
@@ -227,6 +230,7 @@ int   tsdbLoadBlockData(SReadH *pReadh, SBlock *pBlock, SBlockInfo *pBlockInfo);
 int   tsdbLoadBlockDataCols(SReadH *pReadh, SBlock *pBlock, SBlockInfo *pBlkInfo, int16_t *colIds, int numOfColsIds);
 int   tsdbLoadBlockStatis(SReadH *pReadh, SBlock *pBlock);
 int   tsdbLoadBlockOffset(SReadH *pReadh, SBlock *pBlock);
+void  tsdbPrefetchBlockData(SReadH *pReadh, SBlock *pBlock, SBlockInfo *pBlkInfo, int16_t *colIds, int numOfColIds);
 int   tsdbEncodeSBlockIdx(void **buf, SBlockIdx *pIdx);
 void *tsdbDecodeSBlockIdx(void *buf, SBlockIdx *pIdx);
 void  tsdbGetBlockStatis(SReadH *pReadh, SDataStatis *pStatis, int numOfCols, SBlock *pBlock);
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TD_TSDB_ZONE_MAP_H_
+#define _TD_TSDB_ZONE_MAP_H_
+
+/**
+ * The zone map of a table in a file set is appended to the SBlockInfo part of the table in the .head file, after the
+ * sub-blocks and before the checksum. Readers without the zone map only look at the blocks, so the file stays readable.
+ *
+ * The ranges cover all the rows of the table in the file set, but may also cover rows which are deleted or overwritten
+ * since the zone map is merged with the new blocks on commit. A column missing in the zone map has only NULL values.
+ */
+typedef struct {
+  int16_t colId;
+  int8_t  type;
+  int8_t  reserved[5];
+  int64_t numOfNull;
+  int64_t min;  // same encoding as SAggrBlkCol, only valid if numOfNull < numOfRows
+  int64_t max;
+} SZoneMapCol;
+
+typedef struct {
+  int32_t     delimiter;  // TSDB_FILE_DELIMITER
+  int32_t     numOfCols;
+  int64_t     numOfRows;
+  SZoneMapCol cols[];
+} SZoneMap;
+
+// Builder of the zone map of a table when the SBlockInfo part is rewritten
+typedef struct {
+  bool    unknown;  // the ranges of some rows are not known, no zone map is written
+  int64_t numOfRows;
+  SArray *cols;  // SZoneMapCol ordered by colId
+} SZoneMapH;
+
+void            tsdbResetZoneMapH(SZoneMapH *pZmh, SBlockInfo *pBlkInfo, SBlockIdx *pBlkIdx);
+void            tsdbDestroyZoneMapH(SZoneMapH *pZmh);
+void            tsdbZoneMapHAddBlock(SZoneMapH *pZmh, SDataCols *pDataCols, SBlock *pBlock, SAggrBlkData *pAggrBlkData);
+uint32_t        tsdbZoneMapHSize(SZoneMapH *pZmh);
+void            tsdbZoneMapHEncode(SZoneMapH *pZmh, void *buf);
+const SZoneMap *tsdbGetZoneMap(SBlockInfo *pBlkInfo, SBlockIdx *pBlkIdx);
+
+#endif /* _TD_TSDB_ZONE_MAP_H_ */
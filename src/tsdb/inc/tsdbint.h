@@ -62,6 +62,12 @@ extern "C" {
 #include "tsdbFS.h"
 // ReadImpl
 #include "tsdbReadImpl.h"
+// Block Cache
+#include "tsdbBlkCache.h"
+// Head Map
+#include "tsdbHeadMap.h"
+// Zone Map
+#include "tsdbZoneMap.h"
 // Commit
 #include "tsdbCommit.h"
 // Compact
@@ -91,6 +97,8 @@ struct STsdbRepo {
   SMemTable*      mem;
   SMemTable*      imem;
   STsdbFS*        fs;
+  STsdbBlkCache*  blkCache;  // decoded column block cache, NULL if disabled
+  STsdbHeadMap*   headMap;   // mapped .head files shared by queries, NULL if disabled
   SRtn            rtn;
   tsem_t          readyToCommit;
   pthread_mutex_t mutex;
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tsdbint.h"
+#include "hashfunc.h"
+
+struct SBlkCacheNode {
+  SBlkCacheKey   key;
+  SBlkCacheNode *prev;
+  SBlkCacheNode *next;
+  int32_t        len;
+  char           data[];
+};
+
+// process wide counters, consumed by the monitor
+static int64_t tsBlkCacheHitNum = 0;
+static int64_t tsBlkCacheMissNum = 0;
+static int64_t tsBlkCacheUsed = 0;  // bytes held by the caches of all the vnodes
+
+static void tsdbBlkCacheUnlink(STsdbBlkCache *pCache, SBlkCacheNode *pNode);
+static void tsdbBlkCacheLinkHead(STsdbBlkCache *pCache, SBlkCacheNode *pNode);
+static void tsdbBlkCacheRemoveNode(STsdbBlkCache *pCache, SBlkCacheNode *pNode);
+
+STsdbBlkCache *tsdbNewBlkCache(int64_t capacity) {
+  STsdbBlkCache *pCache = (STsdbBlkCache *)calloc(1, sizeof(*pCache));
+  if (pCache == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  pCache->map = taosHashInit(1024, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_NO_LOCK);
+  if (pCache->map == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    free(pCache);
+    return NULL;
+  }
+
+  int code = pthread_mutex_init(&(pCache->lock), NULL);
+  if (code != 0) {
+    terrno = TAOS_SYSTEM_ERROR(code);
+    taosHashCleanup(pCache->map);
+    free(pCache);
+    return NULL;
+  }
+
+  pCache->capacity = capacity;
+  return pCache;
+}
+
+void tsdbFreeBlkCache(STsdbBlkCache *pCache) {
+  if (pCache == NULL) return;
+
+  SBlkCacheNode *pNode = pCache->head;
+  while (pNode) {
+    SBlkCacheNode *pNext = pNode->next;
+    free(pNode);
+    pNode = pNext;
+  }
+
+  atomic_sub_fetch_64(&tsBlkCacheUsed, pCache->used);
+  taosHashCleanup(pCache->map);
+  pthread_mutex_destroy(&(pCache->lock));
+  free(pCache);
+}
+
+void tsdbInitBlkCacheKey(SBlkCacheKey *pKey, SDFile *pDFile, int fid, SBlock *pBlock, int16_t colId) {
+  const char *fname = TSDB_FILE_FULL_NAME(pDFile);
+
+  memset(pKey, 0, sizeof(*pKey));
+  pKey->fid = fid;
+  pKey->fnameHash = MurmurHash3_32(fname, (uint32_t)strlen(fname));
+  pKey->offset = pBlock->offset;
+  pKey->colId = colId;
+  pKey->last = (int8_t)pBlock->last;
+}
+
+// check the key without counting a hit or moving it in the LRU list
+bool tsdbBlkCacheContains(STsdbBlkCache *pCache, SBlkCacheKey *pKey) {
+  pthread_mutex_lock(&(pCache->lock));
+  bool found = (taosHashGet(pCache->map, pKey, sizeof(*pKey)) != NULL);
+  pthread_mutex_unlock(&(pCache->lock));
+
+  return found;
+}
+
+bool tsdbGetFromBlkCache(STsdbBlkCache *pCache, SBlkCacheKey *pKey, SDataCol *pDataCol, int numOfRows,
+                         int maxPoints) {
+  bool found = false;
+
+  pthread_mutex_lock(&(pCache->lock));
+
+  SBlkCacheNode **ppNode = taosHashGet(pCache->map, pKey, sizeof(*pKey));
+  if (ppNode != NULL && tdAllocMemForCol(pDataCol, maxPoints) == 0) {
+    SBlkCacheNode *pNode = *ppNode;
+    memcpy(pDataCol->pData, pNode->data, pNode->len);
+    pDataCol->len = pNode->len;
+
+    // move to the head of the LRU list
+    tsdbBlkCacheUnlink(pCache, pNode);
+    tsdbBlkCacheLinkHead(pCache, pNode);
+    found = true;
+  }
+
+  pthread_mutex_unlock(&(pCache->lock));
+
+  if (found) {
+    atomic_add_fetch_64(&tsBlkCacheHitNum, 1);
+    if (IS_VAR_DATA_TYPE(pDataCol->type)) {
+      dataColSetOffset(pDataCol, numOfRows);
+    }
+  } else {
+    atomic_add_fetch_64(&tsBlkCacheMissNum, 1);
+  }
+
+  return found;
+}
+
+void tsdbPutToBlkCache(STsdbBlkCache *pCache, SBlkCacheKey *pKey, SDataCol *pDataCol) {
+  int64_t size = sizeof(SBlkCacheNode) + pDataCol->len;
+  if (pDataCol->len <= 0 || size > pCache->capacity) return;
+
+  SBlkCacheNode *pNode = (SBlkCacheNode *)malloc((size_t)size);
+  if (pNode == NULL) return;
+
+  pNode->key = *pKey;
+  pNode->prev = NULL;
+  pNode->next = NULL;
+  pNode->len = pDataCol->len;
+  memcpy(pNode->data, pDataCol->pData, pDataCol->len);
+
+  pthread_mutex_lock(&(pCache->lock));
+
+  SBlkCacheNode **ppNode = taosHashGet(pCache->map, pKey, sizeof(*pKey));
+  if (ppNode != NULL) {
+    // another query has loaded the same column chunk
+    pthread_mutex_unlock(&(pCache->lock));
+    free(pNode);
+    return;
+  }
+
+  while (pCache->used + size > pCache->capacity && pCache->tail != NULL) {
+    tsdbBlkCacheRemoveNode(pCache, pCache->tail);
+  }
+
+  if (taosHashPut(pCache->map, pKey, sizeof(*pKey), &pNode, sizeof(pNode)) < 0) {
+    pthread_mutex_unlock(&(pCache->lock));
+    free(pNode);
+    return;
+  }
+
+  tsdbBlkCacheLinkHead(pCache, pNode);
+  pCache->used += size;
+  atomic_add_fetch_64(&tsBlkCacheUsed, size);
+
+  pthread_mutex_unlock(&(pCache->lock));
+}
+
+void tsdbInvalidateBlkCache(STsdbBlkCache *pCache, int fid) {
+  if (pCache == NULL) return;
+
+  int nRemoved = 0;
+
+  pthread_mutex_lock(&(pCache->lock));
+  SBlkCacheNode *pNode = pCache->head;
+  while (pNode) {
+    SBlkCacheNode *pNext = pNode->next;
+    if (pNode->key.fid == fid) {
+      tsdbBlkCacheRemoveNode(pCache, pNode);
+      nRemoved++;
+    }
+    pNode = pNext;
+  }
+  pthread_mutex_unlock(&(pCache->lock));
+
+  if (nRemoved > 0) {
+    tsdbDebug("%d cached column blocks of FSET %d are invalidated", nRemoved, fid);
+  }
+}
+
+// the hits and misses since the last call, and the bytes held now
+void tsdbGetBlkCacheStatisInfo(int64_t *nHit, int64_t *nMiss, int64_t *used) {
+  *nHit = atomic_exchange_64(&tsBlkCacheHitNum, 0);
+  *nMiss = atomic_exchange_64(&tsBlkCacheMissNum, 0);
+  *used = atomic_load_64(&tsBlkCacheUsed);
+}
+
+static void tsdbBlkCacheUnlink(STsdbBlkCache *pCache, SBlkCacheNode *pNode) {
+  if (pNode->prev) {
+    pNode->prev->next = pNode->next;
+  } else {
+    pCache->head = pNode->next;
+  }
+
+  if (pNode->next) {
+    pNode->next->prev = pNode->prev;
+  } else {
+    pCache->tail = pNode->prev;
+  }
+
+  pNode->prev = NULL;
+  pNode->next = NULL;
+}
+
+static void tsdbBlkCacheLinkHead(STsdbBlkCache *pCache, SBlkCacheNode *pNode) {
+  pNode->prev = NULL;
+  pNode->next = pCache->head;
+  if (pCache->head) {
+    pCache->head->prev = pNode;
+  } else {
+    pCache->tail = pNode;
+  }
+  pCache->head = pNode;
+}
+
+static void tsdbBlkCacheRemoveNode(STsdbBlkCache *pCache, SBlkCacheNode *pNode) {
+  tsdbBlkCacheUnlink(pCache, pNode);
+  taosHashRemove(pCache->map, &(pNode->key), sizeof(pNode->key));
+  pCache->used -= (sizeof(SBlkCacheNode) + pNode->len);
+  atomic_sub_fetch_64(&tsBlkCacheUsed, sizeof(SBlkCacheNode) + pNode->len);
+  free(pNode);
+}
@@ -15,10 +15,35 @@
 #include "tsdbint.h"
 
 extern int32_t tsTsdbMetaCompactRatio;
+extern int32_t tsdbDictMaxEntries;
+extern int8_t  tsdbFloatCodec;
+extern int32_t tsdbCommitWorkers;
 
 #define TSDB_MAX_SUBBLOCKS 8
+#define TSDB_COMMIT_MAX_PENDING_SIZE (64 * 1024 * 1024)
 
 typedef struct {
+  pthread_mutex_t mutex;
+  pthread_cond_t  cond;
+  pthread_cond_t  workCond;  // the worker threads wait here for the next FSET
+  pthread_t *     threads;
+  int             nthreads;
+  int64_t         round;     // increased when the tables of a FSET are dispatched
+  int             nRunning;  // worker threads not done with the current round yet
+  bool            stop;
+  int             nextTid;   // next table to dispatch
+  int64_t         nextSeq;   // sequence of the next dispatched table
+  int64_t         flushSeq;  // sequence of the table allowed to append to the files
+  int32_t         code;
+} SCommitPool;
+
+typedef struct {
+  SBlock block;
+  void * pData;  // encoded SBlockData
+  void * pAggr;  // encoded SAggrBlkData
+} SPendBlock;
+
+typedef struct SCommitH {
   SRtn         rtn;     // retention snapshot
   SFSIter      fsIter;  // tsdb file iterator
   int          niters;  // memory iterators
@@ -34,7 +59,17 @@ typedef struct {
   STable *     pTable;
   SArray *     aSupBlk;  // Table super-block array
   SArray *     aSubBlk;  // table sub-block array
+  SZoneMapH    zmh;      // zone map of the table
   SDataCols *  pDataCols;
+  SDFileSet *  pWSet;     // FSET to write, the one of the main handle for the workers
+  int          nWorkers;  // worker handles to commit tables of a FSET in parallel
+  struct SCommitH *pWorkers;
+  SCommitPool *pWorkPool; // the worker threads, kept for all the FSETs of a commit
+  SCommitPool *pPool;     // not NULL while the tables are committed in parallel
+  int64_t      seq;
+  bool         isTurn;    // if the table has its turn to append to the files
+  SArray *     aPendBlk;  // SPendBlock array, blocks encoded before the turn
+  int64_t      pendSize;
 } SCommitH;
 
 /*
@@ -47,7 +82,7 @@ static int64_t tsTickPerHour[] = {3600000L, 3600000000L, 3600000000000L};
 
 #define TSDB_COMMIT_REPO(ch) TSDB_READ_REPO(&(ch->readh))
 #define TSDB_COMMIT_REPO_ID(ch) REPO_ID(TSDB_READ_REPO(&(ch->readh)))
-#define TSDB_COMMIT_WRITE_FSET(ch) (&((ch)->wSet))
+#define TSDB_COMMIT_WRITE_FSET(ch) ((ch)->pWSet)
 #define TSDB_COMMIT_TABLE(ch) ((ch)->pTable)
 #define TSDB_COMMIT_HEAD_FILE(ch) TSDB_DFILE_IN_SET(TSDB_COMMIT_WRITE_FSET(ch), TSDB_FILE_HEAD)
 #define TSDB_COMMIT_DATA_FILE(ch) TSDB_DFILE_IN_SET(TSDB_COMMIT_WRITE_FSET(ch), TSDB_FILE_DATA)
@@ -92,6 +127,16 @@ static void tsdbCloseCommitFile(SCommitH *pCommith, bool hasError);
 static bool tsdbCanAddSubBlock(SCommitH *pCommith, SBlock *pBlock, SMergeInfo *pInfo);
 static void tsdbLoadAndMergeFromCache(SDataCols *pDataCols, int *iter, SCommitIter *pCommitIter, SDataCols *pTarget,
                                       TSKEY maxKey, int maxRows, int8_t update);
+static int  tsdbInitCommitWorkers(SCommitH *pCommith);
+static void tsdbDestroyCommitWorker(SCommitH *pWorker);
+static void tsdbStopCommitWorkers(SCommitH *pCommith);
+static void *tsdbCommitWorkerMain(void *arg);
+static int  tsdbCommitTablesInParallel(SCommitH *pCommith, SDFileSet *pSet);
+static void *tsdbLoopCommitTables(void *arg);
+static int  tsdbCommitWaitTurn(SCommitH *pCommith);
+static void tsdbCommitPassTurn(SCommitH *pCommith, int32_t code);
+static int  tsdbFlushPendBlocks(SCommitH *pCommith);
+static void tsdbClearPendBlocks(SCommitH *pCommith);
 
 void *tsdbCommitData(STsdbRepo *pRepo, bool end) {
   if (pRepo->imem == NULL) {
@@ -169,8 +214,8 @@ int tsdbApplyRtnOnFSet(STsdbRepo *pRepo, SDFileSet *pSet, SRtn *pRtn) {
   return 0;
 }
 
-int tsdbWriteBlockInfoImpl(SDFile *pHeadf, STable *pTable, SArray *pSupA, SArray *pSubA, void **ppBuf,
-                           SBlockIdx *pIdx) {
+int tsdbWriteBlockInfoImpl(SDFile *pHeadf, STable *pTable, SArray *pSupA, SArray *pSubA, SZoneMapH *pZmh,
+                           void **ppBuf, SBlockIdx *pIdx) {
   size_t      nSupBlocks;
   size_t      nSubBlocks;
   uint32_t    tlen;
@@ -188,7 +233,8 @@ int tsdbWriteBlockInfoImpl(SDFile *pHeadf, STable *pTable, SArray *pSupA, SArray
     return 0;
   }
 
-  tlen = (uint32_t)(sizeof(SBlockInfo) + sizeof(SBlock) * (nSupBlocks + nSubBlocks) + sizeof(TSCKSUM));
+  uint32_t zlen = tsdbZoneMapHSize(pZmh);
+  tlen = (uint32_t)(sizeof(SBlockInfo) + sizeof(SBlock) * (nSupBlocks + nSubBlocks) + zlen + sizeof(TSCKSUM));
   if (tsdbMakeRoom(ppBuf, tlen) < 0) return -1;
   pBlkInfo = *ppBuf;
 
@@ -209,6 +255,10 @@ int tsdbWriteBlockInfoImpl(SDFile *pHeadf, STable *pTable, SArray *pSupA, SArray
     }
   }
 
+  if (zlen > 0) {
+    tsdbZoneMapHEncode(pZmh, (void *)(pBlkInfo->blocks + nSupBlocks + nSubBlocks));
+  }
+
   taosCalcChecksumAppend(0, (uint8_t *)pBlkInfo, tlen);
 
   if (tsdbAppendDFile(pHeadf, (void *)pBlkInfo, tlen, &offset) < 0) {
@@ -636,6 +686,7 @@ static int tsdbCommitTSData(STsdbRepo *pRepo) {
     if (pSet->fid < commith.rtn.minFid) {
       tsdbInfo("vgId:%d FSET %d on level %d disk id %d expires, remove it", REPO_ID(pRepo), pSet->fid,
                TSDB_FSET_LEVEL(pSet), TSDB_FSET_ID(pSet));
+      tsdbInvalidateHeadMap(pRepo->headMap, pSet->fid);
     } else {
       break;
     }
@@ -749,17 +800,26 @@ static int tsdbCommitToFile(SCommitH *pCommith, SDFileSet *pSet, int fid) {
   }
 
   // Loop to commit each table data
-  for (int tid = 1; tid < pCommith->niters; tid++) {
-    SCommitIter *pIter = pCommith->iters + tid;
-
-    if (pIter->pTable == NULL) continue;
-
-    if (tsdbCommitToTable(pCommith, tid) < 0) {
+  if (pCommith->nWorkers > 0) {
+    if (tsdbCommitTablesInParallel(pCommith, pSet) < 0) {
       tsdbCloseCommitFile(pCommith, true);
       // revert the file change
       tsdbApplyDFileSetChange(TSDB_COMMIT_WRITE_FSET(pCommith), pSet);
       return -1;
     }
+  } else {
+    for (int tid = 1; tid < pCommith->niters; tid++) {
+      SCommitIter *pIter = pCommith->iters + tid;
+
+      if (pIter->pTable == NULL) continue;
+
+      if (tsdbCommitToTable(pCommith, tid) < 0) {
+        tsdbCloseCommitFile(pCommith, true);
+        // revert the file change
+        tsdbApplyDFileSetChange(TSDB_COMMIT_WRITE_FSET(pCommith), pSet);
+        return -1;
+      }
+    }
   }
 
   if (tsdbWriteBlockIdx(TSDB_COMMIT_HEAD_FILE(pCommith), pCommith->aBlkIdx, (void **)(&(TSDB_COMMIT_BUF(pCommith)))) <
@@ -786,6 +846,9 @@ static int tsdbCommitToFile(SCommitH *pCommith, SDFileSet *pSet, int fid) {
     return -1;
   }
 
+  tsdbInvalidateBlkCache(pRepo->blkCache, fid);
+  tsdbInvalidateHeadMap(pRepo->headMap, fid);
+
   return 0;
 }
 
@@ -816,12 +879,12 @@ static int tsdbCreateCommitIters(SCommitH *pCommith) {
   for (int i = 0; i < pMem->maxTables; i++) {
     if ((pCommith->iters[i].pTable != NULL) && (pMem->tData[i] != NULL) &&
         (TABLE_UID(pCommith->iters[i].pTable) == pMem->tData[i]->uid)) {
-      if ((pCommith->iters[i].pIter = tSkipListCreateIter(pMem->tData[i]->pData)) == NULL) {
+      if ((pCommith->iters[i].pIter = tsdbCreateTableDataIter(pMem->tData[i], NULL, TSDB_ORDER_ASC)) == NULL) {
         terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
         return -1;
       }
 
-      tSkipListIterNext(pCommith->iters[i].pIter);
+      tsdbTableDataIterNext(pCommith->iters[i].pIter);
     }
   }
 
@@ -834,7 +897,7 @@ static void tsdbDestroyCommitIters(SCommitH *pCommith) {
   for (int i = 1; i < pCommith->niters; i++) {
     if (pCommith->iters[i].pTable != NULL) {
       tsdbUnRefTable(pCommith->iters[i].pTable);
-      tSkipListDestroyIter(pCommith->iters[i].pIter);
+      tsdbDestroyTableDataIter(pCommith->iters[i].pIter);
     }
   }
 
@@ -858,6 +921,7 @@ static int tsdbInitCommitH(SCommitH *pCommith, STsdbRepo *pRepo) {
 
   memset(pCommith, 0, sizeof(*pCommith));
   tsdbGetRtnSnap(pRepo, &(pCommith->rtn));
+  pCommith->pWSet = &(pCommith->wSet);
 
   TSDB_FSET_SET_CLOSED(TSDB_COMMIT_WRITE_FSET(pCommith));
 
@@ -902,13 +966,29 @@ static int tsdbInitCommitH(SCommitH *pCommith, STsdbRepo *pRepo) {
     return -1;
   }
 
+  if (tsdbInitCommitWorkers(pCommith) < 0) {
+    tsdbDestroyCommitH(pCommith);
+    return -1;
+  }
+
   return 0;
 }
 
 static void tsdbDestroyCommitH(SCommitH *pCommith) {
+  tsdbStopCommitWorkers(pCommith);
+  if (pCommith->pWorkers) {
+    for (int i = 0; i < pCommith->nWorkers; i++) {
+      tsdbDestroyCommitWorker(pCommith->pWorkers + i);
+    }
+    tfree(pCommith->pWorkers);
+    pCommith->nWorkers = 0;
+  }
+  tsdbClearPendBlocks(pCommith);
+  pCommith->aPendBlk = taosArrayDestroy(&pCommith->aPendBlk);
   pCommith->pDataCols = tdFreeDataCols(pCommith->pDataCols);
   pCommith->aSubBlk = taosArrayDestroy(&pCommith->aSubBlk);
   pCommith->aSupBlk = taosArrayDestroy(&pCommith->aSupBlk);
+  tsdbDestroyZoneMapH(&(pCommith->zmh));
   pCommith->aBlkIdx = taosArrayDestroy(&pCommith->aBlkIdx);
   tsdbDestroyCommitIters(pCommith);
   tsdbDestroyReadH(&(pCommith->readh));
@@ -974,6 +1054,9 @@ static int tsdbCommitToTable(SCommitH *pCommith, int tid) {
     nBlocks = 0;
   }
 
+  // the blocks moved are covered by the zone map read, the ones written are merged into it
+  tsdbResetZoneMapH(&(pCommith->zmh), pCommith->readh.pBlkInfo, pCommith->readh.pBlkIdx);
+
   if (bidx < nBlocks) {
     pBlock = pCommith->readh.pBlkInfo->blocks + bidx;
   } else {
@@ -1029,6 +1112,10 @@ static int tsdbCommitToTable(SCommitH *pCommith, int tid) {
 
   TSDB_RUNLOCK_TABLE(pIter->pTable);
 
+  if (tsdbFlushPendBlocks(pCommith) < 0) {
+    return -1;
+  }
+
   if (tsdbWriteBlockInfo(pCommith) < 0) {
     tsdbError("vgId:%d failed to write SBlockInfo part into file %s since %s", TSDB_COMMIT_REPO_ID(pCommith),
               TSDB_FILE_FULL_NAME(TSDB_COMMIT_HEAD_FILE(pCommith)), tstrerror(terrno));
@@ -1071,12 +1158,13 @@ static int tsdbComparKeyBlock(const void *arg1, const void *arg2) {
   }
 }
 
-int tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile *pDFileAggr, SDataCols *pDataCols,
-                       SBlock *pBlock, bool isLast, bool isSuper, void **ppBuf, void **ppCBuf, void **ppExBuf) {
+// Encode the block data into *ppBuf and the aggregate data into *ppExBuf, all members of pBlock but the offsets are
+// set. The files are not touched, so blocks of different tables can be encoded in parallel.
+static int tsdbEncodeBlock(STsdbRepo *pRepo, STable *pTable, SDataCols *pDataCols, SBlock *pBlock, bool isLast,
+                           bool isSuper, void **ppBuf, void **ppCBuf, void **ppExBuf) {
   STsdbCfg *  pCfg = REPO_CFG(pRepo);
   SBlockData *pBlockData;
   SAggrBlkData *pAggrBlkData = NULL;
-  int64_t     offset = 0, offsetAggr = 0;
   int         rowsToWrite = pDataCols->numOfRows;
 
   ASSERT(rowsToWrite > 0 && rowsToWrite <= pCfg->maxRowsPerFileBlock);
@@ -1132,6 +1220,8 @@ int tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile
   int32_t  tsize = (int32_t)tsdbBlockStatisSize(nColsNotAllNull, SBlockVerLatest);
   int32_t  lsize = tsize;
   int32_t  keyLen = 0;
+  bool     adapted = false;
+  bool     floatAdapt = false;  // any column of the Chimp or decimal codec
 
   uint32_t tsizeAggr = (uint32_t)tsdbBlockAggrSize(nColsNotAllNull, SBlockVerLatest);
 
@@ -1163,9 +1253,27 @@ int tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile
 
     // Compress or just copy
     if (pCfg->compression) {
-      flen = (*(tDataTypes[pDataCol->type].compFunc))((char *)pDataCol->pData, tlen, rowsToWrite, tptr,
-                                                      tlen + COMP_OVERFLOW_BYTES, pCfg->compression, *ppCBuf,
-                                                      tlen + COMP_OVERFLOW_BYTES);
+      flen = -1;
+      if (tsdbDictMaxEntries > 0 &&
+          (pDataCol->type == TSDB_DATA_TYPE_BINARY || pDataCol->type == TSDB_DATA_TYPE_NCHAR)) {
+        // low cardinality columns are dictionary encoded, others fall back to the type compression below
+        flen = tsCompressStringDictImp((char *)pDataCol->pData, tlen, rowsToWrite, tptr, tlen + COMP_OVERFLOW_BYTES,
+                                       tsdbDictMaxEntries);
+      } else if (tsdbFloatCodec && pDataCol->type == TSDB_DATA_TYPE_FLOAT) {
+        flen = tsCompressFloatAdapt((char *)pDataCol->pData, tlen, rowsToWrite, tptr, tlen + COMP_OVERFLOW_BYTES,
+                                    pCfg->compression, *ppCBuf, tlen + COMP_OVERFLOW_BYTES, &adapted);
+        floatAdapt = floatAdapt || adapted;
+      } else if (tsdbFloatCodec && pDataCol->type == TSDB_DATA_TYPE_DOUBLE) {
+        flen = tsCompressDoubleAdapt((char *)pDataCol->pData, tlen, rowsToWrite, tptr, tlen + COMP_OVERFLOW_BYTES,
+                                     pCfg->compression, *ppCBuf, tlen + COMP_OVERFLOW_BYTES, &adapted);
+        floatAdapt = floatAdapt || adapted;
+      }
+
+      if (flen < 0) {
+        flen = (*(tDataTypes[pDataCol->type].compFunc))((char *)pDataCol->pData, tlen, rowsToWrite, tptr,
+                                                        tlen + COMP_OVERFLOW_BYTES, pCfg->compression, *ppCBuf,
+                                                        tlen + COMP_OVERFLOW_BYTES);
+      }
     } else {
       flen = tlen;
       memcpy(tptr, pDataCol->pData, flen);
@@ -1175,7 +1283,6 @@ int tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile
     ASSERT(flen > 0);
     flen += sizeof(TSCKSUM);
     taosCalcChecksumAppend(0, (uint8_t *)tptr, flen);
-    tsdbUpdateDFileMagic(pDFile, POINTER_SHIFT(tptr, flen - sizeof(TSCKSUM)));
 
     if (ncol != 0) {
       tsdbSetBlockColOffset(pBlockCol, toffset);
@@ -1194,29 +1301,16 @@ int tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile
   pBlockData->numOfCols = nColsNotAllNull;
 
   taosCalcChecksumAppend(0, (uint8_t *)pBlockData, tsize);
-  tsdbUpdateDFileMagic(pDFile, POINTER_SHIFT(pBlockData, tsize - sizeof(TSCKSUM)));
-
-  // Write the whole block to file
-  if (tsdbAppendDFile(pDFile, (void *)pBlockData, lsize, &offset) < lsize) {
-    return -1;
-  }
 
   uint32_t aggrStatus = nColsNotAllNull > 0 ? 1 : 0;
   if (aggrStatus > 0) {
-
     taosCalcChecksumAppend(0, (uint8_t *)pAggrBlkData, tsizeAggr);
-    tsdbUpdateDFileMagic(pDFileAggr, POINTER_SHIFT(pAggrBlkData, tsizeAggr - sizeof(TSCKSUM)));
-
-    // Write the whole block to file
-    if (tsdbAppendDFile(pDFileAggr, (void *)pAggrBlkData, tsizeAggr, &offsetAggr) < tsizeAggr) {
-      return -1;
-    }
   }
 
   // Update pBlock membership variables
   pBlock->last = isLast;
-  pBlock->offset = offset;
-  pBlock->algorithm = pCfg->compression;
+  pBlock->offset = 0;
+  pBlock->algorithm = floatAdapt ? (pCfg->compression | COMP_FLOAT_ADAPT) : pCfg->compression;
   pBlock->numOfRows = rowsToWrite;
   pBlock->len = lsize;
   pBlock->keyLen = keyLen;
@@ -1227,22 +1321,104 @@ int tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile
   // since blkVer1
   pBlock->aggrStat = aggrStatus;
   pBlock->blkVer = SBlockVerLatest;
+  pBlock->aggrOffset = 0;
+
+  return 0;
+}
+
+// Append an encoded block to the files and set the offsets of pBlock. The file magic is updated with the column
+// checksums in the same order as they are encoded.
+static int tsdbAppendBlock(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile *pDFileAggr, SBlock *pBlock,
+                           SBlockData *pBlockData, SAggrBlkData *pAggrBlkData) {
+  int64_t  offset = 0, offsetAggr = 0;
+  int32_t  tsize = (int32_t)tsdbBlockStatisSize(pBlock->numOfCols, SBlockVerLatest);
+  uint32_t tsizeAggr = (uint32_t)tsdbBlockAggrSize(pBlock->numOfCols, SBlockVerLatest);
+
+  tsdbUpdateDFileMagic(pDFile, POINTER_SHIFT(pBlockData, tsize + pBlock->keyLen - sizeof(TSCKSUM)));
+  for (int i = 0; i < pBlock->numOfCols; i++) {
+    SBlockCol *pBlockCol = pBlockData->cols + i;
+    tsdbUpdateDFileMagic(pDFile, POINTER_SHIFT(pBlockData, tsize + tsdbGetBlockColOffset(pBlockCol) + pBlockCol->len -
+                                                               sizeof(TSCKSUM)));
+  }
+  tsdbUpdateDFileMagic(pDFile, POINTER_SHIFT(pBlockData, tsize - sizeof(TSCKSUM)));
+
+  // Write the whole block to file
+  if (tsdbAppendDFile(pDFile, (void *)pBlockData, pBlock->len, &offset) < pBlock->len) {
+    return -1;
+  }
+
+  if (pBlock->aggrStat > 0) {
+    tsdbUpdateDFileMagic(pDFileAggr, POINTER_SHIFT(pAggrBlkData, tsizeAggr - sizeof(TSCKSUM)));
+
+    // Write the whole block to file
+    if (tsdbAppendDFile(pDFileAggr, (void *)pAggrBlkData, tsizeAggr, &offsetAggr) < tsizeAggr) {
+      return -1;
+    }
+  }
+
+  pBlock->offset = offset;
   pBlock->aggrOffset = (uint64_t)offsetAggr;
 
   tsdbDebug("vgId:%d tid:%d a block of data is written to file %s, offset %" PRId64
             " numOfRows %d len %d numOfCols %" PRId16 " keyFirst %" PRId64 " keyLast %" PRId64,
-            REPO_ID(pRepo), TABLE_TID(pTable), TSDB_FILE_FULL_NAME(pDFile), offset, rowsToWrite, pBlock->len,
+            REPO_ID(pRepo), TABLE_TID(pTable), TSDB_FILE_FULL_NAME(pDFile), offset, pBlock->numOfRows, pBlock->len,
             pBlock->numOfCols, pBlock->keyFirst, pBlock->keyLast);
 
   return 0;
 }
 
+int tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile *pDFileAggr, SDataCols *pDataCols,
+                       SBlock *pBlock, bool isLast, bool isSuper, void **ppBuf, void **ppCBuf, void **ppExBuf) {
+  if (tsdbEncodeBlock(pRepo, pTable, pDataCols, pBlock, isLast, isSuper, ppBuf, ppCBuf, ppExBuf) < 0) {
+    return -1;
+  }
+
+  return tsdbAppendBlock(pRepo, pTable, pDFile, pDFileAggr, pBlock, (SBlockData *)(*ppBuf), (SAggrBlkData *)(*ppExBuf));
+}
+
 static int tsdbWriteBlock(SCommitH *pCommith, SDFile *pDFile, SDataCols *pDataCols, SBlock *pBlock, bool isLast,
                           bool isSuper) {
-  return tsdbWriteBlockImpl(TSDB_COMMIT_REPO(pCommith), TSDB_COMMIT_TABLE(pCommith), pDFile,
-                            isLast ? TSDB_COMMIT_SMAL_FILE(pCommith) : TSDB_COMMIT_SMAD_FILE(pCommith), pDataCols,
-                            pBlock, isLast, isSuper, (void **)(&(TSDB_COMMIT_BUF(pCommith))),
-                            (void **)(&(TSDB_COMMIT_COMP_BUF(pCommith))), (void **)(&(TSDB_COMMIT_EXBUF(pCommith))));
+  if (pCommith->pPool != NULL && !pCommith->isTurn && pCommith->pendSize < TSDB_COMMIT_MAX_PENDING_SIZE) {
+    // Not the turn of the table to append to the files, keep the encoded block until tsdbFlushPendBlocks
+    SPendBlock pend = {0};
+
+    if (tsdbEncodeBlock(TSDB_COMMIT_REPO(pCommith), TSDB_COMMIT_TABLE(pCommith), pDataCols, &(pend.block), isLast,
+                        isSuper, &(pend.pData), (void **)(&(TSDB_COMMIT_COMP_BUF(pCommith))), &(pend.pAggr)) < 0) {
+      taosTZfree(pend.pData);
+      taosTZfree(pend.pAggr);
+      return -1;
+    }
+
+    if (taosArrayPush(pCommith->aPendBlk, &pend) == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      taosTZfree(pend.pData);
+      taosTZfree(pend.pAggr);
+      return -1;
+    }
+
+    tsdbZoneMapHAddBlock(&(pCommith->zmh), pDataCols, &(pend.block), pend.pAggr);
+
+    // the offset refers to the pending block before it is appended
+    *pBlock = pend.block;
+    pBlock->offset = -(int64_t)taosArrayGetSize(pCommith->aPendBlk);
+    pCommith->pendSize += pend.block.len;
+    return 0;
+  }
+
+  // Too much data pending, wait for the turn and write the rest of the table directly
+  if (tsdbFlushPendBlocks(pCommith) < 0) {
+    return -1;
+  }
+
+  if (tsdbWriteBlockImpl(TSDB_COMMIT_REPO(pCommith), TSDB_COMMIT_TABLE(pCommith), pDFile,
+                         isLast ? TSDB_COMMIT_SMAL_FILE(pCommith) : TSDB_COMMIT_SMAD_FILE(pCommith), pDataCols, pBlock,
+                         isLast, isSuper, (void **)(&(TSDB_COMMIT_BUF(pCommith))),
+                         (void **)(&(TSDB_COMMIT_COMP_BUF(pCommith))), (void **)(&(TSDB_COMMIT_EXBUF(pCommith)))) < 0) {
+    return -1;
+  }
+
+  tsdbZoneMapHAddBlock(&(pCommith->zmh), pDataCols, pBlock, TSDB_COMMIT_EXBUF(pCommith));
+  return 0;
 }
 
 static int tsdbWriteBlockInfo(SCommitH *pCommih) {
@@ -1250,8 +1426,8 @@ static int tsdbWriteBlockInfo(SCommitH *pCommih) {
   SBlockIdx blkIdx;
   STable *  pTable = TSDB_COMMIT_TABLE(pCommih);
 
-  if (tsdbWriteBlockInfoImpl(pHeadf, pTable, pCommih->aSupBlk, pCommih->aSubBlk, (void **)(&(TSDB_COMMIT_BUF(pCommih))),
-                             &blkIdx) < 0) {
+  if (tsdbWriteBlockInfoImpl(pHeadf, pTable, pCommih->aSupBlk, pCommih->aSubBlk, &(pCommih->zmh),
+                             (void **)(&(TSDB_COMMIT_BUF(pCommih))), &blkIdx) < 0) {
     return -1;
   }
 
@@ -1318,7 +1494,7 @@ static int tsdbMergeMemData(SCommitH *pCommith, SCommitIter *pIter, int bidx) {
     keyLimit = pBlock[1].keyFirst - 1;
   }
 
-  SSkipListIterator titer = *(pIter->pIter);
+  STableDataIter titer = *(pIter->pIter);
   if (tsdbLoadBlockDataCols(&(pCommith->readh), pBlock, NULL, &colId, 1) < 0) return -1;
 
   tsdbLoadDataFromCache(pIter->pTable, &titer, keyLimit, INT32_MAX, NULL, pCommith->readh.pDCols[0]->cols[0].pData,
@@ -1497,7 +1673,7 @@ static void tsdbLoadAndMergeFromCache(SDataCols *pDataCols, int *iter, SCommitIt
 
       tdAppendMemRowToDataCol(row, pSchema, pTarget, true, 0);
 
-      tSkipListIterNext(pCommitIter->pIter);
+      tsdbTableDataIterNext(pCommitIter->pIter);
     } else {
       if (update != TD_ROW_OVERWRITE_UPDATE) {
         //copy disk data
@@ -1521,7 +1697,7 @@ static void tsdbLoadAndMergeFromCache(SDataCols *pDataCols, int *iter, SCommitIt
                                 update != TD_ROW_PARTIAL_UPDATE ? 0 : -1);
       }
       (*iter)++;
-      tSkipListIterNext(pCommitIter->pIter);
+      tsdbTableDataIterNext(pCommitIter->pIter);
     }
 
     if (pTarget->numOfRows >= maxRows) break;
@@ -1765,6 +1941,367 @@ static bool tsdbCanAddSubBlock(SCommitH *pCommith, SBlock *pBlock, SMergeInfo *p
   return false;
 }
 
+static int tsdbInitCommitWorkers(SCommitH *pCommith) {
+  STsdbRepo *pRepo = TSDB_COMMIT_REPO(pCommith);
+  STsdbCfg * pCfg = REPO_CFG(pRepo);
+  int        nTables = 0;
+
+  if (tsdbCommitWorkers <= 1) return 0;
+
+  for (int tid = 1; tid < pCommith->niters; tid++) {
+    if (pCommith->iters[tid].pIter != NULL) nTables++;
+  }
+
+  // Not worth the threads for a few tables
+  if (nTables < tsdbCommitWorkers * 2) return 0;
+
+  pCommith->aPendBlk = taosArrayInit(16, sizeof(SPendBlock));
+  if (pCommith->aPendBlk == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  // The main handle works as one of the workers
+  pCommith->pWorkers = (SCommitH *)calloc(tsdbCommitWorkers - 1, sizeof(SCommitH));
+  if (pCommith->pWorkers == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  for (int i = 0; i < tsdbCommitWorkers - 1; i++) {
+    SCommitH *pWorker = pCommith->pWorkers + i;
+
+    pCommith->nWorkers++;
+    pWorker->rtn = pCommith->rtn;
+    pWorker->niters = pCommith->niters;
+    pWorker->iters = pCommith->iters;
+    pWorker->aBlkIdx = pCommith->aBlkIdx;
+    pWorker->pWSet = &(pCommith->wSet);
+
+    if (tsdbInitReadH(&(pWorker->readh), pRepo) < 0) {
+      return -1;
+    }
+
+    pWorker->aSupBlk = taosArrayInit(1024, sizeof(SBlock));
+    pWorker->aSubBlk = taosArrayInit(1024, sizeof(SBlock));
+    pWorker->aPendBlk = taosArrayInit(16, sizeof(SPendBlock));
+    pWorker->pDataCols = tdNewDataCols(0, pCfg->maxRowsPerFileBlock);
+    if (pWorker->aSupBlk == NULL || pWorker->aSubBlk == NULL || pWorker->aPendBlk == NULL ||
+        pWorker->pDataCols == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      return -1;
+    }
+  }
+
+  SCommitPool *pPool = (SCommitPool *)calloc(1, sizeof(SCommitPool));
+  if (pPool == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  pPool->threads = (pthread_t *)calloc(pCommith->nWorkers, sizeof(pthread_t));
+  if (pPool->threads == NULL) {
+    free(pPool);
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  pthread_mutex_init(&(pPool->mutex), NULL);
+  pthread_cond_init(&(pPool->cond), NULL);
+  pthread_cond_init(&(pPool->workCond), NULL);
+  pCommith->pWorkPool = pPool;
+
+  for (int i = 0; i < pCommith->nWorkers; i++) {
+    SCommitH *pWorker = pCommith->pWorkers + i;
+
+    pWorker->pWorkPool = pPool;
+    int code = pthread_create(pPool->threads + i, NULL, tsdbCommitWorkerMain, pWorker);
+    if (code != 0) {
+      terrno = TAOS_SYSTEM_ERROR(code);
+      tsdbError("vgId:%d failed to create commit worker thread since %s", REPO_ID(pRepo), tstrerror(terrno));
+      return -1;
+    }
+    pPool->nthreads++;
+  }
+
+  tsdbDebug("vgId:%d %d tables are committed by %d workers", REPO_ID(pRepo), nTables, tsdbCommitWorkers);
+
+  return 0;
+}
+
+static void tsdbStopCommitWorkers(SCommitH *pCommith) {
+  SCommitPool *pPool = pCommith->pWorkPool;
+
+  if (pPool == NULL) return;
+
+  pthread_mutex_lock(&(pPool->mutex));
+  pPool->stop = true;
+  pthread_cond_broadcast(&(pPool->workCond));
+  pthread_mutex_unlock(&(pPool->mutex));
+
+  for (int i = 0; i < pPool->nthreads; i++) {
+    pthread_join(pPool->threads[i], NULL);
+  }
+
+  pthread_cond_destroy(&(pPool->workCond));
+  pthread_cond_destroy(&(pPool->cond));
+  pthread_mutex_destroy(&(pPool->mutex));
+  free(pPool->threads);
+  tfree(pCommith->pWorkPool);
+}
+
+// A worker thread commits the tables of each FSET dispatched by tsdbCommitTablesInParallel until it is stopped
+static void *tsdbCommitWorkerMain(void *arg) {
+  SCommitH *   pWorker = (SCommitH *)arg;
+  SCommitPool *pPool = pWorker->pWorkPool;
+  int64_t      round = 0;
+
+  setThreadName("tsdbCommitWrk");
+
+  while (true) {
+    pthread_mutex_lock(&(pPool->mutex));
+    while (!pPool->stop && pPool->round == round) {
+      pthread_cond_wait(&(pPool->workCond), &(pPool->mutex));
+    }
+    if (pPool->stop) {
+      pthread_mutex_unlock(&(pPool->mutex));
+      break;
+    }
+    round = pPool->round;
+    pthread_mutex_unlock(&(pPool->mutex));
+
+    tsdbLoopCommitTables(pWorker);
+
+    pthread_mutex_lock(&(pPool->mutex));
+    pPool->nRunning--;
+    pthread_cond_broadcast(&(pPool->cond));
+    pthread_mutex_unlock(&(pPool->mutex));
+  }
+
+  return NULL;
+}
+
+// The iters, aBlkIdx and write FSET belong to the main handle
+static void tsdbDestroyCommitWorker(SCommitH *pWorker) {
+  tsdbClearPendBlocks(pWorker);
+  pWorker->aPendBlk = taosArrayDestroy(&pWorker->aPendBlk);
+  pWorker->pDataCols = tdFreeDataCols(pWorker->pDataCols);
+  pWorker->aSubBlk = taosArrayDestroy(&pWorker->aSubBlk);
+  pWorker->aSupBlk = taosArrayDestroy(&pWorker->aSupBlk);
+  tsdbDestroyZoneMapH(&(pWorker->zmh));
+  tsdbDestroyReadH(&(pWorker->readh));
+}
+
+/*
+ * The tables of a FSET are committed by the workers in parallel, each one reads the old blocks with its own read
+ * handle and encodes the new blocks into memory. The blocks are appended to the files and the SBlockInfo and
+ * SBlockIdx are written in the order of tid, one table at a time, so the files are the same as the ones committed
+ * serially.
+ */
+static int tsdbCommitTablesInParallel(SCommitH *pCommith, SDFileSet *pSet) {
+  SCommitPool *pPool = pCommith->pWorkPool;
+  int          nWorkers = 0;
+
+  pPool->nextTid = 1;
+  pPool->nextSeq = 0;
+  pPool->flushSeq = 0;
+  pPool->code = 0;
+
+  for (; nWorkers < pCommith->nWorkers; nWorkers++) {
+    SCommitH *pWorker = pCommith->pWorkers + nWorkers;
+
+    pWorker->isRFileSet = pCommith->isRFileSet;
+    pWorker->isDFileSame = pCommith->isDFileSame;
+    pWorker->isLFileSame = pCommith->isLFileSame;
+    pWorker->minKey = pCommith->minKey;
+    pWorker->maxKey = pCommith->maxKey;
+
+    if (pWorker->isRFileSet) {
+      if (tsdbSetAndOpenReadFSet(&(pWorker->readh), pSet) < 0) {
+        pPool->code = terrno;
+        break;
+      }
+
+      if (tsdbLoadBlockIdx(&(pWorker->readh)) < 0) {
+        tsdbCloseAndUnsetFSet(&(pWorker->readh));
+        pPool->code = terrno;
+        break;
+      }
+    }
+
+    pWorker->pPool = pPool;
+  }
+
+  if (pPool->code == 0) {
+    pCommith->pPool = pPool;
+
+    // wake up the worker threads for the tables of this FSET, the main handle works as one of them
+    pthread_mutex_lock(&(pPool->mutex));
+    pPool->nRunning = pPool->nthreads;
+    pPool->round++;
+    pthread_cond_broadcast(&(pPool->workCond));
+    pthread_mutex_unlock(&(pPool->mutex));
+
+    tsdbLoopCommitTables(pCommith);
+
+    pthread_mutex_lock(&(pPool->mutex));
+    while (pPool->nRunning > 0) {
+      pthread_cond_wait(&(pPool->cond), &(pPool->mutex));
+    }
+    pthread_mutex_unlock(&(pPool->mutex));
+  }
+
+  for (int i = 0; i < nWorkers; i++) {
+    SCommitH *pWorker = pCommith->pWorkers + i;
+
+    if (pWorker->isRFileSet) {
+      tsdbCloseAndUnsetFSet(&(pWorker->readh));
+    }
+    tsdbClearPendBlocks(pWorker);
+    pWorker->pPool = NULL;
+  }
+  tsdbClearPendBlocks(pCommith);
+  pCommith->pPool = NULL;
+
+  if (pPool->code != 0) {
+    terrno = pPool->code;
+    return -1;
+  }
+
+  return 0;
+}
+
+static void *tsdbLoopCommitTables(void *arg) {
+  SCommitH *   pCommith = (SCommitH *)arg;
+  SCommitPool *pPool = pCommith->pPool;
+  int          tid;
+
+  while (true) {
+    pthread_mutex_lock(&(pPool->mutex));
+    for (tid = pPool->nextTid; tid < pCommith->niters; tid++) {
+      if (pCommith->iters[tid].pTable != NULL) break;
+    }
+
+    if (pPool->code != 0 || tid >= pCommith->niters) {
+      pthread_mutex_unlock(&(pPool->mutex));
+      break;
+    }
+
+    pPool->nextTid = tid + 1;
+    pCommith->seq = pPool->nextSeq++;
+    pthread_mutex_unlock(&(pPool->mutex));
+
+    pCommith->isTurn = false;
+    int code = tsdbCommitToTable(pCommith, tid);
+    if (code == 0 && !pCommith->isTurn) {
+      // nothing written for the table
+      code = tsdbCommitWaitTurn(pCommith);
+    }
+
+    tsdbCommitPassTurn(pCommith, (code < 0) ? terrno : TSDB_CODE_SUCCESS);
+    if (code < 0) break;
+  }
+
+  return NULL;
+}
+
+static int tsdbCommitWaitTurn(SCommitH *pCommith) {
+  SCommitPool *pPool = pCommith->pPool;
+  int32_t      code;
+
+  pthread_mutex_lock(&(pPool->mutex));
+  while (pPool->code == 0 && pPool->flushSeq != pCommith->seq) {
+    pthread_cond_wait(&(pPool->cond), &(pPool->mutex));
+  }
+  code = pPool->code;
+  pthread_mutex_unlock(&(pPool->mutex));
+
+  if (code != 0) {
+    terrno = code;
+    return -1;
+  }
+
+  pCommith->isTurn = true;
+  return 0;
+}
+
+// Pass the turn to the next table, or stop all the workers if code is not success
+static void tsdbCommitPassTurn(SCommitH *pCommith, int32_t code) {
+  SCommitPool *pPool = pCommith->pPool;
+
+  pthread_mutex_lock(&(pPool->mutex));
+  if (code != TSDB_CODE_SUCCESS) {
+    if (pPool->code == 0) pPool->code = code;
+  } else {
+    ASSERT(pCommith->isTurn && pPool->flushSeq == pCommith->seq);
+    pPool->flushSeq++;
+  }
+  pCommith->isTurn = false;
+  pthread_cond_broadcast(&(pPool->cond));
+  pthread_mutex_unlock(&(pPool->mutex));
+}
+
+// Wait for the turn of the table and append the pending blocks to the files
+static int tsdbFlushPendBlocks(SCommitH *pCommith) {
+  if (pCommith->pPool == NULL) return 0;
+
+  if (!pCommith->isTurn && tsdbCommitWaitTurn(pCommith) < 0) {
+    return -1;
+  }
+
+  size_t nPend = taosArrayGetSize(pCommith->aPendBlk);
+  if (nPend == 0) return 0;
+
+  for (size_t i = 0; i < nPend; i++) {
+    SPendBlock *pPend = (SPendBlock *)taosArrayGet(pCommith->aPendBlk, i);
+    bool        isLast = pPend->block.last;
+
+    if (tsdbAppendBlock(TSDB_COMMIT_REPO(pCommith), TSDB_COMMIT_TABLE(pCommith),
+                        isLast ? TSDB_COMMIT_LAST_FILE(pCommith) : TSDB_COMMIT_DATA_FILE(pCommith),
+                        isLast ? TSDB_COMMIT_SMAL_FILE(pCommith) : TSDB_COMMIT_SMAD_FILE(pCommith), &(pPend->block),
+                        (SBlockData *)pPend->pData, (SAggrBlkData *)pPend->pAggr) < 0) {
+      return -1;
+    }
+  }
+
+  // A super block with sub-blocks refers to the sub-block array, the offsets of others are set to the file
+  size_t nSupBlocks = taosArrayGetSize(pCommith->aSupBlk);
+  for (size_t i = 0; i < nSupBlocks; i++) {
+    SBlock *pBlock = (SBlock *)taosArrayGet(pCommith->aSupBlk, i);
+    if (pBlock->numOfSubBlocks == 1 && pBlock->offset < 0) {
+      SPendBlock *pPend = (SPendBlock *)taosArrayGet(pCommith->aPendBlk, -pBlock->offset - 1);
+      pBlock->offset = pPend->block.offset;
+      pBlock->aggrOffset = pPend->block.aggrOffset;
+    }
+  }
+
+  size_t nSubBlocks = taosArrayGetSize(pCommith->aSubBlk);
+  for (size_t i = 0; i < nSubBlocks; i++) {
+    SBlock *pBlock = (SBlock *)taosArrayGet(pCommith->aSubBlk, i);
+    if (pBlock->offset < 0) {
+      SPendBlock *pPend = (SPendBlock *)taosArrayGet(pCommith->aPendBlk, -pBlock->offset - 1);
+      pBlock->offset = pPend->block.offset;
+      pBlock->aggrOffset = pPend->block.aggrOffset;
+    }
+  }
+
+  tsdbClearPendBlocks(pCommith);
+  return 0;
+}
+
+static void tsdbClearPendBlocks(SCommitH *pCommith) {
+  if (pCommith->aPendBlk == NULL) return;
+
+  for (size_t i = 0; i < taosArrayGetSize(pCommith->aPendBlk); i++) {
+    SPendBlock *pPend = (SPendBlock *)taosArrayGet(pCommith->aPendBlk, i);
+    taosTZfree(pPend->pData);
+    taosTZfree(pPend->pAggr);
+  }
+
+  taosArrayClear(pCommith->aPendBlk);
+  pCommith->pendSize = 0;
+}
+
 int tsdbApplyRtn(STsdbRepo *pRepo) {
   SRtn       rtn;
   SFSIter    fsiter;
@@ -1779,6 +2316,7 @@ int tsdbApplyRtn(STsdbRepo *pRepo) {
     if (pSet->fid < rtn.minFid) {
       tsdbInfo("vgId:%d FSET %d at level %d disk id %d expires, remove it", REPO_ID(pRepo), pSet->fid,
                TSDB_FSET_LEVEL(pSet), TSDB_FSET_ID(pSet));
+      tsdbInvalidateHeadMap(pRepo->headMap, pSet->fid);
       continue;
     }
 
@@ -29,6 +29,7 @@ typedef struct {
   SDFileSet  wSet;
   SArray *   aBlkIdx;
   SArray *   aSupBlk;
+  SZoneMapH  zmh;  // zone map of the table, built from the blocks rewritten
   SDataCols *pDataCols;
 } SCompactH;
 
@@ -219,6 +220,8 @@ static int tsdbCompactMeta(STsdbRepo *pRepo) {
 
       tsdbCloseDFileSet(TSDB_COMPACT_WSET(pComph));
       tsdbUpdateDFileSet(REPO_FS(pRepo), TSDB_COMPACT_WSET(pComph));
+      tsdbInvalidateBlkCache(pRepo->blkCache, TSDB_FSET_FID(pSet));
+      tsdbInvalidateHeadMap(pRepo->headMap, TSDB_FSET_FID(pSet));
       tsdbDebug("vgId:%d FSET %d compact over", REPO_ID(pRepo), pSet->fid);
     }
 
@@ -321,6 +324,7 @@ static int tsdbCompactMeta(STsdbRepo *pRepo) {
   static void tsdbDestroyCompactH(SCompactH *pComph) {
     pComph->pDataCols = tdFreeDataCols(pComph->pDataCols);
     pComph->aSupBlk = taosArrayDestroy(&pComph->aSupBlk);
+    tsdbDestroyZoneMapH(&(pComph->zmh));
     pComph->aBlkIdx = taosArrayDestroy(&pComph->aBlkIdx);
     tsdbDestroyCompTbArray(pComph);
     tsdbDestroyReadH(&(pComph->readh));
@@ -451,6 +455,7 @@ static int tsdbCompactMeta(STsdbRepo *pRepo) {
         return -1;
       }
       tdFreeSchema(pSchema);
+      tsdbResetZoneMapH(&(pComph->zmh), NULL, NULL);
 
       // Loop to compact each block data
       for (int i = 0; i < pTh->pBlkIdx->numOfBlocks; i++) {
@@ -492,8 +497,8 @@ static int tsdbCompactMeta(STsdbRepo *pRepo) {
         return -1;
       }
 
-      if (tsdbWriteBlockInfoImpl(TSDB_COMPACT_HEAD_FILE(pComph), pTh->pTable, pComph->aSupBlk, NULL, ppBuf, &blkIdx) <
-          0) {
+      if (tsdbWriteBlockInfoImpl(TSDB_COMPACT_HEAD_FILE(pComph), pTh->pTable, pComph->aSupBlk, NULL, &(pComph->zmh),
+                                 ppBuf, &blkIdx) < 0) {
         return -1;
       }
 
@@ -534,6 +539,8 @@ static int tsdbCompactMeta(STsdbRepo *pRepo) {
       return -1;
     }
 
+    tsdbZoneMapHAddBlock(&(pComph->zmh), pDataCols, &block, *ppExBuf);
+
     if (taosArrayPush(pComph->aSupBlk, (void *)(&block)) == NULL) {
       terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
       return -1;
@@ -44,6 +44,7 @@ typedef struct {
   SDFileSet  wSet;
   SArray *   aBlkIdx;
   SArray *   aSupBlk;
+  SZoneMapH  zmh;  // zone map of the table, the one read still covers the rows left
   SArray *   aSubBlk;
   SDataCols *pDCols;
   SControlDataInfo* pCtlInfo;
@@ -340,6 +341,8 @@ static int tsdbFSetDelete(SDeleteH *pdh, SDFileSet *pSet) {
 
   tsdbCloseDFileSet(TSDB_DELETE_WSET(pdh));
   tsdbUpdateDFileSet(REPO_FS(pRepo), TSDB_DELETE_WSET(pdh));
+  tsdbInvalidateBlkCache(pRepo->blkCache, pSet->fid);
+  tsdbInvalidateHeadMap(pRepo->headMap, pSet->fid);
   tsdbDebug("vgId:%d :SDEL FSET %d delete data over", REPO_ID(pRepo), pSet->fid);
 
   tsdbFSetEnd(pdh);
@@ -403,6 +406,7 @@ static void tsdbDestroyDeleteH(SDeleteH *pdh) {
   pdh->pDCols = tdFreeDataCols(pdh->pDCols);
   pdh->aSupBlk = taosArrayDestroy(&pdh->aSupBlk);
   pdh->aSubBlk = taosArrayDestroy(&pdh->aSubBlk);
+  tsdbDestroyZoneMapH(&(pdh->zmh));
   pdh->aBlkIdx = taosArrayDestroy(&pdh->aBlkIdx);
   tsdbDestroyDeleteTblArray(pdh);
   tsdbDestroyReadH(&(pdh->readh));
@@ -682,6 +686,9 @@ static int tsdbModifyBlocks(SDeleteH *pdh, STableDeleteH *pItem) {
   }
   tdFreeSchema(pSchema);
 
+  // the zone map is located by the blocks read, so get it before they are removed
+  tsdbResetZoneMapH(&(pdh->zmh), pItem->pInfo, pItem->pBlkIdx);
+
   // delete block
   tsdbRemoveDelBlocks(pdh, pItem);
   if(pItem->pBlkIdx->numOfBlocks == 0) {
@@ -725,7 +732,7 @@ static int tsdbModifyBlocks(SDeleteH *pdh, STableDeleteH *pItem) {
   }
 
   // write block info for each table
-  if (tsdbWriteBlockInfoImpl(TSDB_DELETE_HEAD_FILE(pdh), pItem->pTable, pdh->aSupBlk, pdh->aSubBlk,
+  if (tsdbWriteBlockInfoImpl(TSDB_DELETE_HEAD_FILE(pdh), pItem->pTable, pdh->aSupBlk, pdh->aSubBlk, &(pdh->zmh),
                               ppBuf, &blkIdx) < 0) {
     tsdbError("vgId:%d :SDEL tsdbWriteBlockInfoImpl return -1. tid=%d. errno=%d (%s)", REPO_ID(pdh->pRepo),
               pItem->pTable->tableId.tid,  errno, tstrerror(terrno));
@@ -755,6 +762,7 @@ static int tsdbKeepIntactBlocks(SDeleteH *pdh, STableDeleteH * pItem) {
   SBlockIdx  blkIdx  = {0};
   taosArrayClear(pdh->aSupBlk);
   taosArrayClear(pdh->aSubBlk);
+  tsdbResetZoneMapH(&(pdh->zmh), pItem->pInfo, pItem->pBlkIdx);
 
   for (int32_t i = 0; i < pItem->pBlkIdx->numOfBlocks; i++) {
     SBlock *pBlock = pItem->pInfo->blocks + i;
@@ -764,7 +772,7 @@ static int tsdbKeepIntactBlocks(SDeleteH *pdh, STableDeleteH * pItem) {
   // write block info for one table
   void **ppBuf = &(TSDB_DELETE_BUF(pdh));
   int32_t ret  = tsdbWriteBlockInfoImpl(TSDB_DELETE_HEAD_FILE(pdh), pItem->pTable, pdh->aSupBlk, 
-                                       pdh->aSubBlk, ppBuf, &blkIdx);
+                                       pdh->aSubBlk, &(pdh->zmh), ppBuf, &blkIdx);
   if (ret != TSDB_CODE_SUCCESS) {
     return ret;
   }
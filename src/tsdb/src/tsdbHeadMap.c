@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tsdbint.h"
+
+static SHeadMapEntry *tsdbNewHeadMapEntry(SDFile *pHeadf, int fid);
+static void           tsdbFreeHeadMapEntry(SHeadMapEntry *pEntry);
+static SHeadMapEntry *tsdbSearchHeadMap(STsdbHeadMap *pHeadMap, SDFile *pHeadf, int fid);
+static void           tsdbRemoveHeadMapEntries(STsdbHeadMap *pHeadMap, int fid, SArray *pRemoved);
+static bool           tsdbIsCurrentHeadFile(STsdbRepo *pRepo, SDFile *pHeadf, int fid);
+
+STsdbHeadMap *tsdbNewHeadMap() {
+  STsdbHeadMap *pHeadMap = (STsdbHeadMap *)calloc(1, sizeof(*pHeadMap));
+  if (pHeadMap == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  pHeadMap->entries = taosArrayInit(16, sizeof(SHeadMapEntry *));
+  if (pHeadMap->entries == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    free(pHeadMap);
+    return NULL;
+  }
+
+  int code = pthread_mutex_init(&(pHeadMap->lock), NULL);
+  if (code != 0) {
+    terrno = TAOS_SYSTEM_ERROR(code);
+    taosArrayDestroy(&pHeadMap->entries);
+    free(pHeadMap);
+    return NULL;
+  }
+
+  return pHeadMap;
+}
+
+void tsdbFreeHeadMap(STsdbHeadMap *pHeadMap) {
+  if (pHeadMap == NULL) return;
+
+  for (size_t i = 0; i < taosArrayGetSize(pHeadMap->entries); i++) {
+    tsdbReleaseHeadMap(taosArrayGetP(pHeadMap->entries, i));
+  }
+
+  taosArrayDestroy(&pHeadMap->entries);
+  pthread_mutex_destroy(&(pHeadMap->lock));
+  free(pHeadMap);
+}
+
+/*
+ * Get the mapped .head file of a reader. Only the .head file of the current file set is kept in the head map, a reader
+ * of an outdated file set gets a private entry. NULL is returned if the file can not be mapped, the reader then loads
+ * the file as usual.
+ */
+SHeadMapEntry *tsdbAcquireHeadMap(STsdbHeadMap *pHeadMap, STsdbRepo *pRepo, SDFile *pHeadf, int fid) {
+  pthread_mutex_lock(&(pHeadMap->lock));
+  SHeadMapEntry *pEntry = tsdbSearchHeadMap(pHeadMap, pHeadf, fid);
+  if (pEntry != NULL) {
+    atomic_add_fetch_32(&(pEntry->refCount), 1);
+  }
+  pthread_mutex_unlock(&(pHeadMap->lock));
+
+  if (pEntry != NULL) return pEntry;
+
+  pEntry = tsdbNewHeadMapEntry(pHeadf, fid);
+  if (pEntry == NULL || !tsdbIsCurrentHeadFile(pRepo, pHeadf, fid)) return pEntry;
+
+  SArray *pRemoved = taosArrayInit(4, sizeof(SHeadMapEntry *));
+  if (pRemoved == NULL) return pEntry;
+
+  pthread_mutex_lock(&(pHeadMap->lock));
+  SHeadMapEntry *pExist = tsdbSearchHeadMap(pHeadMap, pHeadf, fid);
+  if (pExist != NULL) {
+    // mapped by another reader at the same time
+    atomic_add_fetch_32(&(pExist->refCount), 1);
+  } else {
+    // the entries of the former .head files of the file set are not used by new readers any more
+    tsdbRemoveHeadMapEntries(pHeadMap, fid, pRemoved);
+    if (taosArrayPush(pHeadMap->entries, &pEntry) != NULL) {
+      atomic_add_fetch_32(&(pEntry->refCount), 1);
+    }
+  }
+  pthread_mutex_unlock(&(pHeadMap->lock));
+
+  for (size_t i = 0; i < taosArrayGetSize(pRemoved); i++) {
+    tsdbReleaseHeadMap(taosArrayGetP(pRemoved, i));
+  }
+  taosArrayDestroy(&pRemoved);
+
+  if (pExist != NULL) {
+    tsdbReleaseHeadMap(pEntry);
+    return pExist;
+  }
+
+  return pEntry;
+}
+
+void tsdbReleaseHeadMap(SHeadMapEntry *pEntry) {
+  if (pEntry == NULL) return;
+
+  if (atomic_sub_fetch_32(&(pEntry->refCount), 1) == 0) {
+    tsdbFreeHeadMapEntry(pEntry);
+  }
+}
+
+// The SBlockInfo part of a table in the mapped file, NULL if it is corrupted
+SBlockInfo *tsdbGetBlockInfoFromHeadMap(SHeadMapEntry *pEntry, SBlockIdx *pBlkIdx) {
+  size_t idx = pBlkIdx - (SBlockIdx *)TARRAY_GET_START(pEntry->aBlkIdx);
+  ASSERT(idx < taosArrayGetSize(pEntry->aBlkIdx));
+
+  if ((int64_t)pBlkIdx->offset + pBlkIdx->len > pEntry->mapLen) {
+    terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
+    return NULL;
+  }
+
+  SBlockInfo *pBlkInfo = (SBlockInfo *)POINTER_SHIFT(pEntry->pMap, pBlkIdx->offset);
+  if (atomic_load_8(pEntry->verified + idx) == 0) {
+    if (!taosCheckChecksumWhole((uint8_t *)pBlkInfo, pBlkIdx->len)) {
+      terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
+      return NULL;
+    }
+
+    atomic_store_8(pEntry->verified + idx, 1);
+  }
+
+  return pBlkInfo;
+}
+
+void tsdbInvalidateHeadMap(STsdbHeadMap *pHeadMap, int fid) {
+  if (pHeadMap == NULL) return;
+
+  SArray *pRemoved = taosArrayInit(4, sizeof(SHeadMapEntry *));
+  if (pRemoved == NULL) return;
+
+  pthread_mutex_lock(&(pHeadMap->lock));
+  tsdbRemoveHeadMapEntries(pHeadMap, fid, pRemoved);
+  pthread_mutex_unlock(&(pHeadMap->lock));
+
+  for (size_t i = 0; i < taosArrayGetSize(pRemoved); i++) {
+    tsdbReleaseHeadMap(taosArrayGetP(pRemoved, i));
+  }
+
+  if (taosArrayGetSize(pRemoved) > 0) {
+    tsdbDebug("mapped head file of FSET %d is invalidated", fid);
+  }
+
+  taosArrayDestroy(&pRemoved);
+}
+
+static SHeadMapEntry *tsdbNewHeadMapEntry(SDFile *pHeadf, int fid) {
+  SDFInfo *   pInfo = TSDB_FILE_INFO(pHeadf);
+  struct stat fstatus;
+
+  // the file may be truncated by a failed commit, which would fault the mapped pages
+  if (fstat(TSDB_FILE_FD(pHeadf), &fstatus) < 0 || (uint64_t)fstatus.st_size < pInfo->size ||
+      (uint64_t)pInfo->offset + pInfo->len > pInfo->size || pInfo->len < sizeof(TSCKSUM)) {
+    tsdbDebug("head file %s is not mapped, size:%" PRIu64 " offset:%u len:%u", TSDB_FILE_FULL_NAME(pHeadf),
+              pInfo->size, pInfo->offset, pInfo->len);
+    return NULL;
+  }
+
+  SHeadMapEntry *pEntry = (SHeadMapEntry *)calloc(1, sizeof(*pEntry));
+  if (pEntry == NULL) return NULL;
+
+  pEntry->fid = fid;
+  pEntry->info = *pInfo;
+  pEntry->refCount = 1;
+  pEntry->fname = strdup(TSDB_FILE_FULL_NAME(pHeadf));
+  pEntry->aBlkIdx = taosArrayInit(1024, sizeof(SBlockIdx));
+  pEntry->mapLen = (int64_t)pInfo->size;
+  pEntry->pMap = taosMmapReadOnly(TSDB_FILE_FD(pHeadf), pEntry->mapLen);
+  if (pEntry->fname == NULL || pEntry->aBlkIdx == NULL || pEntry->pMap == NULL) {
+    tsdbDebug("head file %s is not mapped since %s", TSDB_FILE_FULL_NAME(pHeadf), strerror(errno));
+    tsdbFreeHeadMapEntry(pEntry);
+    return NULL;
+  }
+
+  void *pIdxPart = POINTER_SHIFT(pEntry->pMap, pInfo->offset);
+  if (!taosCheckChecksumWhole((uint8_t *)pIdxPart, pInfo->len)) {
+    tsdbError("SBlockIdx part in mapped file %s is corrupted since wrong checksum, offset:%u len :%u",
+              TSDB_FILE_FULL_NAME(pHeadf), pInfo->offset, pInfo->len);
+    tsdbFreeHeadMapEntry(pEntry);
+    return NULL;
+  }
+
+  void *ptr = pIdxPart;
+  while (POINTER_DISTANCE(ptr, pIdxPart) < (pInfo->len - sizeof(TSCKSUM))) {
+    SBlockIdx blkIdx;
+    ptr = tsdbDecodeSBlockIdx(ptr, &blkIdx);
+
+    size_t     size = taosArrayGetSize(pEntry->aBlkIdx);
+    SBlockIdx *pLast = (size > 0) ? taosArrayGetLast(pEntry->aBlkIdx) : NULL;
+    if (ptr == NULL || (pLast != NULL && pLast->tid >= blkIdx.tid) ||
+        taosArrayPush(pEntry->aBlkIdx, &blkIdx) == NULL) {
+      tsdbFreeHeadMapEntry(pEntry);
+      return NULL;
+    }
+  }
+
+  pEntry->verified = calloc(taosArrayGetSize(pEntry->aBlkIdx) + 1, sizeof(int8_t));
+  if (pEntry->verified == NULL) {
+    tsdbFreeHeadMapEntry(pEntry);
+    return NULL;
+  }
+
+  tsdbDebug("head file %s is mapped, %d tables", pEntry->fname, (int)taosArrayGetSize(pEntry->aBlkIdx));
+  return pEntry;
+}
+
+static void tsdbFreeHeadMapEntry(SHeadMapEntry *pEntry) {
+  taosMunmap(pEntry->pMap, pEntry->mapLen);
+  taosArrayDestroy(&pEntry->aBlkIdx);
+  tfree(pEntry->verified);
+  tfree(pEntry->fname);
+  free(pEntry);
+}
+
+static SHeadMapEntry *tsdbSearchHeadMap(STsdbHeadMap *pHeadMap, SDFile *pHeadf, int fid) {
+  SDFInfo *pInfo = TSDB_FILE_INFO(pHeadf);
+
+  for (size_t i = 0; i < taosArrayGetSize(pHeadMap->entries); i++) {
+    SHeadMapEntry *pEntry = taosArrayGetP(pHeadMap->entries, i);
+    if (pEntry->fid == fid && pEntry->info.size == pInfo->size && pEntry->info.offset == pInfo->offset &&
+        pEntry->info.len == pInfo->len && strcmp(pEntry->fname, TSDB_FILE_FULL_NAME(pHeadf)) == 0) {
+      return pEntry;
+    }
+  }
+
+  return NULL;
+}
+
+static void tsdbRemoveHeadMapEntries(STsdbHeadMap *pHeadMap, int fid, SArray *pRemoved) {
+  size_t i = 0;
+  while (i < taosArrayGetSize(pHeadMap->entries)) {
+    SHeadMapEntry *pEntry = taosArrayGetP(pHeadMap->entries, i);
+    if (pEntry->fid == fid && taosArrayPush(pRemoved, &pEntry) != NULL) {
+      taosArrayRemove(pHeadMap->entries, i);
+    } else {
+      i++;
+    }
+  }
+}
+
+static bool tsdbIsCurrentHeadFile(STsdbRepo *pRepo, SDFile *pHeadf, int fid) {
+  STsdbFS *pfs = REPO_FS(pRepo);
+  SFSIter  fsiter;
+  bool     current = false;
+
+  if (tsdbRLockFS(pfs) < 0) return false;
+
+  tsdbFSIterInit(&fsiter, pfs, TSDB_FS_ITER_FORWARD);
+  tsdbFSIterSeek(&fsiter, fid);
+  SDFileSet *pSet = tsdbFSIterNext(&fsiter);
+  if (pSet != NULL && TSDB_FSET_FID(pSet) == fid) {
+    current = (strcmp(TSDB_FILE_FULL_NAME(TSDB_DFILE_IN_SET(pSet, TSDB_FILE_HEAD)), TSDB_FILE_FULL_NAME(pHeadf)) == 0);
+  }
+
+  tsdbUnLockFS(pfs);
+  return current;
+}
@@ -19,6 +19,9 @@
 #include "ttimer.h"
 #include "tthread.h"
 
+extern int32_t tsdbBlkCacheSize;
+extern int8_t  tsdbHeadMmap;
+
 #define IS_VALID_PRECISION(precision) \
   (((precision) >= TSDB_TIME_PRECISION_MILLI) && ((precision) <= TSDB_TIME_PRECISION_NANO))
 #define TSDB_DEFAULT_COMPRESSION TWO_STAGE_COMP
@@ -628,11 +631,31 @@ static STsdbRepo *tsdbNewRepo(STsdbCfg *pCfg, STsdbAppH *pAppH) {
     return NULL;
   }
 
+  if (tsdbBlkCacheSize > 0) {
+    pRepo->blkCache = tsdbNewBlkCache((int64_t)tsdbBlkCacheSize * 1024 * 1024);
+    if (pRepo->blkCache == NULL) {
+      tsdbError("vgId:%d failed to create block cache since %s", REPO_ID(pRepo), tstrerror(terrno));
+      tsdbFreeRepo(pRepo);
+      return NULL;
+    }
+  }
+
+  if (tsdbHeadMmap) {
+    pRepo->headMap = tsdbNewHeadMap();
+    if (pRepo->headMap == NULL) {
+      tsdbError("vgId:%d failed to create head map since %s", REPO_ID(pRepo), tstrerror(terrno));
+      tsdbFreeRepo(pRepo);
+      return NULL;
+    }
+  }
+
   return pRepo;
 }
 
 static void tsdbFreeRepo(STsdbRepo *pRepo) {
   if (pRepo) {
+    tsdbFreeHeadMap(pRepo->headMap);
+    tsdbFreeBlkCache(pRepo->blkCache);
     tsdbFreeFS(pRepo->fs);
     tsdbFreeBufPool(pRepo->pPool);
     tsdbFreeMeta(pRepo->tsdbMeta);
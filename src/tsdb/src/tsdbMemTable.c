@@ -22,6 +22,8 @@
 #define TSDB_DATA_SKIPLIST_LEVEL 5
 #define TSDB_MAX_INSERT_BATCH 512
 
+extern int8_t tsdbMemAppendMode;
+
 typedef struct {
   int32_t  totalLen;
   int32_t  len;
@@ -45,6 +47,7 @@ static int          tsdbInitSubmitBlkIter(SSubmitBlk *pBlock, SSubmitBlkIter *pI
 static SMemRow      tsdbGetSubmitBlkNext(SSubmitBlkIter *pIter);
 static int          tsdbScanAndConvertSubmitMsg(STsdbRepo *pRepo, SSubmitMsg *pMsg);
 static int          tsdbInsertDataToTable(STsdbRepo *pRepo, SSubmitBlk *pBlock, int32_t *affectedrows);
+static int64_t      tsdbAppendDataToTable(STableData *pTableData, SSubmitBlkIter *pBlkIter);
 static int          tsdbInitSubmitMsgIter(SSubmitMsg *pMsg, SSubmitMsgIter *pIter);
 static int          tsdbGetSubmitMsgNext(SSubmitMsgIter *pIter, SSubmitBlk **pPBlock);
 static int          tsdbCheckTableSchema(STsdbRepo *pRepo, SSubmitBlk *pBlock, STable *pTable);
@@ -392,7 +395,7 @@ int tsdbSyncCommit(STsdbRepo *repo) {
  * 
  * The function tries to procceed AS MUCH AS POSSIBLE.
  */
-int tsdbLoadDataFromCache(STable *pTable, SSkipListIterator *pIter, TSKEY maxKey, int maxRowsToRead, SDataCols *pCols,
+int tsdbLoadDataFromCache(STable *pTable, STableDataIter *pIter, TSKEY maxKey, int maxRowsToRead, SDataCols *pCols,
                           TKEY *filterKeys, int nFilterKeys, bool keepDup, SMergeInfo *pMergeInfo) {
   ASSERT(maxRowsToRead > 0 && nFilterKeys >= 0);
   if (pIter == NULL) return 0;
@@ -452,7 +455,7 @@ int tsdbLoadDataFromCache(STable *pTable, SSkipListIterator *pIter, TSKEY maxKey
         tsdbAppendTableRowToCols(pTable, pCols, &pSchema, row);
       }
 
-      tSkipListIterNext(pIter);
+      tsdbTableDataIterNext(pIter);
       row = tsdbNextIterRow(pIter);
       if (row == NULL || memRowKey(row) > maxKey) {
         rowKey = INT64_MAX;
@@ -482,7 +485,7 @@ int tsdbLoadDataFromCache(STable *pTable, SSkipListIterator *pIter, TSKEY maxKey
         }
       }
 
-      tSkipListIterNext(pIter);
+      tsdbTableDataIterNext(pIter);
       row = tsdbNextIterRow(pIter);
       if (row == NULL || memRowKey(row) > maxKey) {
         rowKey = INT64_MAX;
@@ -570,6 +573,7 @@ static STableData *tsdbNewTableData(STsdbCfg *pCfg, STable *pTable) {
   pTableData->keyFirst = INT64_MAX;
   pTableData->keyLast = 0;
   pTableData->numOfRows = 0;
+  pTableData->appendMode = (tsdbMemAppendMode != 0);
 
   uint8_t skipListCreateFlags;
   if(pCfg->update == TD_ROW_DISCARD_UPDATE)
@@ -596,11 +600,212 @@ static void tsdbFreeTableData(STableData *pTableData) {
     int32_t ref = T_REF_DEC(pTableData);
     if (ref == 0) {
       tSkipListDestroy(pTableData->pData);
+      STableDataChunk *pChunk = pTableData->pHead;
+      while (pChunk) {
+        STableDataChunk *pNext = pChunk->next;
+        free(pChunk);
+        pChunk = pNext;
+      }
       free(pTableData);
     }
   }
 }
 
+static SMemRow *tsdbLastAppendedRow(STableData *pTableData) {
+  STableDataChunk *pChunk = pTableData->pTail;
+  if (pChunk == NULL || pChunk->numOfRows == 0) return NULL;
+
+  return pChunk->rows + pChunk->numOfRows - 1;
+}
+
+// find the appended row with the given key, out of order rows are usually close to the last one
+static SMemRow *tsdbFindAppendedRow(STableData *pTableData, TSKEY key) {
+  STableDataChunk *pChunk = pTableData->pTail;
+  while (pChunk != NULL && (pChunk->numOfRows == 0 || key < memRowKey(pChunk->rows[0]))) {
+    pChunk = pChunk->prev;
+  }
+
+  if (pChunk == NULL) return NULL;
+
+  int32_t low = 0, high = pChunk->numOfRows - 1;
+  while (low <= high) {
+    int32_t mid = (low + high) >> 1;
+    TSKEY   midKey = memRowKey(pChunk->rows[mid]);
+    if (midKey == key) {
+      return pChunk->rows + mid;
+    } else if (midKey < key) {
+      low = mid + 1;
+    } else {
+      high = mid - 1;
+    }
+  }
+
+  return NULL;
+}
+
+static int tsdbAppendTableDataRow(STableData *pTableData, SMemRow row) {
+  STableDataChunk *pChunk = pTableData->pTail;
+
+  if (pChunk == NULL || pChunk->numOfRows >= pChunk->capacity) {
+    int32_t capacity = (pChunk == NULL) ? TSDB_DATA_CHUNK_MIN_ROWS : MIN(pChunk->capacity * 2, TSDB_DATA_CHUNK_MAX_ROWS);
+
+    STableDataChunk *pNew = (STableDataChunk *)malloc(sizeof(STableDataChunk) + sizeof(SMemRow) * capacity);
+    if (pNew == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      return -1;
+    }
+
+    pNew->prev = pChunk;
+    pNew->next = NULL;
+    pNew->capacity = capacity;
+    pNew->numOfRows = 0;
+
+    // the new chunk is published after it is initialized, readers may go through the list concurrently
+    if (pChunk == NULL) {
+      atomic_store_ptr(&pTableData->pHead, pNew);
+    } else {
+      atomic_store_ptr(&pChunk->next, pNew);
+    }
+    atomic_store_ptr(&pTableData->pTail, pNew);
+    pChunk = pNew;
+  }
+
+  pChunk->rows[pChunk->numOfRows] = row;
+  atomic_store_32(&pChunk->numOfRows, pChunk->numOfRows + 1);
+  return 0;
+}
+
+STableDataIter *tsdbCreateTableDataIter(STableData *pTableData, TKEY *pKey, int32_t order) {
+  STableDataIter *pIter = (STableDataIter *)calloc(1, sizeof(*pIter));
+  if (pIter == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  SSkipListIterator *pSlIter = tSkipListCreateIterFromVal(pTableData->pData, (const char *)pKey, TSDB_DATA_TYPE_TIMESTAMP, order);
+  if (pSlIter == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    free(pIter);
+    return NULL;
+  }
+
+  pIter->slIter = *pSlIter;
+  tSkipListDestroyIter(pSlIter);
+  pIter->order = order;
+
+  STableDataChunk *pChunk = NULL;
+  int32_t          idx = 0;
+  if ((order == TSDB_ORDER_ASC)) {
+    pChunk = atomic_load_ptr(&pTableData->pHead);
+    if (pKey != NULL && pChunk != NULL) {
+      TSKEY key = tdGetKey(*pKey);
+      // all chunks before the tail are full
+      while (atomic_load_ptr(&pChunk->next) != NULL && memRowKey(pChunk->rows[pChunk->numOfRows - 1]) < key) {
+        pChunk = pChunk->next;
+      }
+
+      int32_t numOfRows = atomic_load_32(&pChunk->numOfRows);
+      while (idx < numOfRows && memRowKey(pChunk->rows[idx]) < key) idx++;
+    }
+  } else {
+    pChunk = atomic_load_ptr(&pTableData->pTail);
+    if (pChunk != NULL) {
+      idx = atomic_load_32(&pChunk->numOfRows) - 1;
+      if (idx < 0 && pChunk->prev != NULL) {
+        // the tail chunk is just created
+        pChunk = pChunk->prev;
+        idx = pChunk->numOfRows - 1;
+      }
+
+      if (pKey != NULL && idx >= 0) {
+        TSKEY key = tdGetKey(*pKey);
+        while (pChunk->prev != NULL && memRowKey(pChunk->rows[0]) > key) {
+          pChunk = pChunk->prev;
+          idx = pChunk->numOfRows - 1;
+        }
+
+        while (idx >= 0 && memRowKey(pChunk->rows[idx]) > key) idx--;
+      }
+    }
+  }
+
+  pIter->pChunk = pChunk;
+  pIter->idx = idx;
+  return pIter;
+}
+
+void *tsdbDestroyTableDataIter(STableDataIter *pIter) {
+  tfree(pIter);
+  return NULL;
+}
+
+static SMemRow tsdbTableDataIterChunkRow(STableDataIter *pIter) {
+  STableDataChunk *pChunk = pIter->pChunk;
+  if (pChunk == NULL) return NULL;
+
+  if ((pIter->order == TSDB_ORDER_ASC)) {
+    if (pIter->idx >= atomic_load_32(&pChunk->numOfRows)) {
+      STableDataChunk *pNext = atomic_load_ptr(&pChunk->next);
+      if (pNext == NULL || atomic_load_32(&pNext->numOfRows) == 0) return NULL;
+
+      pIter->pChunk = pChunk = pNext;
+      pIter->idx = 0;
+    }
+  } else if (pIter->idx < 0) {
+    if (pChunk->prev == NULL) {
+      pIter->pChunk = NULL;
+      return NULL;
+    }
+
+    pIter->pChunk = pChunk = pChunk->prev;
+    pIter->idx = pChunk->numOfRows - 1;
+  }
+
+  return atomic_load_ptr(&pChunk->rows[pIter->idx]);
+}
+
+static SMemRow tsdbTableDataIterSlRow(STableDataIter *pIter) {
+  SSkipListNode *node = tSkipListIterGet(&pIter->slIter);
+  if (node == NULL) return NULL;
+
+  return (SMemRow)SL_GET_NODE_DATA(node);
+}
+
+SMemRow tsdbTableDataIterGet(STableDataIter *pIter) {
+  if (!pIter->started) return NULL;
+
+  SMemRow slRow = tsdbTableDataIterSlRow(pIter);
+  SMemRow chunkRow = tsdbTableDataIterChunkRow(pIter);
+  if (slRow == NULL) return chunkRow;
+  if (chunkRow == NULL) return slRow;
+
+  // keys in the skiplist and the chunks never overlap
+  if ((pIter->order == TSDB_ORDER_ASC)) {
+    return (memRowKey(slRow) < memRowKey(chunkRow)) ? slRow : chunkRow;
+  } else {
+    return (memRowKey(slRow) > memRowKey(chunkRow)) ? slRow : chunkRow;
+  }
+}
+
+bool tsdbTableDataIterNext(STableDataIter *pIter) {
+  if (!pIter->started) {
+    pIter->started = true;
+    tSkipListIterNext(&pIter->slIter);
+    return tsdbTableDataIterGet(pIter) != NULL;
+  }
+
+  SMemRow row = tsdbTableDataIterGet(pIter);
+  if (row == NULL) return false;
+
+  if (row == tsdbTableDataIterSlRow(pIter)) {
+    tSkipListIterNext(&pIter->slIter);
+  } else {
+    pIter->idx += (pIter->order == TSDB_ORDER_ASC) ? 1 : -1;
+  }
+
+  return tsdbTableDataIterGet(pIter) != NULL;
+}
+
 static char *tsdbGetTsTupleKey(const void *data) { return memRowKeys((SMemRow)data); }
 
 static int tsdbAdjustMemMaxTables(SMemTable *pMemTable, int maxTables) {
@@ -884,9 +1089,15 @@ static int tsdbInsertDataToTable(STsdbRepo* pRepo, SSubmitBlk* pBlock, int32_t *
 
   SMemRow lastRow = NULL;
   int64_t osize = SL_SIZE(pTableData->pData);
+  int64_t nAppended = 0;
   tsdbSetupSkipListHookFns(pTableData->pData, pRepo, pTable, &points, &lastRow);
-  tSkipListPutBatchByIter(pTableData->pData, &blkIter, (iter_next_fn_t)tsdbGetSubmitBlkNext);
-  int64_t dsize = SL_SIZE(pTableData->pData) - osize;
+  if (pTableData->appendMode) {
+    nAppended = tsdbAppendDataToTable(pTableData, &blkIter);
+    if (nAppended < 0) return -1;
+  } else {
+    tSkipListPutBatchByIter(pTableData->pData, &blkIter, (iter_next_fn_t)tsdbGetSubmitBlkNext);
+  }
+  int64_t dsize = SL_SIZE(pTableData->pData) - osize + nAppended;
   (*pAffectedRows) += points;
 
   if(lastRow != NULL) {
@@ -911,6 +1122,56 @@ static int tsdbInsertDataToTable(STsdbRepo* pRepo, SSubmitBlk* pBlock, int32_t *
 }
 
 
+/*
+ * Rows with keys larger than all existing ones are appended to the chunks without any search, which is the common case
+ * of time series. Rows out of order go to the skiplist, unless the key exists in the chunks already. Duplicate keys
+ * are handled by the same hook as the skiplist does.
+ *
+ * return the number of rows appended to the chunks, -1 on failure
+ */
+static int64_t tsdbAppendDataToTable(STableData *pTableData, SSubmitBlkIter *pBlkIter) {
+  SSkipList         *pSkipList = pTableData->pData;
+  tGenericSavedFunc *pInsertFn = pSkipList->insertHandleFn;
+  int64_t            nAppended = 0;
+  SMemRow            row = NULL;
+
+  while ((row = tsdbGetSubmitBlkNext(pBlkIter)) != NULL) {
+    TSKEY    key = memRowKey(row);
+    SMemRow *pSlot = tsdbLastAppendedRow(pTableData);
+
+    if (pSlot != NULL && key <= memRowKey(*pSlot)) {
+      if (key < memRowKey(*pSlot)) pSlot = tsdbFindAppendedRow(pTableData, key);
+      if (pSlot == NULL) {
+        tSkipListPut(pSkipList, row);
+        continue;
+      }
+
+      if (SL_DUP_MODE(pSkipList) == SL_UPDATE_DUP_KEY) {
+        pInsertFn->args[0] = row;
+        pInsertFn->args[1] = *pSlot;
+        SMemRow pMem = genericInvoke(pInsertFn);
+        if (pMem != NULL) atomic_store_ptr(pSlot, pMem);
+      } else {
+        // for compatiblity, duplicate key inserted when update=0 should be also calculated as affected rows!
+        pInsertFn->args[0] = NULL;
+        pInsertFn->args[1] = NULL;
+        genericInvoke(pInsertFn);
+      }
+      continue;
+    }
+
+    pInsertFn->args[0] = row;
+    pInsertFn->args[1] = NULL;
+    SMemRow pMem = genericInvoke(pInsertFn);
+    if (pMem == NULL) return -1;
+
+    if (tsdbAppendTableDataRow(pTableData, pMem) < 0) return -1;
+    nAppended++;
+  }
+
+  return nAppended;
+}
+
 static int tsdbInitSubmitMsgIter(SSubmitMsg *pMsg, SSubmitMsgIter *pIter) {
   if (pMsg == NULL) {
     terrno = TSDB_CODE_TDB_SUBMIT_MSG_MSSED_UP;
@@ -19,6 +19,8 @@
 #define TSDB_SUPER_TABLE_SL_LEVEL 5
 #define DEFAULT_TAG_INDEX_COLUMN 0
 
+extern int8_t tsdbTagIndex;
+
 static char *  getTagIndexKey(const void *pData);
 static STable *tsdbNewTable();
 static STable *tsdbCreateTableFromCfg(STableCfg *pCfg, bool isSuper, STable *pSTable);
@@ -27,6 +29,11 @@ static int     tsdbAddTableToMeta(STsdbRepo *pRepo, STable *pTable, bool addIdx,
 static void    tsdbRemoveTableFromMeta(STsdbRepo *pRepo, STable *pTable, bool rmFromIdx, bool lock);
 static int     tsdbAddTableIntoIndex(STsdbMeta *pMeta, STable *pTable, bool refSuper);
 static int     tsdbRemoveTableFromIndex(STsdbMeta *pMeta, STable *pTable);
+static int     tsdbInitTagIndex(STable *pSTable);
+static void    tsdbFreeTagIndex(STable *pSTable);
+static void    tsdbRebuildTagIndex(STsdbRepo *pRepo, STable *pSTable);
+static int     tsdbAddTableIntoTagIndex(STable *pSTable, STable *pTable);
+static void    tsdbRemoveTableFromTagIndex(STable *pSTable, STable *pTable);
 static int     tsdbInitTableCfg(STableCfg *config, ETableType type, uint64_t uid, int32_t tid);
 static int     tsdbTableSetSchema(STableCfg *config, STSchema *pSchema, bool dup);
 static int     tsdbTableSetName(STableCfg *config, char *name, bool dup);
@@ -118,6 +125,9 @@ int tsdbCreateTable(STsdbRepo *repo, STableCfg *pCfg) {
 
   // Register to meta
   tsdbWLockRepoMeta(pRepo);
+  if (superChanged) {
+    tsdbRebuildTagIndex(pRepo, super);
+  }
   if (newSuper) {
     if (tsdbAddTableToMeta(pRepo, super, true, false) < 0) {
       super = NULL;
@@ -391,10 +401,14 @@ int tsdbUpdateTableTagValue(STsdbRepo *repo, SUpdateTableTagValMsg *pMsg) {
     pTable->pSuper->tagSchema = pNewSchema;
     tdFreeSchema(pOldSchema);
     TSDB_WUNLOCK_TABLE(pTable->pSuper);
+
+    tsdbWLockRepoMeta(pRepo);
+    tsdbRebuildTagIndex(pRepo, pTable->pSuper);
+    tsdbUnlockRepoMeta(pRepo);
   }
 
   bool      isChangeIndexCol = (pMsg->colId == colColId(schemaColAt(pTable->pSuper->tagSchema, 0)))
-      || pMsg->type == TSDB_DATA_TYPE_JSON;
+      || pMsg->type == TSDB_DATA_TYPE_JSON || tsdbGetTagIndex(pTable->pSuper, pMsg->colId, pMsg->type) != NULL;
   // STColumn *pCol = bsearch(&(pMsg->colId), pMsg->data, pMsg->numOfTags, sizeof(STColumn), colIdCompar);
   // ASSERT(pCol != NULL);
 
@@ -873,7 +887,7 @@ static STable *tsdbCreateTableFromCfg(STableCfg *pCfg, bool isSuper, STable *pST
     }else{
       pTable->pIndex = tSkipListCreate(TSDB_SUPER_TABLE_SL_LEVEL, colType(pCol), (uint8_t)(colBytes(pCol)), NULL,
                                        SL_ALLOW_DUP_KEY, getTagIndexKey);
-      if (pTable->pIndex == NULL) {
+      if (pTable->pIndex == NULL || tsdbInitTagIndex(pTable) < 0) {
         terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
         goto _err;
       }
@@ -946,6 +960,7 @@ static void tsdbFreeTable(STable *pTable) {
     kvRowFree(pTable->tagVal);
 
     tSkipListDestroy(pTable->pIndex);
+    tsdbFreeTagIndex(pTable);
     taosHashCleanup(pTable->jsonKeyMap);
     taosTZfree(pTable->lastRow);    
     tfree(pTable->sql);
@@ -1084,6 +1099,39 @@ void* tsdbGetJsonTagValue(STable* pTable, char* key, int32_t keyLen, int16_t* re
   return tdGetKVRowValOfCol(pTable->tagVal, colId);
 }
 
+STagIndex *tsdbGetTagIndex(STable *pSTable, int16_t colId, int8_t type) {
+  if (pSTable->tagIndex == NULL) return NULL;
+
+  for (size_t i = 0; i < taosArrayGetSize(pSTable->tagIndex); i++) {
+    STagIndex *pTagIdx = taosArrayGet(pSTable->tagIndex, i);
+    if (pTagIdx->colId == colId) {
+      return (pTagIdx->type == type) ? pTagIdx : NULL;
+    }
+  }
+
+  return NULL;
+}
+
+static void tsdbGetTagIndexKey(STagIndex *pTagIdx, const void *val, const void **key, size_t *keyLen) {
+  if (IS_VAR_DATA_TYPE(pTagIdx->type)) {
+    *key = varDataVal(val);
+    *keyLen = varDataLen(val);
+  } else {
+    *key = val;
+    *keyLen = tDataTypes[pTagIdx->type].bytes;
+  }
+}
+
+// The child tables with the tag value, ordered by the table pointer
+SArray *tsdbGetTagIndexTables(STagIndex *pTagIdx, const void *val) {
+  const void *key = NULL;
+  size_t      keyLen = 0;
+
+  tsdbGetTagIndexKey(pTagIdx, val, &key, &keyLen);
+  SArray **tablist = (SArray **)taosHashGet(pTagIdx->map, key, keyLen);
+  return (tablist == NULL) ? NULL : *tablist;
+}
+
 int tsdbCompareJsonMapValue(const void* a, const void* b) {
   const JsonMapValue* x = (const JsonMapValue*)a;
   const JsonMapValue* y = (const JsonMapValue*)b;
@@ -1092,6 +1140,163 @@ int tsdbCompareJsonMapValue(const void* a, const void* b) {
   return 0;
 }
 
+int tsdbCompareTablePtr(const void *a, const void *b) {
+  const STable *x = *(const STable **)a;
+  const STable *y = *(const STable **)b;
+  if (x > y) return 1;
+  if (x < y) return -1;
+  return 0;
+}
+
+// The first tag column is indexed by the skiplist, float and double tags are not worth an inverted index
+static int tsdbInitTagIndex(STable *pSTable) {
+  if (!tsdbTagIndex) return 0;
+
+  for (int i = DEFAULT_TAG_INDEX_COLUMN + 1; i < schemaNCols(pSTable->tagSchema); i++) {
+    STColumn *pCol = schemaColAt(pSTable->tagSchema, i);
+    if (IS_FLOAT_TYPE(colType(pCol)) || colType(pCol) == TSDB_DATA_TYPE_JSON) continue;
+
+    if (pSTable->tagIndex == NULL) {
+      pSTable->tagIndex = taosArrayInit(schemaNCols(pSTable->tagSchema), sizeof(STagIndex));
+      if (pSTable->tagIndex == NULL) goto _err;
+    }
+
+    STagIndex tagIdx = {.colId = colColId(pCol), .type = colType(pCol)};
+    tagIdx.map = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_ENTRY_LOCK);
+    if (tagIdx.map == NULL) goto _err;
+    taosHashSetFreeFp(tagIdx.map, taosArrayDestroyForHash);
+
+    if (taosArrayPush(pSTable->tagIndex, &tagIdx) == NULL) {
+      taosHashCleanup(tagIdx.map);
+      goto _err;
+    }
+  }
+
+  return 0;
+
+_err:
+  terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+  tsdbFreeTagIndex(pSTable);
+  return -1;
+}
+
+static void tsdbFreeTagIndex(STable *pSTable) {
+  if (pSTable->tagIndex == NULL) return;
+
+  for (size_t i = 0; i < taosArrayGetSize(pSTable->tagIndex); i++) {
+    STagIndex *pTagIdx = taosArrayGet(pSTable->tagIndex, i);
+    taosHashCleanup(pTagIdx->map);
+  }
+
+  taosArrayDestroy(&pSTable->tagIndex);
+}
+
+/*
+ * Index the tag columns of the new tag schema after ALTER STABLE ADD/DROP TAG, the meta is locked for write. Without
+ * the indexes the tag conditions are checked on all the child tables, so a failure only slows down the queries.
+ */
+static void tsdbRebuildTagIndex(STsdbRepo *pRepo, STable *pSTable) {
+  if (pSTable->pIndex == NULL) return;
+
+  tsdbFreeTagIndex(pSTable);
+  if (tsdbInitTagIndex(pSTable) < 0) goto _err;
+  if (pSTable->tagIndex == NULL) return;
+
+  SSkipListIterator *pIter = tSkipListCreateIter(pSTable->pIndex);
+  if (pIter == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    goto _err;
+  }
+
+  while (tSkipListIterNext(pIter)) {
+    STable *pTable = (STable *)SL_GET_NODE_DATA(tSkipListIterGet(pIter));
+    if (tsdbAddTableIntoTagIndex(pSTable, pTable) < 0) {
+      tSkipListDestroyIter(pIter);
+      goto _err;
+    }
+  }
+
+  tSkipListDestroyIter(pIter);
+  tsdbDebug("vgId:%d tag indexes of super table %s are rebuilt for tag version %d", REPO_ID(pRepo),
+            TABLE_CHAR_NAME(pSTable), schemaVersion(pSTable->tagSchema));
+  return;
+
+_err:
+  tsdbFreeTagIndex(pSTable);
+  tsdbWarn("vgId:%d tag indexes of super table %s are dropped since %s", REPO_ID(pRepo), TABLE_CHAR_NAME(pSTable),
+           tstrerror(terrno));
+}
+
+static int tsdbAddTableIntoTagIndex(STable *pSTable, STable *pTable) {
+  if (pSTable->tagIndex == NULL) return 0;
+
+  for (size_t i = 0; i < taosArrayGetSize(pSTable->tagIndex); i++) {
+    STagIndex *pTagIdx = taosArrayGet(pSTable->tagIndex, i);
+
+    void *val = tdGetKVRowValOfCol(pTable->tagVal, pTagIdx->colId);
+    if (val == NULL || isNull(val, pTagIdx->type)) continue;
+
+    const void *key = NULL;
+    size_t      keyLen = 0;
+    tsdbGetTagIndexKey(pTagIdx, val, &key, &keyLen);
+
+    SArray  *tablist = NULL;
+    SArray **pTablist = (SArray **)taosHashGet(pTagIdx->map, key, keyLen);
+    if (pTablist == NULL) {
+      tablist = taosArrayInit(4, POINTER_BYTES);
+      if (tablist == NULL || taosHashPut(pTagIdx->map, key, keyLen, &tablist, POINTER_BYTES) < 0) {
+        taosArrayDestroy(&tablist);
+        terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+        tsdbError("out of memory when put tag index of table %s", TABLE_CHAR_NAME(pTable));
+        return -1;
+      }
+    } else {
+      tablist = *pTablist;
+    }
+
+    void *p = taosArraySearch(tablist, &pTable, tsdbCompareTablePtr, TD_GE);
+    if (p == NULL) {
+      p = taosArrayPush(tablist, &pTable);
+    } else if (*(STable **)p != pTable) {
+      p = taosArrayInsert(tablist, TARRAY_ELEM_IDX(tablist, p), &pTable);
+    }
+
+    if (p == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      tsdbError("out of memory when put tag index of table %s", TABLE_CHAR_NAME(pTable));
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+static void tsdbRemoveTableFromTagIndex(STable *pSTable, STable *pTable) {
+  if (pSTable->tagIndex == NULL) return;
+
+  for (size_t i = 0; i < taosArrayGetSize(pSTable->tagIndex); i++) {
+    STagIndex *pTagIdx = taosArrayGet(pSTable->tagIndex, i);
+
+    void *val = tdGetKVRowValOfCol(pTable->tagVal, pTagIdx->colId);
+    if (val == NULL || isNull(val, pTagIdx->type)) continue;
+
+    SArray *tablist = tsdbGetTagIndexTables(pTagIdx, val);
+    if (tablist == NULL) continue;
+
+    void *p = taosArraySearch(tablist, &pTable, tsdbCompareTablePtr, TD_EQ);
+    if (p != NULL) {
+      taosArrayRemove(tablist, TARRAY_ELEM_IDX(tablist, p));
+    }
+
+    if (taosArrayGetSize(tablist) == 0) {
+      const void *key = NULL;
+      size_t      keyLen = 0;
+      tsdbGetTagIndexKey(pTagIdx, val, &key, &keyLen);
+      taosHashRemove(pTagIdx->map, key, keyLen);
+    }
+  }
+}
+
 static int tsdbAddTableIntoIndex(STsdbMeta *pMeta, STable *pTable, bool refSuper) {
   ASSERT(pTable->type == TSDB_CHILD_TABLE && pTable != NULL);
   STable *pSTable = tsdbGetTableByUid(pMeta, TABLE_SUID(pTable));
@@ -1155,6 +1360,11 @@ static int tsdbAddTableIntoIndex(STsdbMeta *pMeta, STable *pTable, bool refSuper
     }
   }else{
     tSkipListPut(pSTable->pIndex, (void *)pTable);
+    if (tsdbAddTableIntoTagIndex(pSTable, pTable) < 0) {
+      // the queries would miss the table in the indexes, the tag conditions are checked on all the tables instead
+      tsdbWarn("tag indexes of super table %s are dropped since %s", TABLE_CHAR_NAME(pSTable), tstrerror(terrno));
+      tsdbFreeTagIndex(pSTable);
+    }
   }
 
   return 0;
@@ -1217,6 +1427,7 @@ static int tsdbRemoveTableFromIndex(STsdbMeta *pMeta, STable *pTable) {
     }
 
     taosArrayDestroy(&res);
+    tsdbRemoveTableFromTagIndex(pSTable, pTable);
   }
   return 0;
 }
@@ -1467,7 +1678,7 @@ static void *tsdbDecodeTable(void *buf, STable **pRTable) {
       }else{
         pTable->pIndex = tSkipListCreate(TSDB_SUPER_TABLE_SL_LEVEL, colType(pCol), (uint8_t)(colBytes(pCol)), NULL,
                                        SL_ALLOW_DUP_KEY, getTagIndexKey);
-        if (pTable->pIndex == NULL) {
+        if (pTable->pIndex == NULL || tsdbInitTagIndex(pTable) < 0) {
           terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
           tsdbFreeTable(pTable);
           return NULL;
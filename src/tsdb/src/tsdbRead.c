@@ -28,6 +28,8 @@
 #include "qFilter.h"
 #include "cJSON.h"
 
+extern int32_t tsdbReadAheadBlocks;
+
 #define EXTRA_BYTES 2
 #define ASCENDING_TRAVERSE(o)   (o == TSDB_ORDER_ASC)
 #define QH_GET_NUM_OF_COLS(handle) ((size_t)(taosArrayGetSize((handle)->pColumns)))
@@ -95,8 +97,8 @@ typedef struct STableCheckInfo {
   int32_t       numOfBlocks:29; // number of qualified data blocks not the original blocks
   uint8_t        chosen:2;       // indicate which iterator should move forward
   bool          initBuf;        // whether to initialize the in-memory skip list iterator or not
-  SSkipListIterator* iter;      // mem buffer skip list iterator
-  SSkipListIterator* iiter;     // imem buffer skip list iterator
+  STableDataIter*    iter;      // mem buffer iterator
+  STableDataIter*    iiter;     // imem buffer iterator
 } STableCheckInfo;
 
 typedef struct STableBlockInfo {
@@ -129,6 +131,7 @@ typedef struct STsdbQueryHandle {
   STimeWindow    window;           // the primary query time window that applies to all queries
   SDataStatis*   statis;           // query level statistics, only one table block statistics info exists at any time
   int32_t        numOfBlocks;
+  int32_t        prefetchSlot;     // last slot of pDataBlockInfo whose read ahead has been issued
   SArray*        pColumns;         // column list, SColumnInfoData array list
   bool           locateStart;
   int32_t        outputCapacity;
@@ -160,6 +163,9 @@ typedef struct STsdbQueryHandle {
   // callback
   readover_callback readover_cb;
   void*             param;
+  filter_statis_callback filter_cb;
+  void*                  filterParam;
+  SDataStatis*           zoneStatis;  // statistics of the query columns built from the zone map of a table
 } STsdbQueryHandle;
 
 typedef struct STableGroupSupporter {
@@ -189,6 +195,7 @@ static void*   destroyTableCheckInfo(SArray* pTableCheckInfo);
 static bool    tsdbGetExternalRow(TsdbQueryHandleT pHandle);
 static int32_t tsdbQueryTableList(STable* pTable, SArray* pRes, void* filterInfo);
 static STableBlockInfo* moveToNextDataBlockInCurrentFile(STsdbQueryHandle* pQueryHandle);
+static void prefetchFileDataBlocks(STsdbQueryHandle* pQueryHandle);
 static bool initTableMemIterator(STsdbQueryHandle* pHandle, STableCheckInfo* pCheckInfo);
 static SMemRow getSMemRowInTableMem(STableCheckInfo* pCheckInfo, int32_t order, int32_t update, SMemRow* extraRow);
 
@@ -353,8 +360,8 @@ static void resetCheckInfo(STsdbQueryHandle* pQueryHandle) {
   for (int32_t i = 0; i < numOfTables; ++i) {
     STableCheckInfo* pCheckInfo = (STableCheckInfo*) taosArrayGet(pQueryHandle->pTableCheckInfo, i);
     pCheckInfo->lastKey = pQueryHandle->window.skey;
-    pCheckInfo->iter    = tSkipListDestroyIter(pCheckInfo->iter);
-    pCheckInfo->iiter   = tSkipListDestroyIter(pCheckInfo->iiter);
+    pCheckInfo->iter    = tsdbDestroyTableDataIter(pCheckInfo->iter);
+    pCheckInfo->iiter   = tsdbDestroyTableDataIter(pCheckInfo->iiter);
     pCheckInfo->initBuf = false;
 
     if (ASCENDING_TRAVERSE(pQueryHandle->order)) {
@@ -453,6 +460,8 @@ static STsdbQueryHandle* tsdbQueryTablesImpl(STsdbRepo* tsdb, STsdbQueryCond* pC
   if (tsdbInitReadH(&pQueryHandle->rhelper, (STsdbRepo*)tsdb) != 0) {
     goto _end;
   }
+  pQueryHandle->rhelper.pBlkCache = ((STsdbRepo*)tsdb)->blkCache;
+  pQueryHandle->rhelper.pHeadMap = ((STsdbRepo*)tsdb)->headMap;
 
   assert(pCond != NULL && pMemRef != NULL);
   setQueryTimewindow(pQueryHandle, pCond);
@@ -793,8 +802,7 @@ static bool initTableMemIterator(STsdbQueryHandle* pHandle, STableCheckInfo* pCh
     pMem = pMemT->tData[pCheckInfo->tableId.tid];
     if (pMem != NULL && pMem->uid == pCheckInfo->tableId.uid) { // check uid
       TKEY tLastKey = keyToTkey(pCheckInfo->lastKey);
-      pCheckInfo->iter =
-          tSkipListCreateIterFromVal(pMem->pData, (const char*)&tLastKey, TSDB_DATA_TYPE_TIMESTAMP, order);
+      pCheckInfo->iter = tsdbCreateTableDataIter(pMem, &tLastKey, order);
     }
   }
 
@@ -802,8 +810,7 @@ static bool initTableMemIterator(STsdbQueryHandle* pHandle, STableCheckInfo* pCh
     pIMem = pIMemT->tData[pCheckInfo->tableId.tid];
     if (pIMem != NULL && pIMem->uid == pCheckInfo->tableId.uid) { // check uid
       TKEY tLastKey = keyToTkey(pCheckInfo->lastKey);
-      pCheckInfo->iiter =
-          tSkipListCreateIterFromVal(pIMem->pData, (const char*)&tLastKey, TSDB_DATA_TYPE_TIMESTAMP, order);
+      pCheckInfo->iiter = tsdbCreateTableDataIter(pIMem, &tLastKey, order);
     }
   }
 
@@ -812,17 +819,16 @@ static bool initTableMemIterator(STsdbQueryHandle* pHandle, STableCheckInfo* pCh
     return false;
   }
 
-  bool memEmpty  = (pCheckInfo->iter == NULL) || (pCheckInfo->iter != NULL && !tSkipListIterNext(pCheckInfo->iter));
-  bool imemEmpty = (pCheckInfo->iiter == NULL) || (pCheckInfo->iiter != NULL && !tSkipListIterNext(pCheckInfo->iiter));
+  bool memEmpty  = (pCheckInfo->iter == NULL) || (pCheckInfo->iter != NULL && !tsdbTableDataIterNext(pCheckInfo->iter));
+  bool imemEmpty = (pCheckInfo->iiter == NULL) || (pCheckInfo->iiter != NULL && !tsdbTableDataIterNext(pCheckInfo->iiter));
   if (memEmpty && imemEmpty) { // buffer is empty
     return false;
   }
 
   if (!memEmpty) {
-    SSkipListNode* node = tSkipListIterGet(pCheckInfo->iter);
-    assert(node != NULL);
+    SMemRow row = tsdbTableDataIterGet(pCheckInfo->iter);
+    assert(row != NULL);
 
-    SMemRow row = (SMemRow)SL_GET_NODE_DATA(node);
     TSKEY   key = memRowKey(row);  // first timestamp in buffer
     tsdbDebug("%p uid:%" PRId64 ", tid:%d check data in mem from skey:%" PRId64 ", order:%d, ts range in buf:%" PRId64
               "-%" PRId64 ", lastKey:%" PRId64 ", numOfRows:%"PRId64", 0x%"PRIx64,
@@ -841,10 +847,9 @@ static bool initTableMemIterator(STsdbQueryHandle* pHandle, STableCheckInfo* pCh
   }
 
   if (!imemEmpty) {
-    SSkipListNode* node = tSkipListIterGet(pCheckInfo->iiter);
-    assert(node != NULL);
+    SMemRow row = tsdbTableDataIterGet(pCheckInfo->iiter);
+    assert(row != NULL);
 
-    SMemRow row = (SMemRow)SL_GET_NODE_DATA(node);
     TSKEY   key = memRowKey(row);  // first timestamp in buffer
     tsdbDebug("%p uid:%" PRId64 ", tid:%d check data in imem from skey:%" PRId64 ", order:%d, ts range in buf:%" PRId64
               "-%" PRId64 ", lastKey:%" PRId64 ", numOfRows:%"PRId64", 0x%"PRIx64,
@@ -865,24 +870,18 @@ static bool initTableMemIterator(STsdbQueryHandle* pHandle, STableCheckInfo* pCh
 }
 
 static void destroyTableMemIterator(STableCheckInfo* pCheckInfo) {
-  tSkipListDestroyIter(pCheckInfo->iter);
-  tSkipListDestroyIter(pCheckInfo->iiter);
+  tsdbDestroyTableDataIter(pCheckInfo->iter);
+  tsdbDestroyTableDataIter(pCheckInfo->iiter);
 }
 
 static TSKEY extractFirstTraverseKey(STableCheckInfo* pCheckInfo, int32_t order, int32_t update) {
   SMemRow rmem = NULL, rimem = NULL;
   if (pCheckInfo->iter) {
-    SSkipListNode* node = tSkipListIterGet(pCheckInfo->iter);
-    if (node != NULL) {
-      rmem = (SMemRow)SL_GET_NODE_DATA(node);
-    }
+    rmem = tsdbTableDataIterGet(pCheckInfo->iter);
   }
 
   if (pCheckInfo->iiter) {
-    SSkipListNode* node = tSkipListIterGet(pCheckInfo->iiter);
-    if (node != NULL) {
-      rimem = (SMemRow)SL_GET_NODE_DATA(node);
-    }
+    rimem = tsdbTableDataIterGet(pCheckInfo->iiter);
   }
 
   if (rmem == NULL && rimem == NULL) {
@@ -905,12 +904,12 @@ static TSKEY extractFirstTraverseKey(STableCheckInfo* pCheckInfo, int32_t order,
   if (r1 == r2) {
     if(update == TD_ROW_DISCARD_UPDATE){
       pCheckInfo->chosen = CHECKINFO_CHOSEN_IMEM;
-      tSkipListIterNext(pCheckInfo->iter);
+      tsdbTableDataIterNext(pCheckInfo->iter);
       return r2;
     }
     else if(update == TD_ROW_OVERWRITE_UPDATE) {
       pCheckInfo->chosen = CHECKINFO_CHOSEN_MEM;
-      tSkipListIterNext(pCheckInfo->iiter);
+      tsdbTableDataIterNext(pCheckInfo->iiter);
       return r1;
     } else {
       pCheckInfo->chosen = CHECKINFO_CHOSEN_BOTH;
@@ -940,17 +939,11 @@ static TSKEY extractFirstTraverseKey(STableCheckInfo* pCheckInfo, int32_t order,
 static SMemRow getSMemRowInTableMem(STableCheckInfo* pCheckInfo, int32_t order, int32_t update, SMemRow* extraRow) {
   SMemRow rmem = NULL, rimem = NULL;
   if (pCheckInfo->iter) {
-    SSkipListNode* node = tSkipListIterGet(pCheckInfo->iter);
-    if (node != NULL) {
-      rmem = (SMemRow)SL_GET_NODE_DATA(node);
-    }
+    rmem = tsdbTableDataIterGet(pCheckInfo->iter);
   }
 
   if (pCheckInfo->iiter) {
-    SSkipListNode* node = tSkipListIterGet(pCheckInfo->iiter);
-    if (node != NULL) {
-      rimem = (SMemRow)SL_GET_NODE_DATA(node);
-    }
+    rimem = tsdbTableDataIterGet(pCheckInfo->iiter);
   }
 
   if (rmem == NULL && rimem == NULL) {
@@ -972,11 +965,11 @@ static SMemRow getSMemRowInTableMem(STableCheckInfo* pCheckInfo, int32_t order,
 
   if (r1 == r2) {
     if (update == TD_ROW_DISCARD_UPDATE) {
-      tSkipListIterNext(pCheckInfo->iter);
+      tsdbTableDataIterNext(pCheckInfo->iter);
       pCheckInfo->chosen = CHECKINFO_CHOSEN_IMEM;
       return rimem;
     } else if(update == TD_ROW_OVERWRITE_UPDATE){
-      tSkipListIterNext(pCheckInfo->iiter);
+      tsdbTableDataIterNext(pCheckInfo->iiter);
       pCheckInfo->chosen = CHECKINFO_CHOSEN_MEM;
       return rmem;
     } else {
@@ -1009,7 +1002,7 @@ static bool moveToNextRowInMem(STableCheckInfo* pCheckInfo) {
   bool hasNext = false;
   if (pCheckInfo->chosen == CHECKINFO_CHOSEN_MEM) {
     if (pCheckInfo->iter != NULL) {
-      hasNext = tSkipListIterNext(pCheckInfo->iter);
+      hasNext = tsdbTableDataIterNext(pCheckInfo->iter);
     }
 
     if (hasNext) {
@@ -1017,11 +1010,11 @@ static bool moveToNextRowInMem(STableCheckInfo* pCheckInfo) {
     }
 
     if (pCheckInfo->iiter != NULL) {
-      return tSkipListIterGet(pCheckInfo->iiter) != NULL;
+      return tsdbTableDataIterGet(pCheckInfo->iiter) != NULL;
     }
   } else if (pCheckInfo->chosen == CHECKINFO_CHOSEN_IMEM){
     if (pCheckInfo->iiter != NULL) {
-      hasNext = tSkipListIterNext(pCheckInfo->iiter);
+      hasNext = tsdbTableDataIterNext(pCheckInfo->iiter);
     }
 
     if (hasNext) {
@@ -1029,14 +1022,14 @@ static bool moveToNextRowInMem(STableCheckInfo* pCheckInfo) {
     }
 
     if (pCheckInfo->iter != NULL) {
-      return tSkipListIterGet(pCheckInfo->iter) != NULL;
+      return tsdbTableDataIterGet(pCheckInfo->iter) != NULL;
     }
   } else {
     if (pCheckInfo->iter != NULL) {
-      hasNext = tSkipListIterNext(pCheckInfo->iter);
+      hasNext = tsdbTableDataIterNext(pCheckInfo->iter);
     }
     if (pCheckInfo->iiter != NULL) {
-      hasNext = tSkipListIterNext(pCheckInfo->iiter) || hasNext;
+      hasNext = tsdbTableDataIterNext(pCheckInfo->iiter) || hasNext;
     }
   }
 
@@ -1395,6 +1388,93 @@ static void shrinkBlocksByQuery(STsdbQueryHandle *pQueryHandle, STableCheckInfo
     taosArrayDestroy(&pArray);
 }
 
+// rows of the table in the mem and imem snapshot
+static bool hasBufferedRows(STsdbQueryHandle *pQueryHandle, STableCheckInfo *pCheckInfo) {
+  SMemRef* pMemRef = pQueryHandle->pMemRef;
+  if (pMemRef == NULL) return false;
+
+  SMemTable* pMemT = pMemRef->snapshot.mem;
+  SMemTable* pIMemT = pMemRef->snapshot.imem;
+  int32_t    tid = pCheckInfo->tableId.tid;
+
+  if (pMemT && tid < pMemT->maxTables) {
+    STableData* pMem = pMemT->tData[tid];
+    if (pMem && pMem->uid == pCheckInfo->tableId.uid && pMem->numOfRows > 0) return true;
+  }
+  if (pIMemT && tid < pIMemT->maxTables) {
+    STableData* pIMem = pIMemT->tData[tid];
+    if (pIMem && pIMem->uid == pCheckInfo->tableId.uid && pIMem->numOfRows > 0) return true;
+  }
+  return false;
+}
+
+// check the zone map of the table in the file set, return false if none of its blocks can match the query
+static bool filterBlocksByZoneMap(STsdbQueryHandle *pQueryHandle, STableCheckInfo *pCheckInfo) {
+  if (pQueryHandle->filter_cb == NULL) {
+    return true;
+  }
+
+  SBlockIdx      *compIndex = pQueryHandle->rhelper.pBlkIdx;
+  SBlockInfo     *pCompInfo = pCheckInfo->pCompInfo;
+  const SZoneMap *pZoneMap = tsdbGetZoneMap(pCompInfo, compIndex);
+  if (pZoneMap == NULL || compIndex->numOfBlocks == 0) {
+    return true;
+  }
+
+  // rows in buffer are merged with the rows in file, so the rows in file can only be skipped if they are overwritten
+  STsdbCfg *pCfg = &pQueryHandle->pTsdb->config;
+  if (pCfg->update != TD_ROW_OVERWRITE_UPDATE && hasBufferedRows(pQueryHandle, pCheckInfo)) {
+    return true;
+  }
+
+  int32_t numOfCols = (int32_t)taosArrayGetSize(pQueryHandle->pColumns);
+  if (pQueryHandle->zoneStatis == NULL) {
+    pQueryHandle->zoneStatis = calloc(numOfCols, sizeof(SDataStatis));
+    if (pQueryHandle->zoneStatis == NULL) {
+      return true;
+    }
+  }
+
+  // the null counts are scaled to 2 rows, which is enough to tell no, some or all values are NULL
+  SDataStatis *pStatis = pQueryHandle->zoneStatis;
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SColumnInfoData *pColInfo = taosArrayGet(pQueryHandle->pColumns, i);
+    SDataStatis     *p = &pStatis[i];
+
+    memset(p, 0, sizeof(SDataStatis));
+    p->colId = pColInfo->info.colId;
+
+    if (p->colId == PRIMARYKEY_TIMESTAMP_COL_INDEX) {
+      p->min = pCompInfo->blocks[0].keyFirst;
+      p->max = pCompInfo->blocks[compIndex->numOfBlocks - 1].keyLast;
+      continue;
+    }
+
+    p->numOfNull = 2;
+    for (int32_t j = 0; j < pZoneMap->numOfCols; ++j) {
+      const SZoneMapCol *pCol = &pZoneMap->cols[j];
+      if (pCol->colId != p->colId) continue;
+
+      if (pCol->type != pColInfo->info.type) {
+        p->colId = -1;  // the column was altered, no statistics
+      } else {
+        p->numOfNull = (pCol->numOfNull == 0) ? 0 : 1;
+        p->min = pCol->min;
+        p->max = pCol->max;
+      }
+      break;
+    }
+  }
+
+  if (pQueryHandle->filter_cb(pQueryHandle->filterParam, pStatis, numOfCols, 2)) {
+    return true;
+  }
+
+  tsdbDebug("%p %d blocks of table uid:%" PRIu64 " skipped by zone map, 0x%" PRIx64, pQueryHandle,
+            compIndex->numOfBlocks, pCheckInfo->tableId.uid, pQueryHandle->qId);
+  return false;
+}
+
 // load one table (tsd_index point to) need load blocks info and put into pCheckInfo->pCompInfo->blocks
 static int32_t loadBlockInfo(STsdbQueryHandle * pQueryHandle, int32_t tsd_index, int32_t* numOfBlocks) {
   //
@@ -1432,6 +1512,10 @@ static int32_t loadBlockInfo(STsdbQueryHandle * pQueryHandle, int32_t tsd_index,
     return terrno;
   }
 
+  if (!filterBlocksByZoneMap(pQueryHandle, pCheckInfo)) {
+    return 0;
+  }
+
   //
   // TWO PART. shrink no need blocks from all blocks by condition of query
   //
@@ -2726,6 +2810,9 @@ static int32_t getFirstFileDataBlock(STsdbQueryHandle* pQueryHandle, bool* exist
   cur->slot = ASCENDING_TRAVERSE(pQueryHandle->order)? 0:pQueryHandle->numOfBlocks-1;
   cur->fid = pQueryHandle->pFileGroup->fid;
 
+  pQueryHandle->prefetchSlot = cur->slot;
+  prefetchFileDataBlocks(pQueryHandle);
+
   STableBlockInfo* pBlockInfo = &pQueryHandle->pDataBlockInfo[cur->slot];
   return getDataBlockRv(pQueryHandle, pBlockInfo, exists);
 }
@@ -2743,6 +2830,8 @@ static STableBlockInfo* moveToNextDataBlockInCurrentFile(STsdbQueryHandle* pQuer
   cur->mixBlock       = false;
   cur->blockCompleted = false;
 
+  prefetchFileDataBlocks(pQueryHandle);
+
   // no callback check
   STableBlockInfo* pBlockInfo = &pQueryHandle->pDataBlockInfo[cur->slot];
   if(pQueryHandle->readover_cb == NULL) {
@@ -2778,6 +2867,38 @@ static STableBlockInfo* moveToNextDataBlockInCurrentFile(STsdbQueryHandle* pQuer
   return NULL;
 }
 
+/*
+ * The block order of the file is known after createDataBlocksInfo, so keep the reads of the following
+ * tsdbReadAheadBlocks blocks in flight while the current one is decompressed.
+ */
+static void prefetchFileDataBlocks(STsdbQueryHandle* pQueryHandle) {
+  if (tsdbReadAheadBlocks <= 0 || pQueryHandle->numOfBlocks <= 1) {
+    return;
+  }
+
+  SQueryFilePos* cur = &pQueryHandle->cur;
+  bool    asc = ASCENDING_TRAVERSE(pQueryHandle->order);
+  int32_t step = asc ? 1 : -1;
+
+  int32_t end = cur->slot + step * tsdbReadAheadBlocks;
+  end = asc ? MIN(end, pQueryHandle->numOfBlocks - 1) : MAX(end, 0);
+
+  int32_t start = pQueryHandle->prefetchSlot + step;
+  if ((asc && start <= cur->slot) || (!asc && start >= cur->slot)) {
+    start = cur->slot + step;
+  }
+
+  int16_t* colIds = pQueryHandle->defaultLoadColumn->pData;
+  int32_t  numOfCols = (int32_t)QH_GET_NUM_OF_COLS(pQueryHandle);
+
+  for (int32_t i = start; asc ? (i <= end) : (i >= end); i += step) {
+    STableBlockInfo* pBlockInfo = &pQueryHandle->pDataBlockInfo[i];
+    tsdbPrefetchBlockData(&pQueryHandle->rhelper, pBlockInfo->compBlock, pBlockInfo->pTableCheckInfo->pCompInfo,
+                          colIds, numOfCols);
+    pQueryHandle->prefetchSlot = i;
+  }
+}
+
 int32_t tsdbGetFileBlocksDistInfo(TsdbQueryHandleT* queryHandle, STableBlockDist* pTableBlockInfo) {
   STsdbQueryHandle* pQueryHandle = (STsdbQueryHandle*) queryHandle;
 
@@ -4267,6 +4388,7 @@ void tsdbCleanupQueryHandle(TsdbQueryHandleT queryHandle) {
   taosArrayDestroy(&pQueryHandle->defaultLoadColumn);
   tfree(pQueryHandle->pDataBlockInfo);
   tfree(pQueryHandle->statis);
+  tfree(pQueryHandle->zoneStatis);
 
   if (!emptyQueryTimewindow(pQueryHandle)) {
     tsdbMayUnTakeMemSnapshot(pQueryHandle);
@@ -4413,6 +4535,161 @@ static void queryIndexlessColumn(SSkipList* pSkipList, void* filterInfo, SArray*
   tSkipListDestroyIter(iter);
 }
 
+static FORCE_INLINE int32_t tsdbGetTagDataFromTable(void *param, int32_t id, void **data) {
+  STable* pTable = (STable*)param;
+
+  if (id == TSDB_TBNAME_COLUMN_INDEX) {
+    *data = TABLE_NAME(pTable);
+  } else {
+    *data = tdGetKVRowValOfCol(pTable->tagVal, id);
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+static void addTagIndexTables(SArray* pTables, SArray* tablist) {
+  if (tablist != NULL) {
+    taosArrayAddBatch(pTables, tablist->pData, (int32_t)taosArrayGetSize(tablist));
+  }
+}
+
+// the literal prefix of a like pattern, before any wildcard or escape
+static int32_t getLikePatternPrefixLen(const char* pattern, int32_t len) {
+  int32_t i = 0;
+  while (i < len && pattern[i] != '%' && pattern[i] != '_' && pattern[i] != '\\') {
+    ++i;
+  }
+  return i;
+}
+
+/*
+ * Get the tables which may match the unit from the tag index of its column. Only the equal, in and the like with a
+ * literal prefix units can be looked up, return false for other units.
+ */
+static bool getTablesByTagIndex(STable* pSTable, SFilterInfo* info, SFilterUnit* u, SArray* pTables) {
+  uint8_t optr = FILTER_UNIT_OPTR(u);
+  if (u->right.type != FLD_TYPE_VALUE || (optr != TSDB_RELATION_EQUAL && optr != TSDB_RELATION_IN &&
+                                          optr != TSDB_RELATION_LIKE)) {
+    return false;
+  }
+
+  SSchema*   pSchema = FILTER_UNIT_COL_DESC(info, u);
+  STagIndex* pTagIdx = tsdbGetTagIndex(pSTable, pSchema->colId, pSchema->type);
+  void*      val = FILTER_UNIT_VAL_DATA(info, u);
+  if (pTagIdx == NULL || val == NULL) {
+    return false;
+  }
+
+  if (optr == TSDB_RELATION_EQUAL) {
+    addTagIndexTables(pTables, tsdbGetTagIndexTables(pTagIdx, val));
+    return true;
+  }
+
+  if (optr == TSDB_RELATION_IN) {
+    if (!IS_VAR_DATA_TYPE(pTagIdx->type)) return false;
+
+    // the values in the set are without the length prefix, as the keys of the tag index
+    SHashObj* pSet = (SHashObj*)val;
+    void*     p = taosHashIterate(pSet, NULL);
+    while (p) {
+      SArray** tablist = taosHashGet(pTagIdx->map, taosHashGetDataKey(pSet, p), taosHashGetDataKeyLen(pSet, p));
+      if (tablist != NULL) addTagIndexTables(pTables, *tablist);
+      p = taosHashIterate(pSet, p);
+    }
+    return true;
+  }
+
+  // like is case insensitive, so the prefix is compared in lower case with the values in the index
+  if (pTagIdx->type != TSDB_DATA_TYPE_BINARY) return false;
+
+  int32_t prefixLen = getLikePatternPrefixLen(varDataVal(val), varDataLen(val));
+  if (prefixLen == 0) return false;
+
+  void* p = taosHashIterate(pTagIdx->map, NULL);
+  while (p) {
+    uint32_t keyLen = taosHashGetDataKeyLen(pTagIdx->map, p);
+    if (keyLen >= (uint32_t)prefixLen &&
+        strncasecmp(taosHashGetDataKey(pTagIdx->map, p), varDataVal(val), prefixLen) == 0) {
+      addTagIndexTables(pTables, *(SArray**)p);
+    }
+    p = taosHashIterate(pTagIdx->map, p);
+  }
+  return true;
+}
+
+// the order of the tables scanned from the skiplist of the first tag, by the value of the first tag and then the uid
+static int32_t tableFirstTagComparFn(const void* p1, const void* p2, const void* param) {
+  SSkipList* pSkipList = (SSkipList*)param;
+  STable*    pTable1 = *(STable**)p1;
+  STable*    pTable2 = *(STable**)p2;
+
+  int32_t ret = pSkipList->comparFn(pSkipList->keyFn(pTable1), pSkipList->keyFn(pTable2));
+  if (ret != 0) {
+    return ret;
+  }
+
+  if (TABLE_UID(pTable1) == TABLE_UID(pTable2)) {
+    return 0;
+  }
+  return (TABLE_UID(pTable1) < TABLE_UID(pTable2)) ? -1 : 1;
+}
+
+/*
+ * Query the child tables by the inverted tag indexes, if each group of the filter has a unit that can be looked up.
+ * The tables found by the units are then checked by the whole filter. Return false if the indexes can not be used.
+ */
+static bool queryByTagIndex(STable* pSTable, void* filterInfo, SArray* res) {
+  SFilterInfo* info = (SFilterInfo*)filterInfo;
+  if (pSTable->tagIndex == NULL || info == NULL || info->groupNum == 0 || FILTER_ALL_RES(info) ||
+      FILTER_EMPTY_RES(info)) {
+    return false;
+  }
+
+  SArray* pTables = taosArrayInit(32, POINTER_BYTES);
+  if (pTables == NULL) {
+    return false;
+  }
+
+  for (uint32_t g = 0; g < info->groupNum; ++g) {
+    SFilterGroup* group = &info->groups[g];
+    bool          found = false;
+
+    for (uint32_t i = 0; i < group->unitNum && !found; ++i) {
+      found = getTablesByTagIndex(pSTable, info, FILTER_GROUP_UNIT(info, group, i), pTables);
+    }
+
+    if (!found) {
+      taosArrayDestroy(&pTables);
+      return false;
+    }
+  }
+
+  // the tables of the groups may overlap, and are returned in the order of the full scan, which limit and offset
+  // of the query depend on
+  taosArraySort(pTables, tsdbCompareTablePtr);
+  taosArrayRemoveDuplicate(pTables, tsdbCompareTablePtr, NULL);
+  taosqsort(pTables->pData, taosArrayGetSize(pTables), POINTER_BYTES, pSTable->pIndex, tableFirstTagComparFn);
+
+  size_t  size = taosArrayGetSize(pTables);
+  int8_t* addToResult = NULL;
+  for (int32_t i = 0; i < size; ++i) {
+    STable* pTable = taosArrayGetP(pTables, i);
+    filterSetColFieldData(filterInfo, pTable, tsdbGetTagDataFromTable);
+    bool all = filterExecute(filterInfo, 1, &addToResult, NULL, 0);
+
+    if (all || (addToResult && *addToResult)) {
+      STableKeyInfo info1 = {.pTable = (void*)pTable, .lastKey = TSKEY_INITIAL_VAL};
+      taosArrayPush(res, &info1);
+    }
+  }
+
+  tsdbDebug("filter tag index, candidate tables:%" PRIzu ", qualified tables:%" PRIzu, size, taosArrayGetSize(res));
+
+  tfree(addToResult);
+  taosArrayDestroy(&pTables);
+  return true;
+}
+
 static FORCE_INLINE int32_t tsdbGetJsonTagDataFromId(void *param, int32_t id, char* name, void **data) {
   JsonMapValue* jsonMapV = (JsonMapValue*)(param);
   STable* pTable = (STable*)(jsonMapV->table);
@@ -4513,7 +4790,7 @@ static int32_t tsdbQueryTableList(STable* pTable, SArray* pRes, void* filterInfo
 
     if (indexQuery) {
       queryIndexedColumn(pSkipList, filterInfo, pRes);
-    } else {
+    } else if (!queryByTagIndex(pTable, filterInfo, pRes)) {
       queryIndexlessColumn(pSkipList, filterInfo, pRes);
     }
   }
@@ -4692,6 +4969,13 @@ void tsdbAddScanCallback(TsdbQueryHandleT* queryHandle, readover_callback callba
   return ;
 }
 
+// add the callback to skip the blocks of a table in a file set by its zone map
+void tsdbAddFilterCallback(TsdbQueryHandleT* queryHandle, filter_statis_callback callback, void* param) {
+  STsdbQueryHandle* pQueryHandle = (STsdbQueryHandle*)queryHandle;
+  pQueryHandle->filter_cb   = callback;
+  pQueryHandle->filterParam = param;
+}
+
 // get table tid
 int32_t tsdbTableTid(void* pTable) {
   STable *p = (STable *)pTable;
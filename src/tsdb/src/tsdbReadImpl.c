@@ -75,6 +75,8 @@ void tsdbDestroyReadH(SReadH *pReadh) {
   pReadh->pBlkIdx = NULL;
   pReadh->pTable = NULL;
   pReadh->aBlkIdx = taosArrayDestroy(&pReadh->aBlkIdx);
+  tsdbReleaseHeadMap(pReadh->pHeadEntry);
+  pReadh->pHeadEntry = NULL;
   tsdbCloseDFileSet(TSDB_READ_FSET(pReadh));
   pReadh->pRepo = NULL;
 }
@@ -105,6 +107,13 @@ int tsdbLoadBlockIdx(SReadH *pReadh) {
   // No data at all, just return
   if (pHeadf->info.offset <= 0) return 0;
 
+  if (pReadh->pHeadMap != NULL) {
+    ASSERT(pReadh->pHeadEntry == NULL);
+    pReadh->pHeadEntry =
+        tsdbAcquireHeadMap(pReadh->pHeadMap, TSDB_READ_REPO(pReadh), pHeadf, TSDB_FSET_FID(TSDB_READ_FSET(pReadh)));
+    if (pReadh->pHeadEntry != NULL) return 0;
+  }
+
   if (tsdbSeekDFile(pHeadf, pHeadf->info.offset, SEEK_SET) < 0) {
     tsdbError("vgId:%d failed to load SBlockIdx part while seek file %s since %s, offset:%u len :%u",
               TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pHeadf), tstrerror(terrno), pHeadf->info.offset,
@@ -170,12 +179,14 @@ int tsdbSetReadTable(SReadH *pReadh, STable *pTable) {
     return -1;
   }
 
-  size_t size = taosArrayGetSize(pReadh->aBlkIdx);
+  // the SBlockIdx part is shared with other readers if the .head file is mapped
+  SArray *aBlkIdx = (pReadh->pHeadEntry != NULL) ? ((SHeadMapEntry *)pReadh->pHeadEntry)->aBlkIdx : pReadh->aBlkIdx;
+  size_t  size = taosArrayGetSize(aBlkIdx);
   if (size > 0) {
     int64_t left = 0, right = size - 1;
     while (left <= right) {
       int64_t mid = (left + right) / 2;
-      SBlockIdx *pBlkIdx = taosArrayGet(pReadh->aBlkIdx, (size_t)mid);
+      SBlockIdx *pBlkIdx = taosArrayGet(aBlkIdx, (size_t)mid);
       if (pBlkIdx->tid == TABLE_TID(pTable)) {
         if (pBlkIdx->uid == TABLE_UID(pTable)) {
           pReadh->pBlkIdx = pBlkIdx;
@@ -309,12 +320,52 @@ static int tsdbSBlkInfoRefactor(SDFile *pHeadf, SBlockInfo **pDstBlkInfo, SBlock
   return TSDB_CODE_SUCCESS;
 }
 
+static int tsdbLoadBlockInfoFromHeadMap(SReadH *pReadh, void **pTarget, uint32_t *extendedLen) {
+  SDFile *    pHeadf = TSDB_READ_HEAD_FILE(pReadh);
+  SBlockIdx * pBlkIdx = pReadh->pBlkIdx;
+  SBlockInfo *pBlkInfo = tsdbGetBlockInfoFromHeadMap(pReadh->pHeadEntry, pBlkIdx);
+  if (pBlkInfo == NULL) {
+    tsdbError("vgId:%d SBlockInfo part in mapped file %s is corrupted, offset:%u len :%u", TSDB_READ_REPO_ID(pReadh),
+              TSDB_FILE_FULL_NAME(pHeadf), pBlkIdx->offset, pBlkIdx->len);
+    return -1;
+  }
+
+  ASSERT(pBlkIdx->tid == pBlkInfo->tid && pBlkIdx->uid == pBlkInfo->uid);
+
+  // the caller may modify the SBlockInfo, so it is copied out of the mapped pages
+  if (extendedLen != NULL && pTarget != NULL) {
+    if (*extendedLen < pBlkIdx->len) {
+      char *t = realloc(*pTarget, pBlkIdx->len);
+      if (t == NULL) {
+        terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+        return -1;
+      }
+      *pTarget = t;
+    }
+    memcpy(*pTarget, (void *)pBlkInfo, pBlkIdx->len);
+  } else {
+    if (tsdbMakeRoom((void **)(&pReadh->pBlkInfo), pBlkIdx->len) < 0) return -1;
+    memcpy((void *)(pReadh->pBlkInfo), (void *)pBlkInfo, pBlkIdx->len);
+  }
+
+  if (extendedLen != NULL) {
+    *extendedLen = pBlkIdx->len;
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
 int tsdbLoadBlockInfo(SReadH *pReadh, void **pTarget, uint32_t *extendedLen) {
   ASSERT(pReadh->pBlkIdx != NULL);
 
   SDFile *    pHeadf = TSDB_READ_HEAD_FILE(pReadh);
   SBlockIdx * pBlkIdx = pReadh->pBlkIdx;
 
+  // SBlock of older versions are refactored, which is left to the read path
+  if (pReadh->pHeadEntry != NULL && tsdbGetSBlockVer(pHeadf->info.fver) > TSDB_SBLK_VER_0) {
+    return tsdbLoadBlockInfoFromHeadMap(pReadh, pTarget, extendedLen);
+  }
+
   if (tsdbSeekDFile(pHeadf, pBlkIdx->offset, SEEK_SET) < 0) {
     tsdbError("vgId:%d failed to load SBlockInfo part while seek file %s since %s, offset:%u len:%u",
               TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pHeadf), tstrerror(terrno), pBlkIdx->offset, pBlkIdx->len);
@@ -423,6 +474,46 @@ int tsdbLoadBlockDataCols(SReadH *pReadh, SBlock *pBlock, SBlockInfo *pBlkInfo,
   return 0;
 }
 
+static bool tsdbBlockColsInCache(SReadH *pReadh, SDFile *pDFile, SBlock *pBlock, int16_t *colIds, int numOfColIds) {
+  if (pReadh->pBlkCache == NULL) return false;
+
+  SBlkCacheKey cacheKey;
+  for (int i = 0; i < numOfColIds; i++) {
+    tsdbInitBlkCacheKey(&cacheKey, pDFile, TSDB_FSET_FID(TSDB_READ_FSET(pReadh)), pBlock, colIds[i]);
+    if (!tsdbBlkCacheContains(pReadh->pBlkCache, &cacheKey)) return false;
+  }
+
+  return true;
+}
+
+void tsdbPrefetchBlockData(SReadH *pReadh, SBlock *pBlock, SBlockInfo *pBlkInfo, int16_t *colIds, int numOfColIds) {
+  ASSERT(pBlock->numOfSubBlocks > 0);
+
+  SBlock *iBlock = pBlock;
+  if (pBlock->numOfSubBlocks > 1) {
+    iBlock = (SBlock *)POINTER_SHIFT((pBlkInfo ? pBlkInfo : pReadh->pBlkInfo), pBlock->offset);
+  }
+
+  for (int i = 0; i < pBlock->numOfSubBlocks; i++, iBlock++) {
+    SDFile *pDFile = (iBlock->last) ? TSDB_READ_LAST_FILE(pReadh) : TSDB_READ_DATA_FILE(pReadh);
+    if (TSDB_FILE_CLOSED(pDFile)) continue;
+
+    // The offsets of the columns are only known once the SBlockData part is read, so the whole block is read
+    // ahead only when all of its columns are wanted and some of them are not cached. Otherwise only the
+    // SBlockData part, which tsdbLoadBlockDataCols reads first, is read ahead.
+    int64_t len = tsdbBlockStatisSize(iBlock->numOfCols, (uint32_t)iBlock->blkVer);
+    if (numOfColIds >= iBlock->numOfCols && !tsdbBlockColsInCache(pReadh, pDFile, iBlock, colIds, numOfColIds)) {
+      len = iBlock->len;
+    }
+
+    // only a hint, the block is read and verified by tsdbLoadBlockData/tsdbLoadBlockDataCols as usual
+    if (taosReadAhead(TSDB_FILE_FD(pDFile), iBlock->offset, len) != 0) {
+      tsdbTrace("vgId:%d failed to read ahead file %s offset %" PRId64 " len %" PRId64, TSDB_READ_REPO_ID(pReadh),
+                TSDB_FILE_FULL_NAME(pDFile), (int64_t)iBlock->offset, len);
+    }
+  }
+}
+
 static int tsdbLoadBlockStatisFromDFile(SReadH *pReadh, SBlock *pBlock) {
   SDFile *pDFile = (pBlock->last) ? TSDB_READ_LAST_FILE(pReadh) : TSDB_READ_DATA_FILE(pReadh);
   if (tsdbSeekDFile(pDFile, pBlock->offset, SEEK_SET) < 0) {
@@ -616,6 +707,8 @@ static void tsdbResetReadTable(SReadH *pReadh) {
 static void tsdbResetReadFile(SReadH *pReadh) {
   tsdbResetReadTable(pReadh);
   taosArrayClear(pReadh->aBlkIdx);
+  tsdbReleaseHeadMap(pReadh->pHeadEntry);
+  pReadh->pHeadEntry = NULL;
   tsdbCloseDFileSet(TSDB_READ_FSET(pReadh));
 }
 
@@ -692,13 +785,14 @@ static int tsdbLoadBlockDataImpl(SReadH *pReadh, SBlock *pBlock, SDataCols *pDat
     }
 
     if (tcolId == pDataCol->colId) {
-      if (pBlock->algorithm == TWO_STAGE_COMP) {
+      if (COMP_STAGE(pBlock->algorithm) == TWO_STAGE_COMP) {
         int zsize = pDataCol->bytes * pBlock->numOfRows + COMP_OVERFLOW_BYTES;
         if (tsdbMakeRoom((void **)(&TSDB_READ_COMP_BUF(pReadh)), zsize) < 0) return -1;
       }
 
-      if (tsdbCheckAndDecodeColumnData(pDataCol, POINTER_SHIFT(pBlockData, tsize + toffset), tlen, pBlock->algorithm,
-                                       pBlock->numOfRows, pDataCols->maxPoints, TSDB_READ_COMP_BUF(pReadh),
+      if (tsdbCheckAndDecodeColumnData(pDataCol, POINTER_SHIFT(pBlockData, tsize + toffset), tlen,
+                                       COMP_STAGE(pBlock->algorithm), pBlock->numOfRows, pDataCols->maxPoints,
+                                       TSDB_READ_COMP_BUF(pReadh),
                                        (int)taosTSizeof(TSDB_READ_COMP_BUF(pReadh))) < 0) {
         tsdbError("vgId:%d file %s is broken at column %d block offset %" PRId64 " column offset %u",
                   TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFile), tcolId, (int64_t)pBlock->offset, toffset);
@@ -836,9 +930,17 @@ static int tsdbLoadBlockDataColsImpl(SReadH *pReadh, SBlock *pBlock, SDataCols *
 static int tsdbLoadColData(SReadH *pReadh, SDFile *pDFile, SBlock *pBlock, SBlockCol *pBlockCol, SDataCol *pDataCol) {
   ASSERT(pDataCol->colId == pBlockCol->colId);
 
-  STsdbRepo *pRepo = TSDB_READ_REPO(pReadh);
-  STsdbCfg * pCfg = REPO_CFG(pRepo);
-  int        tsize = pDataCol->bytes * pBlock->numOfRows + COMP_OVERFLOW_BYTES;
+  STsdbRepo *  pRepo = TSDB_READ_REPO(pReadh);
+  STsdbCfg *   pCfg = REPO_CFG(pRepo);
+  int          tsize = pDataCol->bytes * pBlock->numOfRows + COMP_OVERFLOW_BYTES;
+  SBlkCacheKey cacheKey;
+
+  if (pReadh->pBlkCache != NULL) {
+    tsdbInitBlkCacheKey(&cacheKey, pDFile, TSDB_FSET_FID(TSDB_READ_FSET(pReadh)), pBlock, pBlockCol->colId);
+    if (tsdbGetFromBlkCache(pReadh->pBlkCache, &cacheKey, pDataCol, pBlock->numOfRows, pCfg->maxRowsPerFileBlock)) {
+      return 0;
+    }
+  }
 
   if (tsdbMakeRoom((void **)(&TSDB_READ_BUF(pReadh)), pBlockCol->len) < 0) return -1;
   if (tsdbMakeRoom((void **)(&TSDB_READ_COMP_BUF(pReadh)), tsize) < 0) return -1;
@@ -866,12 +968,17 @@ static int tsdbLoadColData(SReadH *pReadh, SDFile *pDFile, SBlock *pBlock, SBloc
     return -1;
   }
 
-  if (tsdbCheckAndDecodeColumnData(pDataCol, pReadh->pBuf, pBlockCol->len, pBlock->algorithm, pBlock->numOfRows,
-                                   pCfg->maxRowsPerFileBlock, pReadh->pCBuf, (int32_t)taosTSizeof(pReadh->pCBuf)) < 0) {
+  if (tsdbCheckAndDecodeColumnData(pDataCol, pReadh->pBuf, pBlockCol->len, COMP_STAGE(pBlock->algorithm),
+                                   pBlock->numOfRows, pCfg->maxRowsPerFileBlock, pReadh->pCBuf,
+                                   (int32_t)taosTSizeof(pReadh->pCBuf)) < 0) {
     tsdbError("vgId:%d file %s is broken at column %d offset %" PRId64, REPO_ID(pRepo), TSDB_FILE_FULL_NAME(pDFile),
               pBlockCol->colId, offset);
     return -1;
   }
 
+  if (pReadh->pBlkCache != NULL) {
+    tsdbPutToBlkCache(pReadh->pBlkCache, &cacheKey, pDataCol);
+  }
+
   return 0;
 }
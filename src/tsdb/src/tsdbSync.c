@@ -16,6 +16,8 @@
 #define _DEFAULT_SOURCE
 #include "os.h"
 #include "taoserror.h"
+#include "tglobal.h"
+#include "tmd5.h"
 #include "tsdbint.h"
 
 // Sync handle
@@ -24,29 +26,57 @@ typedef struct {
   SRtn       rtn;
   SOCKET     socketFd;
   void *     pBuf;
+  void *     pDigests;
   bool       mfChanged;
   SMFile *   pmf;
   SMFile     mf;
   SDFileSet  df;
   SDFileSet *pdf;
+  bool       deltaOK;    // the remote can send the changed chunks of a file set only
+  int64_t    startMs;
+  int64_t    sentBytes;  // bytes of the files sent, to throttle the transfer
 } SSyncH;
 
 #define SYNC_BUFFER(sh) ((sh)->pBuf)
 
+/*
+ * A file set which differs from the one of the receiver is sent in chunks of TSDB_SYNC_CHUNK_SIZE bytes. If both sides
+ * support it, the receiver first sends the digests of the chunks of its own file, and the sender only sends the chunks
+ * whose digest differs. The .data file is appended on commit, so a replica which missed a few commits usually has most
+ * of it already.
+ */
+#define TSDB_SYNC_DECISION_NONE 0
+#define TSDB_SYNC_DECISION_WHOLE 1
+#define TSDB_SYNC_DECISION_DELTA 2
+
+#define TSDB_SYNC_FLAG_DELTA 0x1  // appended to the file set info by the senders with tsdbSyncDelta on
+
+#define TSDB_SYNC_CHUNK_SIZE (1024 * 1024)
+#define TSDB_SYNC_DIGEST_SIZE 16
+#define TSDB_SYNC_MAX_CHUNKS (1 << 24)
+
+static int64_t tsSyncSentBytes = 0;
+static int64_t tsSyncSkippedBytes = 0;
+
 static void    tsdbInitSyncH(SSyncH *pSyncH, STsdbRepo *pRepo, SOCKET socketFd);
 static void    tsdbDestroySyncH(SSyncH *pSyncH);
 static int32_t tsdbSyncSendMeta(SSyncH *pSynch);
 static int32_t tsdbSyncRecvMeta(SSyncH *pSynch);
 static int32_t tsdbSendMetaInfo(SSyncH *pSynch);
 static int32_t tsdbRecvMetaInfo(SSyncH *pSynch);
-static int32_t tsdbSendDecision(SSyncH *pSynch, bool toSend);
-static int32_t tsdbRecvDecision(SSyncH *pSynch, bool *toSend);
+static int32_t tsdbSendDecision(SSyncH *pSynch, uint8_t decision);
+static int32_t tsdbRecvDecision(SSyncH *pSynch, uint8_t *decision);
 static int32_t tsdbSyncSendDFileSetArray(SSyncH *pSynch);
 static int32_t tsdbSyncRecvDFileSetArray(SSyncH *pSynch);
 static bool    tsdbIsTowFSetSame(SDFileSet *pSet1, SDFileSet *pSet2);
 static int32_t tsdbSyncSendDFileSet(SSyncH *pSynch, SDFileSet *pSet);
 static int32_t tsdbSendDFileSetInfo(SSyncH *pSynch, SDFileSet *pSet);
 static int32_t tsdbRecvDFileSetInfo(SSyncH *pSynch);
+static int32_t tsdbSyncSendDFile(SSyncH *pSynch, SDFile *pDFile, bool delta);
+static int32_t tsdbSyncRecvDFile(SSyncH *pSynch, SDFile *pDFile, SDFile *pRDFile, bool delta, SDFile *pLDFile);
+static int32_t tsdbSendDigests(SSyncH *pSynch, SDFile *pLDFile);
+static int32_t tsdbRecvDigests(SSyncH *pSynch, uint32_t *nDigests);
+static void    tsdbSyncThrottle(SSyncH *pSynch, int64_t bytes);
 static int     tsdbReload(STsdbRepo *pRepo, bool isMfChanged);
 
 int32_t tsdbSyncSend(void *tsdb, SOCKET socketFd) {
@@ -117,14 +147,23 @@ _err:
 static void tsdbInitSyncH(SSyncH *pSyncH, STsdbRepo *pRepo, SOCKET socketFd) {
   pSyncH->pRepo = pRepo;
   pSyncH->socketFd = socketFd;
+  pSyncH->startMs = taosGetTimestampMs();
   tsdbGetRtnSnap(pRepo, &(pSyncH->rtn));
 }
 
-static void tsdbDestroySyncH(SSyncH *pSyncH) { taosTZfree(pSyncH->pBuf); }
+static void tsdbDestroySyncH(SSyncH *pSyncH) {
+  taosTZfree(pSyncH->pBuf);
+  taosTZfree(pSyncH->pDigests);
+}
+
+void tsdbGetSyncStatisInfo(int64_t *nSent, int64_t *nSkipped) {
+  *nSent = atomic_exchange_64(&tsSyncSentBytes, 0);
+  *nSkipped = atomic_exchange_64(&tsSyncSkippedBytes, 0);
+}
 
 static int32_t tsdbSyncSendMeta(SSyncH *pSynch) {
   STsdbRepo *pRepo = pSynch->pRepo;
-  bool       toSendMeta = false;
+  uint8_t    toSendMeta = TSDB_SYNC_DECISION_NONE;
   SMFile     mf;
 
   // Send meta info to remote
@@ -327,9 +366,8 @@ static int32_t tsdbRecvMetaInfo(SSyncH *pSynch) {
   return 0;
 }
 
-static int32_t tsdbSendDecision(SSyncH *pSynch, bool toSend) {
+static int32_t tsdbSendDecision(SSyncH *pSynch, uint8_t decision) {
   STsdbRepo *pRepo = pSynch->pRepo;
-  uint8_t    decision = toSend;
 
   int32_t writeLen = sizeof(uint8_t);
   int32_t ret = taosWriteMsg(pSynch->socketFd, (void *)(&decision), writeLen);
@@ -342,19 +380,17 @@ static int32_t tsdbSendDecision(SSyncH *pSynch, bool toSend) {
   return 0;
 }
 
-static int32_t tsdbRecvDecision(SSyncH *pSynch, bool *toSend) {
+static int32_t tsdbRecvDecision(SSyncH *pSynch, uint8_t *decision) {
   STsdbRepo *pRepo = pSynch->pRepo;
-  uint8_t    decision = 0;
 
   int32_t readLen = sizeof(uint8_t);
-  int32_t ret = taosReadMsg(pSynch->socketFd, (void *)(&decision), readLen);
+  int32_t ret = taosReadMsg(pSynch->socketFd, (void *)decision, readLen);
   if (ret != readLen) {
     terrno = TAOS_SYSTEM_ERROR(errno);
     tsdbError("vgId:%d, failed to recv decison, ret:%d readLen:%d", REPO_ID(pRepo), ret, readLen);
     return -1;
   }
 
-  *toSend = decision;
   return 0;
 }
 
@@ -389,6 +425,7 @@ static int32_t tsdbSyncRecvDFileSetArray(SSyncH *pSynch) {
   STsdbFS *  pfs = REPO_FS(pRepo);
   SFSIter    fsiter;
   SDFileSet *pLSet;  // Local file set
+  SDFileSet *pLDSet;  // Local file set to receive the changed chunks of the remote file set against
 
   tsdbFSIterInit(&fsiter, pfs, TSDB_FS_ITER_FORWARD);
 
@@ -399,6 +436,7 @@ static int32_t tsdbSyncRecvDFileSetArray(SSyncH *pSynch) {
   }
 
   while (true) {
+    pLDSet = NULL;
     if (pLSet == NULL && pSynch->pdf == NULL) {
       tsdbInfo("vgId:%d, all filesets is disposed", REPO_ID(pRepo));
       break;
@@ -447,9 +485,15 @@ static int32_t tsdbSyncRecvDFileSetArray(SSyncH *pSynch) {
           // Next loop
           continue;
         } else {
-          tsdbInfo("vgId:%d, fileset:%d will be received", REPO_ID(pRepo), pSynch->pdf->fid);
+          // only the changed chunks are received if there is a local fileset to compare with
+          if (pSynch->deltaOK && tsdbSyncDelta && pLSet && pLSet->fid == pSynch->pdf->fid) {
+            pLDSet = pLSet;
+          }
+
+          tsdbInfo("vgId:%d, fileset:%d will be received, delta:%d", REPO_ID(pRepo), pSynch->pdf->fid,
+                   pLDSet != NULL);
           // Notify remote to send there file here
-          if (tsdbSendDecision(pSynch, true) < 0) {
+          if (tsdbSendDecision(pSynch, pLDSet ? TSDB_SYNC_DECISION_DELTA : TSDB_SYNC_DECISION_WHOLE) < 0) {
             tsdbError("vgId:%d, failed to send decision since %s", REPO_ID(pRepo), tstrerror(terrno));
             return -1;
           }
@@ -478,15 +522,17 @@ static int32_t tsdbSyncRecvDFileSetArray(SSyncH *pSynch) {
           SDFile *pDFile = TSDB_DFILE_IN_SET(&fset, ftype);         // local file
           SDFile *pRDFile = TSDB_DFILE_IN_SET(pSynch->pdf, ftype);  // remote file
 
+          SDFile *pLDFile = NULL;                                   // local file to compare with
+
+          if (pLDSet && ftype < tsdbGetNFiles(pLDSet)) {
+            pLDFile = TSDB_DFILE_IN_SET(pLDSet, ftype);
+          }
+
           tsdbInfo("vgId:%d, file:%s will be received, osize:%" PRIu64 " rsize:%" PRIu64, REPO_ID(pRepo),
                    pDFile->f.aname, pDFile->info.size, pRDFile->info.size);
 
-          int64_t writeLen = pRDFile->info.size;
-          int64_t ret = taosCopyFds(pSynch->socketFd, pDFile->fd, writeLen);
-          if (ret != writeLen) {
-            terrno = TAOS_SYSTEM_ERROR(errno);
-            tsdbError("vgId:%d, failed to recv file:%s since %s, ret:%" PRId64 " writeLen:%" PRId64, REPO_ID(pRepo),
-                      pDFile->f.aname, tstrerror(terrno), ret, writeLen);
+          if (tsdbSyncRecvDFile(pSynch, pDFile, pRDFile, pLDSet != NULL, pLDFile) < 0) {
+            tsdbError("vgId:%d, failed to recv file:%s since %s", REPO_ID(pRepo), pDFile->f.aname, tstrerror(terrno));
             tsdbCloseDFileSet(&fset);
             tsdbRemoveDFileSet(&fset);
             return -1;
@@ -494,7 +540,8 @@ static int32_t tsdbSyncRecvDFileSetArray(SSyncH *pSynch) {
 
           // Update new file info
           pDFile->info = pRDFile->info;
-          tsdbInfo("vgId:%d, file:%s is received, size:%" PRId64, REPO_ID(pRepo), pDFile->f.aname, writeLen);
+          tsdbInfo("vgId:%d, file:%s is received, size:%" PRId64, REPO_ID(pRepo), pDFile->f.aname,
+                   pRDFile->info.size);
         }
 
         tsdbCloseDFileSet(&fset);
@@ -567,7 +614,7 @@ static bool tsdbIsTowFSetSame(SDFileSet *pSet1, SDFileSet *pSet2) {
 
 static int32_t tsdbSyncSendDFileSet(SSyncH *pSynch, SDFileSet *pSet) {
   STsdbRepo *pRepo = pSynch->pRepo;
-  bool toSend = false;
+  uint8_t    toSend = TSDB_SYNC_DECISION_NONE;
 
   // skip expired fileset
   if (pSet && tsdbGetFidLevel(pSet->fid, &(pSynch->rtn)) < 0) {
@@ -593,7 +640,8 @@ static int32_t tsdbSyncSendDFileSet(SSyncH *pSynch, SDFileSet *pSet) {
   }
 
   if (toSend) {
-    tsdbInfo("vgId:%d, fileset:%d will be sent", REPO_ID(pRepo), pSet->fid);
+    tsdbInfo("vgId:%d, fileset:%d will be sent, delta:%d", REPO_ID(pRepo), pSet->fid,
+             toSend == TSDB_SYNC_DECISION_DELTA);
 
     for (TSDB_FILE_T ftype = 0; ftype < tsdbGetNFiles(pSet); ftype++) {
       SDFile df = *TSDB_DFILE_IN_SET(pSet, ftype);
@@ -606,11 +654,9 @@ static int32_t tsdbSyncSendDFileSet(SSyncH *pSynch, SDFileSet *pSet) {
       int64_t writeLen = df.info.size;
       tsdbInfo("vgId:%d, file:%s will be sent, size:%" PRId64, REPO_ID(pRepo), df.f.aname, writeLen);
 
-      int64_t ret = taosSendFile(pSynch->socketFd, TSDB_FILE_FD(&df), 0, writeLen);
-      if (ret != writeLen) {
-        terrno = TAOS_SYSTEM_ERROR(errno);
-        tsdbError("vgId:%d, failed to send file:%s since %s, ret:%" PRId64 " writeLen:%" PRId64, REPO_ID(pRepo),
-                  df.f.aname, tstrerror(terrno), ret, writeLen);
+      if (tsdbSyncSendDFile(pSynch, &df, toSend == TSDB_SYNC_DECISION_DELTA) < 0) {
+        tsdbError("vgId:%d, failed to send file:%s since %s, writeLen:%" PRId64, REPO_ID(pRepo), df.f.aname,
+                  tstrerror(terrno), writeLen);
         tsdbCloseDFile(&df);
         return -1;
       }
@@ -632,7 +678,7 @@ static int32_t tsdbSendDFileSetInfo(SSyncH *pSynch, SDFileSet *pSet) {
   uint32_t   tlen = 0;
 
   if (pSet) {
-    tlen = tsdbEncodeDFileSetEx(NULL, pSet) + sizeof(TSCKSUM);
+    tlen = tsdbEncodeDFileSetEx(NULL, pSet) + sizeof(uint8_t) + sizeof(TSCKSUM);
   }
 
   if (tsdbMakeRoom((void **)(&SYNC_BUFFER(pSynch)), tlen + sizeof(tlen)) < 0) {
@@ -645,6 +691,8 @@ static int32_t tsdbSendDFileSetInfo(SSyncH *pSynch, SDFileSet *pSet) {
   void *tptr = ptr;
   if (pSet) {
     tsdbEncodeDFileSetEx(&ptr, pSet);
+    // the receivers not knowing the flag ignore it, and a sender with tsdbSyncDelta off acts as one not knowing it
+    taosEncodeFixedU8(&ptr, tsdbSyncDelta ? TSDB_SYNC_FLAG_DELTA : 0);
     taosCalcChecksumAppend(0, (uint8_t *)tptr, tlen);
   }
 
@@ -698,11 +746,261 @@ static int32_t tsdbRecvDFileSetInfo(SSyncH *pSynch) {
   }
 
   pSynch->pdf = &(pSynch->df);
-  tsdbDecodeDFileSetEx(SYNC_BUFFER(pSynch), pSynch->pdf);
+  void *ptr = tsdbDecodeDFileSetEx(SYNC_BUFFER(pSynch), pSynch->pdf);
+
+  uint8_t flags = 0;
+  if (POINTER_DISTANCE(ptr, SYNC_BUFFER(pSynch)) + sizeof(uint8_t) + sizeof(TSCKSUM) <= tlen) {
+    taosDecodeFixedU8(ptr, &flags);
+  }
+  pSynch->deltaOK = (flags & TSDB_SYNC_FLAG_DELTA) != 0;
+
+  return 0;
+}
+
+static int32_t tsdbSyncSendDFile(SSyncH *pSynch, SDFile *pDFile, bool delta) {
+  STsdbRepo *pRepo = pSynch->pRepo;
+  int64_t    size = pDFile->info.size;
+  int64_t    skipped = 0;
+  uint32_t   nDigests = 0;
+
+  if (delta && tsdbRecvDigests(pSynch, &nDigests) < 0) {
+    return -1;
+  }
+
+  int64_t len = 0;
+  for (int64_t offset = 0, idx = 0; offset < size; offset += len, idx++) {
+    len = MIN(TSDB_SYNC_CHUNK_SIZE, size - offset);
+
+    if (!delta) {
+      int64_t ret = taosSendFile(pSynch->socketFd, TSDB_FILE_FD(pDFile), NULL, len);
+      if (ret != len) {
+        terrno = TAOS_SYSTEM_ERROR(errno);
+        return -1;
+      }
+
+      tsdbSyncThrottle(pSynch, len);
+      continue;
+    }
+
+    // each chunk is led by one byte, 1 if the receiver has the chunk and 0 if the chunk follows
+    if (tsdbMakeRoom((void **)(&SYNC_BUFFER(pSynch)), len + 1) < 0) {
+      return -1;
+    }
+
+    uint8_t *pChunk = (uint8_t *)SYNC_BUFFER(pSynch);
+    int64_t  nread = tsdbReadDFile(pDFile, pChunk + 1, len);
+    if (nread < len) {
+      if (nread >= 0) terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
+      return -1;
+    }
+
+    T_MD5_CTX ctx;
+    tMD5Init(&ctx);
+    tMD5Update(&ctx, pChunk + 1, (unsigned int)len);
+    tMD5Final(&ctx);
+
+    int32_t writeLen = (int32_t)len + 1;
+    if (idx < nDigests &&
+        memcmp(ctx.digest, POINTER_SHIFT(pSynch->pDigests, idx * TSDB_SYNC_DIGEST_SIZE), TSDB_SYNC_DIGEST_SIZE) == 0) {
+      pChunk[0] = 1;
+      writeLen = 1;
+      skipped += len;
+    } else {
+      pChunk[0] = 0;
+    }
+
+    if (taosWriteMsg(pSynch->socketFd, pChunk, writeLen) != writeLen) {
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      return -1;
+    }
+
+    tsdbSyncThrottle(pSynch, writeLen);
+  }
+
+  if (skipped > 0) {
+    atomic_add_fetch_64(&tsSyncSkippedBytes, skipped);
+    tsdbInfo("vgId:%d, file:%s %" PRId64 " of %" PRId64 " bytes are kept by remote", REPO_ID(pRepo),
+             pDFile->f.aname, skipped, size);
+  }
 
   return 0;
 }
 
+static int32_t tsdbSyncRecvDFile(SSyncH *pSynch, SDFile *pDFile, SDFile *pRDFile, bool delta, SDFile *pLDFile) {
+  int64_t size = pRDFile->info.size;
+
+  if (!delta) {
+    int64_t ret = taosCopyFds(pSynch->socketFd, pDFile->fd, size);
+    if (ret != size) {
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      return -1;
+    }
+
+    return 0;
+  }
+
+  SDFile ldf;
+  TSDB_FILE_SET_CLOSED(&ldf);
+  if (pLDFile) {
+    ldf = *pLDFile;
+    if (tsdbOpenDFile(&ldf, O_RDONLY) < 0) {
+      // all the chunks are received then
+      tsdbWarn("vgId:%d, failed to open file:%s to compare since %s", REPO_ID(pSynch->pRepo), ldf.f.aname,
+               tstrerror(terrno));
+      TSDB_FILE_SET_CLOSED(&ldf);
+    }
+  }
+
+  if (tsdbSendDigests(pSynch, TSDB_FILE_OPENED(&ldf) ? &ldf : NULL) < 0) {
+    tsdbCloseDFile(&ldf);
+    return -1;
+  }
+
+  int64_t len = 0;
+  for (int64_t offset = 0; offset < size; offset += len) {
+    len = MIN(TSDB_SYNC_CHUNK_SIZE, size - offset);
+
+    uint8_t same = 0;
+    if (taosReadMsg(pSynch->socketFd, &same, sizeof(same)) != sizeof(same)) {
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      tsdbCloseDFile(&ldf);
+      return -1;
+    }
+
+    if (!same) {
+      if (taosCopyFds(pSynch->socketFd, pDFile->fd, len) != len) {
+        terrno = TAOS_SYSTEM_ERROR(errno);
+        tsdbCloseDFile(&ldf);
+        return -1;
+      }
+      continue;
+    }
+
+    // the chunk is the same as the one of the local file
+    if (!TSDB_FILE_OPENED(&ldf) || offset + len > ldf.info.size) {
+      terrno = TSDB_CODE_TDB_MESSED_MSG;
+      tsdbCloseDFile(&ldf);
+      return -1;
+    }
+
+    if (tsdbMakeRoom((void **)(&SYNC_BUFFER(pSynch)), len) < 0 || tsdbSeekDFile(&ldf, offset, SEEK_SET) < 0) {
+      tsdbCloseDFile(&ldf);
+      return -1;
+    }
+
+    int64_t nread = tsdbReadDFile(&ldf, SYNC_BUFFER(pSynch), len);
+    if (nread < len) {
+      if (nread >= 0) terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
+      tsdbCloseDFile(&ldf);
+      return -1;
+    }
+
+    if (tsdbWriteDFile(pDFile, SYNC_BUFFER(pSynch), len) < 0) {
+      tsdbCloseDFile(&ldf);
+      return -1;
+    }
+  }
+
+  tsdbCloseDFile(&ldf);
+  return 0;
+}
+
+// Send the digests of the chunks of the local file, none if pLDFile is NULL
+static int32_t tsdbSendDigests(SSyncH *pSynch, SDFile *pLDFile) {
+  STsdbRepo *pRepo = pSynch->pRepo;
+  int64_t    size = pLDFile ? pLDFile->info.size : 0;
+  uint32_t   nDigests = (uint32_t)MIN((size + TSDB_SYNC_CHUNK_SIZE - 1) / TSDB_SYNC_CHUNK_SIZE, TSDB_SYNC_MAX_CHUNKS);
+
+  if (tsdbMakeRoom((void **)(&pSynch->pDigests), sizeof(uint32_t) + (size_t)nDigests * TSDB_SYNC_DIGEST_SIZE) < 0) {
+    return -1;
+  }
+
+  uint8_t *pDigest = POINTER_SHIFT(pSynch->pDigests, sizeof(uint32_t));
+  uint32_t idx = 0;
+  for (; idx < nDigests; idx++) {
+    int64_t len = MIN(TSDB_SYNC_CHUNK_SIZE, size - (int64_t)idx * TSDB_SYNC_CHUNK_SIZE);
+
+    if (tsdbMakeRoom((void **)(&SYNC_BUFFER(pSynch)), len) < 0) {
+      return -1;
+    }
+
+    // a local file shorter than its info is only compared up to where it is read
+    if (tsdbReadDFile(pLDFile, SYNC_BUFFER(pSynch), len) < len) {
+      tsdbWarn("vgId:%d, file:%s is only compared in its first %u chunks", REPO_ID(pRepo), pLDFile->f.aname, idx);
+      break;
+    }
+
+    T_MD5_CTX ctx;
+    tMD5Init(&ctx);
+    tMD5Update(&ctx, SYNC_BUFFER(pSynch), (unsigned int)len);
+    tMD5Final(&ctx);
+    memcpy(pDigest + (size_t)idx * TSDB_SYNC_DIGEST_SIZE, ctx.digest, TSDB_SYNC_DIGEST_SIZE);
+  }
+
+  void *ptr = pSynch->pDigests;
+  taosEncodeFixedU32(&ptr, idx);
+
+  int32_t writeLen = (int32_t)(sizeof(uint32_t) + (size_t)idx * TSDB_SYNC_DIGEST_SIZE);
+  int32_t ret = taosWriteMsg(pSynch->socketFd, pSynch->pDigests, writeLen);
+  if (ret != writeLen) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    tsdbError("vgId:%d, failed to send digests, ret:%d writeLen:%d", REPO_ID(pRepo), ret, writeLen);
+    return -1;
+  }
+
+  return 0;
+}
+
+static int32_t tsdbRecvDigests(SSyncH *pSynch, uint32_t *nDigests) {
+  STsdbRepo *pRepo = pSynch->pRepo;
+  char       buf[64] = {0};
+
+  int32_t readLen = sizeof(uint32_t);
+  int32_t ret = taosReadMsg(pSynch->socketFd, buf, readLen);
+  if (ret != readLen) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    tsdbError("vgId:%d, failed to recv digest num, ret:%d readLen:%d", REPO_ID(pRepo), ret, readLen);
+    return -1;
+  }
+
+  taosDecodeFixedU32(buf, nDigests);
+  if (*nDigests > TSDB_SYNC_MAX_CHUNKS) {
+    terrno = TSDB_CODE_TDB_MESSED_MSG;
+    tsdbError("vgId:%d, failed to recv digests since %s, num:%u", REPO_ID(pRepo), tstrerror(terrno), *nDigests);
+    return -1;
+  }
+
+  if (*nDigests == 0) return 0;
+
+  readLen = (int32_t)(*nDigests * TSDB_SYNC_DIGEST_SIZE);
+  if (tsdbMakeRoom((void **)(&pSynch->pDigests), readLen) < 0) {
+    return -1;
+  }
+
+  ret = taosReadMsg(pSynch->socketFd, pSynch->pDigests, readLen);
+  if (ret != readLen) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    tsdbError("vgId:%d, failed to recv digests, ret:%d readLen:%d", REPO_ID(pRepo), ret, readLen);
+    return -1;
+  }
+
+  return 0;
+}
+
+// Keep the bytes sent by a sync under tsdbSyncRate MB per second
+static void tsdbSyncThrottle(SSyncH *pSynch, int64_t bytes) {
+  pSynch->sentBytes += bytes;
+  atomic_add_fetch_64(&tsSyncSentBytes, bytes);
+
+  if (tsdbSyncRate <= 0) return;
+
+  int64_t expectedMs = pSynch->sentBytes * 1000 / ((int64_t)tsdbSyncRate * 1024 * 1024);
+  int64_t elapsedMs = taosGetTimestampMs() - pSynch->startMs;
+  if (expectedMs > elapsedMs) {
+    taosMsleep((int32_t)(expectedMs - elapsedMs));
+  }
+}
+
 static int tsdbReload(STsdbRepo *pRepo, bool isMfChanged) {
   // TODO: may need to stop and restart stream
   // if (isMfChanged) {
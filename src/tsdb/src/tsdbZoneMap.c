@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tsdbint.h"
+
+extern int8_t tsdbZoneMap;
+
+static SZoneMapCol *tsdbZoneMapHGetCol(SZoneMapH *pZmh, int16_t colId, int8_t type, int64_t numOfNull);
+static void         tsdbMergeColRange(SZoneMapCol *pCol, int64_t min, int64_t max);
+
+// the column array is allocated on the first column added
+#define tsdbZoneMapHNumOfCols(pZmh) (((pZmh)->cols == NULL) ? 0 : taosArrayGetSize((pZmh)->cols))
+
+/*
+ * Start the zone map of a table, from the zone map of the table in the file set read if pBlkIdx is not NULL. If the
+ * table has blocks in the file set but no zone map, the zone map is unknown until the table is compacted.
+ */
+void tsdbResetZoneMapH(SZoneMapH *pZmh, SBlockInfo *pBlkInfo, SBlockIdx *pBlkIdx) {
+  pZmh->unknown = (tsdbZoneMap == 0);
+  pZmh->numOfRows = 0;
+  if (pZmh->cols != NULL) taosArrayClear(pZmh->cols);
+
+  if (pZmh->unknown || pBlkIdx == NULL) return;
+
+  const SZoneMap *pZoneMap = tsdbGetZoneMap(pBlkInfo, pBlkIdx);
+  if (pZoneMap == NULL) {
+    pZmh->unknown = true;
+    return;
+  }
+
+  if (pZmh->cols == NULL) {
+    pZmh->cols = taosArrayInit(pZoneMap->numOfCols + 1, sizeof(SZoneMapCol));
+  }
+
+  if (pZmh->cols == NULL || taosArrayAddBatch(pZmh->cols, pZoneMap->cols, pZoneMap->numOfCols) == NULL) {
+    pZmh->unknown = true;
+    return;
+  }
+
+  pZmh->numOfRows = pZoneMap->numOfRows;
+}
+
+void tsdbDestroyZoneMapH(SZoneMapH *pZmh) { pZmh->cols = taosArrayDestroy(&pZmh->cols); }
+
+// Merge the aggregate data of a block written into the zone map
+void tsdbZoneMapHAddBlock(SZoneMapH *pZmh, SDataCols *pDataCols, SBlock *pBlock, SAggrBlkData *pAggrBlkData) {
+  if (pZmh->unknown) return;
+
+  int64_t numOfRows = pBlock->numOfRows;
+  int     numOfAggrCols = pBlock->aggrStat ? pBlock->numOfCols : 0;
+
+  // the columns not in the aggregate data are NULL in the block
+  for (size_t i = 0; i < tsdbZoneMapHNumOfCols(pZmh); i++) {
+    SZoneMapCol *pCol = taosArrayGet(pZmh->cols, i);
+    pCol->numOfNull += numOfRows;
+  }
+
+  int dcol = 1;
+  for (int i = 0; i < numOfAggrCols; i++) {
+    SAggrBlkCol *pAggrBlkCol = (SAggrBlkCol *)pAggrBlkData + i;
+
+    // the aggregate columns are encoded in the order of the data columns
+    while (dcol < pDataCols->numOfCols && pDataCols->cols[dcol].colId != pAggrBlkCol->colId) dcol++;
+    if (dcol >= pDataCols->numOfCols) {
+      pZmh->unknown = true;
+      return;
+    }
+
+    SZoneMapCol *pCol =
+        tsdbZoneMapHGetCol(pZmh, pAggrBlkCol->colId, pDataCols->cols[dcol].type, pZmh->numOfRows + numOfRows);
+    if (pCol == NULL) {
+      pZmh->unknown = true;
+      return;
+    }
+
+    if (pAggrBlkCol->numOfNull < numOfRows) {
+      if (pCol->numOfNull == pZmh->numOfRows + numOfRows) {
+        // no value before the block
+        pCol->min = pAggrBlkCol->min;
+        pCol->max = pAggrBlkCol->max;
+      } else {
+        tsdbMergeColRange(pCol, pAggrBlkCol->min, pAggrBlkCol->max);
+      }
+    }
+
+    pCol->numOfNull -= (numOfRows - pAggrBlkCol->numOfNull);
+  }
+
+  pZmh->numOfRows += numOfRows;
+}
+
+// Size of the encoded zone map, 0 if it is not written
+uint32_t tsdbZoneMapHSize(SZoneMapH *pZmh) {
+  if (pZmh == NULL || pZmh->unknown || pZmh->numOfRows == 0) return 0;
+
+  size_t numOfCols = 0;
+  for (size_t i = 0; i < tsdbZoneMapHNumOfCols(pZmh); i++) {
+    SZoneMapCol *pCol = taosArrayGet(pZmh->cols, i);
+    if (pCol->numOfNull < pZmh->numOfRows) numOfCols++;
+  }
+
+  return (uint32_t)(sizeof(SZoneMap) + sizeof(SZoneMapCol) * numOfCols);
+}
+
+void tsdbZoneMapHEncode(SZoneMapH *pZmh, void *buf) {
+  SZoneMap *pZoneMap = (SZoneMap *)buf;
+
+  pZoneMap->delimiter = TSDB_FILE_DELIMITER;
+  pZoneMap->numOfCols = 0;
+  pZoneMap->numOfRows = pZmh->numOfRows;
+
+  // columns with only NULL values are left out
+  for (size_t i = 0; i < tsdbZoneMapHNumOfCols(pZmh); i++) {
+    SZoneMapCol *pCol = taosArrayGet(pZmh->cols, i);
+    if (pCol->numOfNull < pZmh->numOfRows) {
+      pZoneMap->cols[pZoneMap->numOfCols++] = *pCol;
+    }
+  }
+}
+
+// The zone map in the SBlockInfo part of a table, NULL if the table has no zone map in the file set
+const SZoneMap *tsdbGetZoneMap(SBlockInfo *pBlkInfo, SBlockIdx *pBlkIdx) {
+  size_t tlen = sizeof(SBlockInfo) + sizeof(SBlock) * pBlkIdx->numOfBlocks + sizeof(TSCKSUM);
+  if (pBlkIdx->len < tlen + sizeof(SZoneMap)) return NULL;
+
+  for (uint32_t i = 0; i < pBlkIdx->numOfBlocks; i++) {
+    SBlock *pBlock = pBlkInfo->blocks + i;
+    if (pBlock->numOfSubBlocks > 1) {
+      tlen += sizeof(SBlock) * pBlock->numOfSubBlocks;
+    }
+  }
+
+  if (pBlkIdx->len < tlen + sizeof(SZoneMap)) return NULL;
+
+  const SZoneMap *pZoneMap = (SZoneMap *)POINTER_SHIFT(pBlkInfo, tlen - sizeof(TSCKSUM));
+  if (pZoneMap->delimiter != TSDB_FILE_DELIMITER || pZoneMap->numOfCols < 0 ||
+      pBlkIdx->len != tlen + sizeof(SZoneMap) + sizeof(SZoneMapCol) * (size_t)pZoneMap->numOfCols) {
+    return NULL;
+  }
+
+  return pZoneMap;
+}
+
+static SZoneMapCol *tsdbZoneMapHGetCol(SZoneMapH *pZmh, int16_t colId, int8_t type, int64_t numOfNull) {
+  if (pZmh->cols == NULL) {
+    pZmh->cols = taosArrayInit(16, sizeof(SZoneMapCol));
+    if (pZmh->cols == NULL) return NULL;
+  }
+
+  size_t size = taosArrayGetSize(pZmh->cols);
+  size_t idx = 0;
+  while (idx < size) {
+    SZoneMapCol *pCol = taosArrayGet(pZmh->cols, idx);
+    if (pCol->colId == colId) return (pCol->type == type) ? pCol : NULL;
+    if (pCol->colId > colId) break;
+    idx++;
+  }
+
+  // a new column, all its values so far are NULL
+  SZoneMapCol col = {0};
+  col.colId = colId;
+  col.type = type;
+  col.numOfNull = numOfNull;
+
+  return taosArrayInsert(pZmh->cols, idx, &col);
+}
+
+static void tsdbMergeColRange(SZoneMapCol *pCol, int64_t min, int64_t max) {
+  if (IS_FLOAT_TYPE(pCol->type)) {
+    if (GET_DOUBLE_VAL(&min) < GET_DOUBLE_VAL(&pCol->min)) pCol->min = min;
+    if (GET_DOUBLE_VAL(&max) > GET_DOUBLE_VAL(&pCol->max)) pCol->max = max;
+  } else if (IS_UNSIGNED_NUMERIC_TYPE(pCol->type)) {
+    if ((uint64_t)min < (uint64_t)pCol->min) pCol->min = min;
+    if ((uint64_t)max > (uint64_t)pCol->max) pCol->max = max;
+  } else {
+    // binary and nchar columns have no range, their min and max are 0
+    if (min < pCol->min) pCol->min = min;
+    if (max > pCol->max) pCol->max = max;
+  }
+}
@@ -0,0 +1,241 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tsdbint.h"
+
+/*
+ * Unit test of the decoded column block cache: hits and misses with their counters, the LRU eviction under the
+ * memory budget, and the invalidation of a file set as done by a commit or a compaction of it.
+ *
+ * usage: tsdbBlkCacheTest, it exits with 1 if a check fails
+ */
+
+#define COL_ROWS 250  // an INT column chunk of 1000 bytes
+
+#define CHECK(cond)                                                 \
+  do {                                                              \
+    if (!(cond)) {                                                  \
+      printf("%s:%d, check failed: %s\n", __FILE__, __LINE__, #cond); \
+      numOfFailed++;                                                \
+    }                                                               \
+  } while (0)
+
+static int32_t numOfFailed = 0;
+
+static SBlkCacheKey makeKey(int fid, int64_t offset, int16_t colId, int8_t last) {
+  SBlkCacheKey key;
+  memset(&key, 0, sizeof(key));
+  key.fid = fid;
+  key.fnameHash = 0x1234u + fid;
+  key.offset = offset;
+  key.colId = colId;
+  key.last = last;
+  return key;
+}
+
+static void initCol(SDataCol *pCol) {
+  memset(pCol, 0, sizeof(*pCol));
+  pCol->type = TSDB_DATA_TYPE_INT;
+  pCol->bytes = sizeof(int32_t);
+  if (tdAllocMemForCol(pCol, COL_ROWS) != 0) {
+    printf("failed to alloc column\n");
+    exit(1);
+  }
+}
+
+static void fillCol(SDataCol *pCol, int32_t seed) {
+  for (int i = 0; i < COL_ROWS; i++) {
+    ((int32_t *)pCol->pData)[i] = seed + i;
+  }
+  pCol->len = COL_ROWS * sizeof(int32_t);
+}
+
+static bool colHasSeed(SDataCol *pCol, int32_t seed) {
+  if (pCol->len != COL_ROWS * sizeof(int32_t)) return false;
+  for (int i = 0; i < COL_ROWS; i++) {
+    if (((int32_t *)pCol->pData)[i] != seed + i) return false;
+  }
+  return true;
+}
+
+static void putCol(STsdbBlkCache *pCache, SBlkCacheKey key, int32_t seed) {
+  SDataCol col;
+  initCol(&col);
+  fillCol(&col, seed);
+  tsdbPutToBlkCache(pCache, &key, &col);
+  tfree(col.pData);
+}
+
+static bool getCol(STsdbBlkCache *pCache, SBlkCacheKey key, SDataCol *pCol) {
+  memset(pCol->pData, 0, pCol->spaceSize);
+  pCol->len = 0;
+  return tsdbGetFromBlkCache(pCache, &key, pCol, COL_ROWS, COL_ROWS);
+}
+
+static void testHitAndMiss() {
+  int64_t hit, miss, used;
+  tsdbGetBlkCacheStatisInfo(&hit, &miss, &used);
+
+  STsdbBlkCache *pCache = tsdbNewBlkCache(1024 * 1024);
+  SBlkCacheKey   key = makeKey(1, 4096, 2, 0);
+  SDataCol       col;
+  initCol(&col);
+
+  CHECK(!tsdbBlkCacheContains(pCache, &key));
+  CHECK(!getCol(pCache, key, &col));
+
+  putCol(pCache, key, 100);
+  CHECK(tsdbBlkCacheContains(pCache, &key));
+  CHECK(pCache->used > COL_ROWS * sizeof(int32_t));
+
+  // the chunk loaded by another query keeps the first copy
+  int64_t usedOne = pCache->used;
+  putCol(pCache, key, 200);
+  CHECK(pCache->used == usedOne);
+
+  CHECK(getCol(pCache, key, &col));
+  CHECK(colHasSeed(&col, 100));
+  CHECK(getCol(pCache, key, &col));
+
+  // each part of the key tells the chunks apart
+  SBlkCacheKey other = makeKey(1, 4096, 3, 0);
+  CHECK(!getCol(pCache, other, &col));
+  other = makeKey(1, 8192, 2, 0);
+  CHECK(!getCol(pCache, other, &col));
+  other = makeKey(1, 4096, 2, 1);
+  CHECK(!tsdbBlkCacheContains(pCache, &other));
+  other = key;
+  other.fnameHash++;
+  CHECK(!tsdbBlkCacheContains(pCache, &other));
+
+  tsdbGetBlkCacheStatisInfo(&hit, &miss, &used);
+  CHECK(hit == 2);
+  CHECK(miss == 3);
+  CHECK(used == pCache->used);
+
+  // the counters are reset by a read, the bytes held are not
+  tsdbGetBlkCacheStatisInfo(&hit, &miss, &used);
+  CHECK(hit == 0 && miss == 0);
+  CHECK(used == pCache->used);
+
+  // an empty chunk is not cached
+  SBlkCacheKey emptyKey = makeKey(1, 0, 2, 0);
+  col.len = 0;
+  tsdbPutToBlkCache(pCache, &emptyKey, &col);
+  CHECK(!tsdbBlkCacheContains(pCache, &emptyKey));
+
+  tfree(col.pData);
+  tsdbFreeBlkCache(pCache);
+
+  tsdbGetBlkCacheStatisInfo(&hit, &miss, &used);
+  CHECK(used == 0);
+}
+
+static void testEviction() {
+  // room for 3 chunks with their nodes, not for 4
+  STsdbBlkCache *pCache = tsdbNewBlkCache(3600);
+  SBlkCacheKey   keys[5];
+  SDataCol       col;
+  initCol(&col);
+
+  for (int i = 0; i < 5; i++) {
+    keys[i] = makeKey(1, 4096 * (i + 1), 1, 0);
+  }
+
+  for (int i = 0; i < 3; i++) {
+    putCol(pCache, keys[i], i * 1000);
+  }
+  int64_t nodeSize = pCache->used / 3;
+  CHECK(nodeSize * 3 <= pCache->capacity && nodeSize * 4 > pCache->capacity);
+
+  // the hit makes keys[0] the most recently used, so keys[1] is evicted
+  CHECK(getCol(pCache, keys[0], &col));
+  putCol(pCache, keys[3], 3000);
+  CHECK(pCache->used == nodeSize * 3);
+  CHECK(tsdbBlkCacheContains(pCache, &keys[0]));
+  CHECK(!tsdbBlkCacheContains(pCache, &keys[1]));
+  CHECK(tsdbBlkCacheContains(pCache, &keys[2]));
+  CHECK(tsdbBlkCacheContains(pCache, &keys[3]));
+
+  // a check of the key does not move it, so keys[2] is evicted next
+  putCol(pCache, keys[4], 4000);
+  CHECK(pCache->used == nodeSize * 3);
+  CHECK(!tsdbBlkCacheContains(pCache, &keys[2]));
+
+  int32_t kept[] = {0, 3, 4};
+  for (int i = 0; i < 3; i++) {
+    CHECK(getCol(pCache, keys[kept[i]], &col));
+    CHECK(colHasSeed(&col, kept[i] * 1000));
+  }
+
+  tsdbFreeBlkCache(pCache);
+
+  // a chunk larger than the budget is not cached, and a zero budget disables the cache
+  pCache = tsdbNewBlkCache(512);
+  putCol(pCache, keys[0], 0);
+  CHECK(!tsdbBlkCacheContains(pCache, &keys[0]));
+  CHECK(pCache->used == 0);
+  tsdbFreeBlkCache(pCache);
+
+  pCache = tsdbNewBlkCache(0);
+  putCol(pCache, keys[0], 0);
+  CHECK(!tsdbBlkCacheContains(pCache, &keys[0]));
+  tsdbFreeBlkCache(pCache);
+
+  tfree(col.pData);
+}
+
+static void testInvalidation() {
+  STsdbBlkCache *pCache = tsdbNewBlkCache(1024 * 1024);
+  SDataCol       col;
+  initCol(&col);
+
+  for (int fid = 1; fid <= 3; fid++) {
+    for (int i = 0; i < 4; i++) {
+      putCol(pCache, makeKey(fid, 4096 * (i + 1), 1, i == 3), fid * 100 + i);
+    }
+  }
+  int64_t nodeSize = pCache->used / 12;
+
+  // all the chunks of the .data and .last files of the file set are dropped
+  tsdbInvalidateBlkCache(pCache, 2);
+  CHECK(pCache->used == nodeSize * 8);
+  for (int fid = 1; fid <= 3; fid++) {
+    for (int i = 0; i < 4; i++) {
+      SBlkCacheKey key = makeKey(fid, 4096 * (i + 1), 1, i == 3);
+      CHECK(tsdbBlkCacheContains(pCache, &key) == (fid != 2));
+    }
+  }
+
+  CHECK(getCol(pCache, makeKey(3, 4096, 1, 0), &col));
+  CHECK(colHasSeed(&col, 300));
+
+  tsdbInvalidateBlkCache(pCache, 1);
+  tsdbInvalidateBlkCache(pCache, 3);
+  CHECK(pCache->used == 0);
+  CHECK(pCache->head == NULL && pCache->tail == NULL);
+
+  // the file set is cached again when read after the commit
+  putCol(pCache, makeKey(2, 4096, 1, 0), 7);
+  CHECK(getCol(pCache, makeKey(2, 4096, 1, 0), &col));
+  CHECK(colHasSeed(&col, 7));
+  CHECK(pCache->used == nodeSize);
+
+  tfree(col.pData);
+  tsdbFreeBlkCache(pCache);
+  tsdbInvalidateBlkCache(NULL, 1);
+}
+
+int main(int argc, char *argv[]) {
+  testHitAndMiss();
+  testEviction();
+  testInvalidation();
+
+  if (numOfFailed > 0) {
+    printf("%d checks failed\n", numOfFailed);
+    return 1;
+  }
+
+  printf("all checks passed\n");
+  return 0;
+}
@@ -30,7 +30,8 @@ a single API instead of looping every queue by itself.
 Notes:
 1: taosOpenQueue/taosCloseQueue, taosOpenQset/taosCloseQset is NOT multi-thread safe 
 2: after taosCloseQueue/taosCloseQset is called, read/write operation APIs are not safe.
-3: read/write operation APIs are multi-thread safe
+3: write operation APIs are multi-thread safe and lock free, a queue shall be read by only one
+   thread at a time, unless it is read via a queue set
 
 To remove the limitation and make this set of queue APIs multi-thread safe, REF(tref.c)
 shall be used to set up the protection. 
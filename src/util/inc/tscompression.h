@@ -33,6 +33,13 @@ extern "C" {
 #define NO_COMPRESSION 0
 #define ONE_STAGE_COMP 1
 #define TWO_STAGE_COMP 2
+// Set in the algorithm of a data block having a float/double column of the Chimp or decimal codec. Versions before
+// these codecs do not know the value and fail the block, instead of decoding the column as XOR.
+#define COMP_FLOAT_ADAPT 0x10
+#define COMP_STAGE(algorithm) ((algorithm) & ~COMP_FLOAT_ADAPT)
+
+// max number of distinct values in the dictionary of a dictionary encoded binary/nchar column
+#define TSDB_STR_DICT_MAX_ENTRIES 4096
 
 //
 // compressed data first byte foramt
@@ -46,6 +53,8 @@ extern "C" {
 
 // compression algorithm save first byte higher 7 bit
 #define ALGO_SZ_LOSSY     1 // SZ compress 
+#define ALGO_CHIMP        2 // Chimp XOR of float/double
+#define ALGO_DECIMAL      3 // float/double of a few decimal digits as integers
 
 #define HEAD_MODE(x)  x%2
 #define HEAD_ALGO(x)  x/2
@@ -56,12 +65,18 @@ extern int tsCompressBoolImp(const char *const input, const int nelements, char
 extern int tsDecompressBoolImp(const char *const input, const int nelements, char *const output);
 extern int tsCompressStringImp(const char *const input, int inputSize, char *const output, int outputSize);
 extern int tsDecompressStringImp(const char *const input, int compressedSize, char *const output, int outputSize);
+extern int tsCompressStringDictImp(const char *const input, int inputSize, const int nelements, char *const output,
+                                   int outputSize, int maxEntries);
 extern int tsCompressTimestampImp(const char *const input, const int nelements, char *const output);
 extern int tsDecompressTimestampImp(const char *const input, const int nelements, char *const output);
 extern int tsCompressDoubleImp(const char *const input, const int nelements, char *const output);
 extern int tsDecompressDoubleImp(const char *const input, const int nelements, char *const output);
 extern int tsCompressFloatImp(const char *const input, const int nelements, char *const output);
 extern int tsDecompressFloatImp(const char *const input, const int nelements, char *const output);
+// lossless, the codec is chosen per block
+extern int tsCompressDoubleAdaptImp(const char *const input, const int nelements, char *const output);
+extern int tsCompressFloatAdaptImp(const char *const input, const int nelements, char *const output);
+extern bool tsIsFloatAdaptCodec(const char *const input);
 // lossy
 extern int tsCompressFloatLossyImp(const char * input, const int nelements, char *const output);
 extern int tsDecompressFloatLossyImp(const char * input, int compressedSize, const int nelements, char *const output);
@@ -310,6 +325,50 @@ static FORCE_INLINE int tsDecompressDouble(const char *const input, int compress
 #endif  
 }
 
+// The blocks are decompressed by tsDecompressFloat and tsDecompressDouble, *adapted is set if the Chimp or decimal
+// codec is used
+static FORCE_INLINE int tsCompressFloatAdapt(const char *const input, int inputSize, const int nelements, char *const output,
+                                             int outputSize, char algorithm, char *const buffer, int bufferSize,
+                                             bool *adapted) {
+  *adapted = false;
+#ifdef TD_TSZ
+  if (lossyFloat) return tsCompressFloatLossyImp(input, nelements, output);
+#endif
+  if (algorithm == ONE_STAGE_COMP) {
+    int len = tsCompressFloatAdaptImp(input, nelements, output);
+    *adapted = tsIsFloatAdaptCodec(output);
+    return len;
+  } else if (algorithm == TWO_STAGE_COMP) {
+    int len = tsCompressFloatAdaptImp(input, nelements, buffer);
+    *adapted = tsIsFloatAdaptCodec(buffer);
+    return tsCompressStringImp(buffer, len, output, outputSize);
+  } else {
+    assert(0);
+    return -1;
+  }
+}
+
+static FORCE_INLINE int tsCompressDoubleAdapt(const char *const input, int inputSize, const int nelements, char *const output,
+                                              int outputSize, char algorithm, char *const buffer, int bufferSize,
+                                              bool *adapted) {
+  *adapted = false;
+#ifdef TD_TSZ
+  if (lossyDouble) return tsCompressDoubleLossyImp(input, nelements, output);
+#endif
+  if (algorithm == ONE_STAGE_COMP) {
+    int len = tsCompressDoubleAdaptImp(input, nelements, output);
+    *adapted = tsIsFloatAdaptCodec(output);
+    return len;
+  } else if (algorithm == TWO_STAGE_COMP) {
+    int len = tsCompressDoubleAdaptImp(input, nelements, buffer);
+    *adapted = tsIsFloatAdaptCodec(buffer);
+    return tsCompressStringImp(buffer, len, output, outputSize);
+  } else {
+    assert(0);
+    return -1;
+  }
+}
+
 #ifdef TD_TSZ  
 //
 //  lossy float double
@@ -36,7 +36,9 @@
  *   better when there are a lot of consecutive true values or false values.
  *
  * STRING Compression Algorithm:
- *   We us LZ4 method to compress the string type.
+ *   We us LZ4 method to compress the string type. Binary and nchar columns with a few distinct
+ *   values in a block may also be dictionary encoded, the distinct values are stored once and each
+ *   row is stored as a bit packed code of its value in the dictionary.
  *
  * FLOAT Compression Algorithm:
  *   We use the same method with Akumuli to compress float and double types. The compression
@@ -44,6 +46,9 @@
  *   adjacent values. Then compare the number of leading zeros and trailing zeros. If the number
  *   of leading zeros are larger than the trailing zeros, then record the last serveral bytes
  *   of the XORed value with informations. If not, record the first corresponding bytes.
+ *   The codec of a block may also be chosen from a sample of its values among the XOR codec above,
+ *   Chimp (https://doi.org/10.14778/3551793.3551852), which writes the XORed value at the bit level,
+ *   and a decimal codec, which compresses the values of a few decimal digits as integers.
  *
  */
 
@@ -54,6 +59,7 @@
 #endif
 #include "taosdef.h"
 #include "tscompression.h"
+#include "ttype.h"
 #include "tulog.h"
 #include "tglobal.h"
 
@@ -232,20 +238,128 @@ int tsCompressINTImp(const char *const input, const int nelements, char *const o
   return opos;
 }
 
+/*
+ * Decompress Integer (Simple8B), specialized by the output type. The bit width of every selector is a constant in
+ * its own case, so that the shifts and the zigzag decoding of a whole word are unrolled and turned into packed
+ * operations, e.g., variable shifts of AVX2. Only the prefix sum of the deltas is left as a dependent chain of adds.
+ * An AVX2 clone of each decoder is selected at runtime on x86_64, SSE4.2 is the build baseline.
+ */
+#if defined(__x86_64__) && defined(__GNUC__)
+#define SIMPLE8B_DECODE_AVX2
+#endif
+
+static const int simple8bSelectorToElems[] = {240, 120, 60, 30, 20, 15, 12, 10, 8, 7, 6, 5, 4, 3, 2, 1};
+
+#define SIMPLE8B_UNPACK_CASE(_selector, _bit, _elems)                 \
+  case (_selector):                                                   \
+    for (int k = 0; k < (_elems); ++k) {                              \
+      uint64_t zigzag_value = (w >> (4 + (_bit) * k)) & INT64MASK(_bit); \
+      delta[k] = ZIGZAG_DECODE(int64_t, zigzag_value);                \
+    }                                                                 \
+    break;
+
+#define SIMPLE8B_DECODE_BODY(_type)                                                     \
+  do {                                                                                  \
+    _type      *ostream = (_type *)output;                                              \
+    const char *ip = input + 1;                                                         \
+    int64_t     prev_value = 0;                                                         \
+    int64_t     delta[60];                                                              \
+    for (int count = 0; count < nelements; ip += LONG_BYTES) {                          \
+      uint64_t w = 0;                                                                   \
+      memcpy(&w, ip, LONG_BYTES);                                                       \
+      int selector = (int)(w & INT64MASK(4));                                           \
+      int num = MIN(simple8bSelectorToElems[selector], nelements - count);              \
+      if (selector < 2) {                                                               \
+        for (int k = 0; k < num; ++k) {                                                 \
+          ostream[count + k] = (_type)prev_value;                                       \
+        }                                                                               \
+      } else {                                                                          \
+        switch (selector) {                                                             \
+          SIMPLE8B_UNPACK_CASE(2, 1, 60)                                                \
+          SIMPLE8B_UNPACK_CASE(3, 2, 30)                                                \
+          SIMPLE8B_UNPACK_CASE(4, 3, 20)                                                \
+          SIMPLE8B_UNPACK_CASE(5, 4, 15)                                                \
+          SIMPLE8B_UNPACK_CASE(6, 5, 12)                                                \
+          SIMPLE8B_UNPACK_CASE(7, 6, 10)                                                \
+          SIMPLE8B_UNPACK_CASE(8, 7, 8)                                                 \
+          SIMPLE8B_UNPACK_CASE(9, 8, 7)                                                 \
+          SIMPLE8B_UNPACK_CASE(10, 10, 6)                                               \
+          SIMPLE8B_UNPACK_CASE(11, 12, 5)                                               \
+          SIMPLE8B_UNPACK_CASE(12, 15, 4)                                               \
+          SIMPLE8B_UNPACK_CASE(13, 20, 3)                                               \
+          SIMPLE8B_UNPACK_CASE(14, 30, 2)                                               \
+          SIMPLE8B_UNPACK_CASE(15, 60, 1)                                               \
+        }                                                                               \
+        for (int k = 0; k < num; ++k) {                                                 \
+          prev_value += delta[k];                                                       \
+          ostream[count + k] = (_type)prev_value;                                       \
+        }                                                                               \
+      }                                                                                 \
+      count += num;                                                                     \
+    }                                                                                   \
+  } while (0)
+
+typedef void (*simple8b_decode_func)(const char *const input, const int nelements, char *const output);
+
+#ifdef SIMPLE8B_DECODE_AVX2
+#define SIMPLE8B_DEFINE_DECODER(_name, _type)                                                                  \
+  static void tsDecompress##_name(const char *const input, const int nelements, char *const output) {         \
+    SIMPLE8B_DECODE_BODY(_type);                                                                               \
+  }                                                                                                            \
+  __attribute__((target("avx2"))) static void tsDecompress##_name##Avx2(const char *const input,              \
+                                                                         const int nelements, char *const output) { \
+    SIMPLE8B_DECODE_BODY(_type);                                                                               \
+  }
+#define SIMPLE8B_DECODER_ENTRY(_name) {tsDecompress##_name, tsDecompress##_name##Avx2}
+#else
+#define SIMPLE8B_DEFINE_DECODER(_name, _type)                                                                  \
+  static void tsDecompress##_name(const char *const input, const int nelements, char *const output) {         \
+    SIMPLE8B_DECODE_BODY(_type);                                                                               \
+  }
+#define SIMPLE8B_DECODER_ENTRY(_name) {tsDecompress##_name, tsDecompress##_name}
+#endif
+
+SIMPLE8B_DEFINE_DECODER(Int8, int8_t)
+SIMPLE8B_DEFINE_DECODER(Int16, int16_t)
+SIMPLE8B_DEFINE_DECODER(Int32, int32_t)
+SIMPLE8B_DEFINE_DECODER(Int64, int64_t)
+
+static simple8b_decode_func simple8bDecoder[][2] = {
+  SIMPLE8B_DECODER_ENTRY(Int8), SIMPLE8B_DECODER_ENTRY(Int16), SIMPLE8B_DECODER_ENTRY(Int32),
+  SIMPLE8B_DECODER_ENTRY(Int64),
+};
+
+static bool simple8bUseAvx2() {
+#ifdef SIMPLE8B_DECODE_AVX2
+  static int8_t avx2 = -1;
+  if (avx2 < 0) {
+    avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+  }
+  return avx2 == 1;
+#else
+  return false;
+#endif
+}
+
 int tsDecompressINTImp(const char *const input, const int nelements, char *const output, const char type) {
   int word_length = 0;
+  int idx = 0;
   switch (type) {
     case TSDB_DATA_TYPE_BIGINT:
       word_length = LONG_BYTES;
+      idx = 3;
       break;
     case TSDB_DATA_TYPE_INT:
       word_length = INT_BYTES;
+      idx = 2;
       break;
     case TSDB_DATA_TYPE_SMALLINT:
       word_length = SHORT_BYTES;
+      idx = 1;
       break;
     case TSDB_DATA_TYPE_TINYINT:
       word_length = CHAR_BYTES;
+      idx = 0;
       break;
     default:
       uError("Invalid decompress integer type:%d", type);
@@ -258,65 +372,7 @@ int tsDecompressINTImp(const char *const input, const int nelements, char *const
     return nelements * word_length;
   }
 
-  // Selector value:              0    1   2   3   4   5   6   7   8  9  10  11
-  // 12  13  14  15
-  char bit_per_integer[] = {0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 15, 20, 30, 60};
-  int  selector_to_elems[] = {240, 120, 60, 30, 20, 15, 12, 10, 8, 7, 6, 5, 4, 3, 2, 1};
-
-  const char *ip = input + 1;
-  int         count = 0;
-  int         _pos = 0;
-  int64_t     prev_value = 0;
-
-  while (1) {
-    if (count == nelements) break;
-
-    uint64_t w = 0;
-    memcpy(&w, ip, LONG_BYTES);
-
-    char selector = (char)(w & INT64MASK(4));  // selector = 4
-    char bit = bit_per_integer[(int)selector];      // bit = 3
-    int  elems = selector_to_elems[(int)selector];
-
-    for (int i = 0; i < elems; i++) {
-      uint64_t zigzag_value;
-
-      if (selector == 0 || selector == 1) {
-        zigzag_value = 0;
-      } else {
-        zigzag_value = ((w >> (4 + bit * i)) & INT64MASK(bit));
-      }
-      int64_t diff = ZIGZAG_DECODE(int64_t, zigzag_value);
-      int64_t curr_value = diff + prev_value;
-      prev_value = curr_value;
-
-      switch (type) {
-        case TSDB_DATA_TYPE_BIGINT:
-          *((int64_t *)output + _pos) = (int64_t)curr_value;
-          _pos++;
-          break;
-        case TSDB_DATA_TYPE_INT:
-          *((int32_t *)output + _pos) = (int32_t)curr_value;
-          _pos++;
-          break;
-        case TSDB_DATA_TYPE_SMALLINT:
-          *((int16_t *)output + _pos) = (int16_t)curr_value;
-          _pos++;
-          break;
-        case TSDB_DATA_TYPE_TINYINT:
-          *((int8_t *)output + _pos) = (int8_t)curr_value;
-          _pos++;
-          break;
-        default:
-          perror("Wrong integer types.\n");
-          return -1;
-      }
-      count++;
-      if (count == nelements) break;
-    }
-    ip += LONG_BYTES;
-  }
-
+  (*simple8bDecoder[idx][simple8bUseAvx2() ? 1 : 0])(input, nelements, output);
   return nelements * word_length;
 }
 
@@ -427,6 +483,226 @@ int tsDecompressBoolRLEImp(const char *const input, const int nelements, char *c
 
 /* ----------------------------------------------String Compression
  * ---------------------------------------------- */
+/*
+ * Dictionary encoding of var length data, the layout is:
+ *   | indicator(2) | nelements(int32) | numOfEntries(uint16) | bits(uint8) | entries | codes |
+ * The entries are the distinct values in var data format, the codes are packed in 0, 1, 2, 4, 8 or 16 bits so
+ * that a code never crosses a byte boundary. Versions knowing only the LZ4 indicators refuse the data.
+ */
+#define STR_DICT_INDICATOR 2
+#define STR_DICT_HEAD_SIZE (1 + sizeof(int32_t) + sizeof(uint16_t) + sizeof(uint8_t))
+
+static FORCE_INLINE uint32_t strDictHash(const char *data, int32_t len) {
+  uint32_t h = 2166136261u;
+  for (int32_t i = 0; i < len; ++i) {
+    h = (h ^ (uint8_t)data[i]) * 16777619u;
+  }
+  return h;
+}
+
+static FORCE_INLINE int32_t strDictCodeBits(int32_t numOfEntries) {
+  if (numOfEntries <= 1) return 0;
+  if (numOfEntries <= 2) return 1;
+  if (numOfEntries <= 4) return 2;
+  if (numOfEntries <= 16) return 4;
+  if (numOfEntries <= 256) return 8;
+  return 16;
+}
+
+static FORCE_INLINE int32_t strDictCodesSize(int32_t nelements, int32_t bits) {
+  return (int32_t)(((int64_t)nelements * bits + BITS_PER_BYTE - 1) / BITS_PER_BYTE);
+}
+
+static FORCE_INLINE void strDictSetCode(uint8_t *codes, int32_t i, int32_t bits, uint32_t code) {
+  switch (bits) {
+    case 0:
+      break;
+    case 8:
+      codes[i] = (uint8_t)code;
+      break;
+    case 16:
+      codes[i * 2] = (uint8_t)code;
+      codes[i * 2 + 1] = (uint8_t)(code >> 8);
+      break;
+    default: {
+      int32_t perByte = BITS_PER_BYTE / bits;
+      codes[i / perByte] |= (uint8_t)(code << ((i % perByte) * bits));
+      break;
+    }
+  }
+}
+
+/*
+ * Returns the length of the encoded data, or -1 if there are more distinct values than maxEntries or the encoded
+ * data is not smaller than the input, the caller falls back to tsCompressStringImp then.
+ */
+int tsCompressStringDictImp(const char *const input, int inputSize, const int nelements, char *const output,
+                            int outputSize, int maxEntries) {
+  if (nelements <= 0 || maxEntries <= 0) return -1;
+
+  // a distinct value shall appear 16 times in average at least, LZ4 does better on higher cardinality
+  maxEntries = MIN(maxEntries, nelements / 16);
+  maxEntries = MIN(maxEntries, TSDB_STR_DICT_MAX_ENTRIES);
+  if (maxEntries <= 0) return -1;
+
+  int32_t tableSize = 1;
+  while (tableSize < maxEntries * 2) tableSize <<= 1;
+
+  uint16_t  table[TSDB_STR_DICT_MAX_ENTRIES * 2];  // index of the entry plus one, 0 for an empty slot
+  int32_t   entryOffset[TSDB_STR_DICT_MAX_ENTRIES];
+  uint16_t *codes = malloc(sizeof(uint16_t) * nelements);
+  if (codes == NULL) return -1;
+  memset(table, 0, sizeof(uint16_t) * tableSize);
+
+  int32_t ret = -1;
+  int32_t numOfEntries = 0;
+  int32_t limit = MIN(inputSize, outputSize);
+  int32_t ipos = 0;
+  int32_t opos = STR_DICT_HEAD_SIZE;
+
+  for (int32_t i = 0; i < nelements; ++i) {
+    if (ipos + (int32_t)VARSTR_HEADER_SIZE > inputSize) goto _exit;
+
+    const char *pVal = input + ipos;
+    int32_t     tlen = (int32_t)varDataTLen(pVal);
+    if (ipos + tlen > inputSize) goto _exit;
+
+    uint32_t slot = strDictHash(pVal, tlen) & (tableSize - 1);
+    while (table[slot] != 0) {
+      const char *pEntry = output + entryOffset[table[slot] - 1];
+      if ((int32_t)varDataTLen(pEntry) == tlen && memcmp(pEntry, pVal, tlen) == 0) break;
+      slot = (slot + 1) & (tableSize - 1);
+    }
+
+    if (table[slot] == 0) {
+      if (numOfEntries >= maxEntries || opos + tlen >= limit) goto _exit;
+
+      memcpy(output + opos, pVal, tlen);
+      entryOffset[numOfEntries++] = opos;
+      table[slot] = (uint16_t)numOfEntries;
+      opos += tlen;
+    }
+
+    codes[i] = table[slot] - 1;
+    ipos += tlen;
+  }
+
+  int32_t bits = strDictCodeBits(numOfEntries);
+  int32_t codesSize = strDictCodesSize(nelements, bits);
+  if (opos + codesSize >= limit) goto _exit;
+
+  uint8_t *pCodes = (uint8_t *)output + opos;
+  memset(pCodes, 0, codesSize);
+  for (int32_t i = 0; i < nelements; ++i) {
+    strDictSetCode(pCodes, i, bits, codes[i]);
+  }
+
+  uint16_t entries = (uint16_t)numOfEntries;
+  output[0] = STR_DICT_INDICATOR;
+  memcpy(output + 1, &nelements, sizeof(int32_t));
+  memcpy(output + 1 + sizeof(int32_t), &entries, sizeof(uint16_t));
+  output[STR_DICT_HEAD_SIZE - 1] = (char)bits;
+  ret = opos + codesSize;
+
+_exit:
+  free(codes);
+  return ret;
+}
+
+// entries are copied in 16 bytes chunks when both the entry and the output have the room for it
+#define STR_DICT_COPY_CHUNK 16
+#define STR_DICT_DECODE_LOOP(_code)                                                          \
+  do {                                                                                       \
+    for (int32_t i = 0; i < nelements; ++i) {                                                \
+      uint32_t code = (_code);                                                               \
+      if (code >= numOfEntries) goto _err;                                                   \
+                                                                                             \
+      const char *src = input + entryOffset[code];                                           \
+      int32_t     tlen = entryOffset[code + 1] - entryOffset[code];                          \
+      if (opos + tlen + STR_DICT_COPY_CHUNK <= outputSize && entryOffset[code] < fastLimit) { \
+        for (int32_t k = 0; k < tlen; k += STR_DICT_COPY_CHUNK) {                            \
+          memcpy(output + opos + k, src + k, STR_DICT_COPY_CHUNK);                           \
+        }                                                                                    \
+      } else {                                                                               \
+        if (opos + tlen > outputSize) goto _err;                                             \
+        memcpy(output + opos, src, tlen);                                                    \
+      }                                                                                      \
+      opos += tlen;                                                                          \
+    }                                                                                        \
+  } while (0)
+
+static int tsDecompressStringDict(const char *const input, int compressedSize, char *const output, int outputSize) {
+  int32_t  nelements = 0;
+  uint16_t numOfEntries = 0;
+  int32_t  entryOffset[TSDB_STR_DICT_MAX_ENTRIES + 1];
+
+  if (compressedSize < (int32_t)STR_DICT_HEAD_SIZE) goto _err;
+
+  memcpy(&nelements, input + 1, sizeof(int32_t));
+  memcpy(&numOfEntries, input + 1 + sizeof(int32_t), sizeof(uint16_t));
+  int32_t bits = (uint8_t)input[STR_DICT_HEAD_SIZE - 1];
+  if (nelements <= 0 || numOfEntries == 0 || numOfEntries > TSDB_STR_DICT_MAX_ENTRIES ||
+      bits != strDictCodeBits(numOfEntries)) {
+    goto _err;
+  }
+
+  int32_t ipos = STR_DICT_HEAD_SIZE;
+  for (int32_t i = 0; i < numOfEntries; ++i) {
+    if (ipos + (int32_t)VARSTR_HEADER_SIZE > compressedSize || varDataLen(input + ipos) < 0) goto _err;
+    entryOffset[i] = ipos;
+    ipos += (int32_t)varDataTLen(input + ipos);
+  }
+  entryOffset[numOfEntries] = ipos;
+  if (ipos + strDictCodesSize(nelements, bits) > compressedSize) goto _err;
+
+  // an entry starting before fastLimit can be read in chunks without crossing the end of the input
+  int32_t maxLen = 0;
+  for (int32_t i = 0; i < numOfEntries; ++i) {
+    maxLen = MAX(maxLen, entryOffset[i + 1] - entryOffset[i]);
+  }
+  int32_t fastLimit = compressedSize - maxLen - STR_DICT_COPY_CHUNK;
+
+  const uint8_t *codes = (const uint8_t *)input + ipos;
+  int32_t        opos = 0;
+  switch (bits) {
+    case 0: {
+      // all the values are the same, double the filled part of the output until all are filled
+      opos = entryOffset[1] - entryOffset[0];
+      int64_t total = (int64_t)nelements * opos;
+      if (total > outputSize) goto _err;
+
+      memcpy(output, input + entryOffset[0], opos);
+      while (opos < total) {
+        int32_t len = (int32_t)MIN(opos, total - opos);
+        memcpy(output + opos, output, len);
+        opos += len;
+      }
+      break;
+    }
+    case 1:
+      STR_DICT_DECODE_LOOP((codes[i >> 3] >> (i & 7)) & 0x1);
+      break;
+    case 2:
+      STR_DICT_DECODE_LOOP((codes[i >> 2] >> ((i & 3) << 1)) & 0x3);
+      break;
+    case 4:
+      STR_DICT_DECODE_LOOP((codes[i >> 1] >> ((i & 1) << 2)) & 0xf);
+      break;
+    case 8:
+      STR_DICT_DECODE_LOOP(codes[i]);
+      break;
+    default:
+      STR_DICT_DECODE_LOOP(codes[i * 2] | ((uint32_t)codes[i * 2 + 1] << 8));
+      break;
+  }
+
+  return opos;
+
+_err:
+  uError("Failed to decode dictionary encoded string, compressed size:%d", compressedSize);
+  return -1;
+}
+
 // Note: the size of the output must be larger than input_size + 1 and
 // LZ4_compressBound(size) + 1;
 // >= max(input_size, LZ4_compressBound(input_size)) + 1;
@@ -462,6 +738,8 @@ int tsDecompressStringImp(const char *const input, int compressedSize, char *con
     /* It is not compressed by LZ4 algorithm */
     memcpy(output, input + 1, compressedSize - 1);
     return compressedSize - 1;
+  } else if (input[0] == STR_DICT_INDICATOR) {
+    return tsDecompressStringDict(input, compressedSize, output, outputSize);
   } else {
     uError("Invalid decompress string indicator:%d", input[0]);
     return -1;
@@ -567,6 +845,50 @@ _exit_over:
   return nelements * LONG_BYTES + 1;
 }
 
+static const uint64_t tsByteMask[] = {0x0,
+                                      0xFF,
+                                      0xFFFF,
+                                      0xFFFFFF,
+                                      0xFFFFFFFF,
+                                      0xFFFFFFFFFF,
+                                      0xFFFFFFFFFFFF,
+                                      0xFFFFFFFFFFFFFF,
+                                      0xFFFFFFFFFFFFFFFF};
+
+/*
+ * Read the delta of delta in nbytes. If wide is set, the 8 bytes load is known to stay in the input, and the value
+ * is masked out of it instead of being copied byte by byte.
+ */
+static FORCE_INLINE int64_t tsDecodeDeltaOfDelta(const char *const input, int8_t nbytes, bool wide) {
+  uint64_t dd = 0;
+  if (wide) {
+    memcpy(&dd, input, LONG_BYTES);
+    dd &= tsByteMask[nbytes];
+  } else if (is_bigendian()) {
+    memcpy(((char *)(&dd)) + LONG_BYTES - nbytes, input, nbytes);
+  } else {
+    memcpy(&dd, input, nbytes);
+  }
+
+  return ZIGZAG_DECODE(int64_t, dd);
+}
+
+// number of consecutive zero flags bytes, no more than maxRun
+static FORCE_INLINE int tsCountZeroFlags(const char *const input, int maxRun) {
+  int run = 0;
+  while (run + LONG_BYTES <= maxRun) {
+    uint64_t w = 0;
+    memcpy(&w, input + run, LONG_BYTES);
+    if (w != 0) {
+      return is_bigendian() ? run : (run + BUILDIN_CTZL(w) / BITS_PER_BYTE);
+    }
+    run += LONG_BYTES;
+  }
+
+  while (run < maxRun && input[run] == 0) run++;
+  return run;
+}
+
 int tsDecompressTimestampImp(const char *const input, const int nelements, char *const output) {
   assert(nelements >= 0);
   if (nelements == 0) return 0;
@@ -584,20 +906,27 @@ int tsDecompressTimestampImp(const char *const input, const int nelements, char
     int64_t delta_of_delta = 0;
 
     while (1) {
+      // Zero flags are pairs of values with the same delta, which is the case of most timestamps. Each one takes
+      // exactly one byte, so the run is found with word loads and decoded as an arithmetic sequence.
+      if (opos > 0 && input[ipos] == 0) {
+        int run = tsCountZeroFlags(input + ipos, (nelements - opos) / 2);
+        for (int i = 0; i < run * 2; ++i) {
+          ostream[opos + i] = (int64_t)((uint64_t)prev_value + (uint64_t)prev_delta * (i + 1));
+        }
+
+        prev_value = (int64_t)((uint64_t)prev_value + (uint64_t)prev_delta * run * 2);
+        ipos += run;
+        opos += run * 2;
+        if (opos == nelements) return nelements * LONG_BYTES;
+      }
+
+      // Every pair takes its flags byte at least, so both 8 bytes loads stay in the input if 18 values are left.
+      bool    wide = !is_bigendian() && (nelements - opos >= 18);
       uint8_t flags = input[ipos++];
+
       // Decode dd1
-      uint64_t dd1 = 0;
       nbytes = flags & INT8MASK(4);
-      if (nbytes == 0) {
-        delta_of_delta = 0;
-      } else {
-        if (is_bigendian()) {
-          memcpy(((char *)(&dd1)) + LONG_BYTES - nbytes, input + ipos, nbytes);
-        } else {
-          memcpy(&dd1, input + ipos, nbytes);
-        }
-        delta_of_delta = ZIGZAG_DECODE(int64_t, dd1);
-      }
+      delta_of_delta = tsDecodeDeltaOfDelta(input + ipos, nbytes, wide);
       ipos += nbytes;
       if (opos == 0) {
         prev_value = delta_of_delta;
@@ -611,19 +940,8 @@ int tsDecompressTimestampImp(const char *const input, const int nelements, char
       if (opos == nelements) return nelements * LONG_BYTES;
 
       // Decode dd2
-      uint64_t dd2 = 0;
       nbytes = (flags >> 4) & INT8MASK(4);
-      if (nbytes == 0) {
-        delta_of_delta = 0;
-      } else {
-        if (is_bigendian()) {
-          memcpy(((char *)(&dd2)) + LONG_BYTES - nbytes, input + ipos, nbytes);
-        } else {
-          memcpy(&dd2, input + ipos, nbytes);
-        }
-        // zigzag_decoding
-        delta_of_delta = ZIGZAG_DECODE(int64_t, dd2);
-      }
+      delta_of_delta = tsDecodeDeltaOfDelta(input + ipos, nbytes, wide);
       ipos += nbytes;
       prev_delta = delta_of_delta + prev_delta;
       prev_value = prev_value + prev_delta;
@@ -636,6 +954,358 @@ int tsDecompressTimestampImp(const char *const input, const int nelements, char
     return -1;
   }
 }
+/* --------------------------------------------Adaptive Float Compression
+ * ---------------------------------------------- */
+// first byte of the blocks compressed by the codecs below, apart from the ones of the XOR codec (0 and 1) and of the
+// lossy codec
+#define FLOAT_CHIMP_INDICATOR   ((ALGO_CHIMP << 1) | MODE_COMPRESS)
+#define FLOAT_DECIMAL_INDICATOR ((ALGO_DECIMAL << 1) | MODE_COMPRESS)
+
+#define FLOAT_SAMPLE_SIZE       256  // number of values the codec of a block is chosen by
+#define FLOAT_CHIMP_THRESHOLD   6    // more trailing zeros than this are not written
+#define FLOAT_DECIMAL_MAX_SCALE 10
+
+#define FLOAT_DECIMAL_MAX_INT(bytes) (((bytes) == DOUBLE_BYTES) ? 4503599627370496.0 : 2147483647.0)
+
+bool tsIsFloatAdaptCodec(const char *const input) {
+  return input[0] == FLOAT_CHIMP_INDICATOR || input[0] == FLOAT_DECIMAL_INDICATOR;
+}
+
+typedef struct {
+  char    *buf;
+  int      pos;
+  int      limit;
+  uint64_t acc;    // bits not written into the buffer yet
+  int      nbits;  // number of bits in acc, less than 64
+  bool     overflow;
+} SBitWriter;
+
+typedef struct {
+  const char *buf;
+  int         pos;
+  uint64_t    acc;
+  int         nbits;
+} SBitReader;
+
+// rounded number of leading zeros of the XOR of two values, a code of 3 bits and the number it stands for
+static const uint8_t chimpLeadingCode[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 4, 4, 5, 5,
+                                           6, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+                                           7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7};
+static const uint8_t chimpLeadingValue[] = {0, 8, 12, 16, 18, 20, 22, 24};
+
+static const double floatPow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10};
+
+// put the n (1 to 64) lower bits of v, v has no bit set above them
+static FORCE_INLINE void bitWriterPut(SBitWriter *w, uint64_t v, int n) {
+  w->acc |= v << w->nbits;
+  if (w->nbits + n < 64) {
+    w->nbits += n;
+    return;
+  }
+
+  if (w->pos + LONG_BYTES > w->limit) {
+    w->overflow = true;
+    return;
+  }
+
+  memcpy(w->buf + w->pos, &w->acc, LONG_BYTES);
+  w->pos += LONG_BYTES;
+
+  int written = 64 - w->nbits;
+  w->acc = (written < 64) ? (v >> written) : 0;
+  w->nbits = n - written;
+}
+
+// the last word is written whole, so the reader only loads whole words
+static FORCE_INLINE void bitWriterFlush(SBitWriter *w) {
+  if (w->nbits > 0) bitWriterPut(w, 0, 64 - w->nbits);
+}
+
+// get n (1 to 64) bits
+static FORCE_INLINE uint64_t bitReaderGet(SBitReader *r, int n) {
+  uint64_t v;
+  if (n <= r->nbits) {
+    v = (n < 64) ? (r->acc & INT64MASK(n)) : r->acc;
+    r->acc = (n < 64) ? (r->acc >> n) : 0;
+    r->nbits -= n;
+    return v;
+  }
+
+  uint64_t word;
+  memcpy(&word, r->buf + r->pos, LONG_BYTES);
+  r->pos += LONG_BYTES;
+
+  int consumed = n - r->nbits;
+  v = r->acc | ((r->nbits < 64) ? (word << r->nbits) : 0);
+  v = (n < 64) ? (v & INT64MASK(n)) : v;
+  r->acc = (consumed < 64) ? (word >> consumed) : 0;
+  r->nbits = 64 - consumed;
+  return v;
+}
+
+static FORCE_INLINE uint64_t floatGetBits(const char *const input, int i, int bytes) {
+  if (bytes == DOUBLE_BYTES) {
+    uint64_t v;
+    memcpy(&v, input + (size_t)i * DOUBLE_BYTES, DOUBLE_BYTES);
+    return v;
+  } else {
+    uint32_t v;
+    memcpy(&v, input + (size_t)i * FLOAT_BYTES, FLOAT_BYTES);
+    return v;
+  }
+}
+
+static FORCE_INLINE void floatSetBits(char *const output, int i, uint64_t v, int bytes) {
+  if (bytes == DOUBLE_BYTES) {
+    memcpy(output + (size_t)i * DOUBLE_BYTES, &v, DOUBLE_BYTES);
+  } else {
+    uint32_t v32 = (uint32_t)v;
+    memcpy(output + (size_t)i * FLOAT_BYTES, &v32, FLOAT_BYTES);
+  }
+}
+
+/*
+ * Chimp: the XOR of a value with the previous one is written with a flag of 2 bits,
+ *   00: same as the previous value
+ *   01: 3 bits of the leading zeros code, the number of significant bits and the significant bits, for XORs with more
+ *       trailing zeros than FLOAT_CHIMP_THRESHOLD
+ *   10: the bits after the leading zeros, which are the same as the ones of the previous XOR
+ *   11: 3 bits of the leading zeros code and the bits after the leading zeros
+ * Returns -1 if the output is larger than outputSize.
+ */
+static int floatCompressChimp(const char *const input, const int nelements, char *const output, int outputSize,
+                              int bytes) {
+  int        width = bytes * BITS_PER_BYTE;
+  int        sigBits = (bytes == DOUBLE_BYTES) ? 6 : 5;
+  SBitWriter w = {.buf = output, .pos = 1, .limit = outputSize};
+
+  uint64_t prev = floatGetBits(input, 0, bytes);
+  int      storedLeading = width + 1;
+  bitWriterPut(&w, prev, width);
+
+  for (int i = 1; i < nelements && !w.overflow; i++) {
+    uint64_t curr = floatGetBits(input, i, bytes);
+    uint64_t xor = curr ^ prev;
+    prev = curr;
+
+    if (xor == 0) {
+      bitWriterPut(&w, 0, 2);
+      storedLeading = width + 1;
+      continue;
+    }
+
+    int code = chimpLeadingCode[BUILDIN_CLZL(xor) - (64 - width)];
+    int leading = chimpLeadingValue[code];
+    int trailing = BUILDIN_CTZL(xor);
+
+    if (trailing > FLOAT_CHIMP_THRESHOLD) {
+      int sig = width - leading - trailing;
+      bitWriterPut(&w, 1 | ((uint64_t)code << 2) | ((uint64_t)sig << 5), 5 + sigBits);
+      bitWriterPut(&w, xor >> trailing, sig);
+      storedLeading = width + 1;
+    } else if (leading == storedLeading) {
+      bitWriterPut(&w, 2, 2);
+      bitWriterPut(&w, xor, width - leading);
+    } else {
+      bitWriterPut(&w, 3 | ((uint64_t)code << 2), 5);
+      bitWriterPut(&w, xor, width - leading);
+      storedLeading = leading;
+    }
+  }
+
+  bitWriterFlush(&w);
+  if (w.overflow) return -1;
+
+  output[0] = FLOAT_CHIMP_INDICATOR;
+  return w.pos;
+}
+
+static int floatDecompressChimp(const char *const input, const int nelements, char *const output, int bytes) {
+  int        width = bytes * BITS_PER_BYTE;
+  int        sigBits = (bytes == DOUBLE_BYTES) ? 6 : 5;
+  SBitReader r = {.buf = input + 1};
+
+  uint64_t prev = bitReaderGet(&r, width);
+  int      storedLeading = width + 1;
+  floatSetBits(output, 0, prev, bytes);
+
+  for (int i = 1; i < nelements; i++) {
+    switch (bitReaderGet(&r, 2)) {
+      case 0:
+        storedLeading = width + 1;
+        break;
+      case 1: {
+        uint64_t head = bitReaderGet(&r, 3 + sigBits);
+        int      sig = (int)(head >> 3);
+        int      trailing = width - chimpLeadingValue[head & 0x7] - sig;
+        if (sig == 0 || trailing <= 0) return -1;
+        prev ^= bitReaderGet(&r, sig) << trailing;
+        storedLeading = width + 1;
+        break;
+      }
+      case 2:
+        if (storedLeading > width) return -1;
+        prev ^= bitReaderGet(&r, width - storedLeading);
+        break;
+      default:
+        storedLeading = chimpLeadingValue[bitReaderGet(&r, 3)];
+        prev ^= bitReaderGet(&r, width - storedLeading);
+        break;
+    }
+
+    floatSetBits(output, i, prev, bytes);
+  }
+
+  return nelements * bytes;
+}
+
+// Whether the i-th value is restored bit by bit from an integer of the decimal scale, the integer is set if so
+static FORCE_INLINE bool floatToDecimal(const char *const input, int i, int bytes, int scale, int64_t *pInt) {
+  double v = (bytes == DOUBLE_BYTES) ? ((const double *)input)[i] : ((const float *)input)[i];
+  double x = v * floatPow10[scale];
+
+  // NaN, infinity and values too large for the integer codec are out
+  if (!(x > -FLOAT_DECIMAL_MAX_INT(bytes) && x < FLOAT_DECIMAL_MAX_INT(bytes))) return false;
+
+  *pInt = llround(x);
+  uint64_t restored = 0;
+  if (bytes == DOUBLE_BYTES) {
+    double d = (double)(*pInt) / floatPow10[scale];
+    memcpy(&restored, &d, DOUBLE_BYTES);
+  } else {
+    float f = (float)((double)(*pInt) / floatPow10[scale]);
+    memcpy(&restored, &f, FLOAT_BYTES);
+  }
+
+  return restored == floatGetBits(input, i, bytes);
+}
+
+// The least decimal scale the values are restored from, -1 if there is none
+static int floatDecimalScale(const char *const input, const int nelements, int bytes) {
+  int     scale = 0;
+  int64_t v = 0;
+
+  for (int i = 0; i < nelements; i++) {
+    while (!floatToDecimal(input, i, bytes, scale, &v)) {
+      if (++scale > FLOAT_DECIMAL_MAX_SCALE) return -1;
+    }
+  }
+
+  return scale;
+}
+
+/*
+ * Decimal: values of a few decimal digits, like most sensor readings, are multiplied by 10^scale and the integers are
+ * compressed by the integer codec, after a byte of the scale. Returns -1 if a value is not restored exactly or if the
+ * output is larger than outputSize.
+ */
+static int floatCompressDecimal(const char *const input, const int nelements, char *const output, int outputSize,
+                                int bytes, int scale) {
+  int   size = nelements * bytes;
+  char *ints = malloc(size * 2 + 1);
+  if (ints == NULL) return -1;
+
+  int len = -1;
+  for (int i = 0; i < nelements; i++) {
+    int64_t v = 0;
+    if (!floatToDecimal(input, i, bytes, scale, &v)) goto _exit;
+
+    if (bytes == DOUBLE_BYTES) {
+      ((int64_t *)ints)[i] = v;
+    } else {
+      ((int32_t *)ints)[i] = (int32_t)v;
+    }
+  }
+
+  len = tsCompressINTImp(ints, nelements, ints + size,
+                         (bytes == DOUBLE_BYTES) ? TSDB_DATA_TYPE_BIGINT : TSDB_DATA_TYPE_INT);
+  if (len < 0 || len + 2 > outputSize) {
+    len = -1;
+    goto _exit;
+  }
+
+  output[0] = FLOAT_DECIMAL_INDICATOR;
+  output[1] = (char)scale;
+  memcpy(output + 2, ints + size, len);
+  len += 2;
+
+_exit:
+  free(ints);
+  return len;
+}
+
+static int floatDecompressDecimal(const char *const input, const int nelements, char *const output, int bytes) {
+  int scale = (uint8_t)input[1];
+  if (scale > FLOAT_DECIMAL_MAX_SCALE) return -1;
+
+  double p = floatPow10[scale];
+  if (bytes == DOUBLE_BYTES) {
+    if (tsDecompressINTImp(input + 2, nelements, output, TSDB_DATA_TYPE_BIGINT) < 0) return -1;
+    for (int i = 0; i < nelements; i++) {
+      int64_t v;
+      memcpy(&v, output + (size_t)i * DOUBLE_BYTES, DOUBLE_BYTES);
+      double d = (double)v / p;
+      memcpy(output + (size_t)i * DOUBLE_BYTES, &d, DOUBLE_BYTES);
+    }
+  } else {
+    if (tsDecompressINTImp(input + 2, nelements, output, TSDB_DATA_TYPE_INT) < 0) return -1;
+    for (int i = 0; i < nelements; i++) {
+      int32_t v;
+      memcpy(&v, output + (size_t)i * FLOAT_BYTES, FLOAT_BYTES);
+      float f = (float)((double)v / p);
+      memcpy(output + (size_t)i * FLOAT_BYTES, &f, FLOAT_BYTES);
+    }
+  }
+
+  return nelements * bytes;
+}
+
+/*
+ * The codec of a block is the one of the XOR, Chimp and decimal codecs giving the smallest output for the first values
+ * of the block. The XOR codec is used if the chosen one fails on the whole block.
+ */
+static int floatCompressAdaptive(const char *const input, const int nelements, char *const output, int bytes) {
+  if (nelements <= 0) {
+    return (bytes == DOUBLE_BYTES) ? tsCompressDoubleImp(input, nelements, output)
+                                   : tsCompressFloatImp(input, nelements, output);
+  }
+
+  int  byteLimit = nelements * bytes + 1;
+  int  numOfSamples = MIN(nelements, FLOAT_SAMPLE_SIZE);
+  int  sampleLimit = numOfSamples * bytes + 1;
+  char sample[FLOAT_SAMPLE_SIZE * DOUBLE_BYTES + COMP_OVERFLOW_BYTES];
+
+  int xorLen = (bytes == DOUBLE_BYTES) ? tsCompressDoubleImp(input, numOfSamples, sample)
+                                       : tsCompressFloatImp(input, numOfSamples, sample);
+  int chimpLen = floatCompressChimp(input, numOfSamples, sample, sampleLimit, bytes);
+  int scale = floatDecimalScale(input, numOfSamples, bytes);
+  int decimalLen = (scale < 0) ? -1 : floatCompressDecimal(input, numOfSamples, sample, sampleLimit, bytes, scale);
+
+  int len = -1;
+  if (decimalLen > 0 && decimalLen <= xorLen && (chimpLen < 0 || decimalLen <= chimpLen)) {
+    len = floatCompressDecimal(input, nelements, output, byteLimit, bytes, scale);
+  }
+
+  if (len < 0 && chimpLen > 0 && chimpLen < xorLen) {
+    len = floatCompressChimp(input, nelements, output, byteLimit, bytes);
+  }
+
+  if (len < 0) {
+    len = (bytes == DOUBLE_BYTES) ? tsCompressDoubleImp(input, nelements, output)
+                                  : tsCompressFloatImp(input, nelements, output);
+  }
+
+  return len;
+}
+
+int tsCompressDoubleAdaptImp(const char *const input, const int nelements, char *const output) {
+  return floatCompressAdaptive(input, nelements, output, DOUBLE_BYTES);
+}
+
+int tsCompressFloatAdaptImp(const char *const input, const int nelements, char *const output) {
+  return floatCompressAdaptive(input, nelements, output, FLOAT_BYTES);
+}
+
 /* --------------------------------------------Double Compression
  * ---------------------------------------------- */
 void encodeDoubleValue(uint64_t diff, uint8_t flag, char *const output, int *const pos) {
@@ -750,6 +1420,12 @@ int tsDecompressDoubleImp(const char *const input, const int nelements, char *co
   // output stream
   double *ostream = (double *)output;
 
+  if (input[0] == FLOAT_CHIMP_INDICATOR) {
+    return floatDecompressChimp(input, nelements, output, DOUBLE_BYTES);
+  } else if (input[0] == FLOAT_DECIMAL_INDICATOR) {
+    return floatDecompressDecimal(input, nelements, output, DOUBLE_BYTES);
+  }
+
   if (input[0] == 1) {
     memcpy(output, input + 1, nelements * DOUBLE_BYTES);
     return nelements * DOUBLE_BYTES;
@@ -896,6 +1572,12 @@ uint32_t decodeFloatValue(const char *const input, int *const ipos, uint8_t flag
 int tsDecompressFloatImp(const char *const input, const int nelements, char *const output) {
   float *ostream = (float *)output;
 
+  if (input[0] == FLOAT_CHIMP_INDICATOR) {
+    return floatDecompressChimp(input, nelements, output, FLOAT_BYTES);
+  } else if (input[0] == FLOAT_DECIMAL_INDICATOR) {
+    return floatDecompressDecimal(input, nelements, output, FLOAT_BYTES);
+  }
+
   if (input[0] == 1) {
     memcpy(output, input + 1, nelements * FLOAT_BYTES);
     return nelements * FLOAT_BYTES;
@@ -24,15 +24,21 @@ typedef struct STaosQnode {
   char                item[];
 } STaosQnode;
 
+/*
+ * Writers push items onto a lock free stack, the reader moves all pushed items into its own list in FIFO order
+ * by one atomic exchange. So writers never block each other or the reader. There is only one reader of a queue at
+ * a time, queues in a queue set are read under the protection of the qset mutex.
+ */
 typedef struct STaosQueue {
   int32_t             itemSize;
   int32_t             numOfItems;
-  struct STaosQnode  *head;
+  struct STaosQnode  *stack;   // pushed by writers, the latest one on the top
+  struct STaosQnode  *head;    // owned by the reader
   struct STaosQnode  *tail;
+  int32_t             numOfFetched; // number of items in the reader's list
   struct STaosQueue  *next;    // for queue set
   struct STaosQset   *qset;    // for queue set
   void               *ahandle; // for queue set
-  pthread_mutex_t     mutex;  
 } STaosQueue;
 
 typedef struct STaosQset {
@@ -41,6 +47,9 @@ typedef struct STaosQset {
   pthread_mutex_t    mutex;
   int32_t            numOfQueues;
   int32_t            numOfItems;
+  int64_t            version;       // increased by every write, to detect writes while readers are going to wait
+  int32_t            numOfWaiters;  // readers waiting for sem and not yet waken up
+  int32_t            numOfResumes;  // pending requests to resume reader threads
   tsem_t             sem;
 } STaosQset;
 
@@ -59,33 +68,30 @@ taos_queue taosOpenQueue() {
     return NULL;
   }
 
-  pthread_mutex_init(&queue->mutex, NULL);
-
   uTrace("queue:%p is opened", queue);
   return queue;
 }
 
+static void taosFreeQnodes(STaosQnode *pNode) {
+  while (pNode) {
+    STaosQnode *pTemp = pNode;
+    pNode = pNode->next;
+    free(pTemp);
+  }
+}
+
 void taosCloseQueue(taos_queue param) {
   if (param == NULL) return;
   STaosQueue *queue = (STaosQueue *)param;
-  STaosQnode *pTemp;
-  STaosQset  *qset;
 
-  pthread_mutex_lock(&queue->mutex);
-  STaosQnode *pNode = queue->head;  
-  queue->head = NULL;
-  qset = queue->qset;
-  pthread_mutex_unlock(&queue->mutex);
+  STaosQset *qset = atomic_load_ptr(&queue->qset);
+  if (qset) taosRemoveFromQset(qset, queue);
 
-  if (queue->qset) taosRemoveFromQset(qset, queue); 
-
-  while (pNode) {
-    pTemp = pNode;
-    pNode = pNode->next;
-    free (pTemp);
-  }
+  taosFreeQnodes(queue->head);
+  taosFreeQnodes(atomic_exchange_ptr(&queue->stack, NULL));
+  queue->head = NULL;
+  queue->tail = NULL;
 
-  pthread_mutex_destroy(&queue->mutex);
   uTrace("queue:%p is closed", queue);
   free(queue);
 }
@@ -107,56 +113,146 @@ void taosFreeQitem(void *param) {
   free(temp);
 }
 
+static bool taosClaimQsetWaiter(STaosQset *qset) {
+  int32_t waiters = atomic_load_32(&qset->numOfWaiters);
+  while (waiters > 0) {
+    int32_t old = atomic_val_compare_exchange_32(&qset->numOfWaiters, waiters, waiters - 1);
+    if (old == waiters) return true;
+    waiters = old;
+  }
+
+  return false;
+}
+
+static bool taosTakeQsetResume(STaosQset *qset) {
+  int32_t resumes = atomic_load_32(&qset->numOfResumes);
+  while (resumes > 0) {
+    int32_t old = atomic_val_compare_exchange_32(&qset->numOfResumes, resumes, resumes - 1);
+    if (old == resumes) return true;
+    resumes = old;
+  }
+
+  return false;
+}
+
+// the semaphore is posted only if a reader is waiting, each post is paired with a claimed waiter
+static void taosNotifyQset(STaosQset *qset) {
+  atomic_add_fetch_64(&qset->version, 1);
+  if (taosClaimQsetWaiter(qset)) tsem_post(&qset->sem);
+}
+
+static void taosWaitQset(STaosQset *qset, int64_t version) {
+  atomic_add_fetch_32(&qset->numOfWaiters, 1);
+
+  if (atomic_load_64(&qset->version) != version || atomic_load_32(&qset->numOfResumes) > 0) {
+    // there are new writes, cancel the wait unless a writer has claimed it and posted the semaphore already
+    if (taosClaimQsetWaiter(qset)) return;
+  }
+
+  tsem_wait(&qset->sem);
+}
+
 int taosWriteQitem(taos_queue param, int type, void *item) {
   STaosQueue *queue = (STaosQueue *)param;
   STaosQnode *pNode = (STaosQnode *)(((char *)item) - sizeof(STaosQnode));
+  STaosQnode *top;
   pNode->type = type;
-  pNode->next = NULL;
 
-  pthread_mutex_lock(&queue->mutex);
+  do {
+    top = atomic_load_ptr(&queue->stack);
+    pNode->next = top;
+  } while (atomic_val_compare_exchange_ptr(&queue->stack, top, pNode) != top);
+
+  int32_t items = atomic_add_fetch_32(&queue->numOfItems, 1);
+  uTrace("item:%p is put into queue:%p, type:%d items:%d", item, queue, type, items);
+
+  STaosQset *qset = atomic_load_ptr(&queue->qset);
+  if (qset) {
+    atomic_add_fetch_32(&qset->numOfItems, 1);
+    taosNotifyQset(qset);
+  }
+
+  return 0;
+}
+
+// move the items pushed by writers to the reader's list, the order of the stack is reversed to keep FIFO
+static void taosFetchQnodes(STaosQueue *queue) {
+  STaosQnode *pNode = atomic_exchange_ptr(&queue->stack, NULL);
+  if (pNode == NULL) return;
+
+  STaosQnode *first = NULL;
+  STaosQnode *last = pNode;
+  int32_t     num = 0;
+  while (pNode) {
+    STaosQnode *pNext = pNode->next;
+    pNode->next = first;
+    first = pNode;
+    pNode = pNext;
+    num++;
+  }
 
   if (queue->tail) {
-    queue->tail->next = pNode;
-    queue->tail = pNode;
+    queue->tail->next = first;
   } else {
-    queue->head = pNode;
-    queue->tail = pNode; 
+    queue->head = first;
   }
 
-  queue->numOfItems++;
-  if (queue->qset) atomic_add_fetch_32(&queue->qset->numOfItems, 1);
-  uTrace("item:%p is put into queue:%p, type:%d items:%d", item, queue, type, queue->numOfItems);
+  queue->tail = last;
+  queue->numOfFetched += num;
+}
+
+static bool taosQueueEmpty(STaosQueue *queue) {
+  return queue->head == NULL && atomic_load_ptr(&queue->stack) == NULL;
+}
 
-  pthread_mutex_unlock(&queue->mutex);
+static STaosQnode *taosPopQnode(STaosQueue *queue) {
+  if (queue->head == NULL) taosFetchQnodes(queue);
 
-  if (queue->qset) tsem_post(&queue->qset->sem);
+  STaosQnode *pNode = queue->head;
+  if (pNode == NULL) return NULL;
 
-  return 0;
+  queue->head = pNode->next;
+  if (queue->head == NULL) queue->tail = NULL;
+  queue->numOfFetched--;
+
+  atomic_sub_fetch_32(&queue->numOfItems, 1);
+  STaosQset *qset = atomic_load_ptr(&queue->qset);
+  if (qset) atomic_sub_fetch_32(&qset->numOfItems, 1);
+
+  return pNode;
+}
+
+static int32_t taosPopAllQnodes(STaosQueue *queue, STaosQall *qall) {
+  taosFetchQnodes(queue);
+  if (queue->head == NULL) return 0;
+
+  qall->current = queue->head;
+  qall->start = queue->head;
+  qall->numOfItems = queue->numOfFetched;
+  qall->itemSize = queue->itemSize;
+
+  queue->head = NULL;
+  queue->tail = NULL;
+  queue->numOfFetched = 0;
+
+  atomic_sub_fetch_32(&queue->numOfItems, qall->numOfItems);
+  STaosQset *qset = atomic_load_ptr(&queue->qset);
+  if (qset) atomic_sub_fetch_32(&qset->numOfItems, qall->numOfItems);
+
+  return qall->numOfItems;
 }
 
 int taosReadQitem(taos_queue param, int *type, void **pitem) {
   STaosQueue *queue = (STaosQueue *)param;
-  STaosQnode *pNode = NULL;
-  int         code = 0;
 
-  pthread_mutex_lock(&queue->mutex);
-
-  if (queue->head) {
-      pNode = queue->head;
-      *pitem = pNode->item;
-      *type = pNode->type;
-      queue->head = pNode->next;
-      if (queue->head == NULL) 
-        queue->tail = NULL;
-      queue->numOfItems--;
-      if (queue->qset) atomic_sub_fetch_32(&queue->qset->numOfItems, 1);
-      code = 1;
-      uDebug("item:%p is read out from queue:%p, type:%d items:%d", *pitem, queue, *type, queue->numOfItems);
-  } 
+  STaosQnode *pNode = taosPopQnode(queue);
+  if (pNode == NULL) return 0;
 
-  pthread_mutex_unlock(&queue->mutex);
+  *pitem = pNode->item;
+  *type = pNode->type;
+  uDebug("item:%p is read out from queue:%p, type:%d items:%d", *pitem, queue, *type, queue->numOfItems);
 
-  return code;
+  return 1;
 }
 
 void *taosAllocateQall() {
@@ -171,35 +267,11 @@ void taosFreeQall(void *param) {
 int taosReadAllQitems(taos_queue param, taos_qall p2) {
   STaosQueue *queue = (STaosQueue *)param;
   STaosQall  *qall = (STaosQall *)p2;
-  int         code = 0;
-  bool        empty;
-
-  pthread_mutex_lock(&queue->mutex);
-
-  empty = queue->head == NULL;
-  if (!empty) {
-    memset(qall, 0, sizeof(STaosQall));
-    qall->current = queue->head;
-    qall->start = queue->head;
-    qall->numOfItems = queue->numOfItems;
-    qall->itemSize = queue->itemSize;
-    code = qall->numOfItems;
-
-    queue->head = NULL;
-    queue->tail = NULL;
-    queue->numOfItems = 0;
-    if (queue->qset) atomic_sub_fetch_32(&queue->qset->numOfItems, qall->numOfItems);
-  }
 
-  pthread_mutex_unlock(&queue->mutex);
+  memset(qall, 0, sizeof(STaosQall));
 
-  // if source queue is empty, we set destination qall to empty too.
-  if (empty) {
-    qall->current = NULL;
-    qall->start = NULL;
-    qall->numOfItems = 0;
-  }
-  return code;
+  // if source queue is empty, destination qall is left empty too.
+  return taosPopAllQnodes(queue, qall);
 }
 
 int taosGetQitem(taos_qall param, int *type, void **pitem) {
@@ -251,7 +323,7 @@ void taosCloseQset(taos_qset param) {
     STaosQueue *queue = qset->head;
     qset->head = qset->head->next;
 
-    queue->qset = NULL;
+    atomic_store_ptr(&queue->qset, NULL);
     queue->next = NULL;
   }
   pthread_mutex_unlock(&qset->mutex);
@@ -262,13 +334,14 @@ void taosCloseQset(taos_qset param) {
   free(qset);
 }
 
-// tsem_post 'qset->sem', so that reader threads waiting for it
+// make one reader thread of the qset return without item, so that it
 // resumes execution and return, should only be used to signal the
 // thread to exit.
 void taosQsetThreadResume(taos_qset param) {
   STaosQset *qset = (STaosQset *)param;
   uDebug("qset:%p, it will exit", qset);
-  tsem_post(&qset->sem);
+  atomic_add_fetch_32(&qset->numOfResumes, 1);
+  if (taosClaimQsetWaiter(qset)) tsem_post(&qset->sem);
 }
 
 int taosAddIntoQset(taos_qset p1, taos_queue p2, void *ahandle) {
@@ -284,13 +357,14 @@ int taosAddIntoQset(taos_qset p1, taos_queue p2, void *ahandle) {
   qset->head = queue;
   qset->numOfQueues++;
 
-  pthread_mutex_lock(&queue->mutex);
-  atomic_add_fetch_32(&qset->numOfItems, queue->numOfItems);
-  queue->qset = qset;
-  pthread_mutex_unlock(&queue->mutex);
+  atomic_add_fetch_32(&qset->numOfItems, atomic_load_32(&queue->numOfItems));
+  atomic_store_ptr(&queue->qset, qset);
 
   pthread_mutex_unlock(&qset->mutex);
 
+  // items written before the queue is added shall be read too
+  if (!taosQueueEmpty(queue)) taosNotifyQset(qset);
+
   uTrace("queue:%p is added into qset:%p", queue, qset);
   return 0;
 }
@@ -326,11 +400,9 @@ void taosRemoveFromQset(taos_qset p1, taos_queue p2) {
       if (qset->current == queue) qset->current = tqueue->next;
       qset->numOfQueues--;
 
-      pthread_mutex_lock(&queue->mutex);
-      atomic_sub_fetch_32(&qset->numOfItems, queue->numOfItems);
-      queue->qset = NULL;
+      atomic_sub_fetch_32(&qset->numOfItems, atomic_load_32(&queue->numOfItems));
+      atomic_store_ptr(&queue->qset, NULL);
       queue->next = NULL;
-      pthread_mutex_unlock(&queue->mutex);
     }
   } 
   
@@ -346,43 +418,36 @@ int taosGetQueueNumber(taos_qset param) {
 int taosReadQitemFromQset(taos_qset param, int *type, void **pitem, void **phandle) {
   STaosQset  *qset = (STaosQset *)param;
   STaosQnode *pNode = NULL;
-  int         code = 0;
-   
-  tsem_wait(&qset->sem);
 
-  pthread_mutex_lock(&qset->mutex);
+  while (1) {
+    int64_t version = atomic_load_64(&qset->version);
 
-  for(int i=0; i<qset->numOfQueues; ++i) {
-    if (qset->current == NULL) 
-      qset->current = qset->head;   
-    STaosQueue *queue = qset->current;
-    if (queue) qset->current = queue->next;
-    if (queue == NULL) break;
-    if (queue->head == NULL) continue;
+    pthread_mutex_lock(&qset->mutex);
 
-    pthread_mutex_lock(&queue->mutex);
+    for (int i = 0; i < qset->numOfQueues; ++i) {
+      if (qset->current == NULL) qset->current = qset->head;
+      STaosQueue *queue = qset->current;
+      if (queue) qset->current = queue->next;
+      if (queue == NULL) break;
+      if (taosQueueEmpty(queue)) continue;
 
-    if (queue->head) {
-        pNode = queue->head;
+      pNode = taosPopQnode(queue);
+      if (pNode) {
         *pitem = pNode->item;
         if (type) *type = pNode->type;
         if (phandle) *phandle = queue->ahandle;
-        queue->head = pNode->next;
-        if (queue->head == NULL) 
-          queue->tail = NULL;
-        queue->numOfItems--;
-        atomic_sub_fetch_32(&qset->numOfItems, 1);
-        code = 1;
         uTrace("item:%p is read out from queue:%p, type:%d items:%d", *pitem, queue, pNode->type, queue->numOfItems);
-    } 
+        break;
+      }
+    }
 
-    pthread_mutex_unlock(&queue->mutex);
-    if (pNode) break;
-  }
+    pthread_mutex_unlock(&qset->mutex);
 
-  pthread_mutex_unlock(&qset->mutex);
+    if (pNode) return 1;
+    if (taosTakeQsetResume(qset)) return 0;
 
-  return code; 
+    taosWaitQset(qset, version);
+  }
 }
 
 int taosReadAllQitemsFromQset(taos_qset param, taos_qall p2, void **phandle) {
@@ -391,61 +456,44 @@ int taosReadAllQitemsFromQset(taos_qset param, taos_qall p2, void **phandle) {
   STaosQall  *qall = (STaosQall *)p2;
   int         code = 0;
 
-  tsem_wait(&qset->sem);
-  pthread_mutex_lock(&qset->mutex);
+  while (1) {
+    int64_t version = atomic_load_64(&qset->version);
 
-  for(int i=0; i<qset->numOfQueues; ++i) {
-    if (qset->current == NULL) 
-      qset->current = qset->head;   
-    queue = qset->current;
-    if (queue) qset->current = queue->next;
-    if (queue == NULL) break;
-    if (queue->head == NULL) continue;
-
-    pthread_mutex_lock(&queue->mutex);
-
-    if (queue->head) {
-      qall->current = queue->head;
-      qall->start = queue->head;
-      qall->numOfItems = queue->numOfItems;
-      qall->itemSize = queue->itemSize;
-      code = qall->numOfItems;
-      *phandle = queue->ahandle;
-          
-      queue->head = NULL;
-      queue->tail = NULL;
-      queue->numOfItems = 0;
-      atomic_sub_fetch_32(&qset->numOfItems, qall->numOfItems);
-      for (int j=1; j<qall->numOfItems; ++j) tsem_wait(&qset->sem);
-    } 
-
-    pthread_mutex_unlock(&queue->mutex);
-
-    if (code != 0) break;  
-  }
+    pthread_mutex_lock(&qset->mutex);
 
-  pthread_mutex_unlock(&qset->mutex);
-  return code;
+    for (int i = 0; i < qset->numOfQueues; ++i) {
+      if (qset->current == NULL) qset->current = qset->head;
+      queue = qset->current;
+      if (queue) qset->current = queue->next;
+      if (queue == NULL) break;
+      if (taosQueueEmpty(queue)) continue;
+
+      code = taosPopAllQnodes(queue, qall);
+      if (code != 0) {
+        *phandle = queue->ahandle;
+        break;
+      }
+    }
+
+    pthread_mutex_unlock(&qset->mutex);
+
+    if (code != 0) return code;
+    if (taosTakeQsetResume(qset)) return 0;
+
+    taosWaitQset(qset, version);
+  }
 }
 
 int taosGetQueueItemsNumber(taos_queue param) {
   STaosQueue *queue = (STaosQueue *)param;
   if (!queue) return 0;
 
-  int num;
-  pthread_mutex_lock(&queue->mutex);
-  num = queue->numOfItems;
-  pthread_mutex_unlock(&queue->mutex);
-  return num;
+  return atomic_load_32(&queue->numOfItems);
 }
 
 int taosGetQsetItemsNumber(taos_qset param) {
   STaosQset *qset = (STaosQset *)param;
   if (!qset) return 0;
 
-  int num = 0;
-  pthread_mutex_lock(&qset->mutex);
-  num = qset->numOfItems;
-  pthread_mutex_unlock(&qset->mutex);
-  return num;
+  return atomic_load_32(&qset->numOfItems);
 }
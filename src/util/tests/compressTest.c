@@ -0,0 +1,364 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include "os.h"
+#include "taosdef.h"
+#include "tscompression.h"
+#include "ttype.h"
+
+/*
+ * Micro benchmark of the integer (simple8b) and timestamp (delta of delta) decompression. The output is checked
+ * to be the same as the one of the scalar decoders, which the decoders used to be, and the throughput of both
+ * is reported in MB/s of decompressed data. Binary columns of low cardinality are compared between the LZ4 and
+ * the dictionary encoding. Float and double series like the ones of sensors are compared between the XOR codec and
+ * the codec chosen per block.
+ *
+ * usage: compressTest [-n rows per block] [-l loops] [-j timestamp jitter ratio] [-c distinct binary values]
+ */
+
+#define ZIGZAG_DECODE(T, v) ((v) >> 1) ^ -((T)((v)&1))
+
+static int32_t numOfRows = 4096;
+static int32_t numOfLoops = 2000;
+static double  jitterRatio = 0.01;
+static int32_t numOfDistinct = 16;
+
+static void refDecompressINT(const char *const input, const int nelements, char *const output, const char type) {
+  char bit_per_integer[] = {0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 15, 20, 30, 60};
+  int  selector_to_elems[] = {240, 120, 60, 30, 20, 15, 12, 10, 8, 7, 6, 5, 4, 3, 2, 1};
+
+  if (input[0] == 1) {
+    memcpy(output, input + 1, nelements * tDataTypes[(int)type].bytes);
+    return;
+  }
+
+  const char *ip = input + 1;
+  int         count = 0;
+  int         _pos = 0;
+  int64_t     prev_value = 0;
+
+  while (count < nelements) {
+    uint64_t w = 0;
+    memcpy(&w, ip, LONG_BYTES);
+
+    char selector = (char)(w & INT64MASK(4));
+    char bit = bit_per_integer[(int)selector];
+    int  elems = selector_to_elems[(int)selector];
+
+    for (int i = 0; i < elems; i++) {
+      uint64_t zigzag_value = 0;
+      if (selector > 1) {
+        zigzag_value = ((w >> (4 + bit * i)) & INT64MASK(bit));
+      }
+
+      int64_t diff = ZIGZAG_DECODE(int64_t, zigzag_value);
+      prev_value = diff + prev_value;
+
+      switch (type) {
+        case TSDB_DATA_TYPE_BIGINT:   *((int64_t *)output + _pos++) = (int64_t)prev_value; break;
+        case TSDB_DATA_TYPE_INT:      *((int32_t *)output + _pos++) = (int32_t)prev_value; break;
+        case TSDB_DATA_TYPE_SMALLINT: *((int16_t *)output + _pos++) = (int16_t)prev_value; break;
+        default:                      *((int8_t *)output + _pos++) = (int8_t)prev_value; break;
+      }
+
+      if (++count == nelements) break;
+    }
+    ip += LONG_BYTES;
+  }
+}
+
+static void refDecompressTimestamp(const char *const input, const int nelements, char *const output) {
+  if (input[0] == 0) {
+    memcpy(output, input + 1, nelements * LONG_BYTES);
+    return;
+  }
+
+  int64_t *ostream = (int64_t *)output;
+  int      ipos = 1, opos = 0;
+  int64_t  prev_value = 0;
+  int64_t  prev_delta = 0;
+
+  while (1) {
+    uint8_t flags = input[ipos++];
+    for (int k = 0; k < 2; ++k) {
+      int8_t   nbytes = (k == 0) ? (flags & INT8MASK(4)) : ((flags >> 4) & INT8MASK(4));
+      uint64_t dd = 0;
+      memcpy(&dd, input + ipos, nbytes);
+      ipos += nbytes;
+
+      int64_t delta_of_delta = ZIGZAG_DECODE(int64_t, dd);
+      if (opos == 0) {
+        prev_value = delta_of_delta;
+        prev_delta = 0;
+      } else {
+        prev_delta = delta_of_delta + prev_delta;
+        prev_value = prev_value + prev_delta;
+      }
+
+      ostream[opos++] = prev_value;
+      if (opos == nelements) return;
+    }
+  }
+}
+
+static int64_t getTimestampUs() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+// random walk in the range of the type, small steps with a large one from time to time
+static void generateInt(char *data, int32_t bytes) {
+  int64_t v = 0;
+  int64_t range = (bytes == 8) ? (1LL << 40) : ((1LL << (bytes * 8 - 1)) - 1);
+
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    int64_t step = (rand() % 100 == 0) ? (rand() % 10000) : (rand() % 64 - 32);
+    v += step;
+    if (v > range || v < -range) v = 0;
+
+    switch (bytes) {
+      case 1: ((int8_t *)data)[i] = (int8_t)v; break;
+      case 2: ((int16_t *)data)[i] = (int16_t)v; break;
+      case 4: ((int32_t *)data)[i] = (int32_t)v; break;
+      default: ((int64_t *)data)[i] = v; break;
+    }
+  }
+}
+
+// timestamps of a fixed interval, a few of them are off by some milliseconds
+static void generateTimestamp(char *data) {
+  int64_t ts = 1600000000000LL;
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    ((int64_t *)data)[i] = ts + (int64_t)i * 1000 + (((double)rand() / RAND_MAX < jitterRatio) ? rand() % 100 : 0);
+  }
+}
+
+static void runTest(const char *name, int8_t type, int32_t bytes) {
+  char *input = malloc(numOfRows * bytes);
+  char *compressed = malloc(numOfRows * bytes + 16);
+  char *output = malloc(numOfRows * bytes);
+  char *refOutput = malloc(numOfRows * bytes);
+
+  int32_t len = 0;
+  if (type == TSDB_DATA_TYPE_TIMESTAMP) {
+    generateTimestamp(input);
+    len = tsCompressTimestampImp(input, numOfRows, compressed);
+  } else {
+    generateInt(input, bytes);
+    len = tsCompressINTImp(input, numOfRows, compressed, type);
+  }
+
+  double elapsed[2] = {0};
+  for (int32_t r = 0; r < 2; ++r) {
+    char   *out = (r == 0) ? refOutput : output;
+    int64_t st = getTimestampUs();
+
+    for (int32_t i = 0; i < numOfLoops; ++i) {
+      if (type == TSDB_DATA_TYPE_TIMESTAMP) {
+        if (r == 0) {
+          refDecompressTimestamp(compressed, numOfRows, out);
+        } else {
+          tsDecompressTimestampImp(compressed, numOfRows, out);
+        }
+      } else {
+        if (r == 0) {
+          refDecompressINT(compressed, numOfRows, out, type);
+        } else {
+          tsDecompressINTImp(compressed, numOfRows, out, type);
+        }
+      }
+    }
+
+    elapsed[r] = (getTimestampUs() - st) / 1000000.0;
+  }
+
+  if (memcmp(output, refOutput, numOfRows * bytes) != 0 || memcmp(output, input, numOfRows * bytes) != 0) {
+    printf("%s: decompressed data mismatch\n", name);
+    exit(1);
+  }
+
+  double size = (double)numOfRows * bytes * numOfLoops / (1024 * 1024);
+  printf("%-10s ratio:%5.2f  scalar:%8.1f MB/s  current:%8.1f MB/s  speedup:%.2fx\n", name,
+         (double)numOfRows * bytes / len, size / elapsed[0], size / elapsed[1], elapsed[0] / elapsed[1]);
+
+  free(input);
+  free(compressed);
+  free(output);
+  free(refOutput);
+}
+
+// var data of device status like values, a null value from time to time
+static int32_t generateBinary(char *data) {
+  int32_t len = 0;
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    char *p = data + len;
+    if (rand() % 50 == 0) {
+      varDataSetLen(p, 1);
+      *(uint8_t *)varDataVal(p) = TSDB_DATA_BINARY_NULL;
+    } else {
+      varDataSetLen(p, sprintf(varDataVal(p), "status_of_device_%d", rand() % numOfDistinct));
+    }
+    len += varDataTLen(p);
+  }
+
+  return len;
+}
+
+static void runBinaryTest() {
+  int32_t bytes = VARSTR_HEADER_SIZE + 32;
+  char   *input = malloc(numOfRows * bytes);
+  char   *compressed[2] = {malloc(numOfRows * bytes + 16), malloc(numOfRows * bytes + 16)};
+  char   *output = malloc(numOfRows * bytes);
+
+  int32_t size = generateBinary(input);
+  int32_t len[2] = {tsCompressStringImp(input, size, compressed[0], size + COMP_OVERFLOW_BYTES),
+                    tsCompressStringDictImp(input, size, numOfRows, compressed[1], size + COMP_OVERFLOW_BYTES,
+                                            TSDB_STR_DICT_MAX_ENTRIES)};
+  if (len[1] < 0) {
+    printf("binary: too many distinct values for the dictionary\n");
+    exit(1);
+  }
+
+  double elapsed[2] = {0};
+  for (int32_t r = 0; r < 2; ++r) {
+    int64_t st = getTimestampUs();
+    for (int32_t i = 0; i < numOfLoops; ++i) {
+      if (tsDecompressStringImp(compressed[r], len[r], output, numOfRows * bytes) != size) {
+        printf("binary: decompressed length mismatch\n");
+        exit(1);
+      }
+    }
+    elapsed[r] = (getTimestampUs() - st) / 1000000.0;
+
+    if (memcmp(output, input, size) != 0) {
+      printf("binary: decompressed data mismatch\n");
+      exit(1);
+    }
+  }
+
+  double total = (double)size * numOfLoops / (1024 * 1024);
+  printf("%-10s ratio:%5.2f/%5.2f  lz4:%8.1f MB/s  dict:%8.1f MB/s  speedup:%.2fx\n", "binary", (double)size / len[0],
+         (double)size / len[1], total / elapsed[0], total / elapsed[1], elapsed[0] / elapsed[1]);
+
+  free(input);
+  free(compressed[0]);
+  free(compressed[1]);
+  free(output);
+}
+
+// series of sensors: readings of a fixed precision, a smooth signal of full precision and a rarely changing value
+static void generateFloat(int32_t series, double *data) {
+  double v = 0;
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    switch (series) {
+      case 0:  // temperature of one decimal digit
+        v = (i == 0) ? 25.0 : v + (rand() % 3 - 1) * 0.1;
+        data[i] = round(v * 10) / 10;
+        break;
+      case 1:  // voltage of two decimal digits
+        data[i] = round((220 + (rand() % 200 - 100) / 50.0) * 100) / 100;
+        break;
+      case 2:  // vibration
+        data[i] = sin(i / 50.0) * 3.7 + (double)rand() / RAND_MAX * 0.01;
+        break;
+      default:  // switch position
+        v = (rand() % 500 == 0) ? rand() % 4 : v;
+        data[i] = (i == 0) ? 1 : v;
+        break;
+    }
+  }
+}
+
+static void runFloatTest(const char *name, int32_t series, int32_t bytes) {
+  double *values = malloc(numOfRows * sizeof(double));
+  char   *input = malloc(numOfRows * bytes);
+  char   *compressed[2] = {malloc(numOfRows * bytes + 16), malloc(numOfRows * bytes + 16)};
+  char   *output = malloc(numOfRows * bytes);
+
+  generateFloat(series, values);
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    if (bytes == DOUBLE_BYTES) {
+      ((double *)input)[i] = values[i];
+    } else {
+      ((float *)input)[i] = (float)values[i];
+    }
+  }
+
+  int32_t len[2];
+  if (bytes == DOUBLE_BYTES) {
+    len[0] = tsCompressDoubleImp(input, numOfRows, compressed[0]);
+    len[1] = tsCompressDoubleAdaptImp(input, numOfRows, compressed[1]);
+  } else {
+    len[0] = tsCompressFloatImp(input, numOfRows, compressed[0]);
+    len[1] = tsCompressFloatAdaptImp(input, numOfRows, compressed[1]);
+  }
+
+  double elapsed[2] = {0};
+  for (int32_t r = 0; r < 2; ++r) {
+    int64_t st = getTimestampUs();
+    for (int32_t i = 0; i < numOfLoops; ++i) {
+      if (bytes == DOUBLE_BYTES) {
+        tsDecompressDoubleImp(compressed[r], numOfRows, output);
+      } else {
+        tsDecompressFloatImp(compressed[r], numOfRows, output);
+      }
+    }
+    elapsed[r] = (getTimestampUs() - st) / 1000000.0;
+
+    if (memcmp(output, input, numOfRows * bytes) != 0) {
+      printf("%s: decompressed data mismatch\n", name);
+      exit(1);
+    }
+  }
+
+  double size = (double)numOfRows * bytes * numOfLoops / (1024 * 1024);
+  printf("%-10s ratio:%5.2f/%5.2f  xor:%8.1f MB/s  adapt(%d):%8.1f MB/s\n", name, (double)numOfRows * bytes / len[0],
+         (double)numOfRows * bytes / len[1], size / elapsed[0], (uint8_t)compressed[1][0], size / elapsed[1]);
+
+  free(values);
+  free(input);
+  free(compressed[0]);
+  free(compressed[1]);
+  free(output);
+}
+
+int main(int argc, char *argv[]) {
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-n") == 0 && i < argc - 1) {
+      numOfRows = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-l") == 0 && i < argc - 1) {
+      numOfLoops = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-j") == 0 && i < argc - 1) {
+      jitterRatio = atof(argv[++i]);
+    } else if (strcmp(argv[i], "-c") == 0 && i < argc - 1) {
+      numOfDistinct = atoi(argv[++i]);
+    } else {
+      printf("\nusage: %s [options] \n", argv[0]);
+      printf("  [-n rows]: number of rows in a block, default is:%d\n", numOfRows);
+      printf("  [-l loops]: number of times each block is decompressed, default is:%d\n", numOfLoops);
+      printf("  [-j ratio]: ratio of timestamps off the fixed interval, default is:%.2f\n", jitterRatio);
+      printf("  [-c distinct]: number of distinct binary values, default is:%d\n", numOfDistinct);
+      exit(0);
+    }
+  }
+
+  srand(0);
+  runTest("tinyint", TSDB_DATA_TYPE_TINYINT, CHAR_BYTES);
+  runTest("smallint", TSDB_DATA_TYPE_SMALLINT, SHORT_BYTES);
+  runTest("int", TSDB_DATA_TYPE_INT, INT_BYTES);
+  runTest("bigint", TSDB_DATA_TYPE_BIGINT, LONG_BYTES);
+  runTest("timestamp", TSDB_DATA_TYPE_TIMESTAMP, LONG_BYTES);
+  runBinaryTest();
+
+  const char *series[] = {"temp", "voltage", "vibration", "switch"};
+  for (int32_t s = 0; s < 4; ++s) {
+    char name[32];
+    snprintf(name, sizeof(name), "f:%s", series[s]);
+    runFloatTest(name, s, FLOAT_BYTES);
+    snprintf(name, sizeof(name), "d:%s", series[s]);
+    runFloatTest(name, s, DOUBLE_BYTES);
+  }
+  return 0;
+}
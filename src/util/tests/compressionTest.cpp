@@ -0,0 +1,338 @@
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "tscompression.h"
+#include "ttype.h"
+
+namespace {
+
+// header of a dictionary encoded string: | indicator | nelements(int32) | numOfEntries(uint16) | bits(uint8) |
+const int DICT_HEAD_SIZE = 8;
+const int DICT_BITS_POS = 7;
+
+// var data of nelements rows, row i holds the value numbered i % cardinality, of length 1 to 40
+std::vector<char> buildVarData(int nelements, int cardinality) {
+  std::vector<char> data;
+  for (int i = 0; i < nelements; ++i) {
+    int         v = (i * 7) % cardinality;
+    std::string s = "v" + std::to_string(v) + std::string(v % 40, 'x');
+    VarDataLenT len = (VarDataLenT)s.size();
+    data.insert(data.end(), (char *)&len, (char *)&len + VARSTR_HEADER_SIZE);
+    data.insert(data.end(), s.begin(), s.end());
+  }
+  return data;
+}
+
+int compressDict(const std::vector<char> &input, int nelements, std::vector<char> &output, int maxEntries) {
+  output.assign(input.size() + COMP_OVERFLOW_BYTES, 0);
+  return tsCompressStringDictImp(input.data(), (int)input.size(), nelements, output.data(), (int)output.size(),
+                                 maxEntries);
+}
+
+void checkRoundTrip(int nelements, int cardinality, int expectedBits) {
+  std::vector<char> input = buildVarData(nelements, cardinality);
+  std::vector<char> output;
+
+  int clen = compressDict(input, nelements, output, TSDB_STR_DICT_MAX_ENTRIES);
+  ASSERT_GT(clen, 0) << "cardinality " << cardinality;
+  ASSERT_LT(clen, (int)input.size());
+  ASSERT_EQ(output[0], 2);
+  ASSERT_EQ((uint8_t)output[DICT_BITS_POS], expectedBits);
+
+  std::vector<char> decoded(input.size() + 64, 0);
+  int               dlen = tsDecompressStringImp(output.data(), clen, decoded.data(), (int)decoded.size());
+  ASSERT_EQ(dlen, (int)input.size()) << "cardinality " << cardinality;
+  ASSERT_EQ(memcmp(decoded.data(), input.data(), input.size()), 0) << "cardinality " << cardinality;
+
+  // an output buffer of the exact size takes the bounded copy path at its end
+  std::vector<char> exact(input.size(), 0);
+  dlen = tsDecompressStringImp(output.data(), clen, exact.data(), (int)exact.size());
+  ASSERT_EQ(dlen, (int)input.size());
+  ASSERT_EQ(memcmp(exact.data(), input.data(), input.size()), 0);
+}
+
+}  // namespace
+
+TEST(testCase, string_dict_round_trip) {
+  checkRoundTrip(1000, 1, 0);
+  checkRoundTrip(1000, 2, 1);
+  checkRoundTrip(1000, 3, 2);
+  checkRoundTrip(1000, 16, 4);
+  checkRoundTrip(4096, 17, 8);
+  checkRoundTrip(4096, 256, 8);
+}
+
+TEST(testCase, string_dict_wide_codes) {
+  // more than 256 distinct values need 16 bit codes
+  checkRoundTrip(8192, 257, 16);
+  checkRoundTrip(16384, 1000, 16);
+}
+
+TEST(testCase, string_dict_fallback) {
+  std::vector<char> output;
+
+  // more distinct values than allowed
+  std::vector<char> input = buildVarData(4096, 100);
+  ASSERT_EQ(compressDict(input, 4096, output, 99), -1);
+  ASSERT_GT(compressDict(input, 4096, output, 100), 0);
+
+  // fewer than 16 rows per distinct value
+  input = buildVarData(1000, 100);
+  ASSERT_EQ(compressDict(input, 1000, output, TSDB_STR_DICT_MAX_ENTRIES), -1);
+
+  ASSERT_EQ(compressDict(input, 1000, output, 0), -1);
+}
+
+TEST(testCase, string_dict_corrupt_input) {
+  const int         nelements = 1000;
+  std::vector<char> input = buildVarData(nelements, 3);
+  std::vector<char> output;
+  int               clen = compressDict(input, nelements, output, TSDB_STR_DICT_MAX_ENTRIES);
+  ASSERT_GT(clen, 0);
+  ASSERT_EQ((uint8_t)output[DICT_BITS_POS], 2);
+
+  std::vector<char> decoded(input.size() + 64, 0);
+  std::vector<char> bad;
+
+  // truncated header and truncated codes
+  ASSERT_EQ(tsDecompressStringImp(output.data(), DICT_HEAD_SIZE - 1, decoded.data(), (int)decoded.size()), -1);
+  ASSERT_EQ(tsDecompressStringImp(output.data(), clen - 1, decoded.data(), (int)decoded.size()), -1);
+
+  // code width not matching the number of entries
+  bad = output;
+  bad[DICT_BITS_POS] = 4;
+  ASSERT_EQ(tsDecompressStringImp(bad.data(), clen, decoded.data(), (int)decoded.size()), -1);
+
+  // no entries, or more than the dictionary can hold
+  bad = output;
+  uint16_t entries = 0;
+  memcpy(bad.data() + 5, &entries, sizeof(entries));
+  ASSERT_EQ(tsDecompressStringImp(bad.data(), clen, decoded.data(), (int)decoded.size()), -1);
+  entries = TSDB_STR_DICT_MAX_ENTRIES + 1;
+  memcpy(bad.data() + 5, &entries, sizeof(entries));
+  bad[DICT_BITS_POS] = 16;
+  ASSERT_EQ(tsDecompressStringImp(bad.data(), clen, decoded.data(), (int)decoded.size()), -1);
+
+  // no rows
+  bad = output;
+  int32_t rows = 0;
+  memcpy(bad.data() + 1, &rows, sizeof(rows));
+  ASSERT_EQ(tsDecompressStringImp(bad.data(), clen, decoded.data(), (int)decoded.size()), -1);
+
+  // a code out of the 3 entries
+  bad = output;
+  bad[clen - 1] = (char)0xff;
+  ASSERT_EQ(tsDecompressStringImp(bad.data(), clen, decoded.data(), (int)decoded.size()), -1);
+
+  // output too small
+  ASSERT_EQ(tsDecompressStringImp(output.data(), clen, decoded.data(), (int)input.size() - 1), -1);
+
+  // unknown indicator
+  bad = output;
+  bad[0] = 3;
+  ASSERT_EQ(tsDecompressStringImp(bad.data(), clen, decoded.data(), (int)decoded.size()), -1);
+}
+
+namespace {
+
+// first byte of the float and double blocks
+const int FLOAT_XOR_INDICATOR = 0;
+const int FLOAT_RAW_INDICATOR = 1;
+const int FLOAT_CHIMP_INDICATOR = (ALGO_CHIMP << 1) | MODE_COMPRESS;
+const int FLOAT_DECIMAL_INDICATOR = (ALGO_DECIMAL << 1) | MODE_COMPRESS;
+
+template <typename T>
+int compressFloats(const std::vector<T> &input, std::vector<char> &output) {
+  output.assign(input.size() * sizeof(T) + COMP_OVERFLOW_BYTES * 2, 0);
+  if (sizeof(T) == sizeof(double)) {
+    return tsCompressDoubleAdaptImp((const char *)input.data(), (int)input.size(), output.data());
+  }
+  return tsCompressFloatAdaptImp((const char *)input.data(), (int)input.size(), output.data());
+}
+
+// the values are restored bit by bit, NaN payloads and the sign of zero included, and the codec is returned
+template <typename T>
+int checkFloatRoundTrip(const std::vector<T> &input) {
+  std::vector<char> output;
+  int               clen = compressFloats(input, output);
+  int               size = (int)(input.size() * sizeof(T));
+  EXPECT_GT(clen, 0);
+  EXPECT_LE(clen, size + 1);
+  if (clen <= 0) return -1;
+
+  std::vector<T> decoded(input.size() + 1);
+  int            dlen = (sizeof(T) == sizeof(double))
+                            ? tsDecompressDoubleImp(output.data(), (int)input.size(), (char *)decoded.data())
+                            : tsDecompressFloatImp(output.data(), (int)input.size(), (char *)decoded.data());
+  EXPECT_EQ(dlen, size);
+  EXPECT_EQ(memcmp(decoded.data(), input.data(), size), 0) << "codec " << (int)output[0] << ", " << input.size()
+                                                           << " values";
+  return output[0];
+}
+
+template <typename T>
+std::vector<T> decimalValues(int n) {
+  std::vector<T> v;
+  for (int i = 0; i < n; ++i) {
+    v.push_back((T)((200 + (i * 37) % 100) / 10.0));
+  }
+  return v;
+}
+
+// integers too large for the decimal codec with low bits clear, which Chimp writes in a few bits
+template <typename T>
+std::vector<T> chimpValues(int n) {
+  std::vector<T> v;
+  T              base = (sizeof(T) == sizeof(double)) ? (T)1e17 : (T)1e12;
+  for (int i = 0; i < n; ++i) {
+    v.push_back(base + (T)((i % 8) * 65536.0 * 65536.0));
+  }
+  return v;
+}
+
+template <typename T>
+std::vector<T> randomValues(int n) {
+  std::vector<T> v;
+  uint64_t       x = 88172645463325252ULL;
+  for (int i = 0; i < n; ++i) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    T t;
+    memcpy(&t, &x, sizeof(T));
+    if (t != t) t = (T)i;  // keep the random NaNs out
+    v.push_back(t);
+  }
+  return v;
+}
+
+template <typename T>
+std::vector<T> specialValues(int n) {
+  const T        nan = std::numeric_limits<T>::quiet_NaN();
+  const T        inf = std::numeric_limits<T>::infinity();
+  const T        special[] = {nan, (T)-0.0, inf, -inf, (T)0.0, (T)1.5, -nan, std::numeric_limits<T>::denorm_min()};
+  std::vector<T> v;
+  for (int i = 0; i < n; ++i) {
+    v.push_back(special[(i * 3) % 8]);
+  }
+  return v;
+}
+
+template <typename T>
+void checkFloatCodecs() {
+  const int sizes[] = {1, 2, 3, 17, 100, 255, 256, 257, 1000, 4096};
+
+  for (int n : sizes) {
+    SCOPED_TRACE(n);
+    if (n >= 8) {
+      EXPECT_EQ(checkFloatRoundTrip(decimalValues<T>(n)), FLOAT_DECIMAL_INDICATOR);
+      EXPECT_EQ(checkFloatRoundTrip(chimpValues<T>(n)), FLOAT_CHIMP_INDICATOR);
+    } else {
+      checkFloatRoundTrip(decimalValues<T>(n));
+      checkFloatRoundTrip(chimpValues<T>(n));
+    }
+
+    // NaN, -0.0 and infinity are not decimal values
+    int codec = checkFloatRoundTrip(specialValues<T>(n));
+    EXPECT_NE(codec, FLOAT_DECIMAL_INDICATOR);
+
+    codec = checkFloatRoundTrip(randomValues<T>(n));
+    EXPECT_TRUE(codec == FLOAT_XOR_INDICATOR || codec == FLOAT_RAW_INDICATOR) << codec;
+
+    // a constant block
+    checkFloatRoundTrip(std::vector<T>(n, (T)-0.0));
+    checkFloatRoundTrip(std::vector<T>(n, std::numeric_limits<T>::quiet_NaN()));
+  }
+}
+
+// the sample is decimal but the rest of the block is not, then Chimp is tried, and the XOR codec if Chimp overflows
+template <typename T>
+void checkFloatFallback() {
+  std::vector<T> input = decimalValues<T>(256);
+  std::vector<T> rest = randomValues<T>(744);
+  input.insert(input.end(), rest.begin(), rest.end());
+  EXPECT_EQ(checkFloatRoundTrip(input), FLOAT_CHIMP_INDICATOR);
+
+  input = decimalValues<T>(256);
+  rest = randomValues<T>(3840);
+  input.insert(input.end(), rest.begin(), rest.end());
+  int codec = checkFloatRoundTrip(input);
+  EXPECT_TRUE(codec == FLOAT_XOR_INDICATOR || codec == FLOAT_RAW_INDICATOR) << codec;
+
+  // a single NaN or -0.0 after the sample
+  for (T bad : {std::numeric_limits<T>::quiet_NaN(), (T)-0.0, std::numeric_limits<T>::infinity()}) {
+    input = decimalValues<T>(1000);
+    input[700] = bad;
+    codec = checkFloatRoundTrip(input);
+    EXPECT_NE(codec, FLOAT_DECIMAL_INDICATOR);
+  }
+}
+
+// the block algorithm is flagged when a column uses the Chimp or decimal codec, with a value older readers refuse
+template <typename T>
+bool compressAdapt(const std::vector<T> &input, char algorithm, std::vector<char> &output, int *clen) {
+  int               size = (int)(input.size() * sizeof(T));
+  std::vector<char> buffer(size + COMP_OVERFLOW_BYTES * 2);
+  bool              adapted = true;
+  output.assign(size + COMP_OVERFLOW_BYTES * 2, 0);
+  if (sizeof(T) == sizeof(double)) {
+    *clen = tsCompressDoubleAdapt((const char *)input.data(), size, (int)input.size(), output.data(), (int)output.size(),
+                                  algorithm, buffer.data(), (int)buffer.size(), &adapted);
+  } else {
+    *clen = tsCompressFloatAdapt((const char *)input.data(), size, (int)input.size(), output.data(), (int)output.size(),
+                                 algorithm, buffer.data(), (int)buffer.size(), &adapted);
+  }
+  return adapted;
+}
+
+template <typename T>
+void checkFloatAdaptFlag() {
+  for (char algorithm : {(char)ONE_STAGE_COMP, (char)TWO_STAGE_COMP}) {
+    SCOPED_TRACE((int)algorithm);
+    char flagged = (char)(algorithm | COMP_FLOAT_ADAPT);
+    EXPECT_NE(flagged, ONE_STAGE_COMP);
+    EXPECT_NE(flagged, TWO_STAGE_COMP);
+    EXPECT_EQ(COMP_STAGE(flagged), algorithm);
+
+    std::vector<char> output;
+    int               clen = 0;
+    for (const std::vector<T> &input : {decimalValues<T>(1000), chimpValues<T>(1000)}) {
+      EXPECT_TRUE(compressAdapt(input, algorithm, output, &clen));
+      ASSERT_GT(clen, 0);
+
+      // read back the way tsdb reads a flagged block
+      int               size = (int)(input.size() * sizeof(T));
+      std::vector<T>    decoded(input.size() + 1);
+      std::vector<char> buffer(size + COMP_OVERFLOW_BYTES * 2);
+      int dlen = (sizeof(T) == sizeof(double))
+                     ? tsDecompressDouble(output.data(), clen, (int)input.size(), (char *)decoded.data(), size + 8,
+                                          COMP_STAGE(flagged), buffer.data(), (int)buffer.size())
+                     : tsDecompressFloat(output.data(), clen, (int)input.size(), (char *)decoded.data(), size + 8,
+                                         COMP_STAGE(flagged), buffer.data(), (int)buffer.size());
+      EXPECT_EQ(dlen, size);
+      EXPECT_EQ(memcmp(decoded.data(), input.data(), size), 0);
+    }
+
+    // blocks left to the XOR codec stay readable by older versions
+    EXPECT_FALSE(compressAdapt(randomValues<T>(1000), algorithm, output, &clen));
+    EXPECT_GT(clen, 0);
+  }
+}
+
+}  // namespace
+
+TEST(testCase, double_adaptive_codecs) { checkFloatCodecs<double>(); }
+
+TEST(testCase, float_adaptive_codecs) { checkFloatCodecs<float>(); }
+
+TEST(testCase, double_adaptive_fallback) { checkFloatFallback<double>(); }
+
+TEST(testCase, float_adaptive_fallback) { checkFloatFallback<float>(); }
+
+TEST(testCase, double_adaptive_block_flag) { checkFloatAdaptFlag<double>(); }
+
+TEST(testCase, float_adaptive_block_flag) { checkFloatAdaptFlag<float>(); }
@@ -0,0 +1,329 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include "os.h"
+#include "tqueue.h"
+#include "tulog.h"
+
+/*
+ * Micro benchmark of the queue set, writers put items into their own queues and readers
+ * consume the queue set, as the vnode write and query workers do. The result is compared
+ * with a mutex and semaphore based implementation, which the queue used to be.
+ *
+ * usage: queueTest [-w writers] [-r readers] [-n items per writer] [-a (read all)]
+ */
+
+typedef struct {
+  int32_t writer;
+  int32_t seq;
+} SItem;
+
+typedef struct SRefNode {
+  int32_t          type;
+  struct SRefNode *next;
+  char             item[];
+} SRefNode;
+
+typedef struct SRefQueue {
+  SRefNode        *head;
+  SRefNode        *tail;
+  int32_t          numOfItems;
+  void            *ahandle;
+  struct SRefQueue*next;
+  pthread_mutex_t  mutex;
+} SRefQueue;
+
+typedef struct {
+  SRefQueue       *head;
+  SRefQueue       *current;
+  int32_t          numOfQueues;
+  pthread_mutex_t  mutex;
+  tsem_t           sem;
+} SRefQset;
+
+typedef struct {
+  int32_t    id;
+  int32_t    numOfItems;
+  bool       refImpl;
+  void      *queue;
+  void      *qset;
+  bool       readAll;
+  int32_t   *lastSeq;
+  int64_t    numOfRead;
+  pthread_t  thread;
+} SThreadInfo;
+
+static int32_t numOfWriters = 4;
+static int32_t numOfReaders = 1;
+static int32_t itemsPerWriter = 1000000;
+static bool    readAll = false;
+
+static void *refAllocItem(int size) {
+  SRefNode *pNode = calloc(sizeof(SRefNode) + size, 1);
+  return pNode->item;
+}
+
+static void refFreeItem(void *item) {
+  free((char *)item - sizeof(SRefNode));
+}
+
+static void refWriteItem(SRefQueue *queue, SRefQset *qset, void *item) {
+  SRefNode *pNode = (SRefNode *)((char *)item - sizeof(SRefNode));
+  pNode->next = NULL;
+
+  pthread_mutex_lock(&queue->mutex);
+  if (queue->tail) {
+    queue->tail->next = pNode;
+  } else {
+    queue->head = pNode;
+  }
+  queue->tail = pNode;
+  queue->numOfItems++;
+  pthread_mutex_unlock(&queue->mutex);
+
+  tsem_post(&qset->sem);
+}
+
+// returns the list of items read out, NULL if resumed
+static SRefNode *refReadFromQset(SRefQset *qset, bool all, int32_t *num) {
+  SRefNode *pNode = NULL;
+
+  tsem_wait(&qset->sem);
+  pthread_mutex_lock(&qset->mutex);
+
+  for (int32_t i = 0; i < qset->numOfQueues; ++i) {
+    if (qset->current == NULL) qset->current = qset->head;
+    SRefQueue *queue = qset->current;
+    qset->current = queue->next;
+    if (queue->head == NULL) continue;
+
+    pthread_mutex_lock(&queue->mutex);
+    if (queue->head) {
+      pNode = queue->head;
+      if (all) {
+        *num = queue->numOfItems;
+        queue->head = NULL;
+        queue->tail = NULL;
+        queue->numOfItems = 0;
+        for (int32_t j = 1; j < *num; ++j) tsem_wait(&qset->sem);
+      } else {
+        *num = 1;
+        queue->head = pNode->next;
+        if (queue->head == NULL) queue->tail = NULL;
+        queue->numOfItems--;
+      }
+    }
+    pthread_mutex_unlock(&queue->mutex);
+
+    if (pNode) break;
+  }
+
+  pthread_mutex_unlock(&qset->mutex);
+  return pNode;
+}
+
+static void checkItem(SThreadInfo *pInfo, SItem *pItem) {
+  // items from one writer shall be read out in order
+  if (numOfReaders == 1 && pItem->seq != pInfo->lastSeq[pItem->writer] + 1) {
+    printf("writer:%d, seq:%d is read after seq:%d\n", pItem->writer, pItem->seq, pInfo->lastSeq[pItem->writer]);
+    exit(1);
+  }
+
+  pInfo->lastSeq[pItem->writer] = pItem->seq;
+  pInfo->numOfRead++;
+}
+
+static void *writeItems(void *param) {
+  SThreadInfo *pInfo = (SThreadInfo *)param;
+
+  for (int32_t i = 0; i < pInfo->numOfItems; ++i) {
+    SItem *pItem = pInfo->refImpl ? refAllocItem(sizeof(SItem)) : taosAllocateQitem(sizeof(SItem));
+    pItem->writer = pInfo->id;
+    pItem->seq = i;
+
+    if (pInfo->refImpl) {
+      refWriteItem(pInfo->queue, pInfo->qset, pItem);
+    } else {
+      taosWriteQitem(pInfo->queue, 0, pItem);
+    }
+  }
+
+  return NULL;
+}
+
+static void *readItems(void *param) {
+  SThreadInfo *pInfo = (SThreadInfo *)param;
+  taos_qall    qall = taosAllocateQall();
+  void        *ahandle = NULL;
+  int          type = 0;
+  SItem       *pItem = NULL;
+
+  while (1) {
+    if (pInfo->refImpl) {
+      int32_t   num = 0;
+      SRefNode *pNode = refReadFromQset(pInfo->qset, pInfo->readAll, &num);
+      if (pNode == NULL) break;
+
+      for (int32_t i = 0; i < num; ++i) {
+        SRefNode *pNext = pNode->next;
+        checkItem(pInfo, (SItem *)pNode->item);
+        refFreeItem(pNode->item);
+        pNode = pNext;
+      }
+    } else if (pInfo->readAll) {
+      int32_t num = taosReadAllQitemsFromQset(pInfo->qset, qall, &ahandle);
+      if (num == 0) break;
+
+      for (int32_t i = 0; i < num; ++i) {
+        taosGetQitem(qall, &type, (void **)&pItem);
+        checkItem(pInfo, pItem);
+        taosFreeQitem(pItem);
+      }
+    } else {
+      if (taosReadQitemFromQset(pInfo->qset, &type, (void **)&pItem, &ahandle) == 0) break;
+      checkItem(pInfo, pItem);
+      taosFreeQitem(pItem);
+    }
+  }
+
+  taosFreeQall(qall);
+  return NULL;
+}
+
+static double runTest(bool refImpl) {
+  SThreadInfo *writers = calloc(numOfWriters, sizeof(SThreadInfo));
+  SThreadInfo *readers = calloc(numOfReaders, sizeof(SThreadInfo));
+  void        *qset = NULL;
+
+  if (refImpl) {
+    SRefQset *pQset = calloc(1, sizeof(SRefQset));
+    pthread_mutex_init(&pQset->mutex, NULL);
+    tsem_init(&pQset->sem, 0, 0);
+    qset = pQset;
+  } else {
+    qset = taosOpenQset();
+  }
+
+  for (int32_t i = 0; i < numOfWriters; ++i) {
+    writers[i].id = i;
+    writers[i].numOfItems = itemsPerWriter;
+    writers[i].refImpl = refImpl;
+    writers[i].qset = qset;
+
+    if (refImpl) {
+      SRefQueue *pQueue = calloc(1, sizeof(SRefQueue));
+      pthread_mutex_init(&pQueue->mutex, NULL);
+      SRefQset *pQset = qset;
+      pQueue->next = pQset->head;
+      pQset->head = pQueue;
+      pQset->numOfQueues++;
+      writers[i].queue = pQueue;
+    } else {
+      writers[i].queue = taosOpenQueue();
+      taosAddIntoQset(qset, writers[i].queue, NULL);
+    }
+  }
+
+  struct timeval start, end;
+  gettimeofday(&start, NULL);
+
+  for (int32_t i = 0; i < numOfReaders; ++i) {
+    readers[i].refImpl = refImpl;
+    readers[i].qset = qset;
+    readers[i].readAll = readAll;
+    readers[i].lastSeq = malloc(sizeof(int32_t) * numOfWriters);
+    for (int32_t j = 0; j < numOfWriters; ++j) readers[i].lastSeq[j] = -1;
+    pthread_create(&readers[i].thread, NULL, readItems, readers + i);
+  }
+
+  for (int32_t i = 0; i < numOfWriters; ++i) {
+    pthread_create(&writers[i].thread, NULL, writeItems, writers + i);
+  }
+
+  for (int32_t i = 0; i < numOfWriters; ++i) {
+    pthread_join(writers[i].thread, NULL);
+  }
+
+  // wait until all items are consumed, then let the readers exit
+  int64_t total = (int64_t)numOfWriters * itemsPerWriter;
+  while (1) {
+    int64_t numOfRead = 0;
+    for (int32_t i = 0; i < numOfReaders; ++i) numOfRead += atomic_load_64(&readers[i].numOfRead);
+    if (numOfRead >= total) break;
+    usleep(100);
+  }
+
+  gettimeofday(&end, NULL);
+
+  for (int32_t i = 0; i < numOfReaders; ++i) {
+    if (refImpl) {
+      tsem_post(&((SRefQset *)qset)->sem);
+    } else {
+      taosQsetThreadResume(qset);
+    }
+  }
+
+  for (int32_t i = 0; i < numOfReaders; ++i) {
+    pthread_join(readers[i].thread, NULL);
+    free(readers[i].lastSeq);
+  }
+
+  for (int32_t i = 0; i < numOfWriters; ++i) {
+    if (refImpl) {
+      pthread_mutex_destroy(&((SRefQueue *)writers[i].queue)->mutex);
+      free(writers[i].queue);
+    } else {
+      taosCloseQueue(writers[i].queue);
+    }
+  }
+
+  if (refImpl) {
+    pthread_mutex_destroy(&((SRefQset *)qset)->mutex);
+    tsem_destroy(&((SRefQset *)qset)->sem);
+    free(qset);
+  } else {
+    taosCloseQset(qset);
+  }
+
+  free(writers);
+  free(readers);
+
+  double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1000000.0;
+  return total / elapsed;
+}
+
+int main(int argc, char *argv[]) {
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-w") == 0 && i < argc - 1) {
+      numOfWriters = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-r") == 0 && i < argc - 1) {
+      numOfReaders = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-n") == 0 && i < argc - 1) {
+      itemsPerWriter = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-a") == 0) {
+      readAll = true;
+    } else {
+      printf("\nusage: %s [options] \n", argv[0]);
+      printf("  [-w writers]: number of writer threads, default is:%d\n", numOfWriters);
+      printf("  [-r readers]: number of reader threads, default is:%d\n", numOfReaders);
+      printf("  [-n items]: number of items written by each writer, default is:%d\n", itemsPerWriter);
+      printf("  [-a]: read all items of a queue at once\n");
+      exit(0);
+    }
+  }
+
+  printf("writers:%d readers:%d items per writer:%d read all:%d\n", numOfWriters, numOfReaders, itemsPerWriter,
+         readAll);
+
+  double ref = runTest(true);
+  printf("mutex queue:     %.0f items/s\n", ref);
+
+  double lockFree = runTest(false);
+  printf("lock free queue: %.0f items/s\n", lockFree);
+
+  printf("speedup: %.2fx\n", lockFree / ref);
+  return 0;
+}
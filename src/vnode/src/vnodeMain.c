@@ -34,6 +34,7 @@
 #include "tcrc32c.h"
 
 static int32_t vnodeProcessTsdbStatus(void *arg, int32_t status, int32_t eno);
+static void    vnodeReportRestore(void *arg, int64_t restored, int64_t total, int64_t leftMs);
 
 int32_t vnodeCreate(SCreateVnodeMsg *pVnodeCfg) {
   int32_t code;
@@ -366,7 +367,7 @@ int32_t vnodeOpen(int32_t vgId) {
     return terrno;
   }
 
-  walRestore(pVnode->wal, pVnode, vnodeProcessWrite);
+  walRestore(pVnode->wal, pVnode, vnodeProcessWrite, vnodeReportRestore);
   if (pVnode->version == 0) {
     pVnode->fversion = 0;
     pVnode->version = walGetVersion(pVnode->wal);
@@ -595,6 +596,17 @@ void vnodeCleanUp(SVnodeObj *pVnode) {
   vnodeRelease(pVnode);
 }
 
+// Progress of the wal replay of a vnode, shown as the startup step of the dnode
+static void vnodeReportRestore(void *arg, int64_t restored, int64_t total, int64_t leftMs) {
+  SVnodeObj *pVnode = arg;
+  char       stepDesc[TSDB_STEP_DESC_LEN] = {0};
+
+  snprintf(stepDesc, TSDB_STEP_DESC_LEN, "vgId:%d, wal %" PRId64 " of %" PRId64 " KB restored, %" PRId64 "s left",
+           pVnode->vgId, restored / 1024, total / 1024, leftMs / 1000);
+  dnodeReportStep("open-vnodes", stepDesc, 0);
+  vDebug("%s", stepDesc);
+}
+
 static int32_t vnodeProcessTsdbStatus(void *arg, int32_t status, int32_t eno) {
   SVnodeObj *pVnode = arg;
 
@@ -452,6 +452,9 @@ SVnodeStatisInfo vnodeGetStatisInfo() {
   info.submitReqSucNum = atomic_exchange_64(&tsSubmitReqSucNum, 0);
   info.submitRowNum = atomic_exchange_64(&tsSubmitRowNum, 0);
   info.submitRowSucNum = atomic_exchange_64(&tsSubmitRowSucNum, 0);
+  tsdbGetBlkCacheStatisInfo(&info.blkCacheHitNum, &info.blkCacheMissNum, &info.blkCacheUsed);
+  tsdbGetSyncStatisInfo(&info.syncSentBytes, &info.syncSkippedBytes);
+  walGetCompStatisInfo(&info.walRawBytes, &info.walWrittenBytes);
 
   return info;
 }
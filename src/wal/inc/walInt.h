@@ -39,6 +39,13 @@ extern int32_t wDebugFlag;
 #define WAL_PATH_LEN   (TSDB_FILENAME_LEN + 12)
 #define WAL_FILE_LEN   (WAL_PATH_LEN + 32)
 #define WAL_FILE_NUM   1 // 3
+#define WAL_COMP_SVER  3 // sver of a record compressed by LZ4
+
+// Ahead of the LZ4 data in a compressed record, the len and cksum of the record before compression
+typedef struct {
+  int32_t  len;
+  uint32_t cksum;
+} SWalComp;
 
 typedef struct {
   uint64_t version;
@@ -54,6 +61,7 @@ typedef struct {
   int8_t   reserved[3];
   char     path[WAL_PATH_LEN];
   char     name[WAL_FILE_LEN];
+  char *   compBuf;  // buffer of the compressed record, allocated on the first record compressed
   pthread_mutex_t mutex;
 } SWal;
 
@@ -154,6 +154,7 @@ static void walFreeObj(void *wal) {
 
   tfClose(pWal->tfd);
   pthread_mutex_destroy(&pWal->mutex);
+  tfree(pWal->compBuf);
   tfree(pWal);
 }
 
@@ -20,10 +20,63 @@
 #include "taosmsg.h"
 #include "tchecksum.h"
 #include "tfile.h"
+#include "lz4.h"
 #include "twal.h"
 #include "walInt.h"
 
-static int32_t walRestoreWalFile(SWal *pWal, void *pVnode, FWalWrite writeFp, char *name, int64_t fileId);
+extern int32_t tsWalRestoreReadAhead;
+extern int32_t tsWalRestoreRate;
+extern int32_t tsWalCompressSize;
+
+#define WAL_RESTORE_BATCHES 2
+#define WAL_RESTORE_REPORT_MS 1000
+#define WAL_RESTORE_ALIGN(len) (((len) + 7) & ~7)
+
+// State of the restore of the wal files of a vnode
+typedef struct {
+  SWal *        pWal;
+  void *        pVnode;
+  FWalWrite *   writeFp;
+  FWalProgress *progressFp;
+  int64_t       total;     // bytes of the wal files
+  int64_t       restored;  // bytes of the wal files read and applied
+  int64_t       startMs;
+  int64_t       reportMs;
+} SWalRestore;
+
+typedef struct {
+  char *  buf;
+  int32_t len;      // bytes of the records in the batch
+  int64_t readLen;  // bytes of the file read for the batch, with the corrupted records skipped
+} SWalBatch;
+
+// Reader of a wal file ahead of the records applied
+typedef struct {
+  SWal *          pWal;
+  char *          name;
+  int64_t         fileId;
+  int64_t         tfd;
+  int64_t         offset;
+  int32_t         batchSize;
+  char *          compBuf;  // buffer of the compressed records decompressed
+  pthread_t       thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t  cond;
+  SWalBatch       batches[WAL_RESTORE_BATCHES];
+  int32_t         head;  // the first batch read and not applied
+  int32_t         num;   // number of the batches read and not applied
+  int32_t         code;
+  bool            done;
+  bool            stop;
+} SWalReader;
+
+static int64_t tsWalRestoreBytes = 0;
+static int64_t tsWalRestoreStartMs = 0;
+static int64_t tsWalRawBytes = 0;      // bytes of the records written, before compression
+static int64_t tsWalWrittenBytes = 0;  // bytes of the records written to the wal files
+
+static int32_t walRestoreWalFile(SWalRestore *pRestore, char *name, int64_t fileId);
+static void    walRestoreThrottle(int64_t bytes);
 
 int32_t walRenew(void *handle) {
   if (handle == NULL) return 0;
@@ -132,8 +185,71 @@ static int walValidateChecksum(SWalHead *pHead) {
   return 0;
 }
 
+/*
+ * Compress the record into the buffer of the wal, which is reused by the next record. Returns NULL if the record is
+ * not smaller after compression, and it is written as it is.
+ */
+static SWalHead *walCompressRecord(SWal *pWal, SWalHead *pHead) {
+  if (pHead->len > TSDB_MAX_WAL_SIZE || pHead->len <= sizeof(SWalComp)) return NULL;
+
+  if (pWal->compBuf == NULL) {
+    pWal->compBuf = malloc(sizeof(SWalHead) + TSDB_MAX_WAL_SIZE);
+    if (pWal->compBuf == NULL) return NULL;
+  }
+
+  SWalHead *pComp = (SWalHead *)pWal->compBuf;
+  SWalComp *pInfo = (SWalComp *)pComp->cont;
+
+  // the output is limited to fail the compression as soon as the record is not smaller
+  int32_t maxLen = pHead->len - (int32_t)sizeof(SWalComp) - 1;
+  int32_t compLen = LZ4_compress_default(pHead->cont, (char *)(pInfo + 1), pHead->len, maxLen);
+  if (compLen <= 0) return NULL;
+
+  memcpy(pComp, pHead, sizeof(SWalHead));
+  pComp->sver = WAL_COMP_SVER;
+  pComp->len = (int32_t)sizeof(SWalComp) + compLen;
+  pInfo->len = pHead->len;
+  pInfo->cksum = pHead->cksum;
+
+  pComp->cksum = 0;
+  pComp->cksum = taosCalcChecksum(0, (uint8_t *)pComp, sizeof(SWalHead) + pComp->len);
+
+  return pComp;
+}
+
 #endif
 
+/*
+ * Decompress a record read from the wal file into buf, which has room for sizeof(SWalHead) + TSDB_MAX_WAL_SIZE bytes.
+ * Returns pHead itself if it is not compressed, and NULL if it can not be decompressed. The record decompressed is the
+ * same as the one passed to walWrite, and is checked by the same checksum.
+ */
+void *walDecompressRecord(SWalHead *pHead, void *buf) {
+  if (pHead->sver != WAL_COMP_SVER) return pHead;
+  if (pHead->len < sizeof(SWalComp)) return NULL;
+
+  SWalComp *pInfo = (SWalComp *)pHead->cont;
+  if (pInfo->len < 0 || pInfo->len > TSDB_MAX_WAL_SIZE) return NULL;
+
+  SWalHead *pDest = buf;
+  int32_t   len = LZ4_decompress_safe((char *)(pInfo + 1), pDest->cont, pHead->len - (int32_t)sizeof(SWalComp),
+                                    pInfo->len);
+  if (len != pInfo->len) return NULL;
+
+  // only the records with sver 2 are compressed
+  memcpy(pDest, pHead, sizeof(SWalHead));
+  pDest->sver = 2;
+  pDest->len = pInfo->len;
+  pDest->cksum = pInfo->cksum;
+
+  return pDest;
+}
+
+void walGetCompStatisInfo(int64_t *rawBytes, int64_t *writtenBytes) {
+  *rawBytes = atomic_exchange_64(&tsWalRawBytes, 0);
+  *writtenBytes = atomic_exchange_64(&tsWalWrittenBytes, 0);
+}
+
 int32_t walWrite(void *handle, SWalHead *pHead) {
   if (handle == NULL) return -1;
 
@@ -154,15 +270,32 @@ int32_t walWrite(void *handle, SWalHead *pHead) {
 #endif
 
   int32_t contLen = pHead->len + sizeof(SWalHead);
+  void *  pWrite = pHead;
+  int32_t writeLen = contLen;
 
   pthread_mutex_lock(&pWal->mutex);
 
-  if (tfWrite(pWal->tfd, pHead, contLen) != contLen) {
+#if defined(WAL_CHECKSUM_WHOLE)
+  // pHead is forwarded to the peers after written, so it is compressed into another buffer. The wal kept, which is
+  // never renewed, is not compressed to keep it readable by the versions before the compression.
+  if (tsWalCompressSize >= 0 && pHead->len > tsWalCompressSize && pWal->keep != TAOS_WAL_KEEP) {
+    SWalHead *pComp = walCompressRecord(pWal, pHead);
+    if (pComp != NULL) {
+      pWrite = pComp;
+      writeLen = pComp->len + sizeof(SWalHead);
+    }
+  }
+#endif
+
+  atomic_add_fetch_64(&tsWalRawBytes, contLen);
+  atomic_add_fetch_64(&tsWalWrittenBytes, writeLen);
+
+  if (tfWrite(pWal->tfd, pWrite, writeLen) != writeLen) {
     code = TAOS_SYSTEM_ERROR(errno);
     wError("vgId:%d, file:%s, failed to write since %s", pWal->vgId, pWal->name, strerror(errno));
   } else {
-    wTrace("vgId:%d, write wal, fileId:%" PRId64 " tfd:%" PRId64 " hver:%" PRId64 " wver:%" PRIu64 " len:%d", pWal->vgId,
-           pWal->fileId, pWal->tfd, pHead->version, pWal->version, pHead->len);
+    wTrace("vgId:%d, write wal, fileId:%" PRId64 " tfd:%" PRId64 " hver:%" PRId64 " wver:%" PRIu64 " len:%d wlen:%d",
+           pWal->vgId, pWal->fileId, pWal->tfd, pHead->version, pWal->version, pHead->len, writeLen);
     pWal->version = pHead->version;
   }
 
@@ -185,7 +318,7 @@ void walFsync(void *handle, bool forceFsync) {
   }
 }
 
-int32_t walRestore(void *handle, void *pVnode, FWalWrite writeFp) {
+int32_t walRestore(void *handle, void *pVnode, FWalWrite writeFp, FWalProgress progressFp) {
   if (handle == NULL) return -1;
 
   SWal *  pWal = handle;
@@ -193,6 +326,22 @@ int32_t walRestore(void *handle, void *pVnode, FWalWrite writeFp) {
   int32_t code = 0;
   int64_t fileId = -1;
 
+  SWalRestore restore = {.pWal = pWal, .pVnode = pVnode, .writeFp = writeFp, .progressFp = progressFp};
+  restore.startMs = taosGetTimestampMs();
+  restore.reportMs = restore.startMs;
+
+  // the size of the files to restore, to estimate the time left
+  while (walGetNextFile(pWal, &fileId) >= 0) {
+    if (fileId == pWal->fileId) continue;
+
+    char walName[WAL_FILE_LEN];
+    snprintf(walName, sizeof(pWal->name), "%s/%s%" PRId64, pWal->path, WAL_PREFIX, fileId);
+
+    struct stat walStat;
+    if (stat(walName, &walStat) == 0) restore.total += walStat.st_size;
+  }
+
+  fileId = -1;
   while ((code = walGetNextFile(pWal, &fileId)) >= 0) {
     if (fileId == pWal->fileId) continue;
 
@@ -200,7 +349,7 @@ int32_t walRestore(void *handle, void *pVnode, FWalWrite writeFp) {
     snprintf(walName, sizeof(pWal->name), "%s/%s%" PRId64, pWal->path, WAL_PREFIX, fileId);
 
     wInfo("vgId:%d, file:%s, will be restored", pWal->vgId, walName);
-    code = walRestoreWalFile(pWal, pVnode, writeFp, walName, fileId);
+    code = walRestoreWalFile(&restore, walName, fileId);
     if (code != TSDB_CODE_SUCCESS) {
       wError("vgId:%d, file:%s, failed to restore since %s", pWal->vgId, walName, tstrerror(code));
       continue;
@@ -211,6 +360,10 @@ int32_t walRestore(void *handle, void *pVnode, FWalWrite writeFp) {
     count++;
   }
 
+  if (restore.total > 0 && progressFp != NULL) {
+    (*progressFp)(pVnode, restore.total, restore.total, 0);
+  }
+
   if (pWal->keep != TAOS_WAL_KEEP) return TSDB_CODE_SUCCESS;
 
   if (count == 0) {
@@ -283,6 +436,10 @@ static int32_t walSkipCorruptedRecord(SWal *pWal, SWalHead *pHead, int64_t tfd,
     }
 
     if (pHead->sver >= 1) {
+      if (pHead->len < 0 || pHead->len > TSDB_MAX_WAL_SIZE) {
+        continue;
+      }
+
       if (tfRead(tfd, pHead->cont, pHead->len) < pHead->len) {
 	wError("vgId:%d, read to end of corrupted wal file, offset:%" PRId64, pWal->vgId, pos);
 	return TSDB_CODE_WAL_FILE_CORRUPTED;
@@ -417,142 +574,356 @@ static int walSMemRowCheck(SWalHead *pHead) {
   return 0;
 }
 
-static int32_t walRestoreWalFile(SWal *pWal, void *pVnode, FWalWrite writeFp, char *name, int64_t fileId) {
-  int32_t size = WAL_MAX_SIZE;
-  void *  buffer = tmalloc(size);
-  if (buffer == NULL) {
-    wError("vgId:%d, file:%s, failed to open for restore since %s", pWal->vgId, name, strerror(errno));
-    return TAOS_SYSTEM_ERROR(errno);
+/*
+ * The compressed record is copied out of pHead, which has room for the record decompressed, into *ppBuf. *ppBuf is
+ * allocated by the first record decompressed and reused by the next ones, and freed by the caller.
+ */
+static int32_t walDecompressRecordInPlace(SWalHead *pHead, char **ppBuf) {
+  if (*ppBuf == NULL) {
+    *ppBuf = tmalloc(WAL_MAX_SIZE);
+    if (*ppBuf == NULL) return -1;
   }
 
-  int64_t tfd = tfOpen(name, O_RDWR);
-  if (!tfValid(tfd)) {
-    wError("vgId:%d, file:%s, failed to open for restore since %s", pWal->vgId, name, strerror(errno));
-    tfree(buffer);
-    return TAOS_SYSTEM_ERROR(errno);
-  } else {
-    wDebug("vgId:%d, file:%s, open for restore", pWal->vgId, name);
-  }
+  memcpy(*ppBuf, pHead, sizeof(SWalHead) + pHead->len);
+  return (walDecompressRecord((SWalHead *)(*ppBuf), pHead) == NULL) ? -1 : 0;
+}
 
-  int32_t   code = TSDB_CODE_SUCCESS;
-  int64_t   offset = 0;
-  SWalHead *pHead = buffer;
+/*
+ * Read the next record of a WAL file into pHead, which has room for WAL_MAX_SIZE bytes. The corrupted records are
+ * skipped, and the file is truncated at the first one which can not be skipped. Returns 1 if a record is read, and 0
+ * at the end of the file or on error, with *code set.
+ */
+static int32_t walReadRecord(SWal *pWal, char *name, int64_t fileId, int64_t tfd, int64_t *offset, SWalHead *pHead,
+                             char **ppCompBuf, int32_t *code) {
+  int32_t size = WAL_MAX_SIZE;
 
   while (1) {
     int32_t ret = (int32_t)tfRead(tfd, pHead, sizeof(SWalHead));
-    if (ret == 0) break;
+    if (ret == 0) return 0;
 
     if (ret < 0) {
       wError("vgId:%d, file:%s, failed to read wal head since %s", pWal->vgId, name, strerror(errno));
-      code = TAOS_SYSTEM_ERROR(errno);
-      break;
+      *code = TAOS_SYSTEM_ERROR(errno);
+      return 0;
     }
 
     if (ret < sizeof(SWalHead)) {
       wError("vgId:%d, file:%s, failed to read wal head, ret is %d", pWal->vgId, name, ret);
-      walFtruncate(pWal, tfd, offset);
-      break;
+      walFtruncate(pWal, tfd, *offset);
+      return 0;
     }
 
 #if defined(WAL_CHECKSUM_WHOLE)
-    if ((pHead->sver == 0 && !walValidateChecksum(pHead)) || pHead->sver < 0 || pHead->sver > 2) {
+    // the record found by skipping a corrupted one is read and checked as a whole, unless its sver is 0
+    bool bodyRead = false;
+
+    if ((pHead->sver == 0 && !walValidateChecksum(pHead)) || pHead->sver < 0 || pHead->sver > WAL_COMP_SVER) {
       wError("vgId:%d, file:%s, wal head cksum is messed up, hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId, name,
-             pHead->version, pHead->len, offset);
-      code = walSkipCorruptedRecord(pWal, pHead, tfd, &offset);
-      if (code != TSDB_CODE_SUCCESS) {
-        walFtruncate(pWal, tfd, offset);
-        break;
+             pHead->version, pHead->len, *offset);
+      *code = walSkipCorruptedRecord(pWal, pHead, tfd, offset);
+      if (*code != TSDB_CODE_SUCCESS) {
+        walFtruncate(pWal, tfd, *offset);
+        return 0;
       }
+      bodyRead = (pHead->sver >= 1);
     }
 
-    if (pHead->len < 0 || pHead->len > size - sizeof(SWalHead)) {
+    if (!bodyRead && (pHead->len < 0 || pHead->len > size - sizeof(SWalHead))) {
       wError("vgId:%d, file:%s, wal head len out of range, hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId, name,
-             pHead->version, pHead->len, offset);
-      code = walSkipCorruptedRecord(pWal, pHead, tfd, &offset);
-      if (code != TSDB_CODE_SUCCESS) {
-        walFtruncate(pWal, tfd, offset);
-        break;
+             pHead->version, pHead->len, *offset);
+      *code = walSkipCorruptedRecord(pWal, pHead, tfd, offset);
+      if (*code != TSDB_CODE_SUCCESS) {
+        walFtruncate(pWal, tfd, *offset);
+        return 0;
       }
+      bodyRead = (pHead->sver >= 1);
     }
 
-    ret = (int32_t)tfRead(tfd, pHead->cont, pHead->len);
-    if (ret < 0) {
-      wError("vgId:%d, file:%s, failed to read wal body since %s", pWal->vgId, name, strerror(errno));
-      code = TAOS_SYSTEM_ERROR(errno);
-      break;
-    }
+    if (!bodyRead) {
+      ret = (int32_t)tfRead(tfd, pHead->cont, pHead->len);
+      if (ret < 0) {
+        wError("vgId:%d, file:%s, failed to read wal body since %s", pWal->vgId, name, strerror(errno));
+        *code = TAOS_SYSTEM_ERROR(errno);
+        return 0;
+      }
 
-    if (ret < pHead->len) {
-      wError("vgId:%d, file:%s, failed to read wal body, ret:%d len:%d", pWal->vgId, name, ret, pHead->len);
-      offset += sizeof(SWalHead);
-      continue;
-    }
+      if (ret < pHead->len) {
+        wError("vgId:%d, file:%s, failed to read wal body, ret:%d len:%d", pWal->vgId, name, ret, pHead->len);
+        *offset += sizeof(SWalHead);
+        continue;
+      }
 
-    if ((pHead->sver >= 1) && !walValidateChecksum(pHead)) {
-      wError("vgId:%d, file:%s, wal whole cksum is messed up, hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId, name,
-             pHead->version, pHead->len, offset);
-      code = walSkipCorruptedRecord(pWal, pHead, tfd, &offset);
-      if (code != TSDB_CODE_SUCCESS) {
-        walFtruncate(pWal, tfd, offset);
-        break;
+      if ((pHead->sver >= 1) && !walValidateChecksum(pHead)) {
+        wError("vgId:%d, file:%s, wal whole cksum is messed up, hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId,
+               name, pHead->version, pHead->len, *offset);
+        *code = walSkipCorruptedRecord(pWal, pHead, tfd, offset);
+        if (*code != TSDB_CODE_SUCCESS) {
+          walFtruncate(pWal, tfd, *offset);
+          return 0;
+        }
       }
     }
 
 #else
     if (!taosCheckChecksumWhole((uint8_t *)pHead, sizeof(SWalHead))) {
       wError("vgId:%d, file:%s, wal head cksum is messed up, hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId, name,
-             pHead->version, pHead->len, offset);
-      code = walSkipCorruptedRecord(pWal, pHead, tfd, &offset);
-      if (code != TSDB_CODE_SUCCESS) {
-        walFtruncate(pWal, tfd, offset);
-        break;
+             pHead->version, pHead->len, *offset);
+      *code = walSkipCorruptedRecord(pWal, pHead, tfd, offset);
+      if (*code != TSDB_CODE_SUCCESS) {
+        walFtruncate(pWal, tfd, *offset);
+        return 0;
       }
     }
 
     if (pHead->len < 0 || pHead->len > size - sizeof(SWalHead)) {
       wError("vgId:%d, file:%s, wal head len out of range, hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId, name,
-             pHead->version, pHead->len, offset);
-      code = walSkipCorruptedRecord(pWal, pHead, tfd, &offset);
-      if (code != TSDB_CODE_SUCCESS) {
-        walFtruncate(pWal, tfd, offset);
-        break;
+             pHead->version, pHead->len, *offset);
+      *code = walSkipCorruptedRecord(pWal, pHead, tfd, offset);
+      if (*code != TSDB_CODE_SUCCESS) {
+        walFtruncate(pWal, tfd, *offset);
+        return 0;
       }
     }
 
     ret = (int32_t)tfRead(tfd, pHead->cont, pHead->len);
     if (ret < 0) {
       wError("vgId:%d, file:%s, failed to read wal body since %s", pWal->vgId, name, strerror(errno));
-      code = TAOS_SYSTEM_ERROR(errno);
-      break;
+      *code = TAOS_SYSTEM_ERROR(errno);
+      return 0;
     }
 
     if (ret < pHead->len) {
       wError("vgId:%d, file:%s, failed to read wal body, ret:%d len:%d", pWal->vgId, name, ret, pHead->len);
-      offset += sizeof(SWalHead);
+      *offset += sizeof(SWalHead);
       continue;
     }
 
 #endif
-    offset = offset + sizeof(SWalHead) + pHead->len;
+    int32_t readLen = (int32_t)sizeof(SWalHead) + pHead->len;
+    *offset = *offset + readLen;
 
-    wTrace("vgId:%d, restore wal, fileId:%" PRId64 " hver:%" PRIu64 " wver:%" PRIu64 " len:%d offset:%" PRId64,
-           pWal->vgId, fileId, pHead->version, pWal->version, pHead->len, offset);
+    if (pHead->sver == WAL_COMP_SVER && walDecompressRecordInPlace(pHead, ppCompBuf) != 0) {
+      wError("vgId:%d, file:%s, failed to decompress wal, hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId, name,
+             pHead->version, pHead->len, *offset);
+      continue;
+    }
 
-    pWal->version = pHead->version;
+    wTrace("vgId:%d, restore wal, fileId:%" PRId64 " hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId, fileId,
+           pHead->version, pHead->len, *offset);
 
-    // wInfo("writeFp: %ld", offset);
     if (0 != walSMemRowCheck(pHead)) {
-      wError("vgId:%d, restore wal, fileId:%" PRId64 " hver:%" PRIu64 " wver:%" PRIu64 " len:%d offset:%" PRId64,
-             pWal->vgId, fileId, pHead->version, pWal->version, pHead->len, offset);
+      wError("vgId:%d, restore wal, fileId:%" PRId64 " hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId, fileId,
+             pHead->version, pHead->len, *offset);
+      *code = TAOS_SYSTEM_ERROR(errno);
+      return 0;
+    }
+
+    walRestoreThrottle(readLen);
+    return 1;
+  }
+}
+
+// Keep the wal read by all the restores under tsWalRestoreRate MB per second
+static void walRestoreThrottle(int64_t bytes) {
+  if (tsWalRestoreRate <= 0) return;
+
+  int64_t nowMs = taosGetTimestampMs();
+  atomic_val_compare_exchange_64(&tsWalRestoreStartMs, 0, nowMs);
+
+  int64_t readBytes = atomic_add_fetch_64(&tsWalRestoreBytes, bytes);
+  int64_t expectedMs = readBytes * 1000 / ((int64_t)tsWalRestoreRate * 1024 * 1024);
+  int64_t elapsedMs = nowMs - atomic_load_64(&tsWalRestoreStartMs);
+  if (expectedMs > elapsedMs) {
+    taosMsleep((int32_t)(expectedMs - elapsedMs));
+  }
+}
+
+static void walApplyRecord(SWalRestore *pRestore, SWalHead *pHead) {
+  pRestore->pWal->version = pHead->version;
+  (*pRestore->writeFp)(pRestore->pVnode, pHead, TAOS_QTYPE_WAL, NULL);
+}
+
+static void walReportRestore(SWalRestore *pRestore, int64_t restored) {
+  pRestore->restored += restored;
+  if (pRestore->progressFp == NULL) return;
+
+  int64_t nowMs = taosGetTimestampMs();
+  if (nowMs - pRestore->reportMs < WAL_RESTORE_REPORT_MS) return;
+  pRestore->reportMs = nowMs;
+
+  int64_t total = MAX(pRestore->total, pRestore->restored);
+  int64_t leftMs = (nowMs - pRestore->startMs) * (total - pRestore->restored) / MAX(pRestore->restored, 1);
+  (*pRestore->progressFp)(pRestore->pVnode, pRestore->restored, total, leftMs);
+}
+
+static void *walReadAhead(void *param) {
+  SWalReader *pReader = param;
+  int32_t     code = TSDB_CODE_SUCCESS;
+  bool        eof = false;
+
+  setThreadName("walReadAhead");
+
+  while (!eof) {
+    pthread_mutex_lock(&pReader->mutex);
+    while (pReader->num == WAL_RESTORE_BATCHES && !pReader->stop) {
+      pthread_cond_wait(&pReader->cond, &pReader->mutex);
+    }
+
+    if (pReader->stop) {
+      pthread_mutex_unlock(&pReader->mutex);
+      break;
+    }
+
+    SWalBatch *pBatch = pReader->batches + (pReader->head + pReader->num) % WAL_RESTORE_BATCHES;
+    pthread_mutex_unlock(&pReader->mutex);
+
+    pBatch->len = 0;
+    pBatch->readLen = 0;
+    while (pBatch->len < pReader->batchSize) {
+      SWalHead *pHead = (SWalHead *)(pBatch->buf + pBatch->len);
+      int64_t   offset = pReader->offset;
+
+      int32_t ret = walReadRecord(pReader->pWal, pReader->name, pReader->fileId, pReader->tfd, &pReader->offset, pHead,
+                                  &pReader->compBuf, &code);
+      pBatch->readLen += pReader->offset - offset;
+      if (ret <= 0) {
+        eof = true;
+        break;
+      }
+
+      // the records stay aligned in the batch as in the buffer they are read into without read ahead
+      pBatch->len += WAL_RESTORE_ALIGN(sizeof(SWalHead) + pHead->len);
+    }
+
+    pthread_mutex_lock(&pReader->mutex);
+    pReader->num++;
+    if (eof) {
+      pReader->code = code;
+      pReader->done = true;
+    }
+    pthread_cond_signal(&pReader->cond);
+    pthread_mutex_unlock(&pReader->mutex);
+  }
+
+  return NULL;
+}
+
+// Records are read ahead by a thread into the batches, and applied by the caller in the order of the file
+static int32_t walRestoreWalFileAhead(SWalRestore *pRestore, char *name, int64_t fileId, int64_t tfd) {
+  SWal *     pWal = pRestore->pWal;
+  SWalReader reader = {.pWal = pWal, .name = name, .fileId = fileId, .tfd = tfd};
+  int32_t    code = TSDB_CODE_SUCCESS;
+
+  reader.batchSize = tsWalRestoreReadAhead * 1024 * 1024 / WAL_RESTORE_BATCHES;
+  for (int32_t i = 0; i < WAL_RESTORE_BATCHES; ++i) {
+    // a batch always has room for one more record when it is not full
+    reader.batches[i].buf = tmalloc(reader.batchSize + WAL_MAX_SIZE);
+    if (reader.batches[i].buf == NULL) {
+      code = TAOS_SYSTEM_ERROR(errno);
+      wError("vgId:%d, file:%s, failed to alloc read ahead buffer since %s", pWal->vgId, name, strerror(errno));
+      for (int32_t j = 0; j < i; ++j) tfree(reader.batches[j].buf);
+      return code;
+    }
+  }
+
+  pthread_mutex_init(&reader.mutex, NULL);
+  pthread_cond_init(&reader.cond, NULL);
+
+  pthread_attr_t thattr;
+  pthread_attr_init(&thattr);
+  pthread_attr_setdetachstate(&thattr, PTHREAD_CREATE_JOINABLE);
+  if (pthread_create(&reader.thread, &thattr, walReadAhead, &reader) != 0) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    wError("vgId:%d, file:%s, failed to create read ahead thread since %s", pWal->vgId, name, strerror(errno));
+  }
+  pthread_attr_destroy(&thattr);
+
+  while (code == TSDB_CODE_SUCCESS) {
+    pthread_mutex_lock(&reader.mutex);
+    while (reader.num == 0 && !reader.done) {
+      pthread_cond_wait(&reader.cond, &reader.mutex);
+    }
+
+    if (reader.num == 0) {
+      code = reader.code;
+      pthread_mutex_unlock(&reader.mutex);
+      break;
+    }
+
+    SWalBatch *pBatch = reader.batches + reader.head;
+    pthread_mutex_unlock(&reader.mutex);
+
+    for (int32_t pos = 0; pos < pBatch->len;) {
+      SWalHead *pHead = (SWalHead *)(pBatch->buf + pos);
+      pos += WAL_RESTORE_ALIGN(sizeof(SWalHead) + pHead->len);
+      walApplyRecord(pRestore, pHead);
+    }
+    walReportRestore(pRestore, pBatch->readLen);
+
+    pthread_mutex_lock(&reader.mutex);
+    reader.head = (reader.head + 1) % WAL_RESTORE_BATCHES;
+    reader.num--;
+    pthread_cond_signal(&reader.cond);
+    pthread_mutex_unlock(&reader.mutex);
+  }
+
+  if (taosCheckPthreadValid(reader.thread)) {
+    pthread_mutex_lock(&reader.mutex);
+    reader.stop = true;
+    pthread_cond_signal(&reader.cond);
+    pthread_mutex_unlock(&reader.mutex);
+    pthread_join(reader.thread, NULL);
+  }
+
+  pthread_cond_destroy(&reader.cond);
+  pthread_mutex_destroy(&reader.mutex);
+  for (int32_t i = 0; i < WAL_RESTORE_BATCHES; ++i) {
+    tfree(reader.batches[i].buf);
+  }
+  tfree(reader.compBuf);
+
+  return code;
+}
+
+static int32_t walRestoreWalFile(SWalRestore *pRestore, char *name, int64_t fileId) {
+  SWal *pWal = pRestore->pWal;
+
+  int64_t tfd = tfOpen(name, O_RDWR);
+  if (!tfValid(tfd)) {
+    wError("vgId:%d, file:%s, failed to open for restore since %s", pWal->vgId, name, strerror(errno));
+    return TAOS_SYSTEM_ERROR(errno);
+  } else {
+    wDebug("vgId:%d, file:%s, open for restore", pWal->vgId, name);
+  }
+
+  int32_t code = TSDB_CODE_SUCCESS;
+
+  if (tsWalRestoreReadAhead > 0) {
+    code = walRestoreWalFileAhead(pRestore, name, fileId, tfd);
+  } else {
+    void *buffer = tmalloc(WAL_MAX_SIZE);
+    if (buffer == NULL) {
+      wError("vgId:%d, file:%s, failed to open for restore since %s", pWal->vgId, name, strerror(errno));
       tfClose(tfd);
-      tfree(buffer);
       return TAOS_SYSTEM_ERROR(errno);
     }
-    (*writeFp)(pVnode, pHead, TAOS_QTYPE_WAL, NULL);
+
+    int64_t   offset = 0;
+    SWalHead *pHead = buffer;
+    char *    compBuf = NULL;
+    while (1) {
+      int64_t lastOffset = offset;
+      if (walReadRecord(pWal, name, fileId, tfd, &offset, pHead, &compBuf, &code) <= 0) break;
+
+      walApplyRecord(pRestore, pHead);
+      walReportRestore(pRestore, offset - lastOffset);
+    }
+
+    tfree(compBuf);
+    tfree(buffer);
   }
 
   tfClose(tfd);
-  tfree(buffer);
 
   wDebug("vgId:%d, file:%s, it is closed after restore", pWal->vgId, name);
   return code;
@@ -0,0 +1,312 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <vector>
+
+#include "os.h"
+#include "taoserror.h"
+#include "tchecksum.h"
+#include "tfile.h"
+#include "tglobal.h"
+#include "twal.h"
+
+namespace {
+
+const char *walTestPath = "/tmp/walTest";
+
+std::vector<uint64_t> restoredVersions;
+int32_t               badRecords = 0;
+
+// the payload of each record is derived from its version, so a record applied can be checked by itself. The records
+// of odd versions are compressible, and the ones of even versions are not.
+int32_t recordLen(uint64_t version) { return 20000 + (int32_t)(version * 997 % 30000); }
+
+void fillRecord(SWalHead *pHead, uint64_t version) {
+  memset(pHead, 0, sizeof(SWalHead));
+  pHead->msgType = 1;
+  pHead->version = version;
+  pHead->len = recordLen(version);
+
+  uint32_t seed = (uint32_t)version;
+  for (int32_t i = 0; i < pHead->len; ++i) {
+    if (version % 2 == 1) {
+      pHead->cont[i] = (char)('a' + (i / 16 + version) % 26);
+    } else {
+      seed = seed * 1103515245 + 12345;
+      pHead->cont[i] = (char)(seed >> 16);
+    }
+  }
+}
+
+int32_t restoreRecord(void *pVnode, void *data, int32_t qtype, void *pMsg) {
+  SWalHead *pHead = (SWalHead *)data;
+  SWalHead *pExpected = (SWalHead *)pVnode;
+
+  fillRecord(pExpected, pHead->version);
+  if (pHead->len != pExpected->len || memcmp(pHead->cont, pExpected->cont, pHead->len) != 0) {
+    badRecords++;
+  }
+
+  restoredVersions.push_back(pHead->version);
+  return 0;
+}
+
+void runCmd(const char *cmd) { ASSERT_EQ(system(cmd), 0) << cmd; }
+
+// write the records 1 to num into a new wal file of the path, named by walRenew. The records from compFrom on are
+// written with walCompressSize 0.
+void writeWal(const char *path, int32_t num, int32_t compFrom, SWalHead *pHead, char *name, int32_t nameLen) {
+  int32_t compressSize = tsWalCompressSize;
+
+  SWalCfg cfg = {1, 0, TAOS_WAL_WRITE, TAOS_WAL_NOT_KEEP};
+  void *  pWal = walOpen((char *)path, &cfg);
+  ASSERT_TRUE(pWal != NULL);
+  ASSERT_EQ(walRenew(pWal), 0);
+
+  for (int32_t v = 1; v <= num; ++v) {
+    tsWalCompressSize = (v >= compFrom) ? 0 : -1;
+    fillRecord(pHead, v);
+    EXPECT_EQ(walWrite(pWal, pHead), 0);
+  }
+  tsWalCompressSize = compressSize;
+
+  int64_t fileId = 0;
+  char    fname[128];
+  ASSERT_EQ(walGetWalFile(pWal, fname, &fileId), 0);
+  snprintf(name, nameLen, "%s/%s", path, fname + strlen("wal/"));
+
+  walFsync(pWal, true);
+  walClose(pWal);
+}
+
+// the offset and the sver of each record of a wal file, and the size of the file at the end
+void scanWal(const char *name, std::vector<int64_t> *offsets, std::vector<int8_t> *svers) {
+  FILE *fp = fopen(name, "r");
+  ASSERT_TRUE(fp != NULL);
+
+  SWalHead head;
+  int64_t  offset = 0;
+  while (fread(&head, sizeof(head), 1, fp) == 1) {
+    offsets->push_back(offset);
+    svers->push_back(head.sver);
+    offset += sizeof(SWalHead) + head.len;
+    fseek(fp, offset, SEEK_SET);
+  }
+  offsets->push_back(offset);
+
+  fclose(fp);
+}
+
+std::vector<uint64_t> restoreWal(const char *path, SWalHead *pHead) {
+  restoredVersions.clear();
+  badRecords = 0;
+
+  SWalCfg cfg = {1, 0, TAOS_WAL_WRITE, TAOS_WAL_NOT_KEEP};
+  void *  pWal = walOpen((char *)path, &cfg);
+  EXPECT_TRUE(pWal != NULL);
+  EXPECT_EQ(walRestore(pWal, pHead, restoreRecord, NULL), 0);
+  walClose(pWal);
+
+  EXPECT_EQ(badRecords, 0);
+  return restoredVersions;
+}
+
+void patchFile(const char *name, int64_t offset, const void *data, int32_t len) {
+  int fd = open(name, O_WRONLY);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(pwrite(fd, data, len, offset), len);
+  close(fd);
+}
+
+}  // namespace
+
+// the records skipped in the middle of a wal file are the same whether it is read ahead or not
+TEST(walTest, restoreCorruptedReadAhead) {
+  const int32_t num = 400;  // about 14MB, several batches of the read ahead
+  SWalHead *    pHead = (SWalHead *)malloc(sizeof(SWalHead) + TSDB_MAX_WAL_SIZE);
+
+  char cmd[512];
+  snprintf(cmd, sizeof(cmd), "rm -rf %s && mkdir -p %s", walTestPath, walTestPath);
+  runCmd(cmd);
+
+  char origin[128];
+  snprintf(origin, sizeof(origin), "%s/origin", walTestPath);
+  char name[160];
+  writeWal(origin, num, num + 1, pHead, name, sizeof(name));
+
+  std::vector<int64_t> offsets;
+  std::vector<int8_t>  svers;
+  scanWal(name, &offsets, &svers);
+  ASSERT_EQ(offsets.size(), num + 1);
+
+  // a byte of the body of two adjacent records
+  char byte = 0x5a;
+  patchFile(name, offsets[29] + sizeof(SWalHead) + 100, &byte, 1);
+  patchFile(name, offsets[30] + sizeof(SWalHead) + 5000, &byte, 1);
+
+  // a len out of range, and a len which makes the body end in the next record
+  int32_t len = 0x7fffff00;
+  patchFile(name, offsets[99] + offsetof(SWalHead, len), &len, sizeof(len));
+  len = recordLen(120) + 8;
+  patchFile(name, offsets[119] + offsetof(SWalHead, len), &len, sizeof(len));
+
+  // a head zeroed, and the start of a body zeroed
+  char zeros[sizeof(SWalHead)] = {0};
+  patchFile(name, offsets[149], zeros, sizeof(zeros));
+  patchFile(name, offsets[213] + sizeof(SWalHead), zeros, sizeof(zeros));
+
+  // the last record is cut
+  ASSERT_EQ(truncate(name, offsets[num - 1] + sizeof(SWalHead) + 10), 0);
+
+  std::vector<uint64_t> expected;
+  for (uint64_t v = 1; v < (uint64_t)num; ++v) {
+    if (v == 30 || v == 31 || v == 100 || v == 120 || v == 150 || v == 214) continue;
+    expected.push_back(v);
+  }
+
+  int32_t readAhead = tsWalRestoreReadAhead;
+  int32_t modes[] = {0, 1, 4};
+  for (int32_t i = 0; i < 3; ++i) {
+    char path[128];
+    snprintf(path, sizeof(path), "%s/readahead%d", walTestPath, modes[i]);
+    snprintf(cmd, sizeof(cmd), "mkdir -p %s && cp %s %s/wal1", path, name, path);
+    runCmd(cmd);
+
+    tsWalRestoreReadAhead = modes[i];
+    std::vector<uint64_t> versions = restoreWal(path, pHead);
+    EXPECT_EQ(versions, expected) << "walRestoreReadAhead " << modes[i];
+  }
+  tsWalRestoreReadAhead = readAhead;
+
+  // the files are left the same by the replays
+  snprintf(cmd, sizeof(cmd), "cmp %s/readahead0/wal1 %s/readahead1/wal1 && cmp %s/readahead0/wal1 %s/readahead4/wal1",
+           walTestPath, walTestPath, walTestPath, walTestPath);
+  runCmd(cmd);
+
+  free(pHead);
+}
+
+// the records compressed by walWrite are decompressed into the records passed to it
+TEST(walTest, compressRoundTrip) {
+  const int32_t num = 40;
+  SWalHead *    pHead = (SWalHead *)malloc(sizeof(SWalHead) + TSDB_MAX_WAL_SIZE);
+  SWalHead *    pRecord = (SWalHead *)malloc(sizeof(SWalHead) + TSDB_MAX_WAL_SIZE);
+  char *        buf = (char *)malloc(sizeof(SWalHead) + TSDB_MAX_WAL_SIZE);
+
+  char cmd[512];
+  snprintf(cmd, sizeof(cmd), "rm -rf %s && mkdir -p %s", walTestPath, walTestPath);
+  runCmd(cmd);
+
+  char name[160];
+  writeWal(walTestPath, num, 1, pHead, name, sizeof(name));
+
+  FILE *fp = fopen(name, "r");
+  ASSERT_TRUE(fp != NULL);
+
+  int32_t nComp = 0;
+  for (uint64_t v = 1; v <= (uint64_t)num; ++v) {
+    ASSERT_EQ(fread(pRecord, sizeof(SWalHead), 1, fp), 1);
+    ASSERT_EQ(fread(pRecord->cont, pRecord->len, 1, fp), 1);
+    ASSERT_EQ(pRecord->version, v);
+
+    // only the compressible records are written compressed
+    if (v % 2 == 1) {
+      ASSERT_EQ(pRecord->sver, 3);
+      ASSERT_LT(pRecord->len, recordLen(v) / 4);
+      nComp++;
+    } else {
+      ASSERT_EQ(pRecord->sver, 2);
+      ASSERT_EQ(pRecord->len, recordLen(v));
+    }
+
+    SWalHead *pDest = (SWalHead *)walDecompressRecord(pRecord, buf);
+    ASSERT_TRUE(pDest != NULL);
+    ASSERT_EQ(pDest->sver, 2);
+    ASSERT_EQ(pDest->version, v);
+
+    fillRecord(pHead, v);
+    ASSERT_EQ(pDest->len, pHead->len);
+    ASSERT_EQ(memcmp(pDest->cont, pHead->cont, pHead->len), 0);
+
+    // the checksum of the record passed to walWrite
+    uint32_t cksum = pDest->cksum;
+    pDest->cksum = 0;
+    ASSERT_EQ(taosCalcChecksum(0, (uint8_t *)pDest, sizeof(SWalHead) + pDest->len), cksum);
+  }
+  ASSERT_EQ(nComp, num / 2);
+  fclose(fp);
+
+  // a compressed record with its data cut can not be decompressed
+  fp = fopen(name, "r");
+  ASSERT_TRUE(fp != NULL);
+  ASSERT_EQ(fread(pRecord, sizeof(SWalHead), 1, fp), 1);
+  ASSERT_EQ(fread(pRecord->cont, pRecord->len, 1, fp), 1);
+  fclose(fp);
+  pRecord->len -= 10;
+  ASSERT_TRUE(walDecompressRecord(pRecord, buf) == NULL);
+
+  free(buf);
+  free(pRecord);
+  free(pHead);
+}
+
+// a wal file of raw and compressed records is restored whether it is read ahead or not
+TEST(walTest, restoreMixedCompressed) {
+  const int32_t num = 300;
+  SWalHead *    pHead = (SWalHead *)malloc(sizeof(SWalHead) + TSDB_MAX_WAL_SIZE);
+
+  char cmd[512];
+  snprintf(cmd, sizeof(cmd), "rm -rf %s && mkdir -p %s", walTestPath, walTestPath);
+  runCmd(cmd);
+
+  // the records before 101 are written raw, the compressible ones from 101 on compressed
+  char origin[128];
+  snprintf(origin, sizeof(origin), "%s/origin", walTestPath);
+  char name[160];
+  writeWal(origin, num, 101, pHead, name, sizeof(name));
+
+  std::vector<int64_t> offsets;
+  std::vector<int8_t>  svers;
+  scanWal(name, &offsets, &svers);
+  ASSERT_EQ(offsets.size(), num + 1);
+  ASSERT_EQ(svers[100], 3);
+  ASSERT_EQ(svers[101], 2);
+  ASSERT_EQ(svers[98], 2);
+
+  // a byte of the LZ4 data of a compressed record, which fails its checksum and is skipped
+  char byte = 0x5a;
+  patchFile(name, offsets[200] + sizeof(SWalHead) + 20, &byte, 1);
+
+  std::vector<uint64_t> expected;
+  for (uint64_t v = 1; v <= (uint64_t)num; ++v) {
+    if (v != 201) expected.push_back(v);
+  }
+
+  int32_t readAhead = tsWalRestoreReadAhead;
+  int32_t modes[] = {0, 4};
+  for (int32_t i = 0; i < 2; ++i) {
+    char path[128];
+    snprintf(path, sizeof(path), "%s/readahead%d", walTestPath, modes[i]);
+    snprintf(cmd, sizeof(cmd), "mkdir -p %s && cp %s %s/wal1", path, name, path);
+    runCmd(cmd);
+
+    tsWalRestoreReadAhead = modes[i];
+    std::vector<uint64_t> versions = restoreWal(path, pHead);
+    EXPECT_EQ(versions, expected) << "walRestoreReadAhead " << modes[i];
+  }
+  tsWalRestoreReadAhead = readAhead;
+
+  free(pHead);
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+
+  tfInit();
+  walInit();
+  int ret = RUN_ALL_TESTS();
+  taosRemoveDir((char *)walTestPath);
+  walCleanUp();
+  tfCleanup();
+
+  return ret;
+}
@@ -0,0 +1,58 @@
+#!/bin/bash
+#
+# Cold super table scan benchmark, compares tsdbReadAheadBlocks settings.
+#
+# usage: perftest-cold-scan.sh <cfg dir> [db] [stable] [loops]
+# The database is expected to be populated already, e.g. by taosBenchmark.
+# Must run as root since the page cache is dropped before every query.
+
+CFG_DIR=${1:-/etc/taos}
+DB=${2:-test}
+STB=${3:-meters}
+NUM_LOOP=${4:-5}
+
+SQL="select count(*), avg(current), max(voltage) from $DB.$STB"
+
+function stopTaosd {
+  PID=`ps -ef|grep -w taosd | grep -v grep | awk '{print $2}'`
+  while [ -n "$PID" ]
+  do
+    pkill -TERM -x taosd
+    sleep 1
+    PID=`ps -ef|grep -w taosd | grep -v grep | awk '{print $2}'`
+  done
+}
+
+function startTaosd {
+  nohup taosd -c $CFG_DIR > /dev/null 2>&1 &
+  sleep 5
+}
+
+function setReadAhead {
+  sed -i '/^tsdbReadAheadBlocks/d' $CFG_DIR/taos.cfg
+  echo "tsdbReadAheadBlocks $1" >> $CFG_DIR/taos.cfg
+}
+
+function runTest {
+  total=0
+  for i in `seq 1 $NUM_LOOP`; do
+    sync
+    echo 3 > /proc/sys/vm/drop_caches
+    start=`date +%s%N`
+    taos -c $CFG_DIR -s "$SQL" > /dev/null
+    end=`date +%s%N`
+    total=`echo "scale=4; $total + ($end - $start) / 1000000" | bc`
+  done
+  echo "scale=2; $total / $NUM_LOOP" | bc
+}
+
+for blocks in 0 4 16; do
+  stopTaosd
+  setReadAhead $blocks
+  startTaosd
+  avg=`runTest`
+  echo "tsdbReadAheadBlocks: $blocks, average cold scan time: $avg ms"
+done
+
+stopTaosd
+sed -i '/^tsdbReadAheadBlocks/d' $CFG_DIR/taos.cfg
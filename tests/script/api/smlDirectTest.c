@@ -0,0 +1,337 @@
+// Schemaless insert shall store the same rows through the direct bind path (smlDirectInsert) as through the SQL path:
+// new child tables, missing tags, columns and tags added or widened in the middle of a batch, and tables dropped and
+// created again by another client while the table meta is cached.
+// usage: smlDirectTest [smlDirectInsert, 0 or 1, default 1] [configDir]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <taos.h>
+
+#define TEST_DB  "sml_direct_test"
+#define START_TS 1626006833639000000LL
+
+static int32_t numOfFailed = 0;
+static int     toOther[2];
+static int     fromOther[2];
+
+#define CHECK(cond)                                                 \
+  do {                                                              \
+    if (!(cond)) {                                                  \
+      printf("line %d, check failed: %s\n", __LINE__, #cond);      \
+      numOfFailed++;                                                \
+    }                                                               \
+  } while (0)
+
+static void execute(TAOS *taos, const char *sql) {
+  TAOS_RES *res = taos_query(taos, sql);
+  if (taos_errno(res) != 0) {
+    printf("failed to execute: %s, reason:%s\n", sql, taos_errstr(res));
+    exit(1);
+  }
+  taos_free_result(res);
+}
+
+// the other client runs in its own process, so its changes are not seen by the table meta cache of this one
+static void runOtherClient(const char *configDir) {
+  close(toOther[1]);
+  close(fromOther[0]);
+
+  if (configDir != NULL) {
+    taos_options(TSDB_OPTION_CONFIGDIR, configDir);
+  }
+
+  TAOS *taos = NULL;
+  char  sql[1024];
+  while (1) {
+    int32_t len = 0;
+    if (read(toOther[0], &len, sizeof(len)) != sizeof(len) || len <= 0) break;
+    if (read(toOther[0], sql, len) != len) break;
+    sql[len] = 0;
+
+    if (taos == NULL) {
+      taos = taos_connect(NULL, "root", "taosdata", TEST_DB, 0);
+    }
+
+    TAOS_RES *res = taos_query(taos, sql);
+    int32_t   code = taos_errno(res);
+    if (code != 0) {
+      printf("other client failed to execute: %s, reason:%s\n", sql, taos_errstr(res));
+    }
+    taos_free_result(res);
+
+    if (write(fromOther[1], &code, sizeof(code)) != sizeof(code)) break;
+  }
+
+  if (taos != NULL) taos_close(taos);
+  exit(0);
+}
+
+static void executeByOther(const char *sql) {
+  int32_t len = (int32_t)strlen(sql);
+  int32_t code = -1;
+  if (write(toOther[1], &len, sizeof(len)) != sizeof(len) || write(toOther[1], sql, len) != len ||
+      read(fromOther[0], &code, sizeof(code)) != sizeof(code) || code != 0) {
+    printf("other client failed to execute: %s\n", sql);
+    exit(1);
+  }
+}
+
+static int32_t insertLines(TAOS *taos, char *lines[], int32_t numOfLines) {
+  TAOS_RES *res = taos_schemaless_insert(taos, lines, numOfLines, TSDB_SML_LINE_PROTOCOL, TSDB_SML_TIMESTAMP_NANO_SECONDS);
+  int32_t   code = taos_errno(res);
+  if (code != 0) {
+    printf("schemaless insert failed, reason:%s\n", taos_errstr(res));
+  }
+  taos_free_result(res);
+  return code;
+}
+
+// the value of the first column of the first row as an integer, -1 if no row
+static int64_t queryInt(TAOS *taos, const char *sql) {
+  TAOS_RES *res = taos_query(taos, sql);
+  if (taos_errno(res) != 0) {
+    printf("failed to query: %s, reason:%s\n", sql, taos_errstr(res));
+    taos_free_result(res);
+    return -1;
+  }
+
+  int64_t     val = -1;
+  TAOS_ROW    row = taos_fetch_row(res);
+  TAOS_FIELD *fields = taos_fetch_fields(res);
+  if (row != NULL && row[0] != NULL) {
+    switch (fields[0].type) {
+      case TSDB_DATA_TYPE_BIGINT:
+        val = *(int64_t *)row[0];
+        break;
+      case TSDB_DATA_TYPE_DOUBLE:
+        val = (int64_t)*(double *)row[0];
+        break;
+      default:
+        val = *(int32_t *)row[0];
+        break;
+    }
+  }
+
+  taos_free_result(res);
+  return val;
+}
+
+// the number of rows of the result
+static int64_t queryRows(TAOS *taos, const char *sql) {
+  TAOS_RES *res = taos_query(taos, sql);
+  if (taos_errno(res) != 0) {
+    printf("failed to query: %s, reason:%s\n", sql, taos_errstr(res));
+    taos_free_result(res);
+    return -1;
+  }
+
+  int64_t rows = 0;
+  while (taos_fetch_row(res) != NULL) {
+    rows++;
+  }
+
+  taos_free_result(res);
+  return rows;
+}
+
+// a column of the first row as a string, empty for NULL or no row
+static void queryString(TAOS *taos, const char *sql, int32_t col, char *buf, int32_t size) {
+  buf[0] = 0;
+
+  TAOS_RES *res = taos_query(taos, sql);
+  if (taos_errno(res) != 0) {
+    printf("failed to query: %s, reason:%s\n", sql, taos_errstr(res));
+    taos_free_result(res);
+    return;
+  }
+
+  TAOS_ROW row = taos_fetch_row(res);
+  if (row != NULL && row[col] != NULL) {
+    int32_t len = taos_fetch_lengths(res)[col];
+    len = (len < size - 1) ? len : size - 1;
+    memcpy(buf, row[col], len);
+    buf[len] = 0;
+  }
+
+  taos_free_result(res);
+}
+
+static void testNewChildTables(TAOS *taos) {
+  char   *lines[30];
+  char    buf[30][256];
+  for (int32_t i = 0; i < 30; ++i) {
+    snprintf(buf[i], sizeof(buf[i]), "st1,t1=%d,t2=g%d c1=%di64,c2=%d.5 %lld", i % 3, i % 3, i, i,
+             START_TS + (long long)(i / 3) * 1000000);
+    lines[i] = buf[i];
+  }
+
+  CHECK(insertLines(taos, lines, 30) == 0);
+  CHECK(queryInt(taos, "select count(*) from st1") == 30);
+  CHECK(queryInt(taos, "select sum(c1) from st1") == 435);
+  CHECK(queryRows(taos, "select last(c1) from st1 group by tbname") == 3);
+  CHECK(queryInt(taos, "select count(*) from st1 where t1 = '2'") == 10);
+  CHECK(queryInt(taos, "select max(c1) from st1 where t1 = '1'") == 28);
+}
+
+static void testNullTags(TAOS *taos) {
+  char *lines[] = {
+      "st2,t1=a,t2=b c1=1i64 1626006833639000000",
+      "st2,t1=c c1=2i64 1626006833639000000",
+      "st2,t2=d c1=3i64 1626006833639000000",
+      "st2,t1=c c1=4i64 1626006833640000000",
+  };
+
+  CHECK(insertLines(taos, lines, 4) == 0);
+  CHECK(queryInt(taos, "select count(*) from st2") == 4);
+  CHECK(queryInt(taos, "select count(*) from st2 where t2 is null") == 2);
+  CHECK(queryInt(taos, "select count(*) from st2 where t1 is null") == 1);
+  CHECK(queryInt(taos, "select sum(c1) from st2 where t1 = 'c'") == 6);
+  CHECK(queryInt(taos, "select c1 from st2 where t2 = 'd'") == 3);
+}
+
+static void testSchemaChange(TAOS *taos) {
+  // a column is added, then widened, and a tag is added in the same batch
+  char *lines[] = {
+      "st3,t1=x c1=1i64 1626006833639000000",
+      "st3,t1=x c1=2i64,c2=\"abc\" 1626006833640000000",
+      "st3,t1=y,t2=z c1=3i64,c2=\"abcdefghijklmnopqrstuvwxyz0123456789\" 1626006833641000000",
+      "st3,t1=x c1=4i64 1626006833642000000",
+  };
+
+  CHECK(insertLines(taos, lines, 4) == 0);
+  CHECK(queryInt(taos, "select count(*) from st3") == 4);
+  CHECK(queryInt(taos, "select count(c2) from st3") == 2);
+  CHECK(queryInt(taos, "select sum(c1) from st3 where t1 = 'x'") == 7);
+
+  char val[64];
+  queryString(taos, "select c2 from st3 where c1 = 3", 0, val, sizeof(val));
+  CHECK(strcmp(val, "abcdefghijklmnopqrstuvwxyz0123456789") == 0);
+  queryString(taos, "select c1, t2 from st3 where c1 = 3", 1, val, sizeof(val));
+  CHECK(strcmp(val, "z") == 0);
+  queryString(taos, "select c1, t2 from st3 where c1 = 1", 1, val, sizeof(val));
+  CHECK(strcmp(val, "") == 0);
+
+  // the statement of the next call is prepared with the schema changed by the last one
+  char *next[] = {
+      "st3,t1=x c1=5i64,c3=true 1626006833643000000",
+      "st3,t1=w,t3=v c1=6i64,c2=\"d\" 1626006833643000000",
+  };
+  CHECK(insertLines(taos, next, 2) == 0);
+
+  // the vgroups of the super table cached by the queries above may miss the one of the new child table
+  execute(taos, "reset query cache");
+  CHECK(queryInt(taos, "select count(*) from st3") == 6);
+  CHECK(queryInt(taos, "select count(c3) from st3") == 1);
+  CHECK(queryInt(taos, "select count(*) from st3 where t3 = 'v'") == 1);
+}
+
+static void testStaleMeta(TAOS *taos) {
+  char *lines[] = {
+      "st4,t1=a c1=1i64 1626006833639000000",
+      "st4,t1=a c1=2i64 1626006833640000000",
+      "st4,t1=b c1=3i64 1626006833639000000",
+  };
+  char *more[] = {
+      "st4,t1=a c1=10i64 1626006833650000000",
+      "st4,t1=b c1=20i64 1626006833650000000",
+  };
+
+  CHECK(insertLines(taos, lines, 3) == 0);
+  CHECK(queryInt(taos, "select count(*) from st4") == 3);
+
+  // the child table is dropped and created again by the other client, the cached meta has the old uid
+  char name[256];
+  char sql[512];
+  queryString(taos, "select tbname from st4 where t1 = 'a'", 0, name, sizeof(name));
+  CHECK(strlen(name) > 0);
+  snprintf(sql, sizeof(sql), "drop table `%s`", name);
+  executeByOther(sql);
+  snprintf(sql, sizeof(sql), "create table `%s` using st4 tags ('a')", name);
+  executeByOther(sql);
+
+  CHECK(insertLines(taos, more, 2) == 0);
+  CHECK(queryInt(taos, "select count(*) from st4") == 3);
+  CHECK(queryInt(taos, "select sum(c1) from st4 where t1 = 'a'") == 10);
+  CHECK(queryInt(taos, "select sum(c1) from st4 where t1 = 'b'") == 23);
+
+  // the super table is dropped and created again by the other client
+  executeByOther("drop stable st4");
+  executeByOther("create stable st4 (ts timestamp, c1 bigint) tags (t1 nchar(16))");
+
+  CHECK(insertLines(taos, lines, 3) == 0);
+  CHECK(queryInt(taos, "select count(*) from st4") == 3);
+  CHECK(queryInt(taos, "select sum(c1) from st4") == 6);
+
+  // and the child table is dropped without being created again
+  queryString(taos, "select tbname from st4 where t1 = 'b'", 0, name, sizeof(name));
+  snprintf(sql, sizeof(sql), "drop table `%s`", name);
+  executeByOther(sql);
+
+  CHECK(insertLines(taos, more, 2) == 0);
+  CHECK(queryInt(taos, "select count(*) from st4") == 4);
+  CHECK(queryInt(taos, "select sum(c1) from st4 where t1 = 'b'") == 20);
+}
+
+int main(int argc, char *argv[]) {
+  const char *direct = (argc > 1) ? argv[1] : "1";
+  const char *configDir = (argc > 2) ? argv[2] : NULL;
+
+  // fork before the client is initialized
+  if (pipe(toOther) != 0 || pipe(fromOther) != 0) {
+    printf("failed to create pipes\n");
+    exit(1);
+  }
+
+  pid_t pid = fork();
+  if (pid < 0) {
+    printf("failed to fork the other client\n");
+    exit(1);
+  } else if (pid == 0) {
+    runOtherClient(configDir);
+  }
+  close(toOther[0]);
+  close(fromOther[1]);
+
+  char config[64];
+  snprintf(config, sizeof(config), "{\"smlDirectInsert\": \"%s\"}", direct);
+  setConfRet ret = taos_set_config(config);
+  if (ret.retCode != SET_CONF_RET_SUCC) {
+    printf("failed to set config, reason:%s\n", ret.retMsg);
+    exit(1);
+  }
+
+  if (configDir != NULL) {
+    taos_options(TSDB_OPTION_CONFIGDIR, configDir);
+  }
+
+  TAOS *taos = taos_connect(NULL, "root", "taosdata", NULL, 0);
+  if (taos == NULL) {
+    printf("failed to connect to server, reason:%s\n", taos_errstr(NULL));
+    exit(1);
+  }
+
+  execute(taos, "drop database if exists " TEST_DB);
+  execute(taos, "create database " TEST_DB " precision 'ns'");
+  execute(taos, "use " TEST_DB);
+
+  testNewChildTables(taos);
+  testNullTags(taos);
+  testSchemaChange(taos);
+  testStaleMeta(taos);
+
+  execute(taos, "drop database if exists " TEST_DB);
+  taos_close(taos);
+
+  close(toOther[1]);
+  waitpid(pid, NULL, 0);
+
+  if (numOfFailed > 0) {
+    printf("smlDirectInsert %s: %d checks failed\n", direct, numOfFailed);
+    exit(1);
+  }
+
+  printf("smlDirectInsert %s: schemaless insert test passed\n", direct);
+  return 0;
+}
@@ -0,0 +1,118 @@
+// Throughput of the schemaless insert, compares the SQL text path with the direct bind path.
+// usage: smlInsertBench [numOfTables] [rowsPerTable] [linesPerCall]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/time.h>
+#include <taos.h>
+#include "os.h"
+#include "taoserror.h"
+#include "tglobal.h"
+
+static int64_t getTimestampUs() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static char **generateLines(int32_t numOfTables, int32_t rowsPerTable) {
+  int32_t total = numOfTables * rowsPerTable;
+  char  **lines = calloc(total, sizeof(char *));
+
+  int64_t ts = 1626006833639000000LL;
+  for (int32_t r = 0; r < rowsPerTable; ++r) {
+    for (int32_t t = 0; t < numOfTables; ++t) {
+      char *line = malloc(256);
+      snprintf(line, 256,
+               "meters,location=beijing,groupid=%d current=%d.%03df32,voltage=%di64,phase=%df64,"
+               "ok=%s,note=\"n%d\",desc=L\"d%d\" %" PRId64,
+               t, r % 100, r % 1000, 200 + r % 20, r % 360, (r % 2) ? "true" : "false", r % 7, t % 5,
+               ts + (int64_t)r * 1000000);
+      lines[r * numOfTables + t] = line;
+    }
+  }
+
+  return lines;
+}
+
+static int32_t runInsert(TAOS *taos, const char *db, char **lines, int32_t total, int32_t linesPerCall, int64_t *elapsed) {
+  char sql[128];
+  snprintf(sql, sizeof(sql), "drop database if exists %s", db);
+  taos_free_result(taos_query(taos, sql));
+  snprintf(sql, sizeof(sql), "create database %s precision 'ns'", db);
+  taos_free_result(taos_query(taos, sql));
+  taos_select_db(taos, db);
+
+  int64_t st = getTimestampUs();
+  for (int32_t i = 0; i < total; i += linesPerCall) {
+    int32_t   num = (total - i < linesPerCall) ? (total - i) : linesPerCall;
+    TAOS_RES *res = taos_schemaless_insert(taos, lines + i, num, TSDB_SML_LINE_PROTOCOL, TSDB_SML_TIMESTAMP_NANO_SECONDS);
+    int32_t   code = taos_errno(res);
+    if (code != 0) {
+      printf("insert failed, reason:%s\n", taos_errstr(res));
+      taos_free_result(res);
+      return code;
+    }
+    taos_free_result(res);
+  }
+  *elapsed = getTimestampUs() - st;
+
+  return 0;
+}
+
+static int64_t countRows(TAOS *taos, const char *db) {
+  char sql[128];
+  snprintf(sql, sizeof(sql), "select count(*) from %s.meters", db);
+
+  int64_t   count = -1;
+  TAOS_RES *res = taos_query(taos, sql);
+  TAOS_ROW  row = taos_fetch_row(res);
+  if (row != NULL && row[0] != NULL) {
+    count = *(int64_t *)row[0];
+  }
+  taos_free_result(res);
+  return count;
+}
+
+int main(int argc, char *argv[]) {
+  int32_t numOfTables = (argc > 1) ? atoi(argv[1]) : 100;
+  int32_t rowsPerTable = (argc > 2) ? atoi(argv[2]) : 1000;
+  int32_t linesPerCall = (argc > 3) ? atoi(argv[3]) : 10000;
+  int32_t total = numOfTables * rowsPerTable;
+
+  TAOS *taos = taos_connect(NULL, "root", "taosdata", NULL, 0);
+  if (taos == NULL) {
+    printf("failed to connect to server, reason:%s\n", taos_errstr(NULL));
+    exit(1);
+  }
+
+  char **lines = generateLines(numOfTables, rowsPerTable);
+
+  const char *dbs[] = {"sml_bench_sql", "sml_bench_bind"};
+  int64_t     elapsed[2] = {0};
+  for (int32_t i = 0; i < 2; ++i) {
+    tsSmlDirectInsert = (int8_t)i;
+    if (runInsert(taos, dbs[i], lines, total, linesPerCall, &elapsed[i]) != 0) {
+      exit(1);
+    }
+
+    int64_t count = countRows(taos, dbs[i]);
+    printf("%-16s %d lines in %.3f s, %.0f lines/s, rows in db: %" PRId64 "\n", (i == 0) ? "sql insert:" : "direct insert:",
+           total, elapsed[i] / 1000000.0, total * 1000000.0 / elapsed[i], count);
+    if (count != total) {
+      printf("unexpected number of rows\n");
+      exit(1);
+    }
+  }
+
+  printf("speedup: %.2fx\n", (double)elapsed[0] / elapsed[1]);
+
+  for (int32_t i = 0; i < total; ++i) {
+    free(lines[i]);
+  }
+  free(lines);
+
+  taos_close(taos);
+  return 0;
+}
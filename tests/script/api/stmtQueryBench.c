@@ -0,0 +1,196 @@
+// Latency of prepared select statements, compares parsing the SQL text with rebinding the query template.
+// usage: stmtQueryBench [numOfTables] [rowsPerTable] [executions]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/time.h>
+#include <taos.h>
+#include "os.h"
+#include "taoserror.h"
+#include "tglobal.h"
+
+#define START_TS 1626006833000LL
+
+static int64_t getTimestampUs() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static void execute(TAOS *taos, const char *sql) {
+  TAOS_RES *res = taos_query(taos, sql);
+  if (taos_errno(res) != 0) {
+    printf("failed to execute: %s, reason:%s\n", sql, taos_errstr(res));
+    exit(1);
+  }
+  taos_free_result(res);
+}
+
+static void prepareData(TAOS *taos, int32_t numOfTables, int32_t rowsPerTable) {
+  execute(taos, "drop database if exists stmt_query_bench");
+  execute(taos, "create database stmt_query_bench");
+  execute(taos, "use stmt_query_bench");
+  execute(taos, "create table st (ts timestamp, c1 int, c2 double, c3 binary(16)) tags (t1 int, t2 binary(16), t3 nchar(16))");
+
+  char *sql = malloc(1024 * 1024);
+  for (int32_t t = 0; t < numOfTables; ++t) {
+    int32_t len = sprintf(sql, "insert into ct%d using st tags (%d, 'g%d', 'n%d') values", t, t, t % 4, t % 3);
+    for (int32_t r = 0; r < rowsPerTable; ++r) {
+      len += sprintf(sql + len, " (%" PRId64 ", %d, %d.5, 'v%d')", START_TS + (int64_t)r * 1000, r % 100 + t, r % 17,
+                     r % 5);
+      if (len > 1000 * 1000 || r == rowsPerTable - 1) {
+        execute(taos, sql);
+        len = sprintf(sql, "insert into ct%d values", t);
+      }
+    }
+  }
+  free(sql);
+}
+
+// digest of the result set, to check that both paths return the same rows
+static uint64_t digestResult(TAOS_RES *res) {
+  uint64_t    digest = 14695981039346656037ULL;
+  int32_t     numOfFields = taos_num_fields(res);
+  TAOS_FIELD *fields = taos_fetch_fields(res);
+  char        buf[4096];
+
+  TAOS_ROW row;
+  while ((row = taos_fetch_row(res)) != NULL) {
+    int32_t len = taos_print_row(buf, row, fields, numOfFields);
+    for (int32_t i = 0; i < len; ++i) {
+      digest = (digest ^ (uint8_t)buf[i]) * 1099511628211ULL;
+    }
+    digest = (digest ^ '\n') * 1099511628211ULL;
+  }
+
+  return digest;
+}
+
+typedef struct {
+  const char *sql;
+  int32_t     numOfParams;
+} SBenchQuery;
+
+// parameters of the i-th execution
+static void bindParams(TAOS_BIND *binds, int64_t *v, char *str, uintptr_t *len, int32_t query, int32_t i,
+                       int32_t numOfTables, int32_t rowsPerTable) {
+  int64_t skey = START_TS + (int64_t)(i * 37 % rowsPerTable) * 1000;
+  int64_t ekey = skey + (int64_t)(rowsPerTable / 4 + 1) * 1000;
+
+  memset(binds, 0, sizeof(TAOS_BIND) * 4);
+  for (int32_t j = 0; j < 4; ++j) {
+    binds[j].buffer_type = TSDB_DATA_TYPE_BIGINT;
+    binds[j].buffer = &v[j];
+    binds[j].buffer_length = sizeof(int64_t);
+  }
+
+  switch (query) {
+    case 0:
+      v[0] = skey;
+      v[1] = ekey;
+      v[2] = i % numOfTables;
+      v[3] = 10;
+      binds[0].buffer_type = TSDB_DATA_TYPE_TIMESTAMP;
+      binds[1].buffer_type = TSDB_DATA_TYPE_TIMESTAMP;
+      break;
+    case 1:
+      len[0] = (uintptr_t)sprintf(str, "g%d", i % 4);
+      binds[0].buffer_type = TSDB_DATA_TYPE_BINARY;
+      binds[0].buffer = str;
+      binds[0].buffer_length = len[0];
+      binds[0].length = &len[0];
+      v[1] = skey;
+      v[2] = 5 + i % 7;
+      v[3] = i % 3;
+      binds[1].buffer_type = TSDB_DATA_TYPE_TIMESTAMP;
+      break;
+    default:
+      v[0] = skey;
+      v[1] = ekey;
+      binds[0].buffer_type = TSDB_DATA_TYPE_TIMESTAMP;
+      binds[1].buffer_type = TSDB_DATA_TYPE_TIMESTAMP;
+      break;
+  }
+}
+
+static int32_t runQueries(TAOS *taos, SBenchQuery *query, int32_t q, int32_t executions, int32_t numOfTables,
+                          int32_t rowsPerTable, uint64_t *digest, int64_t *elapsed) {
+  TAOS_STMT *stmt = taos_stmt_init(taos);
+  if (taos_stmt_prepare(stmt, query->sql, 0) != 0) {
+    printf("failed to prepare: %s, reason:%s\n", query->sql, taos_stmt_errstr(stmt));
+    return -1;
+  }
+
+  TAOS_BIND binds[4];
+  int64_t   v[4];
+  char      str[32];
+  uintptr_t len[4];
+
+  *digest = 0;
+  *elapsed = 0;
+  for (int32_t i = 0; i < executions; ++i) {
+    bindParams(binds, v, str, len, q, i, numOfTables, rowsPerTable);
+
+    int64_t st = getTimestampUs();
+    if (taos_stmt_bind_param(stmt, binds) != 0 || taos_stmt_execute(stmt) != 0) {
+      printf("failed to execute: %s, reason:%s\n", query->sql, taos_stmt_errstr(stmt));
+      taos_stmt_close(stmt);
+      return -1;
+    }
+
+    TAOS_RES *res = taos_stmt_use_result(stmt);
+    *digest = *digest * 31 + digestResult(res);
+    *elapsed += getTimestampUs() - st;
+    taos_free_result(res);
+  }
+
+  taos_stmt_close(stmt);
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  int32_t numOfTables = (argc > 1) ? atoi(argv[1]) : 10;
+  int32_t rowsPerTable = (argc > 2) ? atoi(argv[2]) : 1000;
+  int32_t executions = (argc > 3) ? atoi(argv[3]) : 2000;
+
+  TAOS *taos = taos_connect(NULL, "root", "taosdata", NULL, 0);
+  if (taos == NULL) {
+    printf("failed to connect to server, reason:%s\n", taos_errstr(NULL));
+    exit(1);
+  }
+
+  prepareData(taos, numOfTables, rowsPerTable);
+
+  SBenchQuery queries[] = {
+      {"select count(*), avg(c1), max(c2) from st where ts >= ? and ts < ? and t1 = ? limit ?", 4},
+      {"select ts, c1, c3, t2 from st where t2 = ? and ts > ? order by ts desc limit ? offset ?", 4},
+      {"select count(*), sum(c1), last(c3) from ct0 where ts between ? and ? interval(10s)", 2},
+  };
+
+  int64_t total[2] = {0};
+  for (int32_t q = 0; q < (int32_t)(sizeof(queries) / sizeof(queries[0])); ++q) {
+    uint64_t digest[2] = {0};
+    int64_t  elapsed[2] = {0};
+
+    for (int32_t i = 0; i < 2; ++i) {
+      tsStmtQueryTemplate = (int8_t)i;
+      if (runQueries(taos, &queries[q], q, executions, numOfTables, rowsPerTable, &digest[i], &elapsed[i]) != 0) {
+        exit(1);
+      }
+      total[i] += elapsed[i];
+    }
+
+    printf("%s\n  sql text: %.1f us/query, template: %.1f us/query, speedup: %.2fx\n", queries[q].sql,
+           (double)elapsed[0] / executions, (double)elapsed[1] / executions, (double)elapsed[0] / elapsed[1]);
+    if (digest[0] != digest[1]) {
+      printf("results are different\n");
+      exit(1);
+    }
+  }
+
+  printf("speedup: %.2fx\n", (double)total[0] / total[1]);
+
+  taos_close(taos);
+  return 0;
+}
@@ -0,0 +1,315 @@
+// Prepared select statements shall return the same results with and without the query template (stmtQueryTemplate),
+// when the parameters change their types or values, and when the tables change between executions.
+// usage: stmtQueryTest [configDir]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/time.h>
+#include <taos.h>
+#include "os.h"
+#include "taoserror.h"
+#include "tglobal.h"
+
+#define START_TS      1626006833000LL
+#define NUM_OF_TABLES 8
+#define NUM_OF_ROWS   200
+#define EXECUTIONS    40
+#define MAX_PARAMS    4
+
+static void execute(TAOS *taos, const char *sql) {
+  TAOS_RES *res = taos_query(taos, sql);
+  if (taos_errno(res) != 0) {
+    printf("failed to execute: %s, reason:%s\n", sql, taos_errstr(res));
+    exit(1);
+  }
+  taos_free_result(res);
+}
+
+static void createTable(TAOS *taos, int32_t t, int32_t numOfRows) {
+  char sql[512];
+  sprintf(sql, "create table if not exists ct%d using st tags (%d, 'g%d', 'n%d')", t, t, t % 4, t % 3);
+  execute(taos, sql);
+
+  for (int32_t r = 0; r < numOfRows; r += 50) {
+    char   *values = malloc(50 * 64 + 64);
+    int32_t len = sprintf(values, "insert into ct%d values", t);
+    for (int32_t k = r; k < r + 50 && k < numOfRows; ++k) {
+      len += sprintf(values + len, " (%" PRId64 ", %d, 'v%d')", START_TS + (int64_t)k * 1000, k % 100 + t, k % 5);
+    }
+    execute(taos, values);
+    free(values);
+  }
+}
+
+static void prepareData(TAOS *taos) {
+  execute(taos, "drop database if exists stmt_query_test");
+  execute(taos, "create database stmt_query_test");
+  execute(taos, "use stmt_query_test");
+  execute(taos, "create table st (ts timestamp, c1 int, c2 binary(16)) tags (t1 int, t2 binary(16), t3 nchar(16))");
+  for (int32_t t = 0; t < NUM_OF_TABLES; ++t) {
+    createTable(taos, t, NUM_OF_ROWS);
+  }
+}
+
+static uint64_t digestResult(TAOS_RES *res) {
+  uint64_t    digest = 14695981039346656037ULL;
+  int32_t     numOfFields = taos_num_fields(res);
+  TAOS_FIELD *fields = taos_fetch_fields(res);
+  char        buf[4096];
+
+  TAOS_ROW row;
+  while ((row = taos_fetch_row(res)) != NULL) {
+    int32_t len = taos_print_row(buf, row, fields, numOfFields);
+    for (int32_t i = 0; i < len; ++i) {
+      digest = (digest ^ (uint8_t)buf[i]) * 1099511628211ULL;
+    }
+    digest = (digest ^ '\n') * 1099511628211ULL;
+  }
+
+  return digest;
+}
+
+typedef struct {
+  TAOS_BIND binds[MAX_PARAMS];
+  int64_t   v[MAX_PARAMS];
+  int32_t   i32[MAX_PARAMS];
+  char      str[MAX_PARAMS][32];
+  uintptr_t len[MAX_PARAMS];
+  int       isNull;
+} SParams;
+
+static void setInteger(SParams *p, int32_t j, int32_t type, int64_t v) {
+  p->v[j] = v;
+  p->binds[j].buffer_type = type;
+  p->binds[j].buffer = &p->v[j];
+  p->binds[j].buffer_length = sizeof(int64_t);
+  if (type == TSDB_DATA_TYPE_INT) {
+    p->i32[j] = (int32_t)v;
+    p->binds[j].buffer = &p->i32[j];
+    p->binds[j].buffer_length = sizeof(int32_t);
+  }
+}
+
+static void setString(SParams *p, int32_t j, int32_t type, const char *str) {
+  p->len[j] = (uintptr_t)sprintf(p->str[j], "%s", str);
+  p->binds[j].buffer_type = type;
+  p->binds[j].buffer = p->str[j];
+  p->binds[j].buffer_length = p->len[j];
+  p->binds[j].length = &p->len[j];
+}
+
+typedef struct {
+  const char *sql;
+  void (*bindFp)(SParams *p, int32_t i);
+  void (*changeFp)(TAOS *taos, int32_t i);  // changes the tables before the i-th execution
+} SQueryCase;
+
+// time window and tag of both timestamp and integer types, an empty window, and a null tag value
+static void bindWindowTag(SParams *p, int32_t i) {
+  int64_t skey = START_TS + (int64_t)(i * 37 % NUM_OF_ROWS) * 1000;
+  int64_t ekey = (i % 7 == 3) ? skey - 1000 : skey + 60 * 1000;
+  int32_t tsType = (i % 6 < 3) ? TSDB_DATA_TYPE_TIMESTAMP : TSDB_DATA_TYPE_BIGINT;
+
+  setInteger(p, 0, tsType, skey);
+  setInteger(p, 1, tsType, ekey);
+  if (i % 10 == 9) {
+    p->binds[2].buffer_type = TSDB_DATA_TYPE_INT;
+    p->binds[2].is_null = &p->isNull;
+  } else if (i % 5 == 4) {
+    char tag[16];
+    sprintf(tag, "%d", i % NUM_OF_TABLES);
+    setString(p, 2, TSDB_DATA_TYPE_BINARY, tag);
+  } else {
+    setInteger(p, 2, (i % 2) ? TSDB_DATA_TYPE_INT : TSDB_DATA_TYPE_BIGINT, i % NUM_OF_TABLES);
+  }
+}
+
+// string tag, limit and offset of 0, negative and large values
+static void bindTagLimit(SParams *p, int32_t i) {
+  static const int64_t limits[] = {5, 0, 1, 1000, 3, -1};
+  char                 tag[16];
+
+  sprintf(tag, "g%d", i % 5);
+  setString(p, 0, TSDB_DATA_TYPE_BINARY, tag);
+  setInteger(p, 1, TSDB_DATA_TYPE_TIMESTAMP, START_TS + (int64_t)(i % 50) * 1000);
+  setInteger(p, 2, TSDB_DATA_TYPE_BIGINT, limits[i % 6]);
+  setInteger(p, 3, TSDB_DATA_TYPE_BIGINT, (i % 4 == 3) ? 190 : i % 3);
+}
+
+// nchar tag, slimit and soffset
+static void bindNcharSlimit(SParams *p, int32_t i) {
+  char tag[16];
+
+  sprintf(tag, "n%d", i % 4);
+  setString(p, 0, (i % 3) ? TSDB_DATA_TYPE_NCHAR : TSDB_DATA_TYPE_BINARY, tag);
+  setInteger(p, 1, TSDB_DATA_TYPE_INT, 1 + i % 3);
+  setInteger(p, 2, TSDB_DATA_TYPE_INT, i % 4);
+}
+
+static void bindWindow(SParams *p, int32_t i) {
+  setInteger(p, 0, TSDB_DATA_TYPE_TIMESTAMP, START_TS + (int64_t)(i % 20) * 1000);
+  setInteger(p, 1, TSDB_DATA_TYPE_TIMESTAMP, START_TS + (int64_t)(i % 20 + 100) * 1000);
+  setInteger(p, 2, TSDB_DATA_TYPE_INT, i % 3);
+}
+
+// time windows of a few seconds, and of more intervals than a query with fill may return
+static void bindIntervalWindow(SParams *p, int32_t i) {
+  int64_t skey = START_TS + (int64_t)(i % 20) * 1000;
+  int64_t ekey = (i % 4 == 3) ? skey + 20000LL * 1000 * 1000 : skey + 5000;
+
+  setInteger(p, 0, TSDB_DATA_TYPE_TIMESTAMP, skey);
+  setInteger(p, 1, TSDB_DATA_TYPE_TIMESTAMP, ekey);
+}
+
+// time windows in the range of interp, and before it, which has no result with fill(next)
+static void bindRangeWindow(SParams *p, int32_t i) {
+  int64_t skey = (i % 3 == 2) ? START_TS - 100 * 1000 : START_TS + (int64_t)(i % 20) * 1000;
+
+  setInteger(p, 0, TSDB_DATA_TYPE_TIMESTAMP, skey);
+  setInteger(p, 1, TSDB_DATA_TYPE_TIMESTAMP, skey + 30 * 1000);
+}
+
+// the query templates are built while the table meta is not cached, and used while the tables are dropped, created
+// and altered
+static void changeTables(TAOS *taos, int32_t i) {
+  char sql[256];
+
+  switch (i) {
+    case 0:
+      execute(taos, "reset query cache");
+      break;
+    case 5:
+      execute(taos, "drop table ct1");
+      break;
+    case 10:
+      createTable(taos, 1, NUM_OF_ROWS / 2);
+      createTable(taos, NUM_OF_TABLES, NUM_OF_ROWS);
+      break;
+    case 15:
+      execute(taos, "alter table st add column c3 double");
+      break;
+    case 20:
+      execute(taos, "alter table ct2 set tag t1 = 100");
+      break;
+    case 25:
+      execute(taos, "drop table st");
+      execute(taos, "create table st (ts timestamp, c1 int, c2 binary(16)) tags (t1 int, t2 binary(16), t3 nchar(16))");
+      for (int32_t t = 0; t < 3; ++t) {
+        createTable(taos, t, NUM_OF_ROWS / 4);
+      }
+      break;
+    case 30:
+      sprintf(sql, "insert into ct0 values (%" PRId64 ", 1000, 'new')", START_TS + 5500);
+      execute(taos, sql);
+      break;
+    default:
+      break;
+  }
+}
+
+static int32_t countParams(const char *sql) {
+  int32_t n = 0;
+  for (const char *c = sql; *c; ++c) {
+    n += (*c == '?');
+  }
+  return n;
+}
+
+// run all the executions of a case, the error code and the result digest of each execution are kept
+static void runCase(TAOS *taos, SQueryCase *pCase, int32_t *codes, uint64_t *digests) {
+  prepareData(taos);
+
+  TAOS_STMT *stmt = taos_stmt_init(taos);
+  if (taos_stmt_prepare(stmt, pCase->sql, 0) != 0) {
+    printf("failed to prepare: %s, reason:%s\n", pCase->sql, taos_stmt_errstr(stmt));
+    exit(1);
+  }
+
+  for (int32_t i = 0; i < EXECUTIONS; ++i) {
+    SParams p;
+    memset(&p, 0, sizeof(p));
+    p.isNull = 1;
+
+    if (pCase->changeFp != NULL) {
+      (*pCase->changeFp)(taos, i);
+    }
+
+    pCase->bindFp(&p, i);
+    codes[i] = taos_stmt_bind_param(stmt, p.binds);
+    if (codes[i] == 0) {
+      codes[i] = taos_stmt_execute(stmt);
+    }
+
+    digests[i] = 0;
+    if (codes[i] == 0) {
+      TAOS_RES *res = taos_stmt_use_result(stmt);
+      digests[i] = digestResult(res);
+      taos_free_result(res);
+    }
+  }
+
+  taos_stmt_close(stmt);
+}
+
+int main(int argc, char *argv[]) {
+  if (argc > 1) {
+    taos_options(TSDB_OPTION_CONFIGDIR, argv[1]);
+  }
+
+  TAOS *taos = taos_connect(NULL, "root", "taosdata", NULL, 0);
+  if (taos == NULL) {
+    printf("failed to connect to server, reason:%s\n", taos_errstr(NULL));
+    exit(1);
+  }
+
+  SQueryCase cases[] = {
+      {"select count(*), sum(c1) from st where ts >= ? and ts < ? and t1 = ?", bindWindowTag, NULL},
+      {"select ts, c1, t2 from st where t2 = ? and ts > ? order by ts desc limit ? offset ?", bindTagLimit, NULL},
+      {"select count(*), max(c1) from st where t3 = ? group by t1 slimit ? soffset ?", bindNcharSlimit, NULL},
+      {"select count(*), last(c1), last(c2) from st where ts between ? and ? and t1 >= ?", bindWindow, changeTables},
+      {"select c1, c2 from ct0 where ts >= ? and ts <= ? limit 50 offset ?", bindWindow, changeTables},
+      {"select count(*), max(c1) from ct0 where ts >= ? and ts < ? interval(10a) fill(null)", bindIntervalWindow, NULL},
+      {"select interp(c1) from ct0 where ts >= ? and ts <= ? range(1626006843000, 1626006853000) every(1s) fill(next)",
+       bindRangeWindow, NULL},
+  };
+
+  int32_t failed = 0;
+  for (int32_t c = 0; c < (int32_t)(sizeof(cases) / sizeof(cases[0])); ++c) {
+    int32_t  codes[2][EXECUTIONS];
+    uint64_t digests[2][EXECUTIONS];
+
+    if (countParams(cases[c].sql) > MAX_PARAMS) {
+      printf("too many parameters: %s\n", cases[c].sql);
+      exit(1);
+    }
+
+    for (int32_t t = 0; t < 2; ++t) {
+      tsStmtQueryTemplate = (int8_t)t;
+      runCase(taos, &cases[c], codes[t], digests[t]);
+    }
+
+    int32_t numOfSucc = 0;
+    for (int32_t i = 0; i < EXECUTIONS; ++i) {
+      numOfSucc += (codes[0][i] == 0);
+      if (codes[0][i] != codes[1][i] || digests[0][i] != digests[1][i]) {
+        printf("%s\n  execution %d: code 0x%x/0x%x, digest %" PRIx64 "/%" PRIx64 "\n", cases[c].sql, i, codes[0][i],
+               codes[1][i], digests[0][i], digests[1][i]);
+        failed += 1;
+      }
+    }
+
+    printf("%s\n  %d executions, %d succeeded\n", cases[c].sql, EXECUTIONS, numOfSucc);
+  }
+
+  execute(taos, "drop database if exists stmt_query_test");
+  taos_close(taos);
+
+  if (failed > 0) {
+    printf("%d executions are different with the query template\n", failed);
+    exit(1);
+  }
+
+  printf("query template test passed\n");
+  return 0;
+}
@@ -0,0 +1,8 @@
+#!/bin/bash
+
+# generate the rows of a 1000 bytes binary column to import from a file: <file> <rows>
+FILE=$1
+ROWS=$2
+BIN=`head -c 1000 /dev/zero | tr '\0' x`
+
+seq -f "%.0f" 1600000000000 $((1600000000000 + ROWS - 1)) | sed "s/$/,1,'$BIN'/" > $FILE
@@ -557,6 +557,29 @@ if [ "$2" != "sim" ] && [ "$2" != "python" ] && [ "$2" != "jdbc" ] && [ "$2" !=
     echo "demo pass"
     totalExamplePass=`expr $totalExamplePass + 1`
   fi
+
+  cd $tests_dir/script/api
+  echo "building stmt query test"
+  make > /dev/null
+  ./stmtQueryTest > /dev/null 2>&1
+  if [ $? != "0" ]; then
+    echo "stmtQueryTest failed"
+    totalExampleFailed=`expr $totalExampleFailed + 1`
+  else
+    echo "stmtQueryTest pass"
+    totalExamplePass=`expr $totalExamplePass + 1`
+  fi
+
+  for direct in 0 1; do
+    ./smlDirectTest $direct > /dev/null 2>&1
+    if [ $? != "0" ]; then
+      echo "smlDirectTest $direct failed"
+      totalExampleFailed=`expr $totalExampleFailed + 1`
+    else
+      echo "smlDirectTest $direct pass"
+      totalExamplePass=`expr $totalExamplePass + 1`
+    fi
+  done
   echo "### run setconfig tests ###"
 
   stopTaosd